@@ -18,11 +18,13 @@
  */
 
 #include "component_p.h"
+#include "networksession_p.h"
 #include "../error.h"
 #include <QJsonParseError>
 #include <QUrl>
 #include <QReadWriteLock>
 #include <QGlobalStatic>
+#include <QCryptographicHash>
 
 using namespace Fuoten;
 
@@ -74,11 +76,127 @@ public:
         m_defaultNotificator = notificator;
     }
 
+    RequestCoalescer *coalescer() const
+    {
+        return m_defaultCoalescer;
+    }
+
+    void setCoalescer(RequestCoalescer *coalescer)
+    {
+        m_defaultCoalescer = coalescer;
+    }
+
+    int maxConnectionsPerHost() const
+    {
+        return m_maxConnectionsPerHost;
+    }
+
+    void setMaxConnectionsPerHost(int max)
+    {
+        m_maxConnectionsPerHost = max;
+    }
+
+    int reservedInteractiveConnections() const
+    {
+        return m_reservedInteractiveConnections;
+    }
+
+    void setReservedInteractiveConnections(int reserved)
+    {
+        m_reservedInteractiveConnections = reserved;
+    }
+
+    bool http2Allowed() const
+    {
+        return m_http2Allowed;
+    }
+
+    void setHttp2Allowed(bool allowed)
+    {
+        m_http2Allowed = allowed;
+    }
+
+    int backgroundDecodingThreshold() const
+    {
+        return m_backgroundDecodingThreshold;
+    }
+
+    void setBackgroundDecodingThreshold(int bytes)
+    {
+        m_backgroundDecodingThreshold = bytes;
+    }
+
+    int maxRetries() const
+    {
+        return m_maxRetries;
+    }
+
+    void setMaxRetries(int retries)
+    {
+        m_maxRetries = retries;
+    }
+
+    int retryBaseDelay() const
+    {
+        return m_retryBaseDelay;
+    }
+
+    void setRetryBaseDelay(int msecs)
+    {
+        m_retryBaseDelay = msecs;
+    }
+
+    AbstractMetricsSink *metricsSink() const
+    {
+        return m_defaultMetricsSink;
+    }
+
+    void setMetricsSink(AbstractMetricsSink *sink)
+    {
+        m_defaultMetricsSink = sink;
+    }
+
+    TrafficRecorder *trafficRecorder() const
+    {
+        return m_defaultTrafficRecorder;
+    }
+
+    void setTrafficRecorder(TrafficRecorder *recorder)
+    {
+        m_defaultTrafficRecorder = recorder;
+    }
+
+    JsonDecoder *jsonDecoder() const
+    {
+        return m_defaultJsonDecoder;
+    }
+
+    void setJsonDecoder(JsonDecoder *decoder)
+    {
+        m_defaultJsonDecoder = decoder;
+    }
+
+    FastJsonDecoder *fastJsonDecoder()
+    {
+        return &m_fastJsonDecoder;
+    }
+
 private:
+    FastJsonDecoder m_fastJsonDecoder;
     AbstractConfiguration *m_defaultConfig = nullptr;
     AbstractStorage *m_defaultStorage = nullptr;
     AbstractNamFactory *m_namFactory = nullptr;
     AbstractNotificator *m_defaultNotificator = nullptr;
+    RequestCoalescer *m_defaultCoalescer = nullptr;
+    AbstractMetricsSink *m_defaultMetricsSink = nullptr;
+    TrafficRecorder *m_defaultTrafficRecorder = nullptr;
+    JsonDecoder *m_defaultJsonDecoder = nullptr;
+    int m_maxConnectionsPerHost = 6;
+    int m_reservedInteractiveConnections = 2;
+    int m_backgroundDecodingThreshold = 256 * 1024;
+    int m_maxRetries = 3;
+    int m_retryBaseDelay = 1000;
+    bool m_http2Allowed = true;
 };
 Q_GLOBAL_STATIC(DefaultValues, defVals)
 
@@ -179,6 +297,281 @@ void ComponentPrivate::setDefaultNotificator(AbstractNotificator *notificator)
 }
 
 
+RequestCoalescer *ComponentPrivate::defaultCoalescer()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    RequestCoalescer *rc = defs->coalescer();
+    defs->lock.unlock();
+
+    return rc;
+}
+
+
+void ComponentPrivate::setDefaultCoalescer(RequestCoalescer *coalescer)
+{
+    qDebug("Setting default coalescer to %p.", coalescer);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setCoalescer(coalescer);
+}
+
+
+int ComponentPrivate::maxConnectionsPerHost()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    const int max = defs->maxConnectionsPerHost();
+    defs->lock.unlock();
+
+    return max;
+}
+
+
+void ComponentPrivate::setMaxConnectionsPerHost(int max)
+{
+    qDebug("Setting maximum connections per host to %i.", max);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setMaxConnectionsPerHost(max);
+}
+
+
+int ComponentPrivate::reservedInteractiveConnections()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    const int reserved = defs->reservedInteractiveConnections();
+    defs->lock.unlock();
+
+    return reserved;
+}
+
+
+void ComponentPrivate::setReservedInteractiveConnections(int reserved)
+{
+    qDebug("Setting reserved interactive connections to %i.", reserved);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setReservedInteractiveConnections(reserved);
+}
+
+
+bool ComponentPrivate::http2Allowed()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    const bool allowed = defs->http2Allowed();
+    defs->lock.unlock();
+
+    return allowed;
+}
+
+
+void ComponentPrivate::setHttp2Allowed(bool allowed)
+{
+    qDebug("Setting HTTP/2 allowed to %s.", allowed ? "true" : "false");
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setHttp2Allowed(allowed);
+}
+
+
+int ComponentPrivate::backgroundDecodingThreshold()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    const int bytes = defs->backgroundDecodingThreshold();
+    defs->lock.unlock();
+
+    return bytes;
+}
+
+
+void ComponentPrivate::setBackgroundDecodingThreshold(int bytes)
+{
+    qDebug("Setting background decoding threshold to %i bytes.", bytes);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setBackgroundDecodingThreshold(bytes);
+}
+
+
+int ComponentPrivate::maxRetries()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    const int retries = defs->maxRetries();
+    defs->lock.unlock();
+
+    return retries;
+}
+
+
+void ComponentPrivate::setMaxRetries(int retries)
+{
+    qDebug("Setting maximum retries to %i.", retries);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setMaxRetries(retries);
+}
+
+
+int ComponentPrivate::retryBaseDelay()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    const int msecs = defs->retryBaseDelay();
+    defs->lock.unlock();
+
+    return msecs;
+}
+
+
+void ComponentPrivate::setRetryBaseDelay(int msecs)
+{
+    qDebug("Setting retry base delay to %i milliseconds.", msecs);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setRetryBaseDelay(msecs);
+}
+
+
+AbstractMetricsSink *ComponentPrivate::defaultMetricsSink()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    AbstractMetricsSink *sink = defs->metricsSink();
+    defs->lock.unlock();
+
+    return sink;
+}
+
+
+void ComponentPrivate::setDefaultMetricsSink(AbstractMetricsSink *sink)
+{
+    qDebug("Setting default metrics sink to %p.", sink);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setMetricsSink(sink);
+}
+
+
+TrafficRecorder *ComponentPrivate::defaultTrafficRecorder()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    TrafficRecorder *recorder = defs->trafficRecorder();
+    defs->lock.unlock();
+
+    return recorder;
+}
+
+
+void ComponentPrivate::setDefaultTrafficRecorder(TrafficRecorder *recorder)
+{
+    qDebug("Setting default traffic recorder to %p.", recorder);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setTrafficRecorder(recorder);
+}
+
+
+JsonDecoder *ComponentPrivate::defaultJsonDecoder()
+{
+    const DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    JsonDecoder *decoder = defs->jsonDecoder();
+    defs->lock.unlock();
+
+    return decoder;
+}
+
+
+void ComponentPrivate::setDefaultJsonDecoder(JsonDecoder *decoder)
+{
+    qDebug("Setting default JSON decoder to %p.", decoder);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+    QWriteLocker locker(&defs->lock);
+
+    defs->setJsonDecoder(decoder);
+}
+
+
+const JsonDecoder *ComponentPrivate::jsonDecoder()
+{
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->lock.lockForRead();
+    const JsonDecoder *decoder = defs->jsonDecoder();
+    if (!decoder) {
+        decoder = defs->fastJsonDecoder();
+    }
+    defs->lock.unlock();
+
+    return decoder;
+}
+
+
+int ComponentPrivate::parallelDecodingThreshold()
+{
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    return defs->fastJsonDecoder()->parallelDecodingThreshold();
+}
+
+
+void ComponentPrivate::setParallelDecodingThreshold(int bytes)
+{
+    qDebug("Setting parallel decoding threshold to %i bytes.", bytes);
+    DefaultValues *defs = defVals();
+    Q_ASSERT(defs);
+
+    defs->fastJsonDecoder()->setParallelDecodingThreshold(bytes);
+}
+
+
 Component::Component(QObject *parent) :
     QObject(parent), d_ptr(new ComponentPrivate)
 {
@@ -195,6 +588,17 @@ Component::Component(ComponentPrivate &dd, QObject *parent) :
 
 Component::~Component()
 {
+    Q_D(Component);
+    // replies of the shared network session are not children of this object
+    if (!d->networkAccessManager) {
+        if (d->reply) {
+            d->reply->disconnect(this);
+            d->reply->abort();
+            d->reply->deleteLater();
+        } else if (d->sessionTicket) {
+            NetworkSession::current()->cancel(d->sessionTicket);
+        }
+    }
 }
 
 
@@ -212,14 +616,24 @@ void Component::sendRequest()
 
     setError(nullptr);
 
+    if (!d->retrying) {
+        d->retryCount = 0;
+    }
+    d->retrying = false;
+
     d->result.clear();
     d->jsonResult = QJsonDocument();
+    d->resultDecoded = false;
+    d->records.clear();
+    d->replyHash.clear();
 
     if (Q_UNLIKELY(!checkInput())) {
         setInOperation(false);
         return;
     }
 
+    d->startMetrics();
+
     QUrl url;
 
     if (d->configuration->getUseSSL()) {
@@ -247,19 +661,22 @@ void Component::sendRequest()
     Q_ASSERT_X(url.isValid(), "send request", "invalid API URL");
 
     if (!d->networkAccessManager) {
+        // without a factory the shared network session of the current thread is used
         AbstractNamFactory *namf = Component::networkAccessManagerFactory();
         if (namf) {
             d->networkAccessManager = namf->create(this);
-        } else {
-            d->networkAccessManager = new QNetworkAccessManager(this);
-        }
-        if (d->configuration->getIgnoreSSLErrors()) {
-            connect(d->networkAccessManager, &QNetworkAccessManager::sslErrors, this, &Component::_ignoreSSLErrors);
+            if (d->configuration->getIgnoreSSLErrors()) {
+                connect(d->networkAccessManager, &QNetworkAccessManager::sslErrors, this, &Component::_ignoreSSLErrors);
+            }
         }
     }
 
     QNetworkRequest nr(url);
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    nr.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, ComponentPrivate::http2Allowed());
+#endif
+
     if (!d->requestHeaders.isEmpty()) {
         QHash<QByteArray, QByteArray>::const_iterator i = d->requestHeaders.constBegin();
         while (i != d->requestHeaders.constEnd()) {
@@ -303,22 +720,49 @@ void Component::sendRequest()
     }
 #endif
 
-    if (Q_LIKELY(d->requestTimeout > 0)) {
-        if (!d->timeoutTimer) {
-            d->timeoutTimer = new QTimer(this);
-            qDebug("Created new timeout timer at %p.", d->timeoutTimer);
-            d->timeoutTimer->setSingleShot(true);
-            d->timeoutTimer->setTimerType(Qt::VeryCoarseTimer);
-            connect(d->timeoutTimer, &QTimer::timeout, this, &Component::_requestTimedOut);
+    // the timeout only covers the request itself, not the time it waits in the queue of the network session
+    auto startTimeoutTimer = [this, d] () {
+        if (Q_LIKELY(d->requestTimeout > 0)) {
+            if (!d->timeoutTimer) {
+                d->timeoutTimer = new QTimer(this);
+                qDebug("Created new timeout timer at %p.", d->timeoutTimer);
+                d->timeoutTimer->setSingleShot(true);
+                d->timeoutTimer->setTimerType(Qt::VeryCoarseTimer);
+                connect(d->timeoutTimer, &QTimer::timeout, this, &Component::_requestTimedOut);
+            }
+            d->timeoutTimer->start(d->requestTimeout * 1000);
+            qDebug("Started timeout timer with %u seconds.", d->requestTimeout);
         }
-        d->timeoutTimer->start(d->requestTimeout * 1000);
-        qDebug("Started timeout timer with %u seconds.", d->requestTimeout);
-    }
+    };
+
+    d->requestUrl = url;
 
-    d->performNetworkOperation(nr);
-    Q_CHECK_PTR(d->reply);
-    if (!connect(d->reply, &QNetworkReply::finished, this, &Component::_requestFinished)) {
-        qFatal("Failed to connect QNetworkReply to Component::_requestFinished slot.");
+    if (d->networkAccessManager) {
+        startTimeoutTimer();
+        d->reply = d->performNetworkOperation(d->networkAccessManager, nr);
+        Q_CHECK_PTR(d->reply);
+        d->watchReply(d->reply, this);
+        if (!connect(d->reply, &QNetworkReply::finished, this, &Component::_requestFinished)) {
+            qFatal("Failed to connect QNetworkReply to Component::_requestFinished slot.");
+        }
+    } else {
+        const bool ignoreSSLErrors = d->configuration->getIgnoreSSLErrors();
+        NetworkSession *session = NetworkSession::current();
+        d->queueDepth = session->queuedRequests();
+        d->sessionTicket = session->enqueue(url, d->priority, this, [d, nr] (QNetworkAccessManager *nam) {
+            return d->performNetworkOperation(nam, nr);
+        }, [this, d, ignoreSSLErrors, startTimeoutTimer] (QNetworkReply *reply) {
+            d->sessionTicket = 0;
+            startTimeoutTimer();
+            d->reply = reply;
+            d->watchReply(reply, this);
+            if (ignoreSSLErrors) {
+                connect(reply, &QNetworkReply::sslErrors, this, [this, reply] (const QList<QSslError> &errors) {_ignoreSSLErrors(reply, errors);});
+            }
+            if (!connect(reply, &QNetworkReply::finished, this, &Component::_requestFinished)) {
+                qFatal("Failed to connect QNetworkReply to Component::_requestFinished slot.");
+            }
+        });
     }
 }
 
@@ -334,18 +778,62 @@ void Component::_requestFinished()
 
     qDebug("%s", "Reading network reply data.");
     d->result = d->reply->readAll();
+    d->replyFinished(d->reply);
+
+    TrafficRecorder *recorder = ComponentPrivate::defaultTrafficRecorder();
+    if (recorder && (d->httpStatus > 0)) {
+        recorder->record(QString::fromLatin1(d->operationName()), TrafficRecord::routeFromUrl(d->requestUrl), d->payload, d->httpStatus, d->reply->header(QNetworkRequest::ContentTypeHeader).toByteArray(), d->result);
+    }
 
     if (Q_LIKELY(d->reply->error() == QNetworkReply::NoError)) {
 
-        if (checkOutput()) {
-            qDebug("%s", "Calling successCallback().");
-            successCallback();
-        } else {
-            setInOperation(false);
+        if (d->skipUnchanged && isUseStorageEnabled() && storage()) {
+            d->replyHash = QCryptographicHash::hash(d->result, QCryptographicHash::Sha1);
+            if (storage()->replyHash(d->replyHashKey()) == d->replyHash) {
+                qDebug("%s", "Reply did not change since the last request. Skipping processing.");
+                d->replyHash.clear();
+                d->reply->deleteLater();
+                d->reply = nullptr;
+                d->recordMetrics(RequestMetrics::Unchanged);
+                setInOperation(false);
+                Q_EMIT replyUnchanged();
+                return;
+            }
+        }
+
+        const int threshold = ComponentPrivate::backgroundDecodingThreshold();
+        if ((d->expectedJSONType != Empty) && (threshold > 0) && (d->result.size() >= threshold)) {
+            qDebug("Decoding %i bytes of reply data in the background.", d->result.size());
+            d->reply->deleteLater();
+            d->reply = nullptr;
+
+            // the worker deletes itself, so a running decoding does not block the destruction of this object
+            JsonDecodeWorker *worker = new JsonDecodeWorker(d->result, d->recordType, ComponentPrivate::jsonDecoder());
+            connect(worker, &QThread::finished, this, [this, d, worker] () {
+                if (d->recordType != DecodedRecords::None) {
+                    d->records = worker->records();
+                } else {
+                    d->jsonResult = worker->document();
+                    d->jsonParseError = worker->parseError();
+                    d->resultDecoded = true;
+                }
+                d->parseTime = worker->elapsed();
+                d->processResult(this);
+            });
+            connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+            worker->start();
+            return;
         }
 
+        d->processResult(this);
+
+    } else if (d->isRetryable(d->reply)) {
+        qDebug("Request failed with transient error: %s", qUtf8Printable(d->reply->errorString()));
+        d->recordMetrics(RequestMetrics::Retried);
+        d->scheduleRetry(this);
     } else {
         qDebug("%s", "Extracting error data from network reply.");
+        d->recordMetrics(RequestMetrics::Failed);
         extractError(d->reply);
         setInOperation(false);
     }
@@ -355,6 +843,14 @@ void Component::_requestFinished()
 }
 
 
+void Component::_retryRequest()
+{
+    Q_D(Component);
+    d->retrying = true;
+    sendRequest();
+}
+
+
 void Component::extractError(QNetworkReply *reply)
 {
     Q_ASSERT_X(reply, "extract error", "invalid QNetworkReply");
@@ -370,14 +866,36 @@ void Component::_requestTimedOut()
 {
     Q_D(Component);
 
+    if (d->isRetryable(nullptr)) {
+        qDebug("Request timed out after %u seconds.", requestTimeout());
+        d->recordMetrics(RequestMetrics::TimedOut);
+        if (d->reply) {
+            QNetworkReply *nr = d->reply;
+            d->reply = nullptr;
+            delete nr;
+        } else if (d->sessionTicket) {
+            NetworkSession::current()->cancel(d->sessionTicket);
+            d->sessionTicket = 0;
+        }
+        d->scheduleRetry(this);
+        return;
+    }
+
     //% "The connection to the server timed out after %n second(s)."
-    setError(new Error(Error::RequestError, Error::Critical, qtTrId("err-conn-timeout", requestTimeout()), d->reply->request().url().toString(), this));
+    setError(new Error(Error::RequestError, Error::Critical, qtTrId("err-conn-timeout", requestTimeout()), d->requestUrl.toString(), this));
 
+    d->recordMetrics(RequestMetrics::TimedOut);
     setInOperation(false);
 
-    QNetworkReply *nr = d->reply;
-    d->reply = nullptr;
-    delete nr;
+    if (d->reply) {
+        QNetworkReply *nr = d->reply;
+        d->reply = nullptr;
+        delete nr;
+    } else if (d->sessionTicket) {
+        // the request is still waiting for a free connection
+        NetworkSession::current()->cancel(d->sessionTicket);
+        d->sessionTicket = 0;
+    }
     Q_EMIT failed(error());
 }
 
@@ -417,9 +935,26 @@ bool Component::checkOutput()
 {
     Q_D(Component);
 
+    if (d->recordType != DecodedRecords::None) {
+        // classes that decode into typed records build the JSON document only on demand in jsonResult()
+        if (!d->records.decoded) {
+            d->records.decode(d->recordType, ComponentPrivate::jsonDecoder(), d->result);
+        }
+        if (Q_UNLIKELY(!d->records.valid)) {
+            setError(new Error(Error::OutputError, Error::Critical, d->records.errorString, QString(), this));
+            Q_EMIT failed(error());
+            return false;
+        }
+        return true;
+    }
+
     if (!(d->expectedJSONType == Empty)) {
         QJsonParseError jsonError;
-        d->jsonResult = QJsonDocument::fromJson(d->result, &jsonError);
+        if (d->resultDecoded) {
+            jsonError = d->jsonParseError;
+        } else {
+            d->jsonResult = QJsonDocument::fromJson(d->result, &jsonError);
+        }
         if (jsonError.error != QJsonParseError::NoError) {
             setError(new Error(jsonError, this));
             Q_EMIT failed(error());
@@ -562,6 +1097,32 @@ void Component::setUseStorage(bool useStorage)
 }
 
 
+Component::Priority Component::priority() const { Q_D(const Component); return d->priority; }
+
+void Component::setPriority(Priority priority)
+{
+    Q_D(Component);
+    if (priority != d->priority) {
+        d->priority = priority;
+        qDebug("Changed priority to %i.", d->priority);
+        Q_EMIT priorityChanged(d->priority);
+    }
+}
+
+
+bool Component::isSkipUnchangedEnabled() const { Q_D(const Component); return d->skipUnchanged; }
+
+void Component::setSkipUnchanged(bool skipUnchanged)
+{
+    Q_D(Component);
+    if (skipUnchanged != d->skipUnchanged) {
+        d->skipUnchanged = skipUnchanged;
+        qDebug("Changed skipUnchanged to %s.", d->skipUnchanged ? "true" : "false");
+        Q_EMIT skipUnchangedChanged(d->skipUnchanged);
+    }
+}
+
+
 AbstractNotificator *Component::notificator() const
 {
     Q_D(const Component);
@@ -631,6 +1192,144 @@ AbstractNotificator *Component::defaultNotificator()
 }
 
 
+void Component::setDefaultCoalescer(RequestCoalescer *coalescer)
+{
+    ComponentPrivate::setDefaultCoalescer(coalescer);
+}
+
+
+RequestCoalescer *Component::defaultCoalescer()
+{
+    return ComponentPrivate::defaultCoalescer();
+}
+
+
+void Component::setMaxConnectionsPerHost(int max)
+{
+    ComponentPrivate::setMaxConnectionsPerHost(max);
+}
+
+
+int Component::maxConnectionsPerHost()
+{
+    return ComponentPrivate::maxConnectionsPerHost();
+}
+
+
+void Component::setReservedInteractiveConnections(int reserved)
+{
+    ComponentPrivate::setReservedInteractiveConnections(reserved);
+}
+
+
+int Component::reservedInteractiveConnections()
+{
+    return ComponentPrivate::reservedInteractiveConnections();
+}
+
+
+int Component::queuedRequests()
+{
+    return NetworkSession::current()->queuedRequests();
+}
+
+
+void Component::setHttp2Allowed(bool allowed)
+{
+    ComponentPrivate::setHttp2Allowed(allowed);
+}
+
+
+bool Component::http2Allowed()
+{
+    return ComponentPrivate::http2Allowed();
+}
+
+
+void Component::setBackgroundDecodingThreshold(int bytes)
+{
+    ComponentPrivate::setBackgroundDecodingThreshold(bytes);
+}
+
+
+int Component::backgroundDecodingThreshold()
+{
+    return ComponentPrivate::backgroundDecodingThreshold();
+}
+
+
+void Component::setParallelDecodingThreshold(int bytes)
+{
+    ComponentPrivate::setParallelDecodingThreshold(bytes);
+}
+
+
+int Component::parallelDecodingThreshold()
+{
+    return ComponentPrivate::parallelDecodingThreshold();
+}
+
+
+void Component::setMaxRetries(int retries)
+{
+    ComponentPrivate::setMaxRetries(retries);
+}
+
+
+int Component::maxRetries()
+{
+    return ComponentPrivate::maxRetries();
+}
+
+
+void Component::setRetryBaseDelay(int msecs)
+{
+    ComponentPrivate::setRetryBaseDelay(msecs);
+}
+
+
+int Component::retryBaseDelay()
+{
+    return ComponentPrivate::retryBaseDelay();
+}
+
+
+void Component::setDefaultMetricsSink(AbstractMetricsSink *sink)
+{
+    ComponentPrivate::setDefaultMetricsSink(sink);
+}
+
+
+AbstractMetricsSink *Component::defaultMetricsSink()
+{
+    return ComponentPrivate::defaultMetricsSink();
+}
+
+
+void Component::setDefaultTrafficRecorder(TrafficRecorder *recorder)
+{
+    ComponentPrivate::setDefaultTrafficRecorder(recorder);
+}
+
+
+TrafficRecorder *Component::defaultTrafficRecorder()
+{
+    return ComponentPrivate::defaultTrafficRecorder();
+}
+
+
+void Component::setDefaultJsonDecoder(JsonDecoder *decoder)
+{
+    ComponentPrivate::setDefaultJsonDecoder(decoder);
+}
+
+
+JsonDecoder *Component::defaultJsonDecoder()
+{
+    return ComponentPrivate::defaultJsonDecoder();
+}
+
+
 void Component::setExpectedJSONType(ExpectedJSONType type)
 {
     Q_D(Component);
@@ -655,6 +1354,10 @@ void Component::setApiRoute(const QStringList &routeParts)
 QJsonDocument Component::jsonResult() const
 {
     Q_D(const Component);
+    if (!d->resultDecoded && (d->recordType != DecodedRecords::None) && !d->result.isEmpty()) {
+        d->jsonResult = QJsonDocument::fromJson(d->result, &d->jsonParseError);
+        d->resultDecoded = true;
+    }
     return d->jsonResult;
 }
 
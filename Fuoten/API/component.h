@@ -38,6 +38,10 @@ class AbstractConfiguration;
 class AbstractStorage;
 class AbstractNamFactory;
 class AbstractNotificator;
+class RequestCoalescer;
+class AbstractMetricsSink;
+class TrafficRecorder;
+class JsonDecoder;
 
 /*!
  * \brief Base class for all API requests.
@@ -51,6 +55,10 @@ class AbstractNotificator;
  * an instance of a Component subclass via the property setter functions setStorage() and
  * setConfiguration() will take precedence over the default ones.
  *
+ * By default all Component objects of a thread share a single QNetworkAccessManager, so that
+ * keep-alive connections, TLS sessions and HTTP/2 connections are reused across requests and API
+ * classes. Use setMaxConnectionsPerHost() and setHttp2Allowed() to configure the shared session.
+ *
  * To modify the QNetworkAccessManager that will be used to perform the network requests,
  * create a subclass of AbstractNamFactory and set it via Component::setNetworkAccessManagerFactory().
  * This will than be used to create new QNetworkAccessManager instances on the fly that will
@@ -184,6 +192,9 @@ class FUOTENSHARED_EXPORT Component : public QObject
      *
      * If you set the timeout to 0, it wil be disabled. Default value: \a 120 \a seconds
      *
+     * The timeout starts when the request is sent, time spent waiting for a free connection
+     * of the shared network session does not count.
+     *
      * \par Access functions:
      * <TABLE><TR><TD>quint8</TD><TD>requestTimeout() const</TD></TR><TR><TD>void</TD><TD>setRequestTimeout(quint8 nRequestTimeout)</TD></TR></TABLE>
      * \par Notifier signal:
@@ -253,6 +264,22 @@ class FUOTENSHARED_EXPORT Component : public QObject
      * void useStorageChanged(bool useStorage)
      */
     Q_PROPERTY(bool useStorage READ isUseStorageEnabled WRITE setUseStorage NOTIFY useStorageChanged)
+    /*!
+     * \brief If \c true, replies that did not change since the last request to the same URL will not be processed.
+     *
+     * Only used if a storage is used, see \link Component::useStorage useStorage \endlink. A hash of the raw reply data is
+     * compared with the hash of the last successfully processed reply to the same URL, that is stored via
+     * AbstractStorage::setReplyHash(). If both are equal, the reply will neither be parsed nor be given to the storage,
+     * and replyUnchanged() will be emitted instead of the succeeded() signal. Defaults to \c false.
+     *
+     * \par Access functions:
+     * \li bool isSkipUnchangedEnabled() const
+     * \li void setSkipUnchanged(bool skipUnchanged)
+     *
+     * \par Notifier signal:
+     * void skipUnchangedChanged(bool skipUnchanged)
+     */
+    Q_PROPERTY(bool skipUnchanged READ isSkipUnchangedEnabled WRITE setSkipUnchanged NOTIFY skipUnchangedChanged)
     /*!
      * \brief Pointer to an object derived from AbstractNotificator.
      *
@@ -274,6 +301,24 @@ class FUOTENSHARED_EXPORT Component : public QObject
      * \sa notify()
      */
     Q_PROPERTY(Fuoten::AbstractNotificator *notificator READ notificator WRITE setNotificator NOTIFY notificatorChanged)
+    /*!
+     * \brief Priority of the request in the shared network session.
+     *
+     * Requests with a higher priority are started before queued requests with a lower priority. Requests that
+     * are not interactive leave reservedInteractiveConnections() free for interactive ones, bulk requests
+     * additionally give other requests the chance to go first by waiting for the next event loop iteration.
+     * Only used if no network access manager factory has been set. Defaults to Component::NormalPriority,
+     * classes for user actions like MarkItem, StarItem or CreateFeed default to Component::InteractivePriority,
+     * the Synchronizer uses Component::BulkPriority for its requests.
+     *
+     * \par Access functions:
+     * \li Priority priority() const
+     * \li void setPriority(Priority priority)
+     *
+     * \par Notifier signal:
+     * \li void priorityChanged(Priority priority)
+     */
+    Q_PROPERTY(Fuoten::Component::Priority priority READ priority WRITE setPriority NOTIFY priorityChanged)
 public:
     /*!
      * \brief Constructs a component with the given \a parent.
@@ -294,6 +339,16 @@ public:
         Object  = 2     /**< Expects a JSON object in the reply body. */
     };
 
+    /*!
+     * \brief Defines the priority of a request in the shared network session.
+     */
+    enum Priority : quint8 {
+        BulkPriority        = 0,    /**< Big transfers like the pages of a synchronization, yield to all other requests. */
+        NormalPriority      = 1,    /**< Default priority. */
+        InteractivePriority = 2     /**< Actions triggered by the user, can use the reserved connections. */
+    };
+    Q_ENUM(Priority)
+
     /*!
      * \brief Executes the API request.
      *
@@ -367,6 +422,18 @@ public:
      */
     bool isUseStorageEnabled() const;
 
+    /*!
+     * \brief Getter function for the \link Component::skipUnchanged skipUnchanged \endlink property.
+     * \sa setSkipUnchanged(), skipUnchangedChanged()
+     */
+    bool isSkipUnchangedEnabled() const;
+
+    /*!
+     * \brief Getter function for the \link Component::priority priority \endlink property.
+     * \sa setPriority(), priorityChanged()
+     */
+    Priority priority() const;
+
     /*!
      * \brief Getter function for the \link Component::notificator notificator \endlink property.
      * \sa setNotificator(), notificatorChanged()
@@ -399,6 +466,18 @@ public:
      */
     void setUseStorage(bool useStorage);
 
+    /*!
+     * \brief Setter function for the \link Component::skipUnchanged skipUnchanged \endlink property.
+     * \sa isSkipUnchangedEnabled(), skipUnchangedChanged()
+     */
+    void setSkipUnchanged(bool skipUnchanged);
+
+    /*!
+     * \brief Setter function for the \link Component::priority priority \endlink property.
+     * \sa priority(), priorityChanged()
+     */
+    void setPriority(Priority priority);
+
     /*!
      * \brief Setter function for the \link Component::notificator notificator \endlink property.
      * \sa notificator(), notificatorChanged()
@@ -432,7 +511,7 @@ public:
     /*!
      * \brief Sets the network access manager \a factory.
      * The factory will be used to create QNetworkAccessManager objects on demand.
-     * If no factory is set, a default QNetworkAccessManager object will be created.
+     * If no factory is set, the QNetworkAccessManager of the shared network session will be used.
      * The Component class will take ownership of the created QNetworkAccessManager.
      * \sa networkAccessManagerFactory()
      */
@@ -456,6 +535,203 @@ public:
      */
     static AbstractNotificator *defaultNotificator();
 
+    /*!
+     * \brief Sets the global default request coalescer.
+     *
+     * If set, Article::mark() and Article::star() will add their actions to the \a coalescer instead of
+     * sending single requests. Set a \c nullptr to disable coalescing again, what is the default.
+     * \sa defaultCoalescer()
+     */
+    static void setDefaultCoalescer(RequestCoalescer *coalescer);
+
+    /*!
+     * \brief Returns the global default request coalescer.
+     * \sa setDefaultCoalescer()
+     */
+    static RequestCoalescer *defaultCoalescer();
+
+    /*!
+     * \brief Sets the maximum number of parallel requests per host to \a max.
+     *
+     * Only used by the shared network session, that is used if no network access manager factory has been set.
+     * Requests above the limit will be queued and started as soon as a running request to the same host has finished.
+     * A value of \c 0 disables the limit. Defaults to \c 6, what is also the number of parallel connections
+     * QNetworkAccessManager opens to the same host, so higher values will have no effect.
+     *
+     * \sa maxConnectionsPerHost()
+     */
+    static void setMaxConnectionsPerHost(int max);
+
+    /*!
+     * \brief Returns the maximum number of parallel requests per host.
+     * \sa setMaxConnectionsPerHost()
+     */
+    static int maxConnectionsPerHost();
+
+    /*!
+     * \brief Sets the number of connections per host that are \a reserved for interactive requests.
+     *
+     * Requests with a lower priority than Component::InteractivePriority will only use maxConnectionsPerHost() minus
+     * \a reserved connections, but at least one, so that user actions are not queued behind a big synchronization.
+     * Only used by the shared network session. A value of \c 0 disables the reservation. Defaults to \c 2.
+     *
+     * \sa reservedInteractiveConnections(), priority
+     */
+    static void setReservedInteractiveConnections(int reserved);
+
+    /*!
+     * \brief Returns the number of connections per host that are reserved for interactive requests.
+     * \sa setReservedInteractiveConnections()
+     */
+    static int reservedInteractiveConnections();
+
+    /*!
+     * \brief Returns the number of requests that are waiting for a free connection in the shared network session of the calling thread.
+     *
+     * The queue depth at the time a request has been enqueued is also available as RequestMetrics::queueDepth.
+     */
+    static int queuedRequests();
+
+    /*!
+     * \brief Set \a allowed to \c false to disable the use of HTTP/2.
+     *
+     * If allowed, HTTP/2 will be used when the server supports it, so that all requests can be multiplexed over a
+     * single connection. Requires Qt 5.8 or newer. Defaults to \c true.
+     *
+     * \sa http2Allowed()
+     */
+    static void setHttp2Allowed(bool allowed);
+
+    /*!
+     * \brief Returns \c true if the use of HTTP/2 is allowed.
+     * \sa setHttp2Allowed()
+     */
+    static bool http2Allowed();
+
+    /*!
+     * \brief Sets the reply size in \a bytes above which JSON replies will be decoded in a background thread.
+     *
+     * Replies that are at least this big will be decoded in their own thread instead of the thread the Component
+     * lives in, so that decoding a big reply does not block the event loop and can overlap with other work, like
+     * writing the previous reply to the storage. checkOutput() and successCallback() will still be called in the
+     * thread of the Component after decoding has been finished. A value of \c 0 disables background decoding.
+     * Defaults to 256 KiB.
+     *
+     * \sa backgroundDecodingThreshold()
+     */
+    static void setBackgroundDecodingThreshold(int bytes);
+
+    /*!
+     * \brief Returns the reply size in bytes above which JSON replies will be decoded in a background thread.
+     * \sa setBackgroundDecodingThreshold()
+     */
+    static int backgroundDecodingThreshold();
+
+    /*!
+     * \brief Sets the reply size in \a bytes above which the built-in decoder decodes items on multiple threads.
+     *
+     * Applies to the FastJsonDecoder that is used if no decoder has been set via setDefaultJsonDecoder(). A value
+     * of \c 0 disables parallel decoding. Defaults to 4 MiB.
+     *
+     * \sa parallelDecodingThreshold(), FastJsonDecoder::setParallelDecodingThreshold()
+     */
+    static void setParallelDecodingThreshold(int bytes);
+
+    /*!
+     * \brief Returns the reply size in bytes above which the built-in decoder decodes items on multiple threads.
+     * \sa setParallelDecodingThreshold()
+     */
+    static int parallelDecodingThreshold();
+
+    /*!
+     * \brief Sets the maximum number of times a failed request will be sent again to \a retries.
+     *
+     * Requests that failed because of a transient error, like a timeout, a lost connection or one of the HTTP
+     * status codes 429, 502, 503 and 504, will be sent again after a delay. POST requests will never be retried,
+     * because they are not idempotent. A value of \c 0 disables retrying. Defaults to \c 3.
+     *
+     * \sa maxRetries(), setRetryBaseDelay()
+     */
+    static void setMaxRetries(int retries);
+
+    /*!
+     * \brief Returns the maximum number of times a failed request will be sent again.
+     * \sa setMaxRetries()
+     */
+    static int maxRetries();
+
+    /*!
+     * \brief Sets the base delay in milliseconds for retrying failed requests to \a msecs.
+     *
+     * The delay before the nth retry is a random value between \c 0 and \a msecs * 2^(n-1) milliseconds,
+     * limited to one minute. Defaults to \c 1000.
+     *
+     * \sa retryBaseDelay(), setMaxRetries()
+     */
+    static void setRetryBaseDelay(int msecs);
+
+    /*!
+     * \brief Returns the base delay in milliseconds for retrying failed requests.
+     * \sa setRetryBaseDelay()
+     */
+    static int retryBaseDelay();
+
+    /*!
+     * \brief Sets the global default metrics \a sink.
+     *
+     * If set, every Component will hand the timing information of its requests to the \a sink, see
+     * RequestMetrics for the collected values. Every attempt of a request is recorded on its own, so retried
+     * requests will appear multiple times. Set a \c nullptr to disable the collection again, what is the default.
+     * The \a sink has to outlive all Component objects that might use it.
+     *
+     * \sa defaultMetricsSink(), MetricsAggregator
+     */
+    static void setDefaultMetricsSink(AbstractMetricsSink *sink);
+
+    /*!
+     * \brief Returns the global default metrics sink.
+     * \sa setDefaultMetricsSink()
+     */
+    static AbstractMetricsSink *defaultMetricsSink();
+
+    /*!
+     * \brief Sets the global default traffic \a recorder.
+     *
+     * If set, every Component will write its requests and the received replies to the \a recorder, so that
+     * the traffic can be replayed later with ReplayNamFactory. Credentials and the host name are not recorded.
+     * Set a \c nullptr to stop recording, what is the default. The \a recorder has to outlive all Component
+     * objects that might use it.
+     *
+     * \sa defaultTrafficRecorder(), TrafficRecorder
+     */
+    static void setDefaultTrafficRecorder(TrafficRecorder *recorder);
+
+    /*!
+     * \brief Returns the global default traffic recorder.
+     * \sa setDefaultTrafficRecorder()
+     */
+    static TrafficRecorder *defaultTrafficRecorder();
+
+    /*!
+     * \brief Sets the global default JSON \a decoder.
+     *
+     * The \a decoder is used by GetFolders, GetFeeds, GetItems and GetUpdatedItems to decode their replies into
+     * typed records. If no decoder is set, what is the default, a FastJsonDecoder is used. Set a JsonDecoder
+     * object to decode via QJsonDocument. The \a decoder has to outlive all Component objects that might use it
+     * and has to be reentrant, as big replies are decoded in a background thread.
+     *
+     * \sa defaultJsonDecoder(), setBackgroundDecodingThreshold()
+     */
+    static void setDefaultJsonDecoder(JsonDecoder *decoder);
+
+    /*!
+     * \brief Returns the global default JSON decoder.
+     *
+     * Returns a \c nullptr if no decoder has been set and the internal FastJsonDecoder is used.
+     * \sa setDefaultJsonDecoder()
+     */
+    static JsonDecoder *defaultJsonDecoder();
+
 Q_SIGNALS:
     /*!
      * \brief This signal is emitted when the in operation status changes.
@@ -494,6 +770,24 @@ Q_SIGNALS:
      */
     void useStorageChanged(bool useStorage);
 
+    /*!
+     * \brief Notifier signal for the \link Component::skipUnchanged skipUnchanged \endlink property.
+     * \sa setSkipUnchanged(), isSkipUnchangedEnabled()
+     */
+    void skipUnchangedChanged(bool skipUnchanged);
+
+    /*!
+     * \brief Notifier signal for the \link Component::priority priority \endlink property.
+     * \sa setPriority(), priority()
+     */
+    void priorityChanged(Fuoten::Component::Priority priority);
+
+    /*!
+     * \brief This signal is emitted instead of succeeded() if the reply did not change since the last request.
+     * \sa skipUnchanged
+     */
+    void replyUnchanged();
+
     /*!
      * \brief Notifier signal for the \link Component::notificator notificator \endlink property.
      * \sa setNotificator(), notificator()
@@ -516,6 +810,16 @@ Q_SIGNALS:
      */
     void succeeded(const QJsonDocument &result);
 
+    /*!
+     * \brief This signal is emitted after the reply of a successful request has been processed.
+     *
+     * It is emitted after succeeded() and after the data has been handed to the \link Component::storage storage \endlink,
+     * but does not carry the reply data. Connect to this signal instead of succeeded() if you are only interested in the
+     * request being finished. GetFolders, GetFeeds, GetItems and GetUpdatedItems only create the QJsonDocument for
+     * succeeded() if something is connected to it.
+     */
+    void processed();
+
     /*!
      * \brief Emit this signal in a subclass when the request failed for some reason.
      * \sa error
@@ -572,6 +876,9 @@ protected:
 
     /*!
      * \brief Returns the JSON result document.
+     *
+     * Classes that decode their replies into typed records, like GetItems, build the document only when this is
+     * called for the first time after a request.
      */
     QJsonDocument jsonResult() const;
 
@@ -738,6 +1045,7 @@ private Q_SLOTS:
     void _requestFinished();
     void _requestTimedOut();
     void _ignoreSSLErrors(QNetworkReply *reply, const QList<QSslError> &errors);
+    void _retryRequest();
 
 private:
     Q_DISABLE_COPY(Component)
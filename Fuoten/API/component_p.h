@@ -27,9 +27,119 @@
 #include <QTimer>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QUrl>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include "../Helpers/abstractmetricssink.h"
+#include "../Helpers/tracer.h"
+#include "../Helpers/trafficrecorder.h"
+#include "../Helpers/trafficarchive_p.h"
+#include "../Helpers/fastjsondecoder.h"
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+#include <QRandomGenerator>
+#endif
 
 namespace Fuoten {
 
+/*
+ * Typed records decoded from a reply. Only the list matching the type of
+ * the request is filled.
+ */
+class DecodedRecords
+{
+public:
+    enum Type : quint8 {
+        None = 0,
+        Folders,
+        Feeds,
+        Items
+    };
+
+    bool decode(Type type, const JsonDecoder *decoder, const QByteArray &data)
+    {
+        switch (type) {
+        case Folders:
+            valid = decoder->decodeFolders(data, &folders, &errorString);
+            break;
+        case Feeds:
+            valid = decoder->decodeFeeds(data, &feeds, &errorString);
+            break;
+        case Items:
+            valid = decoder->decodeItems(data, &items, &errorString);
+            break;
+        default:
+            valid = true;
+            break;
+        }
+        decoded = true;
+        return valid;
+    }
+
+    void clear()
+    {
+        folders.clear();
+        feeds.clear();
+        items.clear();
+        errorString.clear();
+        decoded = false;
+        valid = false;
+    }
+
+    FolderRecords folders;
+    FeedRecords feeds;
+    ItemRecords items;
+    QString errorString;
+    bool decoded = false;
+    bool valid = false;
+};
+
+/*
+ * Decodes a JSON reply in its own thread, so that big replies do not
+ * block the thread the Component lives in. If a record type is given,
+ * the reply is decoded into typed records instead of a QJsonDocument.
+ */
+class JsonDecodeWorker : public QThread
+{
+public:
+    JsonDecodeWorker(const QByteArray &data, DecodedRecords::Type recordType, const JsonDecoder *decoder, QObject *parent = nullptr) :
+        QThread(parent), m_data(data), m_decoder(decoder), m_recordType(recordType)
+    {}
+
+    QJsonDocument document() const { return m_document; }
+
+    DecodedRecords records() const { return m_records; }
+
+    QJsonParseError parseError() const { return m_parseError; }
+
+    qint64 elapsed() const { return m_elapsed; }
+
+protected:
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+        if (m_recordType != DecodedRecords::None) {
+            m_records.decode(m_recordType, m_decoder, m_data);
+        } else {
+            m_document = QJsonDocument::fromJson(m_data, &m_parseError);
+        }
+        m_elapsed = timer.nsecsElapsed();
+        m_data.clear();
+    }
+
+private:
+    QByteArray m_data;
+    QJsonDocument m_document;
+    QJsonParseError m_parseError;
+    DecodedRecords m_records;
+    const JsonDecoder *m_decoder = nullptr;
+    qint64 m_elapsed = 0;
+    DecodedRecords::Type m_recordType = DecodedRecords::None;
+};
+
 class ComponentPrivate
 {
 public:
@@ -37,37 +147,328 @@ public:
 
     virtual ~ComponentPrivate() {}
 
-    void performNetworkOperation(const QNetworkRequest &request)
+    QNetworkReply *performNetworkOperation(QNetworkAccessManager *nam, const QNetworkRequest &request)
     {
+        QNetworkReply *r = nullptr;
         switch(namOperation) {
         case QNetworkAccessManager::HeadOperation:
-            reply = networkAccessManager->head(request);
-            qDebug("Performing HEAD network operation with reply at %p.", reply);
+            r = nam->head(request);
+            qDebug("Performing HEAD network operation with reply at %p.", r);
             break;
         case QNetworkAccessManager::PostOperation:
-            reply = networkAccessManager->post(request, payload);
-            qDebug("Performing POST network operation with reply at %p.", reply);
+            r = nam->post(request, payload);
+            qDebug("Performing POST network operation with reply at %p.", r);
             break;
         case QNetworkAccessManager::PutOperation:
-            reply = networkAccessManager->put(request, payload);
-            qDebug("Performing PUT network operation with reply at %p.", reply);
+            r = nam->put(request, payload);
+            qDebug("Performing PUT network operation with reply at %p.", r);
             break;
         case QNetworkAccessManager::DeleteOperation:
-            reply = networkAccessManager->deleteResource(request);
-            qDebug("Performing DELETE network operation with reply at %p.", reply);
+            r = nam->deleteResource(request);
+            qDebug("Performing DELETE network operation with reply at %p.", r);
             break;
         default:
-            reply = networkAccessManager->get(request);
-            qDebug("Performing GET network operation with reply at %p.", reply);
+            r = nam->get(request);
+            qDebug("Performing GET network operation with reply at %p.", r);
             break;
         }
+        return r;
+    }
+
+    /*
+     * Returns true if the failed request can be sent again. Only requests that
+     * failed for a transient reason and whose operation is idempotent are retried.
+     */
+    bool isRetryable(QNetworkReply *failedReply) const
+    {
+        if ((namOperation == QNetworkAccessManager::PostOperation) || (retryCount >= maxRetries())) {
+            return false;
+        }
+
+        if (!failedReply) {
+            // request timed out
+            return true;
+        }
+
+        switch (failedReply->error()) {
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+            return true;
+        default:
+            break;
+        }
+
+        const int status = failedReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        return ((status == 429) || (status == 502) || (status == 503) || (status == 504));
+    }
+
+    /*
+     * Returns the delay in milliseconds before the next retry. The delay grows
+     * exponentially with every retry and is randomized over the whole interval,
+     * so that clients that failed together do not retry together.
+     */
+    int nextRetryDelay() const
+    {
+        const qint64 cap = qMin<qint64>(static_cast<qint64>(retryBaseDelay()) << qMin<int>(retryCount, 16), 60000);
+        if (cap <= 0) {
+            return 0;
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+        return static_cast<int>(QRandomGenerator::global()->bounded(cap + 1));
+#else
+        return static_cast<int>(qrand() % (cap + 1));
+#endif
+    }
+
+    void scheduleRetry(Component *q)
+    {
+        if (!retryTimer) {
+            retryTimer = new QTimer(q);
+            retryTimer->setSingleShot(true);
+            QObject::connect(retryTimer, &QTimer::timeout, q, &Component::_retryRequest);
+        }
+        const int delay = nextRetryDelay();
+        retryCount++;
+        qDebug("Retrying request to %s in %i milliseconds (%u of %i).", qUtf8Printable(requestUrl.toString()), delay, retryCount, maxRetries());
+        retryTimer->start(delay);
+    }
+
+    /*
+     * Starts collecting timing information for the current request attempt,
+     * if a metrics sink has been set or the tracer is enabled.
+     */
+    void startMetrics()
+    {
+        traceBegin = Tracer::isEnabled() ? Tracer::timestamp() : -1;
+        httpStatus = 0;
+        queueDepth = -1;
+        metricsSink = defaultMetricsSink();
+        if (metricsSink) {
+            metricsTimer.start();
+            metricsTimestamp = QDateTime::currentMSecsSinceEpoch() * 1000;
+            replyStartedAt = -1;
+            encryptedAt = -1;
+            firstByteAt = -1;
+            finishedAt = -1;
+            parseTime = -1;
+        }
+    }
+
+    /*
+     * Connects to the reply signals that mark the phases of the request.
+     */
+    void watchReply(QNetworkReply *r, Component *q)
+    {
+        if (!metricsSink) {
+            return;
+        }
+        replyStartedAt = metricsTimer.nsecsElapsed();
+        QObject::connect(r, &QNetworkReply::encrypted, q, [this] () {
+            if (encryptedAt < 0) {
+                encryptedAt = metricsTimer.nsecsElapsed();
+            }
+        });
+        QObject::connect(r, &QNetworkReply::metaDataChanged, q, [this] () {
+            if (firstByteAt < 0) {
+                firstByteAt = metricsTimer.nsecsElapsed();
+            }
+        });
+    }
+
+    void replyFinished(QNetworkReply *r)
+    {
+        httpStatus = r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (!metricsSink) {
+            return;
+        }
+        finishedAt = metricsTimer.nsecsElapsed();
+        if (firstByteAt < 0) {
+            firstByteAt = finishedAt;
+        }
+    }
+
+    QString replyHashKey() const
+    {
+        return requestUrl.toString(QUrl::RemoveUserInfo);
+    }
+
+    /*
+     * Returns the hash of the current reply and clears it, so that it is
+     * not stored by processResult(). Use this to give the hash to the
+     * storage, that stores it after the data has been written.
+     */
+    QByteArray takeReplyHash()
+    {
+        const QByteArray hash = replyHash;
+        replyHash.clear();
+        return hash;
+    }
+
+    const char *operationName() const
+    {
+        switch (namOperation) {
+        case QNetworkAccessManager::HeadOperation:
+            return "HEAD";
+        case QNetworkAccessManager::PostOperation:
+            return "POST";
+        case QNetworkAccessManager::PutOperation:
+            return "PUT";
+        case QNetworkAccessManager::DeleteOperation:
+            return "DELETE";
+        default:
+            return "GET";
+        }
+    }
+
+    /*
+     * Returns the metrics collected for the current request attempt. All
+     * durations are converted to microseconds.
+     */
+    RequestMetrics currentMetrics(RequestMetrics::Result result) const
+    {
+        RequestMetrics m;
+        m.apiRoute = apiRoute;
+        m.method = QString::fromLatin1(operationName());
+        m.timestamp = metricsTimestamp;
+        m.queueDepth = queueDepth;
+        if (replyStartedAt > -1) {
+            m.queueWait = replyStartedAt / 1000;
+            if (encryptedAt > -1) {
+                m.connectionSetup = (encryptedAt - replyStartedAt) / 1000;
+            }
+            if (firstByteAt > -1) {
+                m.timeToFirstByte = (firstByteAt - replyStartedAt) / 1000;
+                if (finishedAt > -1) {
+                    m.download = (finishedAt - firstByteAt) / 1000;
+                }
+            }
+        }
+        if (parseTime > -1) {
+            m.parse = parseTime / 1000;
+        }
+        m.total = metricsTimer.nsecsElapsed() / 1000;
+        m.bytesSent = payload.size();
+        m.bytesReceived = result.size();
+        m.httpStatus = httpStatus;
+        m.attempt = retryCount;
+        m.result = result;
+        return m;
+    }
+
+    /*
+     * Returns the name and the arguments of the span of the current request
+     * attempt for the tracer.
+     */
+    QString traceName() const
+    {
+        return QString::fromLatin1(operationName()) + QLatin1Char(' ') + apiRoute;
+    }
+
+    QVariantMap traceArgs(RequestMetrics::Result r) const
+    {
+        static const char *resultNames[] = {"succeeded", "unchanged", "failed", "retried", "timed out"};
+        QVariantMap args;
+        args.insert(QStringLiteral("url"), requestUrl.toString(QUrl::RemoveUserInfo|QUrl::RemoveQuery));
+        args.insert(QStringLiteral("result"), QLatin1String(resultNames[r]));
+        args.insert(QStringLiteral("attempt"), static_cast<int>(retryCount));
+        args.insert(QStringLiteral("httpStatus"), httpStatus);
+        args.insert(QStringLiteral("bytesReceived"), result.size());
+        return args;
+    }
+
+    /*
+     * Hands the metrics of the current request attempt to the sink and the
+     * tracer. Every attempt is recorded only once.
+     */
+    void recordMetrics(RequestMetrics::Result result)
+    {
+        if (traceBegin > -1) {
+            const qint64 begin = traceBegin;
+            traceBegin = -1;
+            Tracer::addAsyncSpan("request", traceName(), reinterpret_cast<quintptr>(this), begin, Tracer::timestamp(), traceArgs(result));
+        }
+        if (metricsSink) {
+            AbstractMetricsSink *sink = metricsSink;
+            metricsSink = nullptr;
+            sink->record(currentMetrics(result));
+        }
+    }
+
+    /*
+     * Checks the decoded result and calls the successCallback(). Stores the
+     * hash of the reply afterwards, if the unchanged check is enabled, and
+     * emits Component::processed().
+     */
+    void processResult(Component *q)
+    {
+        QElapsedTimer timer;
+        if (metricsSink) {
+            timer.start();
+        }
+
+        if (q->checkOutput()) {
+            // the callback might already start the next request of this object
+            const qint64 begin = traceBegin;
+            QString spanName;
+            QVariantMap spanArgs;
+            if (begin > -1) {
+                traceBegin = -1;
+                spanName = traceName();
+                spanArgs = traceArgs(RequestMetrics::Succeeded);
+            }
+            AbstractMetricsSink *sink = metricsSink;
+            RequestMetrics m;
+            if (sink) {
+                parseTime = qMax<qint64>(parseTime, 0) + timer.nsecsElapsed();
+                metricsSink = nullptr;
+                m = currentMetrics(RequestMetrics::Succeeded);
+                timer.restart();
+            }
+            qDebug("%s", "Calling successCallback().");
+            q->successCallback();
+            if (sink) {
+                m.processing = timer.nsecsElapsed() / 1000;
+                m.total += m.processing;
+                if (error) {
+                    m.result = RequestMetrics::Failed;
+                }
+                sink->record(m);
+            }
+            if (begin > -1) {
+                if (error) {
+                    spanArgs.insert(QStringLiteral("result"), QStringLiteral("failed"));
+                }
+                Tracer::addAsyncSpan("request", spanName, reinterpret_cast<quintptr>(this), begin, Tracer::timestamp(), spanArgs);
+            }
+            // components that give the hash to the storage in their successCallback() have taken it
+            if (!replyHash.isEmpty() && !error) {
+                q->storage()->setReplyHash(replyHashKey(), replyHash);
+            }
+            if (!error) {
+                Q_EMIT q->processed();
+            }
+        } else {
+            if (metricsSink) {
+                parseTime = qMax<qint64>(parseTime, 0) + timer.nsecsElapsed();
+            }
+            recordMetrics(RequestMetrics::Failed);
+            q->setInOperation(false);
+        }
     }
 
     QHash<QByteArray, QByteArray> requestHeaders;
     QString apiRoute;
     QByteArray result;
     QByteArray payload;
-    QJsonDocument jsonResult;
+    QByteArray replyHash;
+    mutable QJsonDocument jsonResult;
+    mutable QJsonParseError jsonParseError;
+    DecodedRecords records;
     QUrlQuery urlQuery;
     QNetworkAccessManager *networkAccessManager = nullptr;
     Error *error = nullptr;
@@ -76,13 +477,32 @@ public:
     AbstractNotificator *notificator = nullptr;
     QTimer *timeoutTimer = nullptr;
     QNetworkReply *reply = nullptr;
+    QUrl requestUrl;
+    QElapsedTimer metricsTimer;
+    AbstractMetricsSink *metricsSink = nullptr;
+    qint64 metricsTimestamp = 0;
+    qint64 replyStartedAt = -1;
+    qint64 encryptedAt = -1;
+    qint64 firstByteAt = -1;
+    qint64 finishedAt = -1;
+    qint64 parseTime = -1;
+    qint64 traceBegin = -1;
+    int httpStatus = 0;
+    quint64 sessionTicket = 0;
+    int queueDepth = -1;
     QNetworkAccessManager::Operation namOperation = QNetworkAccessManager::GetOperation;
     quint8 requestTimeout = 120;
-    quint8 retryCount;
+    QTimer *retryTimer = nullptr;
+    quint8 retryCount = 0;
     Component::ExpectedJSONType expectedJSONType = Component::Empty;
+    Component::Priority priority = Component::NormalPriority;
+    DecodedRecords::Type recordType = DecodedRecords::None;
     bool requiresAuth = true;
     bool inOperation = false;
     bool useStorage = true;
+    mutable bool resultDecoded = false;
+    bool skipUnchanged = false;
+    bool retrying = false;
 
     static AbstractConfiguration *defaultConfiguration();
     static void setDefaultConfiguration(AbstractConfiguration *config);
@@ -92,6 +512,29 @@ public:
     static void setNetworkAccessManagerFactory(AbstractNamFactory *factory);
     static AbstractNotificator *defaultNotificator();
     static void setDefaultNotificator(AbstractNotificator *notificator);
+    static RequestCoalescer *defaultCoalescer();
+    static void setDefaultCoalescer(RequestCoalescer *coalescer);
+    static int maxConnectionsPerHost();
+    static void setMaxConnectionsPerHost(int max);
+    static int reservedInteractiveConnections();
+    static void setReservedInteractiveConnections(int reserved);
+    static bool http2Allowed();
+    static void setHttp2Allowed(bool allowed);
+    static int backgroundDecodingThreshold();
+    static void setBackgroundDecodingThreshold(int bytes);
+    static int maxRetries();
+    static void setMaxRetries(int retries);
+    static int retryBaseDelay();
+    static void setRetryBaseDelay(int msecs);
+    static AbstractMetricsSink *defaultMetricsSink();
+    static void setDefaultMetricsSink(AbstractMetricsSink *sink);
+    static TrafficRecorder *defaultTrafficRecorder();
+    static void setDefaultTrafficRecorder(TrafficRecorder *recorder);
+    static JsonDecoder *defaultJsonDecoder();
+    static void setDefaultJsonDecoder(JsonDecoder *decoder);
+    static const JsonDecoder *jsonDecoder();
+    static int parallelDecodingThreshold();
+    static void setParallelDecodingThreshold(int bytes);
 
 private:
     Q_DISABLE_COPY(ComponentPrivate)
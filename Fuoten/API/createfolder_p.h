@@ -33,6 +33,7 @@ public:
     {
         expectedJSONType = Component::Object;
         namOperation = QNetworkAccessManager::PostOperation;
+        priority = Component::InteractivePriority;
         apiRoute = QStringLiteral("/folders");
     }
 
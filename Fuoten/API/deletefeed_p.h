@@ -33,6 +33,7 @@ public:
     {
         expectedJSONType = Component::Empty;
         namOperation = QNetworkAccessManager::DeleteOperation;
+        priority = Component::InteractivePriority;
     }
 
     qint64 feedId = 0;
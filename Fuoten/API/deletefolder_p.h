@@ -33,6 +33,7 @@ public:
     {
         expectedJSONType = Component::Empty;
         namOperation = QNetworkAccessManager::DeleteOperation;
+        priority = Component::InteractivePriority;
     }
 
 
@@ -22,6 +22,7 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QJsonDocument>
+#include <QMetaMethod>
 
 using namespace Fuoten;
 
@@ -56,35 +57,34 @@ void GetFeeds::execute()
 
 void GetFeeds::successCallback()
 {
+    Q_D(GetFeeds);
+
     if (isUseStorageEnabled() && storage()) {
-        storage()->feedsRequested(jsonResult());
+        storage()->feedsRequested(d->records.feeds, d->replyHashKey(), d->takeReplyHash());
     }
 
     setInOperation(false);
 
     qDebug("Successfully requested the feed list from the server.");
 
-    Q_EMIT succeeded(jsonResult());
+    // only build the JSON document if somebody is interested in it
+    if (isSignalConnected(QMetaMethod::fromSignal(&Component::succeeded))) {
+        Q_EMIT succeeded(jsonResult());
+    }
 }
 
 
 bool GetFeeds::checkOutput()
 {
-    if (Q_LIKELY(Component::checkOutput())) {
-
-        if (Q_UNLIKELY(!jsonResult().object().value(QStringLiteral("feeds")).isArray())) {
-            //% "The data the server replied does not contain a \"feeds\" array."
-            setError(new Error(Error::OutputError, Error::Critical, qtTrId("libfuoten-err-no-feeds-array-in-reply"), QString(), this));
-            Q_EMIT failed(error());
-            return false;
-        }
-
+    // the JsonDecoder used by Component::checkOutput() already checks for the feeds array
+    return Component::checkOutput();
+}
 
-    } else {
-        return false;
-    }
 
-    return true;
+FeedRecords GetFeeds::feedRecords() const
+{
+    Q_D(const GetFeeds);
+    return d->records.feeds;
 }
 
 #include "moc_getfeeds.cpp"
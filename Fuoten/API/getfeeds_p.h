@@ -31,6 +31,7 @@ public:
     {
         apiRoute = QStringLiteral("/feeds");
         expectedJSONType = Component::Object;
+        recordType = DecodedRecords::Feeds;
     }
 };
 
@@ -22,6 +22,7 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QJsonDocument>
+#include <QMetaMethod>
 
 using namespace Fuoten;
 
@@ -58,35 +59,34 @@ void GetFolders::execute()
 
 void GetFolders::successCallback()
 {
+    Q_D(GetFolders);
+
     if (isUseStorageEnabled() && storage()) {
-        storage()->foldersRequested(jsonResult());
+        storage()->foldersRequested(d->records.folders, d->replyHashKey(), d->takeReplyHash());
     }
 
     setInOperation(false);
 
     qDebug("Successfully requested the folder list from the server.");
 
-    Q_EMIT succeeded(jsonResult());
+    // only build the JSON document if somebody is interested in it
+    if (isSignalConnected(QMetaMethod::fromSignal(&Component::succeeded))) {
+        Q_EMIT succeeded(jsonResult());
+    }
 }
 
 
 bool GetFolders::checkOutput()
 {
-    if (Q_LIKELY(Component::checkOutput())) {
-
-        if (Q_UNLIKELY(!jsonResult().object().value(QStringLiteral("folders")).isArray())) {
-            //% "The data the server replied does not contain a \"folders\" array."
-            setError(new Error(Error::OutputError, Error::Critical, qtTrId("libfuoten-err-no-folders-array-in-reply"), QString(), this));
-            Q_EMIT failed(error());
-            return false;
-        }
-
+    // the JsonDecoder used by Component::checkOutput() already checks for the folders array
+    return Component::checkOutput();
+}
 
-    } else {
-        return false;
-    }
 
-    return true;
+FolderRecords GetFolders::folderRecords() const
+{
+    Q_D(const GetFolders);
+    return d->records.folders;
 }
 
 #include "moc_getfolders.cpp"
@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include "component.h"
+#include "../records.h"
 #include "../fuoten_global.h"
 
 namespace Fuoten {
@@ -34,9 +35,9 @@ class GetFoldersPrivate;
  * To request the folder list, the Component::configuration property has to be set to a valid AbstractConfiguration object. After setting it,
  * call execute() to perform the API request.
  *
- * If a valid AbstractStorage object is set to the Component::storage property, AbstractStorage::foldersRequested will be called in the successCallback()
+ * If a valid AbstractStorage object is set to the Component::storage property, AbstractStorage::foldersRequested(const FolderRecords &) will be called in the successCallback()
  * to save the requested folders in the local storage. If the request succeeded, the Component::succeeded() signal will be emitted, containing the JSON api
- * reply.
+ * reply, if something is connected to it. The Component::processed() signal will be emitted in any case after a successful request.
  *
  * If something failed, Component::failed() will be emitted and the Component::error property will contain a valid pointer to an Error object.
  *
@@ -71,15 +72,23 @@ public:
      */
     Q_INVOKABLE void execute() override;
 
+    /*!
+     * \brief Returns the folders of the last successful request.
+     *
+     * The folders are decoded directly from the reply by the JsonDecoder set via Component::setDefaultJsonDecoder(),
+     * in the order of the API reply.
+     */
+    FolderRecords folderRecords() const;
+
 protected:
     GetFolders(GetFoldersPrivate &dd, QObject *parent = nullptr);
 
     /*!
      * \brief Finishes the the operation if the request was successful.
      *
-     * If Component::storage points to a valid object, it will use AbstractStorage::foldersRequested() to store, update and delete the
+     * If Component::storage points to a valid object, it will use AbstractStorage::foldersRequested(const FolderRecords &) to store, update and delete the
      * folders in the local storage according to the server reply. Afterwards it will set Component::inOperation to false and will emit
-     * the Component::succeeded() signal.
+     * the Component::succeeded() signal, if it is connected.
      */
     void successCallback() override;
 
@@ -28,7 +28,10 @@ namespace Fuoten {
 
 class GetFoldersPrivate : public ComponentPrivate {
 public:
-    GetFoldersPrivate() : ComponentPrivate() {}
+    GetFoldersPrivate() : ComponentPrivate()
+    {
+        recordType = DecodedRecords::Folders;
+    }
 };
 
 }
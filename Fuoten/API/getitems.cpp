@@ -23,6 +23,7 @@
 #include <QJsonValue>
 #include <QUrlQuery>
 #include <QMetaEnum>
+#include <QMetaMethod>
 
 using namespace Fuoten;
 
@@ -80,31 +81,27 @@ void GetItems::execute()
 
 void GetItems::successCallback()
 {
+    Q_D(GetItems);
+
     if (isUseStorageEnabled() && storage()) {
-        storage()->itemsRequested(jsonResult());
+        storage()->itemsRequested(d->records.items, d->batchToken);
     }
 
     setInOperation(false);
 
     qDebug("Successfully requested the items from the server.");
 
-    Q_EMIT succeeded(jsonResult());
+    // only build the JSON document if somebody is interested in it
+    if (isSignalConnected(QMetaMethod::fromSignal(&Component::succeeded))) {
+        Q_EMIT succeeded(jsonResult());
+    }
 }
 
 
 bool GetItems::checkOutput()
 {
-    if (Q_LIKELY(Component::checkOutput())) {
-
-        if (Q_UNLIKELY(!jsonResult().object().value(QStringLiteral("items")).isArray())) {
-            //% "The data the server replied does not contain an \"items\" array."
-            setError(new Error(Error::OutputError, Error::Critical, qtTrId("libfuoten-err-no-items-array-in-reply"), QString(), this));
-            Q_EMIT failed(error());
-            return false;
-        }
-
-
-    } else {
+    // the JsonDecoder used by Component::checkOutput() already checks for the items array
+    if (Q_UNLIKELY(!Component::checkOutput())) {
         setInOperation(false);
         return false;
     }
@@ -113,6 +110,27 @@ bool GetItems::checkOutput()
 }
 
 
+ItemRecords GetItems::itemRecords() const
+{
+    Q_D(const GetItems);
+    return d->records.items;
+}
+
+
+quint64 GetItems::batchToken() const
+{
+    Q_D(const GetItems);
+    return d->batchToken;
+}
+
+
+void GetItems::setBatchToken(quint64 token)
+{
+    Q_D(GetItems);
+    d->batchToken = token;
+}
+
+
 bool GetItems::checkInput()
 {
     if (Q_LIKELY(Component::checkInput())) {
@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include "component.h"
+#include "../records.h"
 #include "../fuoten.h"
 #include "../fuoten_global.h"
 
@@ -36,9 +37,9 @@ class GetItemsPrivate;
  * To request the items/articles, the Component::configuration property has to be set to a valid AbstractConfiguration object. After setting it,
  * call execute() to perform the API request.
  *
- * If a valid AbstractStorage object is set to the Component::storage property, AbstractStorage::itemsRequested will be called in the successCallback()
+ * If a valid AbstractStorage object is set to the Component::storage property, AbstractStorage::itemsRequested(const ItemRecords &) will be called in the successCallback()
  * to save the requested items in the local storage. If the request succeeded, the Component::succeeded() signal will be emitted, containing the JSON api
- * reply.
+ * reply, if something is connected to it. The Component::processed() signal will be emitted in any case after a successful request.
  *
  * If something failed, Component::failed() will be emitted and the Component::error property will contain a valid pointer to an Error object.
  *
@@ -222,6 +223,30 @@ public:
      */
     Q_INVOKABLE void execute() override;
 
+    /*!
+     * \brief Returns the items of the last successful request.
+     *
+     * The items are decoded directly from the reply by the JsonDecoder set via Component::setDefaultJsonDecoder(),
+     * in the order of the API reply.
+     */
+    ItemRecords itemRecords() const;
+
+    /*!
+     * \brief Returns the token that is passed to AbstractStorage::itemsRequested() together with the items.
+     *
+     * \sa setBatchToken()
+     */
+    quint64 batchToken() const;
+
+    /*!
+     * \brief Sets the \a token that is passed to AbstractStorage::itemsRequested() together with the items.
+     *
+     * The storage echoes the token with AbstractStorage::itemsBatchStored() after it has stored the items,
+     * so that the caller can identify the writes of its own requests. Create tokens with
+     * AbstractStorage::createBatchToken(). The default value \c 0 does not identify a request.
+     */
+    void setBatchToken(quint64 token);
+
 
 Q_SIGNALS:
     /*!
@@ -261,9 +286,9 @@ protected:
     /*!
      * \brief Finishes the the operation if the request was successful.
      *
-     * If Component::storage points to a valid object, it will use AbstractStorage::itemsRequested() to store, update and delete the
+     * If Component::storage points to a valid object, it will use AbstractStorage::itemsRequested(const ItemRecords &) to store, update and delete the
      * items in the local storage according to the server reply. Afterwards it will set Component::inOperation to false and will emit
-     * the Component::succeeded() signal.
+     * the Component::succeeded() signal, if it is connected.
      */
     void successCallback() override;
 
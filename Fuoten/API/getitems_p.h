@@ -32,6 +32,7 @@ public:
     {
         apiRoute = QStringLiteral("/items");
         expectedJSONType = Component::Object;
+        recordType = DecodedRecords::Items;
     }
 
     GetItemsPrivate(int nBatchSize, qint64 nOffset, FuotenEnums::Type nType, qint64 nParentId, bool nGetRead, bool nOldestFirst) :
@@ -45,12 +46,14 @@ public:
     {
         apiRoute = QStringLiteral("/items");
         expectedJSONType = Component::Object;
+        recordType = DecodedRecords::Items;
     }
 
     qint64 offset = 0;
     qint64 parentId = 0;
     int batchSize = -1;
     FuotenEnums::Type type = FuotenEnums::All;
+    quint64 batchToken = 0;
     bool getRead = false;
     bool oldestFirst = false;
 };
@@ -24,6 +24,7 @@
 #include <QUrlQuery>
 #include <QMetaEnum>
 #include <QJsonArray>
+#include <QMetaMethod>
 
 using namespace Fuoten;
 
@@ -69,35 +70,48 @@ void GetUpdatedItems::execute()
 
 void GetUpdatedItems::successCallback()
 {
+    Q_D(GetUpdatedItems);
+
     if (isUseStorageEnabled() && storage()) {
-        storage()->itemsRequested(jsonResult());
+        storage()->itemsRequested(d->records.items, d->batchToken);
     }
 
     setInOperation(false);
 
     qDebug("%s", "Successfully requested updated items from the server.");
 
-    Q_EMIT succeeded(jsonResult());
+    // only build the JSON document if somebody is interested in it
+    if (isSignalConnected(QMetaMethod::fromSignal(&Component::succeeded))) {
+        Q_EMIT succeeded(jsonResult());
+    }
 }
 
 
 bool GetUpdatedItems::checkOutput()
 {
-    if (Q_LIKELY(Component::checkOutput())) {
+    // the JsonDecoder used by Component::checkOutput() already checks for the items array
+    return Component::checkOutput();
+}
 
-        if (Q_UNLIKELY(!jsonResult().object().value(QStringLiteral("items")).isArray())) {
-            //% "The data the server replied does not contain an \"items\" array."
-            setError(new Error(Error::OutputError, Error::Critical, qtTrId("libfuoten-err-no-items-array-in-reply"), QString(), this));
-            Q_EMIT failed(error());
-            return false;
-        }
 
+ItemRecords GetUpdatedItems::itemRecords() const
+{
+    Q_D(const GetUpdatedItems);
+    return d->records.items;
+}
 
-    } else {
-        return false;
-    }
 
-    return true;
+quint64 GetUpdatedItems::batchToken() const
+{
+    Q_D(const GetUpdatedItems);
+    return d->batchToken;
+}
+
+
+void GetUpdatedItems::setBatchToken(quint64 token)
+{
+    Q_D(GetUpdatedItems);
+    d->batchToken = token;
 }
 
 
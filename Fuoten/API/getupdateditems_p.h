@@ -32,6 +32,7 @@ public:
     {
         apiRoute = QStringLiteral("/items/updated");
         expectedJSONType = Component::Object;
+        recordType = DecodedRecords::Items;
     }
 
     GetUpdatedItemsPrivate(const QDateTime &nLastModified, FuotenEnums::Type nType, qint64 nParentId) :
@@ -42,11 +43,13 @@ public:
     {
         apiRoute = QStringLiteral("/item/updated");
         expectedJSONType = Component::Object;
+        recordType = DecodedRecords::Items;
     }
 
     qint64 parentId = 0;
     QDateTime lastModified;
     FuotenEnums::Type type = FuotenEnums::All;
+    quint64 batchToken = 0;
 };
 
 }
@@ -31,12 +31,16 @@ public:
     MarkAllItemsReadPrivate() :
         ComponentPrivate(),
         newestItemId(0)
-    {}
+    {
+        priority = Component::InteractivePriority;
+    }
 
     explicit MarkAllItemsReadPrivate(qint64 nNewestItemId) :
         ComponentPrivate(),
         newestItemId(nNewestItemId)
-    {}
+    {
+        priority = Component::InteractivePriority;
+    }
 
     qint64 newestItemId;
 };
@@ -36,6 +36,7 @@ public:
     {
         expectedJSONType = Component::Empty;
         namOperation = QNetworkAccessManager::PutOperation;
+        priority = Component::InteractivePriority;
     }
 
     MarkItemPrivate(qint64 nItemId, bool nUnread) :
@@ -44,6 +45,7 @@ public:
     {
         expectedJSONType = Component::Empty;
         namOperation = QNetworkAccessManager::PutOperation;
+        priority = Component::InteractivePriority;
     }
 
 
@@ -18,9 +18,7 @@
  */
 
 #include "markmultipleitems_p.h"
-#include <QJsonArray>
-#include <QJsonObject>
-#include <QJsonValue>
+#include "payloadwriter_p.h"
 #include "../error.h"
 
 using namespace Fuoten;
@@ -62,18 +60,7 @@ void MarkMultipleItems::execute()
         setApiRoute(QStringLiteral("/items/read/multiple"));
     }
 
-    QJsonArray ia;
-    if (!itemIds().isEmpty()) {
-        const IdList iids = itemIds();
-        for (qint64 id : iids) {
-            ia.append(QJsonValue(id));
-        }
-    }
-
-    QJsonObject plo; // payload object
-    plo.insert(QStringLiteral("items"), QJsonValue(ia));
-
-    setPayload(plo);
+    setPayload(PayloadWriter::idList(itemIds()));
 
     sendRequest();
 }
@@ -35,6 +35,7 @@ public:
     {
         expectedJSONType = Component::Empty;
         namOperation = QNetworkAccessManager::PutOperation;
+        priority = Component::InteractivePriority;
     }
 
     qint64 feedId;
@@ -0,0 +1,208 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "networksession_p.h"
+#include "component.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadStorage>
+#include <QTimer>
+
+using namespace Fuoten;
+
+static QThreadStorage<QPointer<NetworkSession>> threadSessions;
+
+
+NetworkSession::NetworkSession(QObject *parent) :
+    QObject(parent), m_nam(new QNetworkAccessManager(this))
+{
+    qDebug("Created new network session at %p for thread %p.", this, QThread::currentThread());
+}
+
+
+NetworkSession::~NetworkSession()
+{
+    qDebug("Destroying network session at %p.", this);
+}
+
+
+NetworkSession *NetworkSession::current()
+{
+    NetworkSession *session = threadSessions.localData().data();
+
+    if (!session) {
+        QThread *thread = QThread::currentThread();
+        QCoreApplication *app = QCoreApplication::instance();
+        if (app && (app->thread() == thread)) {
+            session = new NetworkSession(app);
+        } else {
+            session = new NetworkSession;
+            connect(thread, &QThread::finished, session, &QObject::deleteLater);
+        }
+        threadSessions.setLocalData(QPointer<NetworkSession>(session));
+    }
+
+    return session;
+}
+
+
+QNetworkAccessManager *NetworkSession::networkAccessManager() const
+{
+    return m_nam;
+}
+
+
+QString NetworkSession::hostKey(const QUrl &url)
+{
+    return url.scheme() + QLatin1String("://") + url.host() + QLatin1Char(':') + QString::number(url.port(-1));
+}
+
+
+quint64 NetworkSession::enqueue(const QUrl &url, Component::Priority priority, QObject *context, const Operation &operation, const StartedCallback &started)
+{
+    Pending p;
+    p.ticket = ++m_nextTicket;
+    p.hostKey = hostKey(url);
+    p.context = context;
+    p.operation = operation;
+    p.started = started;
+    p.priority = priority;
+
+    // requests with the same or a higher priority that are already waiting go first
+    const int next = nextPending(p.hostKey);
+    const bool waiting = (next > -1) && (m_queue.at(next).priority >= priority);
+
+    if ((priority != Component::BulkPriority) && !waiting && canStart(p.hostKey, priority)) {
+        start(p);
+        // there is nothing left to cancel
+        return 0;
+    }
+
+    qDebug("Queueing request to %s with priority %i, %i requests already running.", qUtf8Printable(p.hostKey), priority, m_active.value(p.hostKey));
+    m_queue.append(p);
+    if (priority == Component::BulkPriority) {
+        // yield to requests that are enqueued before the event loop runs again
+        const QString key = p.hostKey;
+        QTimer::singleShot(0, this, [this, key] () {startNext(key);});
+    }
+
+    return p.ticket;
+}
+
+
+void NetworkSession::cancel(quint64 ticket)
+{
+    for (int i = 0; i < m_queue.size(); ++i) {
+        if (m_queue.at(i).ticket == ticket) {
+            m_queue.removeAt(i);
+            return;
+        }
+    }
+}
+
+
+void NetworkSession::start(const Pending &p)
+{
+    QNetworkReply *reply = p.operation(m_nam);
+    Q_CHECK_PTR(reply);
+
+    m_running.insert(reply, p.hostKey);
+    m_active[p.hostKey]++;
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply] () {release(reply);});
+    connect(reply, &QObject::destroyed, this, [this, reply] () {release(reply);});
+
+    p.started(reply);
+}
+
+
+void NetworkSession::release(QNetworkReply *reply)
+{
+    const auto it = m_running.find(reply);
+    if (it == m_running.end()) {
+        return;
+    }
+
+    const QString key = it.value();
+    m_running.erase(it);
+
+    if (--m_active[key] <= 0) {
+        m_active.remove(key);
+    }
+
+    startNext(key);
+}
+
+
+bool NetworkSession::canStart(const QString &hostKey, Component::Priority priority) const
+{
+    const int max = Component::maxConnectionsPerHost();
+    if (max <= 0) {
+        return true;
+    }
+
+    int limit = max;
+    if (priority != Component::InteractivePriority) {
+        limit = qMax(1, max - Component::reservedInteractiveConnections());
+    }
+
+    return m_active.value(hostKey) < limit;
+}
+
+
+int NetworkSession::nextPending(const QString &hostKey) const
+{
+    int next = -1;
+    for (int i = 0; i < m_queue.size(); ++i) {
+        const Pending &p = m_queue.at(i);
+        if ((p.hostKey == hostKey) && ((next < 0) || (p.priority > m_queue.at(next).priority))) {
+            next = i;
+        }
+    }
+    return next;
+}
+
+
+void NetworkSession::startNext(const QString &hostKey)
+{
+    int i = nextPending(hostKey);
+    while ((i > -1) && canStart(hostKey, m_queue.at(i).priority)) {
+        const Pending p = m_queue.takeAt(i);
+        // the requesting object might have been destroyed in the meantime
+        if (p.context) {
+            start(p);
+        }
+        i = nextPending(hostKey);
+    }
+}
+
+
+int NetworkSession::activeRequests() const
+{
+    return m_running.size();
+}
+
+
+int NetworkSession::queuedRequests() const
+{
+    return m_queue.size();
+}
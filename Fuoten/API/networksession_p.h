@@ -0,0 +1,120 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FUOTENNETWORKSESSION_P_H
+#define FUOTENNETWORKSESSION_P_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QUrl>
+#include <functional>
+#include "component.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace Fuoten {
+
+/*
+ * Library owned network session that is shared by all Component objects of
+ * a thread that do not use an AbstractNamFactory.
+ *
+ * All requests go through the same QNetworkAccessManager, so keep-alive
+ * connections and TLS sessions are reused across API classes. The number of
+ * parallel requests per host is limited by Component::maxConnectionsPerHost(),
+ * requests above the limit are queued and started when a running request
+ * for the same host finishes.
+ *
+ * Queued requests are started by their Component::Priority, requests with
+ * the same priority in the order they have been enqueued. Requests that are
+ * not interactive leave Component::reservedInteractiveConnections() free,
+ * so that user actions do not have to wait for a big download. Bulk
+ * requests are never started directly but on the next event loop iteration,
+ * so that interactive requests enqueued in the meantime go first.
+ */
+class NetworkSession : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<QNetworkReply*(QNetworkAccessManager *nam)> Operation;
+    typedef std::function<void(QNetworkReply *reply)> StartedCallback;
+
+    ~NetworkSession();
+
+    /*
+     * Returns the session of the current thread. The session will be created
+     * on the first call.
+     */
+    static NetworkSession *current();
+
+    QNetworkAccessManager *networkAccessManager() const;
+
+    /*
+     * Enqueues a request to the host of url. The operation is performed as
+     * soon as a connection slot is free and started is called with the
+     * created reply. If a slot is available, this happens immediately. If
+     * the context object has been destroyed before the request could be
+     * started, the request will be dropped. Returns a ticket that can be
+     * used to cancel a queued request, or 0 if the request has already been
+     * started, in which case started has been called before this returns.
+     */
+    quint64 enqueue(const QUrl &url, Component::Priority priority, QObject *context, const Operation &operation, const StartedCallback &started);
+
+    /*
+     * Removes a request that has not been started yet from the queue.
+     */
+    void cancel(quint64 ticket);
+
+    int activeRequests() const;
+    int queuedRequests() const;
+
+private:
+    explicit NetworkSession(QObject *parent = nullptr);
+
+    struct Pending {
+        quint64 ticket;
+        QString hostKey;
+        QPointer<QObject> context;
+        Operation operation;
+        StartedCallback started;
+        Component::Priority priority;
+    };
+
+    static QString hostKey(const QUrl &url);
+    bool canStart(const QString &hostKey, Component::Priority priority) const;
+    int nextPending(const QString &hostKey) const;
+    void start(const Pending &p);
+    void release(QNetworkReply *reply);
+    void startNext(const QString &hostKey);
+
+    QNetworkAccessManager *m_nam = nullptr;
+    QHash<QNetworkReply*, QString> m_running;
+    QHash<QString, int> m_active;
+    QList<Pending> m_queue;
+    quint64 m_nextTicket = 0;
+
+    Q_DISABLE_COPY(NetworkSession)
+};
+
+}
+
+#endif // FUOTENNETWORKSESSION_P_H
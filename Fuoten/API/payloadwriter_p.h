@@ -0,0 +1,109 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENPAYLOADWRITER_P_H
+#define FUOTENPAYLOADWRITER_P_H
+
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QPair>
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+/*
+ * Writes the JSON payloads of the multi item requests directly into a byte
+ * array. Building a QJsonArray and serializing it afterwards needs several
+ * times the memory of the result for big lists, so the payload is written
+ * in one pass into a buffer that is reserved up front.
+ */
+class PayloadWriter
+{
+public:
+    /*
+     * Returns {"items":[id,id,...]}
+     */
+    static QByteArray idList(const IdList &ids)
+    {
+        QByteArray ba;
+        ba.reserve(12 + ids.size() * 8);
+        ba.append("{\"items\":[");
+        bool first = true;
+        for (qint64 id : ids) {
+            if (!first) {
+                ba.append(',');
+            }
+            ba.append(QByteArray::number(id));
+            first = false;
+        }
+        ba.append("]}");
+        return ba;
+    }
+
+    /*
+     * Returns {"items":[{"feedId":id,"guidHash":"hash"},...]}
+     */
+    static QByteArray itemList(const QList<QPair<qint64,QString>> &items)
+    {
+        QByteArray ba;
+        ba.reserve(12 + items.size() * 64);
+        ba.append("{\"items\":[");
+        bool first = true;
+        for (const QPair<qint64,QString> &i : items) {
+            if (!first) {
+                ba.append(',');
+            }
+            ba.append("{\"feedId\":");
+            ba.append(QByteArray::number(i.first));
+            ba.append(",\"guidHash\":");
+            appendString(ba, i.second);
+            ba.append('}');
+            first = false;
+        }
+        ba.append("]}");
+        return ba;
+    }
+
+private:
+    static void appendString(QByteArray &ba, const QString &str)
+    {
+        static const char hex[] = "0123456789abcdef";
+        const QByteArray utf8 = str.toUtf8();
+        ba.append('"');
+        for (const char c : utf8) {
+            const uchar uc = static_cast<uchar>(c);
+            if (c == '"' || c == '\\') {
+                ba.append('\\');
+                ba.append(c);
+            } else if (uc < 0x20) {
+                ba.append("\\u00");
+                ba.append(hex[uc >> 4]);
+                ba.append(hex[uc & 0xf]);
+            } else {
+                ba.append(c);
+            }
+        }
+        ba.append('"');
+    }
+};
+
+}
+
+#endif // FUOTENPAYLOADWRITER_P_H
@@ -34,6 +34,7 @@ public:
     {
         expectedJSONType = Component::Empty;
         namOperation = QNetworkAccessManager::PutOperation;
+        priority = Component::InteractivePriority;
     }
 
     ~RenameFeedPrivate() {}
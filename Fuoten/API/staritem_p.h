@@ -35,6 +35,7 @@ public:
     {
         expectedJSONType = Component::Empty;
         namOperation = QNetworkAccessManager::PutOperation;
+        priority = Component::InteractivePriority;
     }
 
     StarItemPrivate(qint64 nFeedId, const QString &nGuidHash, bool nStarred) :
@@ -45,6 +46,7 @@ public:
     {
         expectedJSONType = Component::Empty;
         namOperation = QNetworkAccessManager::PutOperation;
+        priority = Component::InteractivePriority;
     }
 
     qint64 feedId;
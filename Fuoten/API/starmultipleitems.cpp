@@ -18,10 +18,8 @@
  */
 
 #include "starmultipleitems_p.h"
+#include "payloadwriter_p.h"
 #include "../error.h"
-#include <QJsonArray>
-#include <QJsonObject>
-#include <QJsonValue>
 
 using namespace Fuoten;
 
@@ -62,21 +60,7 @@ void StarMultipleItems::execute()
         setApiRoute(QStringLiteral("/items/unstar/multiple"));
     }
 
-    QJsonArray arr;
-    if (!itemsToStar().isEmpty()) {
-        const QList<QPair<qint64,QString>> its = itemsToStar();
-        for (const QPair<qint64,QString> &p : its) {
-            QJsonObject o;
-            o.insert(QStringLiteral("feedId"), QJsonValue(p.first));
-            o.insert(QStringLiteral("guidHash"), QJsonValue(p.second));
-            arr.append(QJsonValue(o));
-        }
-    }
-
-    QJsonObject plo; // payload object
-    plo.insert(QStringLiteral("items"), QJsonValue(arr));
-
-    setPayload(plo);
+    setPayload(PayloadWriter::itemList(itemsToStar()));
 
     sendRequest();
 }
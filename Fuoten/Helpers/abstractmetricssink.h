@@ -0,0 +1,156 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENABSTRACTMETRICSSINK_H
+#define FUOTENABSTRACTMETRICSSINK_H
+
+#include <QString>
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+/*!
+ * \brief Timing and size information about a single network request of a Component.
+ *
+ * All durations are in microseconds. Durations that could not be measured are \c -1, for example the
+ * connection setup, that is only known for encrypted connections, where it contains the time until the
+ * TLS handshake has been finished.
+ *
+ * Every attempt of a request is recorded on its own, so a request that has been retried two times
+ * results in two records with the result RequestMetrics::Retried and one with the final result.
+ */
+struct FUOTENSHARED_EXPORT RequestMetrics
+{
+    /*!
+     * \brief Result of a request attempt.
+     */
+    enum Result : quint8 {
+        Succeeded = 0,  /**< The request succeeded and the result has been processed. */
+        Unchanged,      /**< The reply did not change since the last request and has not been processed, see Component::skipUnchanged. */
+        Failed,         /**< The request failed or the result could not be processed. */
+        Retried,        /**< The request failed for a transient reason and will be sent again. */
+        TimedOut        /**< The request timed out. */
+    };
+
+    /*!
+     * \brief API route of the request, like \c /folders.
+     */
+    QString apiRoute;
+    /*!
+     * \brief HTTP method of the request.
+     */
+    QString method;
+    /*!
+     * \brief Time the request has been started, in microseconds since the epoch.
+     */
+    qint64 timestamp = 0;
+    /*!
+     * \brief Time the request waited for a free connection in the shared network session.
+     */
+    qint64 queueWait = -1;
+    /*!
+     * \brief Number of requests that were waiting in the shared network session when the request has been enqueued.
+     *
+     * \c -1 if the request did not use the shared network session. See Component::priority.
+     */
+    int queueDepth = -1;
+    /*!
+     * \brief Time from sending the request until the encrypted connection has been established.
+     */
+    qint64 connectionSetup = -1;
+    /*!
+     * \brief Time from sending the request until the response headers have been received.
+     */
+    qint64 timeToFirstByte = -1;
+    /*!
+     * \brief Time from receiving the response headers until the reply has been finished.
+     */
+    qint64 download = -1;
+    /*!
+     * \brief Time needed to parse and check the JSON reply.
+     */
+    qint64 parse = -1;
+    /*!
+     * \brief Time needed by Component::successCallback(), that mostly contains the processing by the storage.
+     *
+     * Storages that process the data in their own threads return early, so this only contains the synchronous part.
+     */
+    qint64 processing = -1;
+    /*!
+     * \brief Time from starting the request until the end of the processing.
+     */
+    qint64 total = -1;
+    /*!
+     * \brief Size of the request payload in bytes.
+     */
+    qint64 bytesSent = 0;
+    /*!
+     * \brief Size of the reply body in bytes.
+     */
+    qint64 bytesReceived = 0;
+    /*!
+     * \brief HTTP status code of the reply, \c 0 if there was no reply.
+     */
+    int httpStatus = 0;
+    /*!
+     * \brief Number of the attempt, starting at \c 0.
+     */
+    int attempt = 0;
+    /*!
+     * \brief Result of the request attempt.
+     */
+    Result result = Succeeded;
+};
+
+/*!
+ * \brief Receives timing information about every request performed by the API classes.
+ *
+ * Implement record() and set the sink via Component::setDefaultMetricsSink() to get a RequestMetrics
+ * record for every request attempt. As the API classes can be used from different threads, record()
+ * has to be thread-safe. It is called in the thread of the Component and should return fast.
+ *
+ * If no sink is set, which is the default, no timing information is collected.
+ *
+ * MetricsAggregator is a ready to use implementation that keeps percentile histograms per API route.
+ *
+ * \headerfile "" <Fuoten/Helpers/AbstractMetricsSink>
+ */
+class FUOTENSHARED_EXPORT AbstractMetricsSink
+{
+    Q_DISABLE_COPY(AbstractMetricsSink)
+public:
+    /*!
+     * \brief Constructs a new AbstractMetricsSink.
+     */
+    AbstractMetricsSink();
+
+    /*!
+     * \brief Destroys the sink. The default implementation does nothing.
+     */
+    virtual ~AbstractMetricsSink();
+
+    /*!
+     * \brief Records the \a metrics of a finished request attempt.
+     */
+    virtual void record(const RequestMetrics &metrics) = 0;
+};
+
+}
+
+#endif // FUOTENABSTRACTMETRICSSINK_H
@@ -21,6 +21,12 @@
 
 using namespace Fuoten;
 
+AbstractNamFactory::AbstractNamFactory()
+{
+
+}
+
+
 AbstractNamFactory::~AbstractNamFactory()
 {
 
@@ -41,6 +41,11 @@ class AbstractNamFactory
 {
     Q_DISABLE_COPY(AbstractNamFactory)
 public:
+    /*!
+     * \brief Constructs a new AbstractNamFactory.
+     */
+    AbstractNamFactory();
+
     /*!
      * \brief Destroys the factory. The default implementation does nothing.
      */
@@ -0,0 +1,505 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "fastjsondecoder_p.h"
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QAtomicInt>
+
+using namespace Fuoten;
+
+template<int N>
+static inline bool keyIs(const char *key, int length, const char (&name)[N])
+{
+    return (length == N - 1) && (std::memcmp(key, name, N - 1) == 0);
+}
+
+
+static bool decodeFolder(JsonScanner &s, FolderRecord *f)
+{
+    bool first = true;
+    const char *key = nullptr;
+    int length = 0;
+    while (s.nextKey(&first, &key, &length)) {
+        bool ok = true;
+        if (keyIs(key, length, "id")) {
+            ok = s.readInt64(&f->id);
+        } else if (keyIs(key, length, "name")) {
+            ok = s.readString(&f->name);
+        } else {
+            ok = s.skipValue();
+        }
+        if (Q_UNLIKELY(!ok)) {
+            return false;
+        }
+    }
+    return !s.hasError();
+}
+
+
+static bool decodeFeed(JsonScanner &s, FeedRecord *f)
+{
+    bool first = true;
+    const char *key = nullptr;
+    int length = 0;
+    while (s.nextKey(&first, &key, &length)) {
+        bool ok = true;
+        if (keyIs(key, length, "id")) {
+            ok = s.readInt64(&f->id);
+        } else if (keyIs(key, length, "url")) {
+            ok = s.readString(&f->url);
+        } else if (keyIs(key, length, "title")) {
+            ok = s.readString(&f->title);
+        } else if (keyIs(key, length, "faviconLink")) {
+            ok = s.readString(&f->faviconLink);
+        } else if (keyIs(key, length, "added")) {
+            ok = s.readUInt(&f->added);
+        } else if (keyIs(key, length, "folderId")) {
+            ok = s.readInt64(&f->folderId);
+        } else if (keyIs(key, length, "unreadCount")) {
+            ok = s.readUInt(&f->unreadCount);
+        } else if (keyIs(key, length, "ordering")) {
+            uint ordering = 0;
+            ok = s.readUInt(&ordering);
+            f->ordering = static_cast<quint8>(ordering);
+        } else if (keyIs(key, length, "link")) {
+            ok = s.readString(&f->link);
+        } else if (keyIs(key, length, "pinned")) {
+            ok = s.readBool(&f->pinned);
+        } else if (keyIs(key, length, "updateErrorCount")) {
+            ok = s.readUInt(&f->updateErrorCount);
+        } else if (keyIs(key, length, "lastUpdateError")) {
+            ok = s.readString(&f->lastUpdateError);
+        } else {
+            ok = s.skipValue();
+        }
+        if (Q_UNLIKELY(!ok)) {
+            return false;
+        }
+    }
+    return !s.hasError();
+}
+
+
+static bool decodeItem(JsonScanner &s, ItemRecord *i)
+{
+    bool first = true;
+    const char *key = nullptr;
+    int length = 0;
+    while (s.nextKey(&first, &key, &length)) {
+        bool ok = true;
+        if (keyIs(key, length, "id")) {
+            ok = s.readInt64(&i->id);
+        } else if (keyIs(key, length, "guid")) {
+            ok = s.readString(&i->guid);
+        } else if (keyIs(key, length, "guidHash")) {
+            ok = s.readString(&i->guidHash);
+        } else if (keyIs(key, length, "url")) {
+            ok = s.readString(&i->url);
+        } else if (keyIs(key, length, "title")) {
+            ok = s.readString(&i->title);
+        } else if (keyIs(key, length, "author")) {
+            ok = s.readString(&i->author);
+        } else if (keyIs(key, length, "pubDate")) {
+            ok = s.readUInt(&i->pubDate);
+        } else if (keyIs(key, length, "body")) {
+            ok = s.readString(&i->body);
+        } else if (keyIs(key, length, "enclosureMime")) {
+            ok = s.readString(&i->enclosureMime);
+        } else if (keyIs(key, length, "enclosureLink")) {
+            ok = s.readString(&i->enclosureLink);
+        } else if (keyIs(key, length, "feedId")) {
+            ok = s.readInt64(&i->feedId);
+        } else if (keyIs(key, length, "unread")) {
+            ok = s.readBool(&i->unread);
+        } else if (keyIs(key, length, "starred")) {
+            ok = s.readBool(&i->starred);
+        } else if (keyIs(key, length, "lastModified")) {
+            ok = s.readUInt(&i->lastModified);
+        } else if (keyIs(key, length, "fingerprint")) {
+            ok = s.readString(&i->fingerprint);
+        } else {
+            ok = s.skipValue();
+        }
+        if (Q_UNLIKELY(!ok)) {
+            return false;
+        }
+    }
+    return !s.hasError();
+}
+
+
+/*
+ * Scans the root object of data for the array identified by name and
+ * decodes its elements with decodeRecord. Elements that are not objects
+ * or that are empty objects are skipped, like JsonDecoder does.
+ */
+template<typename T, int N, typename F>
+static bool decodeList(const QByteArray &data, const char (&name)[N], QVector<T> *list, F decodeRecord, bool *found, QString *errorString)
+{
+    JsonScanner s(data.constData(), data.constData() + data.size());
+    const int initialSize = list->size();
+
+    if (s.consume('{')) {
+        bool first = true;
+        const char *key = nullptr;
+        int length = 0;
+        while (s.nextKey(&first, &key, &length)) {
+            if (keyIs(key, length, name) && s.consume('[')) {
+                // the last occurrence of a duplicated key wins, like in QJsonObject
+                list->resize(initialSize);
+                *found = true;
+                bool firstElement = true;
+                while (s.nextElement(&firstElement)) {
+                    if (s.consume('{')) {
+                        if (s.consume('}')) {
+                            continue;
+                        }
+                        T record;
+                        if (Q_UNLIKELY(!decodeRecord(s, &record))) {
+                            break;
+                        }
+                        list->append(record);
+                    } else if (Q_UNLIKELY(!s.skipValue())) {
+                        break;
+                    }
+                }
+            } else if (Q_UNLIKELY(!s.skipValue())) {
+                break;
+            }
+        }
+    } else {
+        // the root is not an object, but it still has to be valid JSON
+        s.skipValue();
+    }
+
+    if (!s.hasError() && !s.atEnd()) {
+        s.fail(QJsonParseError::GarbageAtEnd);
+    }
+
+    if (Q_UNLIKELY(s.hasError())) {
+        list->resize(initialSize);
+        *found = false;
+        if (errorString) {
+            *errorString = s.errorString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Consecutive elements of an array, separated by commas.
+ */
+struct ElementRange {
+    const char *begin;
+    const char *end;
+};
+
+
+/*
+ * Scans the root object of data for the array identified by name like
+ * decodeList() does, but only locates the boundaries of its elements and
+ * groups them into ranges of at least chunkSize bytes. Returns false if
+ * the data is not valid or has no such array, decodeList() will then
+ * report the error.
+ */
+template<int N>
+static bool splitList(const QByteArray &data, const char (&name)[N], int chunkSize, QVector<ElementRange> *ranges)
+{
+    JsonScanner s(data.constData(), data.constData() + data.size());
+
+    if (!s.consume('{')) {
+        return false;
+    }
+
+    bool found = false;
+    bool first = true;
+    const char *key = nullptr;
+    int length = 0;
+    while (s.nextKey(&first, &key, &length)) {
+        if (keyIs(key, length, name) && s.consume('[')) {
+            // the last occurrence of a duplicated key wins, like in QJsonObject
+            ranges->clear();
+            found = true;
+            bool firstElement = true;
+            ElementRange range = {nullptr, nullptr};
+            while (s.nextElement(&firstElement)) {
+                if (!range.begin) {
+                    range.begin = s.position();
+                }
+                if (Q_UNLIKELY(!s.skipValue())) {
+                    break;
+                }
+                range.end = s.position();
+                if ((range.end - range.begin) >= chunkSize) {
+                    ranges->append(range);
+                    range.begin = nullptr;
+                }
+            }
+            if (range.begin) {
+                ranges->append(range);
+            }
+        } else if (Q_UNLIKELY(!s.skipValue())) {
+            break;
+        }
+    }
+
+    return found && !s.hasError() && s.atEnd();
+}
+
+
+/*
+ * Decodes the items in range and appends them to items.
+ */
+static bool decodeItemRange(const ElementRange &range, ItemRecords *items)
+{
+    JsonScanner s(range.begin, range.end);
+    do {
+        if (s.consume('{')) {
+            if (s.consume('}')) {
+                continue;
+            }
+            ItemRecord item;
+            if (Q_UNLIKELY(!decodeItem(s, &item))) {
+                return false;
+            }
+            items->append(item);
+        } else if (Q_UNLIKELY(!s.skipValue())) {
+            return false;
+        }
+    } while (s.consume(','));
+
+    return !s.hasError() && s.atEnd();
+}
+
+
+/*
+ * Shared state of the threads decoding the ranges of an items array. Every
+ * thread takes the next range that has not been taken yet, so faster
+ * threads decode more ranges. The results are stored per range to keep
+ * the original order.
+ */
+class ParallelItemsDecoder
+{
+public:
+    ParallelItemsDecoder(const QVector<ElementRange> &ranges) :
+        m_ranges(ranges), m_results(ranges.size())
+    {
+        m_resultsData = m_results.data();
+    }
+
+    void decode()
+    {
+        int i = 0;
+        while (!m_failed.load() && ((i = m_next.fetchAndAddRelaxed(1)) < m_ranges.size())) {
+            if (Q_UNLIKELY(!decodeItemRange(m_ranges.at(i), &m_resultsData[i]))) {
+                m_failed.store(1);
+            }
+        }
+    }
+
+    bool failed() const { return m_failed.load(); }
+
+    QVector<ItemRecords> &results() { return m_results; }
+
+    QSemaphore finished;
+
+private:
+    const QVector<ElementRange> m_ranges;
+    QVector<ItemRecords> m_results;
+    ItemRecords *m_resultsData = nullptr;
+    QAtomicInt m_next;
+    QAtomicInt m_failed;
+};
+
+
+class ParallelItemsRunnable : public QRunnable
+{
+public:
+    explicit ParallelItemsRunnable(ParallelItemsDecoder *decoder) :
+        QRunnable(), m_decoder(decoder)
+    {}
+
+    void run() override
+    {
+        m_decoder->decode();
+        m_decoder->finished.release();
+    }
+
+private:
+    ParallelItemsDecoder *m_decoder;
+};
+
+
+/*
+ * Decodes the items array of data on the calling thread and on idle threads
+ * of the global thread pool. Threads that are not idle are not waited for,
+ * so this can not dead lock when called from a thread of the pool. Returns
+ * false if the sequential decoder has to be used instead.
+ */
+static bool decodeItemsParallel(const QByteArray &data, ItemRecords *items)
+{
+    const int threads = QThread::idealThreadCount();
+    if (threads < 2) {
+        return false;
+    }
+
+    // more ranges than threads balance the different item sizes
+    QVector<ElementRange> ranges;
+    if (!splitList(data, "items", qMax(data.size() / (threads * 4), 65536), &ranges) || (ranges.size() < 2)) {
+        return false;
+    }
+
+    ParallelItemsDecoder decoder(ranges);
+
+    int started = 0;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    for (int i = 1; i < qMin(threads, ranges.size()); ++i) {
+        ParallelItemsRunnable *runnable = new ParallelItemsRunnable(&decoder);
+        if (!pool->tryStart(runnable)) {
+            delete runnable;
+            break;
+        }
+        started++;
+    }
+
+    qDebug("Decoding %i item ranges on %i threads.", ranges.size(), started + 1);
+
+    decoder.decode();
+    decoder.finished.acquire(started);
+
+    if (Q_UNLIKELY(decoder.failed())) {
+        return false;
+    }
+
+    QVector<ItemRecords> &results = decoder.results();
+    int count = 0;
+    for (const ItemRecords &r : results) {
+        count += r.size();
+    }
+    items->reserve(items->size() + count);
+    for (ItemRecords &r : results) {
+        for (ItemRecord &i : r) {
+            items->append(std::move(i));
+        }
+        r.clear();
+    }
+
+    return true;
+}
+
+
+FastJsonDecoder::FastJsonDecoder() :
+    JsonDecoder(* new FastJsonDecoderPrivate)
+{
+
+}
+
+
+FastJsonDecoder::~FastJsonDecoder()
+{
+
+}
+
+
+bool FastJsonDecoder::decodeFolders(const QByteArray &data, FolderRecords *folders, QString *errorString) const
+{
+    Q_ASSERT_X(folders, "decode folders", "invalid folder list");
+
+    bool found = false;
+    if (Q_UNLIKELY(!decodeList(data, "folders", folders, decodeFolder, &found, errorString))) {
+        return false;
+    }
+
+    if (Q_UNLIKELY(!found)) {
+        if (errorString) {
+            *errorString = qtTrId("libfuoten-err-no-folders-array-in-reply");
+        }
+        return false;
+    }
+
+    return true;
+}
+
+
+bool FastJsonDecoder::decodeFeeds(const QByteArray &data, FeedRecords *feeds, QString *errorString) const
+{
+    Q_ASSERT_X(feeds, "decode feeds", "invalid feed list");
+
+    bool found = false;
+    if (Q_UNLIKELY(!decodeList(data, "feeds", feeds, decodeFeed, &found, errorString))) {
+        return false;
+    }
+
+    if (Q_UNLIKELY(!found)) {
+        if (errorString) {
+            *errorString = qtTrId("libfuoten-err-no-feeds-array-in-reply");
+        }
+        return false;
+    }
+
+    return true;
+}
+
+
+bool FastJsonDecoder::decodeItems(const QByteArray &data, ItemRecords *items, QString *errorString) const
+{
+    Q_ASSERT_X(items, "decode items", "invalid item list");
+
+    Q_D(const FastJsonDecoder);
+
+    const int threshold = d->parallelDecodingThreshold.load();
+
+    if ((threshold > 0) && (data.size() >= threshold) && decodeItemsParallel(data, items)) {
+        return true;
+    }
+
+    bool found = false;
+    if (Q_UNLIKELY(!decodeList(data, "items", items, decodeItem, &found, errorString))) {
+        return false;
+    }
+
+    if (Q_UNLIKELY(!found)) {
+        if (errorString) {
+            *errorString = qtTrId("libfuoten-err-no-items-array-in-reply");
+        }
+        return false;
+    }
+
+    return true;
+}
+
+
+void FastJsonDecoder::setParallelDecodingThreshold(int bytes)
+{
+    Q_D(FastJsonDecoder);
+    d->parallelDecodingThreshold.store(bytes);
+}
+
+
+int FastJsonDecoder::parallelDecodingThreshold() const
+{
+    Q_D(const FastJsonDecoder);
+    return d->parallelDecodingThreshold.load();
+}
@@ -0,0 +1,93 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENFASTJSONDECODER_H
+#define FUOTENFASTJSONDECODER_H
+
+#include "jsondecoder.h"
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+class FastJsonDecoderPrivate;
+
+/*!
+ * \brief Decodes the JSON replies of the News App API directly into typed records.
+ *
+ * In contrast to the JsonDecoder base implementation, no QJsonDocument is built. The reply data is scanned
+ * once and the values of the known keys are converted directly from UTF-8 into the record fields, unknown
+ * keys are skipped. The end of strings is located with the vectorized memchr() of the C library, so that long
+ * article bodies do not have to be inspected character by character.
+ *
+ * Big \c items arrays, like the reply of the first synchronization, are decoded on multiple cores. The array is
+ * scanned once to locate the boundaries of the item objects, then chunks of items are converted in parallel on the
+ * global QThreadPool and the calling thread. The items are appended in their original order. See
+ * setParallelDecodingThreshold().
+ *
+ * This is the decoder used by the API classes if no other decoder has been set via Component::setDefaultJsonDecoder().
+ *
+ * \headerfile "" <Fuoten/Helpers/FastJsonDecoder>
+ */
+class FUOTENSHARED_EXPORT FastJsonDecoder : public JsonDecoder
+{
+public:
+    /*!
+     * \brief Constructs a new FastJsonDecoder.
+     */
+    FastJsonDecoder();
+
+    /*!
+     * \brief Destroys the decoder.
+     */
+    ~FastJsonDecoder() override;
+
+    bool decodeFolders(const QByteArray &data, FolderRecords *folders, QString *errorString = nullptr) const override;
+
+    bool decodeFeeds(const QByteArray &data, FeedRecords *feeds, QString *errorString = nullptr) const override;
+
+    bool decodeItems(const QByteArray &data, ItemRecords *items, QString *errorString = nullptr) const override;
+
+    /*!
+     * \brief Sets the reply size in \a bytes above which items are decoded on multiple threads.
+     *
+     * Item replies that are at least this big are split into chunks that are decoded in parallel, if
+     * QThread::idealThreadCount() reports more than one core. Threads of the global QThreadPool are only used
+     * if they are idle, the calling thread always decodes chunks itself. A value of \c 0 disables parallel
+     * decoding. Defaults to 4 MiB. The value can be changed while the decoder is in use by other threads.
+     * Use Component::setParallelDecodingThreshold() to change it for the decoder used by default.
+     *
+     * \sa parallelDecodingThreshold()
+     */
+    void setParallelDecodingThreshold(int bytes);
+
+    /*!
+     * \brief Returns the reply size in bytes above which items are decoded on multiple threads.
+     *
+     * \sa setParallelDecodingThreshold()
+     */
+    int parallelDecodingThreshold() const;
+
+private:
+    Q_DISABLE_COPY(FastJsonDecoder)
+    Q_DECLARE_PRIVATE(FastJsonDecoder)
+};
+
+}
+
+#endif // FUOTENFASTJSONDECODER_H
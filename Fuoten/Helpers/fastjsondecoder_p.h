@@ -0,0 +1,544 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENFASTJSONDECODER_P_H
+#define FUOTENFASTJSONDECODER_P_H
+
+#include "fastjsondecoder.h"
+#include "jsondecoder_p.h"
+#include <QByteArray>
+#include <QString>
+#include <QJsonParseError>
+#include <QAtomicInt>
+#include <cstring>
+
+namespace Fuoten {
+
+/*
+ * Forward only scanner over UTF-8 encoded JSON data that reads values
+ * directly into C++ types without building a document. The end of strings
+ * is searched with memchr(), that is vectorized by the C library, so long
+ * article bodies are skipped in big steps. Strings without escape sequences
+ * are converted with a single QString::fromUtf8() call.
+ *
+ * The scanner is as lenient as the QJsonValue conversion functions: values
+ * of an unexpected type are skipped and result in empty or zero values.
+ */
+class JsonScanner
+{
+public:
+    JsonScanner(const char *begin, const char *end) :
+        m_begin(begin), m_pos(begin), m_end(end)
+    {}
+
+    bool hasError() const { return m_error != QJsonParseError::NoError; }
+
+    QString errorString() const
+    {
+        QJsonParseError e;
+        e.error = m_error;
+        e.offset = m_errorOffset;
+        return e.errorString();
+    }
+
+    int errorOffset() const { return m_errorOffset; }
+
+    const char *position() const { return m_pos; }
+
+    bool fail(QJsonParseError::ParseError error)
+    {
+        if (!hasError()) {
+            m_error = error;
+            m_errorOffset = static_cast<int>(m_pos - m_begin);
+        }
+        m_pos = m_end;
+        return false;
+    }
+
+    void skipWhitespace()
+    {
+        while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t')) {
+            ++m_pos;
+        }
+    }
+
+    /*
+     * Returns the next non whitespace character without consuming it, or 0
+     * at the end of the data.
+     */
+    char peek()
+    {
+        skipWhitespace();
+        return (m_pos < m_end) ? *m_pos : '\0';
+    }
+
+    bool atEnd()
+    {
+        skipWhitespace();
+        return m_pos >= m_end;
+    }
+
+    bool consume(char c)
+    {
+        if (peek() == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    /*
+     * Moves to the next member of an object whose opening brace has already
+     * been consumed. Returns false at the end of the object or on errors.
+     * The key points into the scanned data or into an internal buffer, if
+     * it contained escape sequences, and is valid until the next call.
+     */
+    bool nextKey(bool *first, const char **key, int *keyLength)
+    {
+        const char c = peek();
+        if (c == '}') {
+            ++m_pos;
+            return false;
+        }
+        if (!*first) {
+            if (c != ',') {
+                return fail((c == '\0') ? QJsonParseError::UnterminatedObject : QJsonParseError::MissingValueSeparator);
+            }
+            ++m_pos;
+            skipWhitespace();
+        }
+        *first = false;
+
+        if (m_pos >= m_end || *m_pos != '"') {
+            return fail(QJsonParseError::UnterminatedObject);
+        }
+        ++m_pos;
+
+        const char *start = nullptr;
+        int length = 0;
+        bool escaped = false;
+        if (!scanString(&start, &length, &escaped)) {
+            return false;
+        }
+        if (escaped) {
+            m_keyBuffer.clear();
+            if (!unescape(start, length, &m_keyBuffer)) {
+                return false;
+            }
+            start = m_keyBuffer.constData();
+            length = m_keyBuffer.size();
+        }
+
+        if (!consume(':')) {
+            return fail(QJsonParseError::MissingNameSeparator);
+        }
+
+        *key = start;
+        *keyLength = length;
+        return true;
+    }
+
+    /*
+     * Moves to the next element of an array whose opening bracket has
+     * already been consumed. Returns false at the end of the array or on
+     * errors.
+     */
+    bool nextElement(bool *first)
+    {
+        const char c = peek();
+        if (c == ']') {
+            ++m_pos;
+            return false;
+        }
+        if (!*first) {
+            if (c != ',') {
+                return fail((c == '\0') ? QJsonParseError::UnterminatedArray : QJsonParseError::MissingValueSeparator);
+            }
+            ++m_pos;
+        }
+        *first = false;
+        if (atEnd()) {
+            return fail(QJsonParseError::UnterminatedArray);
+        }
+        return true;
+    }
+
+    bool readString(QString *out)
+    {
+        if (peek() != '"') {
+            out->clear();
+            return skipValue();
+        }
+        ++m_pos;
+
+        const char *start = nullptr;
+        int length = 0;
+        bool escaped = false;
+        if (!scanString(&start, &length, &escaped)) {
+            return false;
+        }
+
+        if (!escaped) {
+            *out = QString::fromUtf8(start, length);
+            return true;
+        }
+
+        QByteArray buffer;
+        buffer.reserve(length);
+        if (!unescape(start, length, &buffer)) {
+            return false;
+        }
+        *out = QString::fromUtf8(buffer);
+        return true;
+    }
+
+    bool readInt64(qint64 *out)
+    {
+        const char c = peek();
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            const char *start = m_pos;
+            bool integer = true;
+            if (!scanNumber(&integer)) {
+                return false;
+            }
+            if (integer) {
+                const char *p = start;
+                const bool negative = (*p == '-');
+                if (negative) {
+                    ++p;
+                }
+                quint64 v = 0;
+                while (p < m_pos) {
+                    v = v * 10 + static_cast<quint64>(*p - '0');
+                    ++p;
+                }
+                *out = negative ? -static_cast<qint64>(v) : static_cast<qint64>(v);
+            } else {
+                *out = static_cast<qint64>(QByteArray::fromRawData(start, static_cast<int>(m_pos - start)).toDouble());
+            }
+            return true;
+        }
+
+        if (c == '"') {
+            // QVariant converts numeric strings, so do the same here
+            QString s;
+            if (!readString(&s)) {
+                return false;
+            }
+            *out = s.toLongLong();
+            return true;
+        }
+
+        if (c == 't' || c == 'f') {
+            bool b = false;
+            if (!readBool(&b)) {
+                return false;
+            }
+            *out = b ? 1 : 0;
+            return true;
+        }
+
+        *out = 0;
+        return skipValue();
+    }
+
+    bool readUInt(uint *out)
+    {
+        qint64 v = 0;
+        if (!readInt64(&v)) {
+            return false;
+        }
+        *out = static_cast<uint>(v);
+        return true;
+    }
+
+    bool readBool(bool *out)
+    {
+        const char c = peek();
+        if (c == 't') {
+            *out = true;
+            return scanLiteral("true", 4);
+        }
+        if (c == 'f') {
+            *out = false;
+            return scanLiteral("false", 5);
+        }
+        *out = false;
+        return skipValue();
+    }
+
+    bool skipValue()
+    {
+        const char c = peek();
+        switch (c) {
+        case '"':
+        {
+            ++m_pos;
+            const char *start = nullptr;
+            int length = 0;
+            bool escaped = false;
+            return scanString(&start, &length, &escaped);
+        }
+        case '{':
+        {
+            if (++m_depth > maxDepth) {
+                return fail(QJsonParseError::DeepNesting);
+            }
+            ++m_pos;
+            bool first = true;
+            const char *key = nullptr;
+            int keyLength = 0;
+            while (nextKey(&first, &key, &keyLength)) {
+                if (!skipValue()) {
+                    return false;
+                }
+            }
+            --m_depth;
+            return !hasError();
+        }
+        case '[':
+        {
+            if (++m_depth > maxDepth) {
+                return fail(QJsonParseError::DeepNesting);
+            }
+            ++m_pos;
+            bool first = true;
+            while (nextElement(&first)) {
+                if (!skipValue()) {
+                    return false;
+                }
+            }
+            --m_depth;
+            return !hasError();
+        }
+        case 't':
+            return scanLiteral("true", 4);
+        case 'f':
+            return scanLiteral("false", 5);
+        case 'n':
+            return scanLiteral("null", 4);
+        case '\0':
+            return fail(QJsonParseError::IllegalValue);
+        default:
+        {
+            bool integer = true;
+            return scanNumber(&integer);
+        }
+        }
+    }
+
+private:
+    /*
+     * Scans the string whose opening quote has already been consumed and
+     * sets start and length to the raw content between the quotes.
+     */
+    bool scanString(const char **start, int *length, bool *escaped)
+    {
+        const char *s = m_pos;
+        const char *p = s;
+        for (;;) {
+            const char *quote = static_cast<const char*>(std::memchr(p, '"', static_cast<size_t>(m_end - p)));
+            if (!quote) {
+                return fail(QJsonParseError::UnterminatedString);
+            }
+            const char *backslash = static_cast<const char*>(std::memchr(p, '\\', static_cast<size_t>(quote - p)));
+            if (!backslash) {
+                m_pos = quote + 1;
+                break;
+            }
+            *escaped = true;
+            // an odd number of backslashes escapes the quote
+            const char *b = quote;
+            while (b > s && *(b - 1) == '\\') {
+                --b;
+            }
+            if (((quote - b) % 2) == 0) {
+                m_pos = quote + 1;
+                break;
+            }
+            p = quote + 1;
+        }
+        *start = s;
+        *length = static_cast<int>(m_pos - 1 - s);
+        return true;
+    }
+
+    bool scanLiteral(const char *literal, int length)
+    {
+        if ((m_end - m_pos) < length || std::memcmp(m_pos, literal, static_cast<size_t>(length)) != 0) {
+            return fail(QJsonParseError::IllegalValue);
+        }
+        m_pos += length;
+        return true;
+    }
+
+    bool scanNumber(bool *integer)
+    {
+        if (m_pos < m_end && *m_pos == '-') {
+            ++m_pos;
+        }
+        const char *digits = m_pos;
+        while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9') {
+            ++m_pos;
+        }
+        if (m_pos == digits) {
+            return fail(QJsonParseError::IllegalNumber);
+        }
+        while (m_pos < m_end && ((*m_pos >= '0' && *m_pos <= '9') || *m_pos == '.' || *m_pos == 'e' || *m_pos == 'E' || *m_pos == '+' || *m_pos == '-')) {
+            *integer = false;
+            ++m_pos;
+        }
+        return true;
+    }
+
+    static int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    static bool readHex4(const char *p, const char *end, uint *out)
+    {
+        if ((end - p) < 4) {
+            return false;
+        }
+        uint v = 0;
+        for (int i = 0; i < 4; ++i) {
+            const int h = hexValue(p[i]);
+            if (h < 0) {
+                return false;
+            }
+            v = (v << 4) | static_cast<uint>(h);
+        }
+        *out = v;
+        return true;
+    }
+
+    static void appendUtf8(uint ucs4, QByteArray *out)
+    {
+        if (ucs4 < 0x80) {
+            out->append(static_cast<char>(ucs4));
+        } else if (ucs4 < 0x800) {
+            out->append(static_cast<char>(0xc0 | (ucs4 >> 6)));
+            out->append(static_cast<char>(0x80 | (ucs4 & 0x3f)));
+        } else if (ucs4 < 0x10000) {
+            out->append(static_cast<char>(0xe0 | (ucs4 >> 12)));
+            out->append(static_cast<char>(0x80 | ((ucs4 >> 6) & 0x3f)));
+            out->append(static_cast<char>(0x80 | (ucs4 & 0x3f)));
+        } else {
+            out->append(static_cast<char>(0xf0 | (ucs4 >> 18)));
+            out->append(static_cast<char>(0x80 | ((ucs4 >> 12) & 0x3f)));
+            out->append(static_cast<char>(0x80 | ((ucs4 >> 6) & 0x3f)));
+            out->append(static_cast<char>(0x80 | (ucs4 & 0x3f)));
+        }
+    }
+
+    /*
+     * Resolves the escape sequences of the raw string content and appends
+     * the UTF-8 encoded result to out.
+     */
+    bool unescape(const char *start, int length, QByteArray *out)
+    {
+        const char *p = start;
+        const char *end = start + length;
+        while (p < end) {
+            const char *backslash = static_cast<const char*>(std::memchr(p, '\\', static_cast<size_t>(end - p)));
+            if (!backslash) {
+                out->append(p, static_cast<int>(end - p));
+                break;
+            }
+            out->append(p, static_cast<int>(backslash - p));
+            p = backslash + 1;
+            if (p >= end) {
+                return fail(QJsonParseError::IllegalEscapeSequence);
+            }
+            switch (*p) {
+            case '"':  out->append('"');  break;
+            case '\\': out->append('\\'); break;
+            case '/':  out->append('/');  break;
+            case 'b':  out->append('\b'); break;
+            case 'f':  out->append('\f'); break;
+            case 'n':  out->append('\n'); break;
+            case 'r':  out->append('\r'); break;
+            case 't':  out->append('\t'); break;
+            case 'u':
+            {
+                uint ucs4 = 0;
+                if (!readHex4(p + 1, end, &ucs4)) {
+                    return fail(QJsonParseError::IllegalEscapeSequence);
+                }
+                p += 4;
+                if (ucs4 >= 0xd800 && ucs4 < 0xdc00) {
+                    uint low = 0;
+                    if ((end - p) > 6 && p[1] == '\\' && p[2] == 'u' && readHex4(p + 3, end, &low) && low >= 0xdc00 && low < 0xe000) {
+                        ucs4 = 0x10000 + ((ucs4 - 0xd800) << 10) + (low - 0xdc00);
+                        p += 6;
+                    } else {
+                        ucs4 = 0xfffd;
+                    }
+                } else if (ucs4 >= 0xdc00 && ucs4 < 0xe000) {
+                    ucs4 = 0xfffd;
+                }
+                appendUtf8(ucs4, out);
+                break;
+            }
+            default:
+                return fail(QJsonParseError::IllegalEscapeSequence);
+            }
+            ++p;
+        }
+        return true;
+    }
+
+    static const int maxDepth = 1024;
+
+    const char *m_begin = nullptr;
+    const char *m_pos = nullptr;
+    const char *m_end = nullptr;
+    QByteArray m_keyBuffer;
+    int m_depth = 0;
+    int m_errorOffset = 0;
+    QJsonParseError::ParseError m_error = QJsonParseError::NoError;
+};
+
+
+class FastJsonDecoderPrivate : public JsonDecoderPrivate
+{
+public:
+    FastJsonDecoderPrivate() : JsonDecoderPrivate() {}
+
+    ~FastJsonDecoderPrivate() override {}
+
+    QAtomicInt parallelDecodingThreshold = 4194304;
+
+private:
+    Q_DISABLE_COPY(FastJsonDecoderPrivate)
+};
+
+}
+
+#endif // FUOTENFASTJSONDECODER_P_H
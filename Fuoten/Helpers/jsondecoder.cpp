@@ -0,0 +1,277 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsondecoder_p.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QJsonParseError>
+#include <QVariant>
+
+using namespace Fuoten;
+
+/*
+ * Parses data into a QJsonDocument and checks that the root object contains
+ * an array identified by key. Sets the errorString if the data is not valid
+ * or if there is no such array.
+ */
+static bool parseDocument(const QByteArray &data, const QString &key, QJsonDocument *json, QString *errorString)
+{
+    QJsonParseError jsonError;
+    *json = QJsonDocument::fromJson(data, &jsonError);
+    if (Q_UNLIKELY(jsonError.error != QJsonParseError::NoError)) {
+        if (errorString) {
+            *errorString = jsonError.errorString();
+        }
+        return false;
+    }
+
+    if (Q_UNLIKELY(!json->object().value(key).isArray())) {
+        if (errorString) {
+            *errorString = QString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * Converts the non empty objects of the array identified by key with convert.
+ */
+template<typename T, typename F>
+static QVector<T> recordsFromJson(const QJsonDocument &json, const QString &key, F convert)
+{
+    const QJsonArray a = json.object().value(key).toArray();
+    QVector<T> records;
+    records.reserve(a.size());
+    for (const QJsonValue &v : a) {
+        const QJsonObject o = v.toObject();
+        if (Q_LIKELY(!o.isEmpty())) {
+            records.append(convert(o));
+        }
+    }
+    return records;
+}
+
+
+/*
+ * The News App API sends null for strings that are not set.
+ */
+static QJsonValue nullableString(const QString &s)
+{
+    return s.isEmpty() ? QJsonValue() : QJsonValue(s);
+}
+
+
+JsonDecoder::JsonDecoder() :
+    d_ptr(new JsonDecoderPrivate)
+{
+
+}
+
+
+JsonDecoder::JsonDecoder(JsonDecoderPrivate &dd) :
+    d_ptr(&dd)
+{
+
+}
+
+
+JsonDecoder::~JsonDecoder()
+{
+
+}
+
+
+bool JsonDecoder::decodeFolders(const QByteArray &data, FolderRecords *folders, QString *errorString) const
+{
+    Q_ASSERT_X(folders, "decode folders", "invalid folder list");
+
+    QJsonDocument json;
+    if (Q_UNLIKELY(!parseDocument(data, QStringLiteral("folders"), &json, errorString))) {
+        if (errorString && errorString->isEmpty()) {
+            //% "The data the server replied does not contain a \"folders\" array."
+            *errorString = qtTrId("libfuoten-err-no-folders-array-in-reply");
+        }
+        return false;
+    }
+
+    folders->append(foldersFromJson(json));
+
+    return true;
+}
+
+
+bool JsonDecoder::decodeFeeds(const QByteArray &data, FeedRecords *feeds, QString *errorString) const
+{
+    Q_ASSERT_X(feeds, "decode feeds", "invalid feed list");
+
+    QJsonDocument json;
+    if (Q_UNLIKELY(!parseDocument(data, QStringLiteral("feeds"), &json, errorString))) {
+        if (errorString && errorString->isEmpty()) {
+            //% "The data the server replied does not contain a \"feeds\" array."
+            *errorString = qtTrId("libfuoten-err-no-feeds-array-in-reply");
+        }
+        return false;
+    }
+
+    feeds->append(feedsFromJson(json));
+
+    return true;
+}
+
+
+bool JsonDecoder::decodeItems(const QByteArray &data, ItemRecords *items, QString *errorString) const
+{
+    Q_ASSERT_X(items, "decode items", "invalid item list");
+
+    QJsonDocument json;
+    if (Q_UNLIKELY(!parseDocument(data, QStringLiteral("items"), &json, errorString))) {
+        if (errorString && errorString->isEmpty()) {
+            //% "The data the server replied does not contain an \"items\" array."
+            *errorString = qtTrId("libfuoten-err-no-items-array-in-reply");
+        }
+        return false;
+    }
+
+    items->append(itemsFromJson(json));
+
+    return true;
+}
+
+
+FolderRecord JsonDecoder::folderFromJson(const QJsonObject &o)
+{
+    FolderRecord f;
+    f.id = o.value(QStringLiteral("id")).toVariant().toLongLong();
+    f.name = o.value(QStringLiteral("name")).toString();
+    return f;
+}
+
+
+FeedRecord JsonDecoder::feedFromJson(const QJsonObject &o)
+{
+    FeedRecord f;
+    f.id = o.value(QStringLiteral("id")).toVariant().toLongLong();
+    f.folderId = o.value(QStringLiteral("folderId")).toVariant().toLongLong();
+    f.title = o.value(QStringLiteral("title")).toString();
+    f.url = o.value(QStringLiteral("url")).toString();
+    f.link = o.value(QStringLiteral("link")).toString();
+    f.faviconLink = o.value(QStringLiteral("faviconLink")).toString();
+    f.lastUpdateError = o.value(QStringLiteral("lastUpdateError")).toString();
+    f.added = o.value(QStringLiteral("added")).toVariant().toUInt();
+    f.unreadCount = o.value(QStringLiteral("unreadCount")).toVariant().toUInt();
+    f.updateErrorCount = o.value(QStringLiteral("updateErrorCount")).toVariant().toUInt();
+    f.ordering = o.value(QStringLiteral("ordering")).toInt();
+    f.pinned = o.value(QStringLiteral("pinned")).toBool();
+    return f;
+}
+
+
+ItemRecord JsonDecoder::itemFromJson(const QJsonObject &o)
+{
+    ItemRecord i;
+    i.id = o.value(QStringLiteral("id")).toVariant().toLongLong();
+    i.feedId = o.value(QStringLiteral("feedId")).toVariant().toLongLong();
+    i.guid = o.value(QStringLiteral("guid")).toString();
+    i.guidHash = o.value(QStringLiteral("guidHash")).toString();
+    i.url = o.value(QStringLiteral("url")).toString();
+    i.title = o.value(QStringLiteral("title")).toString();
+    i.author = o.value(QStringLiteral("author")).toString();
+    i.body = o.value(QStringLiteral("body")).toString();
+    i.enclosureMime = o.value(QStringLiteral("enclosureMime")).toString();
+    i.enclosureLink = o.value(QStringLiteral("enclosureLink")).toString();
+    i.fingerprint = o.value(QStringLiteral("fingerprint")).toString();
+    i.pubDate = o.value(QStringLiteral("pubDate")).toVariant().toUInt();
+    i.lastModified = o.value(QStringLiteral("lastModified")).toVariant().toUInt();
+    i.unread = o.value(QStringLiteral("unread")).toBool();
+    i.starred = o.value(QStringLiteral("starred")).toBool();
+    return i;
+}
+
+
+FolderRecords JsonDecoder::foldersFromJson(const QJsonDocument &json)
+{
+    return recordsFromJson<FolderRecord>(json, QStringLiteral("folders"), folderFromJson);
+}
+
+
+FeedRecords JsonDecoder::feedsFromJson(const QJsonDocument &json)
+{
+    return recordsFromJson<FeedRecord>(json, QStringLiteral("feeds"), feedFromJson);
+}
+
+
+ItemRecords JsonDecoder::itemsFromJson(const QJsonDocument &json)
+{
+    return recordsFromJson<ItemRecord>(json, QStringLiteral("items"), itemFromJson);
+}
+
+
+QJsonObject JsonDecoder::folderToJson(const FolderRecord &folder)
+{
+    QJsonObject o;
+    o.insert(QStringLiteral("id"), folder.id);
+    o.insert(QStringLiteral("name"), folder.name);
+    return o;
+}
+
+
+QJsonObject JsonDecoder::feedToJson(const FeedRecord &feed)
+{
+    QJsonObject o;
+    o.insert(QStringLiteral("id"), feed.id);
+    o.insert(QStringLiteral("url"), feed.url);
+    o.insert(QStringLiteral("title"), feed.title);
+    o.insert(QStringLiteral("faviconLink"), nullableString(feed.faviconLink));
+    o.insert(QStringLiteral("added"), static_cast<qint64>(feed.added));
+    o.insert(QStringLiteral("folderId"), feed.folderId);
+    o.insert(QStringLiteral("unreadCount"), static_cast<qint64>(feed.unreadCount));
+    o.insert(QStringLiteral("ordering"), feed.ordering);
+    o.insert(QStringLiteral("link"), feed.link);
+    o.insert(QStringLiteral("pinned"), feed.pinned);
+    o.insert(QStringLiteral("updateErrorCount"), static_cast<qint64>(feed.updateErrorCount));
+    o.insert(QStringLiteral("lastUpdateError"), nullableString(feed.lastUpdateError));
+    return o;
+}
+
+
+QJsonObject JsonDecoder::itemToJson(const ItemRecord &item)
+{
+    QJsonObject o;
+    o.insert(QStringLiteral("id"), item.id);
+    o.insert(QStringLiteral("guid"), item.guid);
+    o.insert(QStringLiteral("guidHash"), item.guidHash);
+    o.insert(QStringLiteral("url"), item.url);
+    o.insert(QStringLiteral("title"), item.title);
+    o.insert(QStringLiteral("author"), item.author);
+    o.insert(QStringLiteral("pubDate"), static_cast<qint64>(item.pubDate));
+    o.insert(QStringLiteral("body"), item.body);
+    o.insert(QStringLiteral("enclosureMime"), nullableString(item.enclosureMime));
+    o.insert(QStringLiteral("enclosureLink"), nullableString(item.enclosureLink));
+    o.insert(QStringLiteral("feedId"), item.feedId);
+    o.insert(QStringLiteral("unread"), item.unread);
+    o.insert(QStringLiteral("starred"), item.starred);
+    o.insert(QStringLiteral("lastModified"), static_cast<qint64>(item.lastModified));
+    o.insert(QStringLiteral("fingerprint"), item.fingerprint);
+    return o;
+}
@@ -0,0 +1,146 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENJSONDECODER_H
+#define FUOTENJSONDECODER_H
+
+#include <QByteArray>
+#include <QScopedPointer>
+#include "../records.h"
+#include "../fuoten_global.h"
+
+class QJsonObject;
+class QJsonDocument;
+
+namespace Fuoten {
+
+class JsonDecoderPrivate;
+
+/*!
+ * \brief Decodes the JSON replies of the News App API into typed records.
+ *
+ * GetFolders, GetFeeds, GetItems and GetUpdatedItems use the decoder set via Component::setDefaultJsonDecoder()
+ * to convert the reply data into FolderRecord, FeedRecord and ItemRecord lists. If no decoder has been set,
+ * a FastJsonDecoder is used.
+ *
+ * This implementation parses the data into a QJsonDocument and converts the contained objects. It is the
+ * compatibility fallback and can be reimplemented to plug in other parsers. As the API classes might decode
+ * big replies in a background thread, all decode functions have to be reentrant.
+ *
+ * \headerfile "" <Fuoten/Helpers/JsonDecoder>
+ */
+class FUOTENSHARED_EXPORT JsonDecoder
+{
+    Q_DISABLE_COPY(JsonDecoder)
+public:
+    /*!
+     * \brief Constructs a new JsonDecoder.
+     */
+    JsonDecoder();
+
+    /*!
+     * \brief Destroys the decoder.
+     */
+    virtual ~JsonDecoder();
+
+    /*!
+     * \brief Decodes the folders contained in the reply \a data of GetFolders and appends them to \a folders.
+     *
+     * Returns \c false and sets the \a errorString if the data is not valid JSON or does not contain a \c folders array.
+     */
+    virtual bool decodeFolders(const QByteArray &data, FolderRecords *folders, QString *errorString = nullptr) const;
+
+    /*!
+     * \brief Decodes the feeds contained in the reply \a data of GetFeeds and appends them to \a feeds.
+     *
+     * Returns \c false and sets the \a errorString if the data is not valid JSON or does not contain a \c feeds array.
+     */
+    virtual bool decodeFeeds(const QByteArray &data, FeedRecords *feeds, QString *errorString = nullptr) const;
+
+    /*!
+     * \brief Decodes the items contained in the reply \a data of GetItems or GetUpdatedItems and appends them to \a items.
+     *
+     * Returns \c false and sets the \a errorString if the data is not valid JSON or does not contain an \c items array.
+     */
+    virtual bool decodeItems(const QByteArray &data, ItemRecords *items, QString *errorString = nullptr) const;
+
+    /*!
+     * \brief Converts the \c folders array of the GetFolders reply \a json into a list of records.
+     *
+     * Array elements that are not objects or that are empty are skipped.
+     */
+    static FolderRecords foldersFromJson(const QJsonDocument &json);
+
+    /*!
+     * \brief Converts the \c feeds array of the GetFeeds reply \a json into a list of records.
+     *
+     * Array elements that are not objects or that are empty are skipped.
+     */
+    static FeedRecords feedsFromJson(const QJsonDocument &json);
+
+    /*!
+     * \brief Converts the \c items array of the GetItems or GetUpdatedItems reply \a json into a list of records.
+     *
+     * Array elements that are not objects or that are empty are skipped.
+     */
+    static ItemRecords itemsFromJson(const QJsonDocument &json);
+
+    /*!
+     * \brief Converts the JSON object \a o of a single folder into a FolderRecord.
+     */
+    static FolderRecord folderFromJson(const QJsonObject &o);
+
+    /*!
+     * \brief Converts the JSON object \a o of a single feed into a FeedRecord.
+     */
+    static FeedRecord feedFromJson(const QJsonObject &o);
+
+    /*!
+     * \brief Converts the JSON object \a o of a single item into an ItemRecord.
+     */
+    static ItemRecord itemFromJson(const QJsonObject &o);
+
+    /*!
+     * \brief Converts the \a folder record into a JSON object like it is used by the News App API.
+     */
+    static QJsonObject folderToJson(const FolderRecord &folder);
+
+    /*!
+     * \brief Converts the \a feed record into a JSON object like it is used by the News App API.
+     */
+    static QJsonObject feedToJson(const FeedRecord &feed);
+
+    /*!
+     * \brief Converts the \a item record into a JSON object like it is used by the News App API.
+     *
+     * Used for example to hand new articles to AbstractNotificator::checkForPublishing().
+     */
+    static QJsonObject itemToJson(const ItemRecord &item);
+
+protected:
+    const QScopedPointer<JsonDecoderPrivate> d_ptr;
+    JsonDecoder(JsonDecoderPrivate &dd);
+
+private:
+    Q_DECLARE_PRIVATE(JsonDecoder)
+};
+
+}
+
+#endif // FUOTENJSONDECODER_H
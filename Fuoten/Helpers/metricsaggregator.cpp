@@ -0,0 +1,184 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "metricsaggregator_p.h"
+#include <QMutexLocker>
+#include <QJsonValue>
+
+using namespace Fuoten;
+
+MetricsAggregator::MetricsAggregator() :
+    AbstractMetricsSink(), d_ptr(new MetricsAggregatorPrivate)
+{
+
+}
+
+
+MetricsAggregator::~MetricsAggregator()
+{
+
+}
+
+
+void MetricsAggregator::record(const RequestMetrics &metrics)
+{
+    Q_D(MetricsAggregator);
+
+    const QString key = MetricsAggregatorPrivate::routeKey(metrics);
+
+    QMutexLocker locker(&d->mutex);
+
+    MetricsAggregatorPrivate::RouteStats &s = d->routes[key];
+    s.count++;
+    if ((metrics.result == RequestMetrics::Failed) || (metrics.result == RequestMetrics::TimedOut)) {
+        s.failures++;
+    } else if (metrics.result == RequestMetrics::Retried) {
+        s.retries++;
+    }
+    s.bytesSent += metrics.bytesSent;
+    s.bytesReceived += metrics.bytesReceived;
+    s.maxQueueDepth = qMax(s.maxQueueDepth, metrics.queueDepth);
+
+    s.phases[QueueWait].add(metrics.queueWait);
+    s.phases[ConnectionSetup].add(metrics.connectionSetup);
+    s.phases[TimeToFirstByte].add(metrics.timeToFirstByte);
+    s.phases[Download].add(metrics.download);
+    s.phases[Parse].add(metrics.parse);
+    s.phases[Processing].add(metrics.processing);
+    s.phases[Total].add(metrics.total);
+}
+
+
+QStringList MetricsAggregator::routes() const
+{
+    Q_D(const MetricsAggregator);
+    QMutexLocker locker(&d->mutex);
+    QStringList lst = d->routes.keys();
+    lst.sort();
+    return lst;
+}
+
+
+quint64 MetricsAggregator::count(const QString &route) const
+{
+    Q_D(const MetricsAggregator);
+    QMutexLocker locker(&d->mutex);
+    return d->routes.value(route).count;
+}
+
+
+quint64 MetricsAggregator::failures(const QString &route) const
+{
+    Q_D(const MetricsAggregator);
+    QMutexLocker locker(&d->mutex);
+    return d->routes.value(route).failures;
+}
+
+
+quint64 MetricsAggregator::retries(const QString &route) const
+{
+    Q_D(const MetricsAggregator);
+    QMutexLocker locker(&d->mutex);
+    return d->routes.value(route).retries;
+}
+
+
+qint64 MetricsAggregator::bytesReceived(const QString &route) const
+{
+    Q_D(const MetricsAggregator);
+    QMutexLocker locker(&d->mutex);
+    return d->routes.value(route).bytesReceived;
+}
+
+
+qint64 MetricsAggregator::bytesSent(const QString &route) const
+{
+    Q_D(const MetricsAggregator);
+    QMutexLocker locker(&d->mutex);
+    return d->routes.value(route).bytesSent;
+}
+
+
+int MetricsAggregator::maxQueueDepth(const QString &route) const
+{
+    Q_D(const MetricsAggregator);
+    QMutexLocker locker(&d->mutex);
+    return d->routes.value(route).maxQueueDepth;
+}
+
+
+qint64 MetricsAggregator::percentile(const QString &route, Phase phase, double percentile) const
+{
+    Q_D(const MetricsAggregator);
+    if (phase >= PhaseCount) {
+        return -1;
+    }
+    QMutexLocker locker(&d->mutex);
+    auto it = d->routes.constFind(route);
+    if (it == d->routes.constEnd()) {
+        return -1;
+    }
+    return it.value().phases[phase].percentile(percentile);
+}
+
+
+QJsonObject MetricsAggregator::toJson() const
+{
+    Q_D(const MetricsAggregator);
+
+    static const char *phaseNames[PhaseCount] = {"queueWait", "connectionSetup", "timeToFirstByte", "download", "parse", "processing", "total"};
+
+    QMutexLocker locker(&d->mutex);
+
+    QJsonObject o;
+    for (auto it = d->routes.constBegin(); it != d->routes.constEnd(); ++it) {
+        const MetricsAggregatorPrivate::RouteStats &s = it.value();
+        QJsonObject r;
+        r.insert(QStringLiteral("count"), QJsonValue(static_cast<qint64>(s.count)));
+        r.insert(QStringLiteral("failures"), QJsonValue(static_cast<qint64>(s.failures)));
+        r.insert(QStringLiteral("retries"), QJsonValue(static_cast<qint64>(s.retries)));
+        r.insert(QStringLiteral("bytesSent"), QJsonValue(s.bytesSent));
+        r.insert(QStringLiteral("bytesReceived"), QJsonValue(s.bytesReceived));
+        if (s.maxQueueDepth > -1) {
+            r.insert(QStringLiteral("maxQueueDepth"), QJsonValue(s.maxQueueDepth));
+        }
+        for (int p = 0; p < PhaseCount; ++p) {
+            const MetricsHistogram &h = s.phases[p];
+            if (h.count == 0) {
+                continue;
+            }
+            QJsonObject ph;
+            ph.insert(QStringLiteral("p50"), QJsonValue(h.percentile(50.0)));
+            ph.insert(QStringLiteral("p90"), QJsonValue(h.percentile(90.0)));
+            ph.insert(QStringLiteral("p99"), QJsonValue(h.percentile(99.0)));
+            ph.insert(QStringLiteral("max"), QJsonValue(h.max));
+            r.insert(QLatin1String(phaseNames[p]), ph);
+        }
+        o.insert(it.key(), r);
+    }
+    return o;
+}
+
+
+void MetricsAggregator::clear()
+{
+    Q_D(MetricsAggregator);
+    QMutexLocker locker(&d->mutex);
+    d->routes.clear();
+}
@@ -0,0 +1,148 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENMETRICSAGGREGATOR_H
+#define FUOTENMETRICSAGGREGATOR_H
+
+#include <QStringList>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include "abstractmetricssink.h"
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+class MetricsAggregatorPrivate;
+
+/*!
+ * \brief In-memory metrics sink that aggregates request timings per API route.
+ *
+ * Every phase of a request is added to a histogram with logarithmic buckets, that has a relative error
+ * of less than 12.5%, so percentiles can be queried without keeping the single values. Numeric path
+ * segments of the API routes are replaced by \c {id}, so that requests for different folders or feeds
+ * are aggregated together, the HTTP method is prepended, like <TT>PUT /items/read/multiple</TT>.
+ *
+ * All functions are thread-safe.
+ *
+ * \code{.cpp}
+ * MetricsAggregator *metrics = new MetricsAggregator;
+ * Component::setDefaultMetricsSink(metrics);
+ * // ... synchronize ...
+ * qDebug() << metrics->toJson();
+ * \endcode
+ *
+ * \headerfile "" <Fuoten/Helpers/MetricsAggregator>
+ */
+class FUOTENSHARED_EXPORT MetricsAggregator : public AbstractMetricsSink
+{
+public:
+    /*!
+     * \brief The phases of a request, see RequestMetrics for descriptions.
+     */
+    enum Phase : quint8 {
+        QueueWait = 0,
+        ConnectionSetup,
+        TimeToFirstByte,
+        Download,
+        Parse,
+        Processing,
+        Total,
+        PhaseCount
+    };
+
+    /*!
+     * \brief Constructs a new empty MetricsAggregator.
+     */
+    MetricsAggregator();
+
+    /*!
+     * \brief Destroys the MetricsAggregator.
+     */
+    ~MetricsAggregator();
+
+    /*!
+     * \brief Adds the \a metrics to the histograms of the request route.
+     */
+    void record(const RequestMetrics &metrics) override;
+
+    /*!
+     * \brief Returns the list of recorded routes.
+     */
+    QStringList routes() const;
+
+    /*!
+     * \brief Returns the number of recorded request attempts for the \a route.
+     */
+    quint64 count(const QString &route) const;
+
+    /*!
+     * \brief Returns the number of failed and timed out request attempts for the \a route.
+     */
+    quint64 failures(const QString &route) const;
+
+    /*!
+     * \brief Returns the number of retried request attempts for the \a route.
+     */
+    quint64 retries(const QString &route) const;
+
+    /*!
+     * \brief Returns the number of bytes received for the \a route.
+     */
+    qint64 bytesReceived(const QString &route) const;
+
+    /*!
+     * \brief Returns the number of bytes sent for the \a route.
+     */
+    qint64 bytesSent(const QString &route) const;
+
+    /*!
+     * \brief Returns the highest number of requests that were waiting in the shared network session when a request for the \a route has been enqueued.
+     *
+     * Returns \c -1 if no request of the route used the shared network session.
+     */
+    int maxQueueDepth(const QString &route) const;
+
+    /*!
+     * \brief Returns the value in microseconds below which \a percentile percent of the \a phase durations of the \a route are.
+     *
+     * Returns \c -1 if no values have been recorded for the phase.
+     */
+    qint64 percentile(const QString &route, Phase phase, double percentile) const;
+
+    /*!
+     * \brief Returns a summary containing count, bytes, the maximum queue depth and the 50th, 90th, 99th percentile and the maximum of every phase per route.
+     */
+    QJsonObject toJson() const;
+
+    /*!
+     * \brief Removes all recorded values.
+     */
+    void clear();
+
+protected:
+    const QScopedPointer<MetricsAggregatorPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(MetricsAggregator)
+    Q_DECLARE_PRIVATE(MetricsAggregator)
+};
+
+}
+
+#endif // FUOTENMETRICSAGGREGATOR_H
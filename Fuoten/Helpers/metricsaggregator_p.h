@@ -0,0 +1,124 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENMETRICSAGGREGATOR_P_H
+#define FUOTENMETRICSAGGREGATOR_P_H
+
+#include "metricsaggregator.h"
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+#include <QRegularExpression>
+
+namespace Fuoten {
+
+/*
+ * Histogram with eight linear sub buckets per power of two. Values below
+ * eight have their own bucket.
+ */
+class MetricsHistogram
+{
+public:
+    MetricsHistogram() : buckets(8 + 60 * 8, 0) {}
+
+    static int index(qint64 value)
+    {
+        if (value < 8) {
+            return static_cast<int>(qMax<qint64>(value, 0));
+        }
+        int exp = 3;
+        while ((value >> (exp + 1)) > 0) {
+            exp++;
+        }
+        const int sub = static_cast<int>((value >> (exp - 3)) & 7);
+        return 8 + (exp - 3) * 8 + sub;
+    }
+
+    static qint64 upperBound(int index)
+    {
+        if (index < 8) {
+            return index;
+        }
+        const int exp = (index - 8) / 8 + 3;
+        const int sub = (index - 8) % 8;
+        return (static_cast<qint64>(8 + sub + 1) << (exp - 3)) - 1;
+    }
+
+    void add(qint64 value)
+    {
+        if (value < 0) {
+            return;
+        }
+        const int i = qMin(index(value), buckets.size() - 1);
+        buckets[i]++;
+        count++;
+        max = qMax(max, value);
+    }
+
+    qint64 percentile(double p) const
+    {
+        if (count == 0) {
+            return -1;
+        }
+        const quint64 rank = qMax<quint64>(1, static_cast<quint64>(qBound(0.0, p, 100.0) / 100.0 * count + 0.5));
+        quint64 seen = 0;
+        for (int i = 0; i < buckets.size(); ++i) {
+            seen += buckets.at(i);
+            if (seen >= rank) {
+                return qMin(upperBound(i), max);
+            }
+        }
+        return max;
+    }
+
+    QVector<quint32> buckets;
+    quint64 count = 0;
+    qint64 max = 0;
+};
+
+class MetricsAggregatorPrivate
+{
+public:
+    struct RouteStats {
+        MetricsHistogram phases[MetricsAggregator::PhaseCount];
+        quint64 count = 0;
+        quint64 failures = 0;
+        quint64 retries = 0;
+        qint64 bytesSent = 0;
+        qint64 bytesReceived = 0;
+        int maxQueueDepth = -1;
+    };
+
+    MetricsAggregatorPrivate() {}
+
+    static QString routeKey(const RequestMetrics &m)
+    {
+        static const QRegularExpression numericSegment(QStringLiteral("/\\d+(?=/|$)"));
+        QString route = m.apiRoute;
+        route.replace(numericSegment, QStringLiteral("/{id}"));
+        return m.method + QLatin1Char(' ') + route;
+    }
+
+    mutable QMutex mutex;
+    QHash<QString, RouteStats> routes;
+};
+
+}
+
+#endif // FUOTENMETRICSAGGREGATOR_P_H
@@ -0,0 +1,276 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "replaynamfactory_p.h"
+#include <QFile>
+#include <QTimer>
+#include <QMutexLocker>
+
+using namespace Fuoten;
+
+ReplayReply::ReplayReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request, const TrafficRecord *record, QObject *parent) :
+    QNetworkReply(parent)
+{
+    setRequest(request);
+    setUrl(request.url());
+    setOperation(op);
+
+    int status = 404;
+    if (record) {
+        status = record->httpStatus;
+        m_data = qUncompress(record->responseBody);
+        if (!record->contentType.isEmpty()) {
+            setHeader(QNetworkRequest::ContentTypeHeader, record->contentType);
+        }
+    }
+
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, status);
+    setHeader(QNetworkRequest::ContentLengthHeader, m_data.size());
+
+    if (status >= 400) {
+        QNetworkReply::NetworkError code;
+        switch (status) {
+        case 401:
+            code = QNetworkReply::AuthenticationRequiredError;
+            break;
+        case 403:
+            code = QNetworkReply::ContentAccessDenied;
+            break;
+        case 404:
+            code = QNetworkReply::ContentNotFoundError;
+            break;
+        case 405:
+            code = QNetworkReply::ContentOperationNotPermittedError;
+            break;
+        case 409:
+            code = QNetworkReply::ContentConflictError;
+            break;
+        case 503:
+            code = QNetworkReply::ServiceUnavailableError;
+            break;
+        default:
+            code = (status >= 500) ? QNetworkReply::InternalServerError : QNetworkReply::UnknownContentError;
+            break;
+        }
+        setError(code, QStringLiteral("Replayed reply with HTTP status %1.").arg(status));
+    }
+
+    open(QIODevice::ReadOnly|QIODevice::Unbuffered);
+
+    // like a real reply, the data is delivered after returning to the event loop
+    QTimer::singleShot(0, this, [this] () {deliver();});
+}
+
+
+void ReplayReply::deliver()
+{
+    if (isFinished()) {
+        return;
+    }
+
+    Q_EMIT metaDataChanged();
+    if (!m_data.isEmpty()) {
+        Q_EMIT downloadProgress(m_data.size(), m_data.size());
+        Q_EMIT readyRead();
+    }
+    setFinished(true);
+    Q_EMIT finished();
+}
+
+
+void ReplayReply::abort()
+{
+    if (isFinished()) {
+        return;
+    }
+
+    setError(QNetworkReply::OperationCanceledError, QStringLiteral("Operation canceled"));
+    setFinished(true);
+    Q_EMIT finished();
+}
+
+
+qint64 ReplayReply::bytesAvailable() const
+{
+    return (m_data.size() - m_pos) + QNetworkReply::bytesAvailable();
+}
+
+
+bool ReplayReply::isSequential() const
+{
+    return true;
+}
+
+
+qint64 ReplayReply::readData(char *data, qint64 maxSize)
+{
+    if (m_pos >= m_data.size()) {
+        return -1;
+    }
+
+    const qint64 len = qMin(maxSize, m_data.size() - m_pos);
+    memcpy(data, m_data.constData() + m_pos, static_cast<size_t>(len));
+    m_pos += len;
+    return len;
+}
+
+
+
+ReplayNetworkAccessManager::ReplayNetworkAccessManager(ReplayNamFactoryPrivate *factory, QObject *parent) :
+    QNetworkAccessManager(parent), m_factory(factory)
+{
+
+}
+
+
+QNetworkReply *ReplayNetworkAccessManager::createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData)
+{
+    Q_UNUSED(outgoingData);
+
+    QString method;
+    switch (op) {
+    case QNetworkAccessManager::HeadOperation:
+        method = QStringLiteral("HEAD");
+        break;
+    case QNetworkAccessManager::PostOperation:
+        method = QStringLiteral("POST");
+        break;
+    case QNetworkAccessManager::PutOperation:
+        method = QStringLiteral("PUT");
+        break;
+    case QNetworkAccessManager::DeleteOperation:
+        method = QStringLiteral("DELETE");
+        break;
+    case QNetworkAccessManager::CustomOperation:
+        method = QString::fromLatin1(request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray());
+        break;
+    default:
+        method = QStringLiteral("GET");
+        break;
+    }
+
+    const QString route = TrafficRecord::routeFromUrl(request.url());
+
+    TrafficRecord record;
+    if (m_factory->find(method, route, &record)) {
+        return new ReplayReply(op, request, &record, this);
+    }
+
+    qWarning("No recorded reply for %s %s.", qUtf8Printable(method), qUtf8Printable(route));
+    return new ReplayReply(op, request, nullptr, this);
+}
+
+
+
+ReplayNamFactory::ReplayNamFactory() :
+    AbstractNamFactory(), d_ptr(new ReplayNamFactoryPrivate)
+{
+
+}
+
+
+ReplayNamFactory::~ReplayNamFactory()
+{
+
+}
+
+
+bool ReplayNamFactory::load(const QString &fileName)
+{
+    QFile f(fileName);
+    if (Q_UNLIKELY(!f.open(QIODevice::ReadOnly))) {
+        qWarning("Failed to open traffic archive %s: %s", qUtf8Printable(fileName), qUtf8Printable(f.errorString()));
+        return false;
+    }
+
+    QDataStream stream(&f);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (Q_UNLIKELY((magic != TrafficRecord::magic) || (version != TrafficRecord::version))) {
+        qWarning("%s is not a supported traffic archive.", qUtf8Printable(fileName));
+        return false;
+    }
+
+    QVector<TrafficRecord> records;
+    QHash<QString, QVector<int>> exact;
+    QHash<QString, QVector<int>> byPath;
+
+    while (!stream.atEnd()) {
+        TrafficRecord r;
+        stream >> r;
+        if (Q_UNLIKELY(stream.status() != QDataStream::Ok)) {
+            qWarning("Failed to read record %i of traffic archive %s.", records.size() + 1, qUtf8Printable(fileName));
+            return false;
+        }
+        const QString key = r.method + QLatin1Char(' ') + r.route;
+        const int q = key.indexOf(QLatin1Char('?'));
+        exact[key].append(records.size());
+        byPath[(q < 0) ? key : key.left(q)].append(records.size());
+        records.append(r);
+    }
+
+    Q_D(ReplayNamFactory);
+    QMutexLocker locker(&d->mutex);
+    d->records = records;
+    d->exact = exact;
+    d->byPath = byPath;
+    d->exactPositions.clear();
+    d->pathPositions.clear();
+    d->unmatched = 0;
+
+    qDebug("Loaded %i records from traffic archive %s.", records.size(), qUtf8Printable(fileName));
+
+    return true;
+}
+
+
+int ReplayNamFactory::count() const
+{
+    Q_D(const ReplayNamFactory);
+    QMutexLocker locker(&d->mutex);
+    return d->records.size();
+}
+
+
+int ReplayNamFactory::unmatched() const
+{
+    Q_D(const ReplayNamFactory);
+    QMutexLocker locker(&d->mutex);
+    return d->unmatched;
+}
+
+
+void ReplayNamFactory::rewind()
+{
+    Q_D(ReplayNamFactory);
+    QMutexLocker locker(&d->mutex);
+    d->exactPositions.clear();
+    d->pathPositions.clear();
+    d->unmatched = 0;
+}
+
+
+QNetworkAccessManager *ReplayNamFactory::create(QObject *parent)
+{
+    Q_D(ReplayNamFactory);
+    return new ReplayNetworkAccessManager(d, parent);
+}
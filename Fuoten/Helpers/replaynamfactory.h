@@ -0,0 +1,105 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENREPLAYNAMFACTORY_H
+#define FUOTENREPLAYNAMFACTORY_H
+
+#include <QString>
+#include <QScopedPointer>
+#include "abstractnamfactory.h"
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+class ReplayNamFactoryPrivate;
+
+/*!
+ * \brief Network access manager factory that answers requests with replies recorded by TrafficRecorder.
+ *
+ * The created QNetworkAccessManager objects do not access the network, they return the recorded reply
+ * for every request. Requests are matched by HTTP method and API route including the URL query. If there
+ * is no recorded reply with the same query, the replies for the same route are used, so requests whose
+ * query depends on the time of the last synchronization can be replayed, too. Replies with the same key
+ * are returned in the recorded order, after the last one has been used, it will be returned again.
+ * Requests without a recorded reply are answered with HTTP status \c 404.
+ *
+ * As the replies are delivered without network latency, a replayed synchronization mostly measures the
+ * JSON decoding, the storage and the models and is deterministic, as long as the same archive is used.
+ *
+ * \code{.cpp}
+ * ReplayNamFactory *replay = new ReplayNamFactory;
+ * if (replay->load(QStringLiteral("/tmp/sync.fuotentraffic"))) {
+ *     Component::setNetworkAccessManagerFactory(replay);
+ * }
+ * \endcode
+ *
+ * All functions are thread-safe.
+ *
+ * \headerfile "" <Fuoten/Helpers/ReplayNamFactory>
+ */
+class FUOTENSHARED_EXPORT ReplayNamFactory : public AbstractNamFactory
+{
+public:
+    /*!
+     * \brief Constructs a new ReplayNamFactory without recorded replies.
+     */
+    ReplayNamFactory();
+
+    /*!
+     * \brief Destroys the ReplayNamFactory.
+     *
+     * The factory has to outlive all network access managers it created.
+     */
+    ~ReplayNamFactory() override;
+
+    /*!
+     * \brief Loads the archive \a fileName written by TrafficRecorder.
+     *
+     * Replaces the currently loaded replies and returns \c false if the file could not be read.
+     */
+    bool load(const QString &fileName);
+
+    /*!
+     * \brief Returns the number of loaded replies.
+     */
+    int count() const;
+
+    /*!
+     * \brief Returns the number of requests that have been answered with \c 404 because of a missing reply.
+     */
+    int unmatched() const;
+
+    /*!
+     * \brief Starts to return the replies from the beginning again, for example to replay the archive a second time.
+     */
+    void rewind();
+
+    /*!
+     * \brief Creates a network access manager that returns the recorded replies.
+     */
+    QNetworkAccessManager *create(QObject *parent) override;
+
+private:
+    const QScopedPointer<ReplayNamFactoryPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(ReplayNamFactory)
+};
+
+}
+
+#endif // FUOTENREPLAYNAMFACTORY_H
@@ -0,0 +1,121 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENREPLAYNAMFACTORY_P_H
+#define FUOTENREPLAYNAMFACTORY_P_H
+
+#include "replaynamfactory.h"
+#include "trafficarchive_p.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+
+namespace Fuoten {
+
+class ReplayNamFactoryPrivate
+{
+public:
+    /*
+     * Returns the index of the next record in the list identified by key and
+     * advances the position of the list. Returns -1 if there is no list.
+     */
+    static int take(const QHash<QString, QVector<int>> &lists, QHash<QString, int> &positions, const QString &key)
+    {
+        const auto it = lists.constFind(key);
+        if (it == lists.constEnd()) {
+            return -1;
+        }
+        int &pos = positions[key];
+        const int idx = it.value().at(qMin(pos, it.value().size() - 1));
+        pos++;
+        return idx;
+    }
+
+    /*
+     * Copies the record that answers a request with the given method and
+     * route to record. Returns false if there is none.
+     */
+    bool find(const QString &method, const QString &route, TrafficRecord *record)
+    {
+        QMutexLocker locker(&mutex);
+        const QString key = method + QLatin1Char(' ') + route;
+        int idx = take(exact, exactPositions, key);
+        if (idx < 0) {
+            const int q = key.indexOf(QLatin1Char('?'));
+            idx = take(byPath, pathPositions, (q < 0) ? key : key.left(q));
+        }
+        if (idx < 0) {
+            unmatched++;
+            return false;
+        }
+        *record = records.at(idx);
+        return true;
+    }
+
+    QVector<TrafficRecord> records;
+    QHash<QString, QVector<int>> exact;
+    QHash<QString, QVector<int>> byPath;
+    QHash<QString, int> exactPositions;
+    QHash<QString, int> pathPositions;
+    mutable QMutex mutex;
+    int unmatched = 0;
+};
+
+
+/*
+ * Reply that delivers a recorded response in the next event loop iteration.
+ */
+class ReplayReply : public QNetworkReply
+{
+public:
+    ReplayReply(QNetworkAccessManager::Operation op, const QNetworkRequest &request, const TrafficRecord *record, QObject *parent = nullptr);
+
+    void abort() override;
+    qint64 bytesAvailable() const override;
+    bool isSequential() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+
+private:
+    void deliver();
+
+    QByteArray m_data;
+    qint64 m_pos = 0;
+};
+
+
+class ReplayNetworkAccessManager : public QNetworkAccessManager
+{
+public:
+    ReplayNetworkAccessManager(ReplayNamFactoryPrivate *factory, QObject *parent = nullptr);
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData = nullptr) override;
+
+private:
+    ReplayNamFactoryPrivate *m_factory;
+};
+
+}
+
+#endif // FUOTENREPLAYNAMFACTORY_P_H
@@ -0,0 +1,263 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "requestcoalescer_p.h"
+#include "../API/component.h"
+#include "../API/markmultipleitems.h"
+#include "../API/starmultipleitems.h"
+#include "../error.h"
+
+using namespace Fuoten;
+
+namespace {
+
+struct MarkBatch {
+    IdList itemIds;
+    QHash<qint64, QPointer<Article>> articles;
+};
+
+struct StarBatch {
+    QList<QPair<qint64,QString>> items;
+    QHash<QPair<qint64,QString>, QPointer<Article>> articles;
+};
+
+}
+
+
+RequestCoalescer::RequestCoalescer(QObject *parent) :
+    QObject(parent), d_ptr(new RequestCoalescerPrivate)
+{
+    Q_D(RequestCoalescer);
+    d->timer.setSingleShot(true);
+    d->timer.setInterval(500);
+    connect(&d->timer, &QTimer::timeout, this, &RequestCoalescer::flush);
+}
+
+
+RequestCoalescer::~RequestCoalescer()
+{
+    flush();
+}
+
+
+int RequestCoalescer::window() const { Q_D(const RequestCoalescer); return d->timer.interval(); }
+
+void RequestCoalescer::setWindow(int window)
+{
+    Q_D(RequestCoalescer);
+    if (window != d->timer.interval()) {
+        d->timer.setInterval(window);
+        qDebug("Changed window to %i.", window);
+        Q_EMIT windowChanged(window);
+    }
+}
+
+
+int RequestCoalescer::pending() const { Q_D(const RequestCoalescer); return d->pending(); }
+
+
+void RequestCoalescer::mark(Article *article, bool unread, AbstractConfiguration *config, AbstractStorage *storage)
+{
+    Q_ASSERT_X(article, "coalesce mark article", "invalid article");
+
+    Q_D(RequestCoalescer);
+
+    RequestCoalescerPrivate::Action a;
+    a.value = unread;
+    a.original = article->unread() ? 1 : 0;
+    a.article = article;
+    a.config = config ? config : Component::defaultConfiguration();
+    a.storage = storage ? storage : Component::defaultStorage();
+
+    if (!RequestCoalescerPrivate::add(d->marks, article->id(), a)) {
+        qDebug("Opposing mark actions for item %lli cancelled out.", article->id());
+    }
+
+    if (!d->timer.isActive()) {
+        d->timer.start();
+    }
+
+    Q_EMIT pendingChanged(pending());
+}
+
+
+void RequestCoalescer::markItem(qint64 itemId, bool unread, AbstractConfiguration *config, AbstractStorage *storage)
+{
+    Q_D(RequestCoalescer);
+
+    RequestCoalescerPrivate::Action a;
+    a.value = unread;
+    a.config = config ? config : Component::defaultConfiguration();
+    a.storage = storage ? storage : Component::defaultStorage();
+
+    RequestCoalescerPrivate::add(d->marks, itemId, a);
+
+    if (!d->timer.isActive()) {
+        d->timer.start();
+    }
+
+    Q_EMIT pendingChanged(pending());
+}
+
+
+void RequestCoalescer::star(Article *article, bool starred, AbstractConfiguration *config, AbstractStorage *storage)
+{
+    Q_ASSERT_X(article, "coalesce star article", "invalid article");
+
+    Q_D(RequestCoalescer);
+
+    RequestCoalescerPrivate::Action a;
+    a.value = starred;
+    a.original = article->starred() ? 1 : 0;
+    a.article = article;
+    a.config = config ? config : Component::defaultConfiguration();
+    a.storage = storage ? storage : Component::defaultStorage();
+
+    if (!RequestCoalescerPrivate::add(d->stars, qMakePair(article->feedId(), article->guidHash()), a)) {
+        qDebug("Opposing star actions for item %lli cancelled out.", article->id());
+    }
+
+    if (!d->timer.isActive()) {
+        d->timer.start();
+    }
+
+    Q_EMIT pendingChanged(pending());
+}
+
+
+void RequestCoalescer::starItem(qint64 feedId, const QString &guidHash, bool starred, AbstractConfiguration *config, AbstractStorage *storage)
+{
+    Q_D(RequestCoalescer);
+
+    RequestCoalescerPrivate::Action a;
+    a.value = starred;
+    a.config = config ? config : Component::defaultConfiguration();
+    a.storage = storage ? storage : Component::defaultStorage();
+
+    RequestCoalescerPrivate::add(d->stars, qMakePair(feedId, guidHash), a);
+
+    if (!d->timer.isActive()) {
+        d->timer.start();
+    }
+
+    Q_EMIT pendingChanged(pending());
+}
+
+
+void RequestCoalescer::flush()
+{
+    Q_D(RequestCoalescer);
+
+    d->timer.stop();
+
+    if (d->pending() == 0) {
+        return;
+    }
+
+    qDebug("Flushing %i mark and %i star actions.", d->marks.size(), d->stars.size());
+
+    QHash<QPair<RequestCoalescerPrivate::GroupKey,bool>, MarkBatch> markBatches;
+    for (auto it = d->marks.constBegin(); it != d->marks.constEnd(); ++it) {
+        const RequestCoalescerPrivate::Action &a = it.value();
+        MarkBatch &b = markBatches[qMakePair(qMakePair(a.config, a.storage), a.value)];
+        b.itemIds.append(it.key());
+        if (a.article) {
+            b.articles.insert(it.key(), a.article);
+        }
+    }
+    d->marks.clear();
+
+    QHash<QPair<RequestCoalescerPrivate::GroupKey,bool>, StarBatch> starBatches;
+    for (auto it = d->stars.constBegin(); it != d->stars.constEnd(); ++it) {
+        const RequestCoalescerPrivate::Action &a = it.value();
+        StarBatch &b = starBatches[qMakePair(qMakePair(a.config, a.storage), a.value)];
+        b.items.append(it.key());
+        if (a.article) {
+            b.articles.insert(it.key(), a.article);
+        }
+    }
+    d->stars.clear();
+
+    Q_EMIT pendingChanged(0);
+
+    for (auto it = markBatches.constBegin(); it != markBatches.constEnd(); ++it) {
+        const bool unread = it.key().second;
+        const MarkBatch batch = it.value();
+
+        MarkMultipleItems *mmi = new MarkMultipleItems(batch.itemIds, unread);
+        mmi->setConfiguration(it.key().first.first);
+        mmi->setStorage(it.key().first.second);
+        mmi->setPriority(Component::InteractivePriority);
+        connect(mmi, &MarkMultipleItems::succeeded, this, [this, batch, unread] () {
+            for (qint64 id : batch.itemIds) {
+                Article *a = batch.articles.value(id);
+                if (a) {
+                    a->setUnread(unread);
+                }
+                Q_EMIT itemMarked(id, unread);
+            }
+        });
+        connect(mmi, &Component::failed, this, [this, batch, unread] (Error *e) {
+            for (qint64 id : batch.itemIds) {
+                Article *a = batch.articles.value(id);
+                if (a) {
+                    a->setError(e);
+                }
+                Q_EMIT markFailed(id, unread, e);
+            }
+        });
+        connect(mmi, &MarkMultipleItems::succeeded, mmi, &QObject::deleteLater);
+        connect(mmi, &Component::failed, mmi, &QObject::deleteLater);
+        mmi->execute();
+    }
+
+    for (auto it = starBatches.constBegin(); it != starBatches.constEnd(); ++it) {
+        const bool starred = it.key().second;
+        const StarBatch batch = it.value();
+
+        StarMultipleItems *smi = new StarMultipleItems(starred);
+        smi->setItemsToStar(batch.items);
+        smi->setConfiguration(it.key().first.first);
+        smi->setStorage(it.key().first.second);
+        smi->setPriority(Component::InteractivePriority);
+        connect(smi, &StarMultipleItems::succeeded, this, [this, batch, starred] () {
+            for (const QPair<qint64,QString> &i : batch.items) {
+                Article *a = batch.articles.value(i);
+                if (a) {
+                    a->setStarred(starred);
+                }
+                Q_EMIT itemStarred(i.first, i.second, starred);
+            }
+        });
+        connect(smi, &Component::failed, this, [this, batch, starred] (Error *e) {
+            for (const QPair<qint64,QString> &i : batch.items) {
+                Article *a = batch.articles.value(i);
+                if (a) {
+                    a->setError(e);
+                }
+                Q_EMIT starFailed(i.first, i.second, starred, e);
+            }
+        });
+        connect(smi, &StarMultipleItems::succeeded, smi, &QObject::deleteLater);
+        connect(smi, &Component::failed, smi, &QObject::deleteLater);
+        smi->execute();
+    }
+}
+
+#include "moc_requestcoalescer.cpp"
@@ -0,0 +1,190 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENREQUESTCOALESCER_H
+#define FUOTENREQUESTCOALESCER_H
+
+#include <QObject>
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+class RequestCoalescerPrivate;
+class Article;
+class Error;
+class AbstractConfiguration;
+class AbstractStorage;
+
+/*!
+ * \brief Collects single mark and star actions and sends them as multi item requests.
+ *
+ * Marking or starring articles one by one creates a MarkItem or StarItem request per article. When a user
+ * skims through a list of articles, this can result in dozens of small requests in a few seconds. The
+ * RequestCoalescer collects these actions for the duration of the \link RequestCoalescer::window window \endlink
+ * and sends them afterwards via MarkMultipleItems and StarMultipleItems. Actions for the same item replace
+ * each other, so only the last requested state is sent. If the last requested state of an Article equals
+ * the state it had when the first action was added, the actions cancel each other out and nothing will be sent.
+ *
+ * Actions are grouped by their AbstractConfiguration and AbstractStorage, so every combination results in its
+ * own requests. After a request succeeded, itemMarked() or itemStarred() is emitted for every item in the request
+ * and the state of the Article objects that are still alive is updated. If a request failed, markFailed() or
+ * starFailed() is emitted for every item and the error is set to the Article objects.
+ *
+ * If set via Component::setDefaultCoalescer(), Article::mark() and Article::star() will use the coalescer instead
+ * of sending single requests if the action should not be enqueued.
+ *
+ * \headerfile "" <Fuoten/Helpers/RequestCoalescer>
+ */
+class FUOTENSHARED_EXPORT RequestCoalescer : public QObject
+{
+    Q_OBJECT
+    /*!
+     * \brief Time in milliseconds collected actions are held back before they are sent.
+     *
+     * The window starts with the first action added after the last flush. The default value is \c 500.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>window() const</TD></TR><TR><TD>void</TD><TD>setWindow(int window)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>windowChanged(int window)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int window READ window WRITE setWindow NOTIFY windowChanged)
+    /*!
+     * \brief Number of mark and star actions that are currently waiting to be sent.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>pending() const</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>pendingChanged(int pending)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int pending READ pending NOTIFY pendingChanged)
+public:
+    /*!
+     * \brief Constructs a new RequestCoalescer object with the given \a parent.
+     */
+    explicit RequestCoalescer(QObject *parent = nullptr);
+
+    /*!
+     * \brief Destroys the RequestCoalescer object.
+     *
+     * Actions that are still pending will be sent before.
+     */
+    ~RequestCoalescer();
+
+    /*!
+     * \brief Getter function for the \link RequestCoalescer::window window \endlink property.
+     * \sa setWindow(), windowChanged()
+     */
+    int window() const;
+
+    /*!
+     * \brief Setter function for the \link RequestCoalescer::window window \endlink property.
+     * Emits the windowChanged() signal if \a window is not equal to the stored value.
+     * \sa window(), windowChanged()
+     */
+    void setWindow(int window);
+
+    /*!
+     * \brief Getter function for the \link RequestCoalescer::pending pending \endlink property.
+     * \sa pendingChanged()
+     */
+    int pending() const;
+
+    /*!
+     * \brief Adds an action to mark the \a article as \a unread or read.
+     *
+     * The state of the \a article will be updated after the request succeeded. If \a config is a \c nullptr,
+     * Component::defaultConfiguration() will be used, if \a storage is a \c nullptr, Component::defaultStorage()
+     * will be used.
+     */
+    Q_INVOKABLE void mark(Fuoten::Article *article, bool unread, Fuoten::AbstractConfiguration *config = nullptr, Fuoten::AbstractStorage *storage = nullptr);
+
+    /*!
+     * \brief Adds an action to mark the item identified by \a itemId as \a unread or read.
+     *
+     * As the current state of the item is unknown, an opposing action for the same item will replace this one
+     * instead of cancelling it out.
+     */
+    Q_INVOKABLE void markItem(qint64 itemId, bool unread, Fuoten::AbstractConfiguration *config = nullptr, Fuoten::AbstractStorage *storage = nullptr);
+
+    /*!
+     * \brief Adds an action to mark the \a article as \a starred or unstarred.
+     *
+     * The state of the \a article will be updated after the request succeeded.
+     */
+    Q_INVOKABLE void star(Fuoten::Article *article, bool starred, Fuoten::AbstractConfiguration *config = nullptr, Fuoten::AbstractStorage *storage = nullptr);
+
+    /*!
+     * \brief Adds an action to mark the item identified by \a feedId and \a guidHash as \a starred or unstarred.
+     *
+     * As the current state of the item is unknown, an opposing action for the same item will replace this one
+     * instead of cancelling it out.
+     */
+    Q_INVOKABLE void starItem(qint64 feedId, const QString &guidHash, bool starred, Fuoten::AbstractConfiguration *config = nullptr, Fuoten::AbstractStorage *storage = nullptr);
+
+public Q_SLOTS:
+    /*!
+     * \brief Sends all pending actions immediately.
+     */
+    void flush();
+
+Q_SIGNALS:
+    /*!
+     * \brief This is emitted if the value of the \link RequestCoalescer::window window \endlink property changes.
+     * \sa window(), setWindow()
+     */
+    void windowChanged(int window);
+
+    /*!
+     * \brief This is emitted if the value of the \link RequestCoalescer::pending pending \endlink property changes.
+     * \sa pending()
+     */
+    void pendingChanged(int pending);
+
+    /*!
+     * \brief This is emitted for every item of a successful request to mark items.
+     */
+    void itemMarked(qint64 itemId, bool unread);
+
+    /*!
+     * \brief This is emitted for every item of a successful request to star items.
+     */
+    void itemStarred(qint64 feedId, const QString &guidHash, bool starred);
+
+    /*!
+     * \brief This is emitted for every item of a failed request to mark items.
+     */
+    void markFailed(qint64 itemId, bool unread, Fuoten::Error *error);
+
+    /*!
+     * \brief This is emitted for every item of a failed request to star items.
+     */
+    void starFailed(qint64 feedId, const QString &guidHash, bool starred, Fuoten::Error *error);
+
+protected:
+    const QScopedPointer<RequestCoalescerPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(RequestCoalescer)
+    Q_DECLARE_PRIVATE(RequestCoalescer)
+};
+
+}
+
+#endif // FUOTENREQUESTCOALESCER_H
@@ -0,0 +1,90 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENREQUESTCOALESCER_P_H
+#define FUOTENREQUESTCOALESCER_P_H
+
+#include "requestcoalescer.h"
+#include "../article.h"
+#include <QTimer>
+#include <QHash>
+#include <QPair>
+#include <QPointer>
+
+namespace Fuoten {
+
+class RequestCoalescerPrivate
+{
+public:
+    /*
+     * A pending action. original is the state of the item when the first action
+     * was added, -1 if it is unknown because no Article object was given.
+     */
+    struct Action {
+        bool value = false;
+        int original = -1;
+        QPointer<Article> article;
+        AbstractConfiguration *config = nullptr;
+        AbstractStorage *storage = nullptr;
+    };
+
+    typedef QPair<qint64, QString> StarKey;
+    typedef QPair<AbstractConfiguration*, AbstractStorage*> GroupKey;
+
+    RequestCoalescerPrivate() {}
+
+    ~RequestCoalescerPrivate() {}
+
+    /*
+     * Adds the action to the table. Returns false if it cancelled out a
+     * pending action for the same key.
+     */
+    template<typename Key>
+    static bool add(QHash<Key, Action> &table, const Key &key, const Action &action)
+    {
+        auto it = table.find(key);
+        if (it == table.end()) {
+            table.insert(key, action);
+            return true;
+        }
+
+        if ((it.value().original > -1) && (it.value().original == static_cast<int>(action.value))) {
+            table.erase(it);
+            return false;
+        }
+
+        it.value().value = action.value;
+        it.value().config = action.config;
+        it.value().storage = action.storage;
+        if (action.article) {
+            it.value().article = action.article;
+        }
+        return true;
+    }
+
+    int pending() const { return marks.size() + stars.size(); }
+
+    QTimer timer;
+    QHash<qint64, Action> marks;
+    QHash<StarKey, Action> stars;
+};
+
+}
+
+#endif // FUOTENREQUESTCOALESCER_P_H
@@ -66,6 +66,7 @@ void Synchronizer::start()
     d->setInOperation(true);
 
     d->startTime = QDateTime::currentDateTime();
+    d->traceBegin = Tracer::isEnabled() ? Tracer::timestamp() : -1;
 
     if (!d->configuration) {
         setConfiguration(Component::defaultConfiguration());
@@ -81,7 +82,12 @@ void Synchronizer::start()
 
     setError(nullptr);
 
-    d->totalActions = d->configuration->getLastSync().isValid() ? 4 : 5;
+    d->loadCheckpoint();
+
+    d->plannedStages = SynchronizerPrivate::stageBit(SynchronizerPrivate::Folders) | SynchronizerPrivate::stageBit(SynchronizerPrivate::Feeds) | SynchronizerPrivate::stageBit(SynchronizerPrivate::Items);
+    if (!d->configuration->getLastSync().isValid()) {
+        d->plannedStages |= SynchronizerPrivate::stageBit(SynchronizerPrivate::Starred);
+    }
 
     if (d->storage) {
         QueryArgs qa;
@@ -99,9 +105,11 @@ void Synchronizer::start()
                 }
                 if (a->queue().testFlag(FuotenEnums::Star)) {
                     d->queuedStarredArticles.append(qMakePair(a->feedId(), a->guidHash()));
+                    d->queuedStarredIds.append(a->id());
                 }
                 if (a->queue().testFlag(FuotenEnums::Unstar)) {
                     d->queuedUnstarredArticles.append(qMakePair(a->feedId(), a->guidHash()));
+                    d->queuedUnstarredIds.append(a->id());
                 }
             }
 
@@ -109,42 +117,37 @@ void Synchronizer::start()
 
             if (!d->queuedUnreadArticles.empty()) {
                 qDebug("Found %i articles queued as unread.", d->queuedUnreadArticles.size());
-                d->totalActions++;
+                d->plannedStages |= SynchronizerPrivate::stageBit(SynchronizerPrivate::UploadUnread);
             }
 
             if (!d->queuedReadArticles.empty()) {
                 qDebug("Found %i articles queued as read.", d->queuedReadArticles.size());
-                d->totalActions++;
+                d->plannedStages |= SynchronizerPrivate::stageBit(SynchronizerPrivate::UploadRead);
             }
 
             if (!d->queuedStarredArticles.empty()) {
                 qDebug("Found %i articles queued as starred.", d->queuedStarredArticles.size());
-                d->totalActions++;
+                d->plannedStages |= SynchronizerPrivate::stageBit(SynchronizerPrivate::UploadStarred);
             }
 
             if (!d->queuedUnstarredArticles.empty()) {
                 qDebug("Found %i articles queue as unstarred.", d->queuedUnstarredArticles.size());
-                d->totalActions++;
-            }
-
-            if (!d->queuedUnreadArticles.isEmpty()) {
-                notifyAboutUnread();
-            } else if (!d->queuedReadArticles.isEmpty()) {
-                notifyAboutRead();
-            } else if (!d->queuedStarredArticles.isEmpty()) {
-                notifyAboutStarred();
-            } else if (!d->queuedUnstarredArticles.isEmpty()) {
-                notifyAboutUnstarred();
-            } else {
-                requestFolders();
+                d->plannedStages |= SynchronizerPrivate::stageBit(SynchronizerPrivate::UploadUnstarred);
             }
+        }
+    }
 
-        } else {
-            requestFolders();
+    // one action per stage and one for finishing the synchronization
+    d->totalActions = 1;
+    for (quint8 s = 0; s < SynchronizerPrivate::StageCount; ++s) {
+        if (d->plannedStages & SynchronizerPrivate::stageBit(static_cast<SynchronizerPrivate::Stage>(s))) {
+            d->totalActions++;
         }
-    } else {
-        requestFolders();
     }
+
+    qDebug("Running %i synchronization steps with up to %i in parallel.", static_cast<int>(d->totalActions) - 1, d->maxParallelStages);
+
+    d->scheduleStages();
 }
 
 
@@ -189,28 +192,12 @@ void Synchronizer::setError(Error *nError)
 void Synchronizer::notifyAboutUnread()
 {
     Q_D(Synchronizer);
-    if (!d->unreadMultipleItems) {
+    if (!d->remainingChunks.contains(SynchronizerPrivate::UploadUnread)) {
         setProgress(++d->performedActions/d->totalActions);
         //% "Synchronizing unread articles"
         setCurrentAction(qtTrId("libfuoten-sync-unread-articles"));
 
-        d->unreadMultipleItems = new MarkMultipleItems(this);
-        d->unreadMultipleItems->setConfiguration(d->configuration);
-        d->unreadMultipleItems->setItemIds(d->queuedUnreadArticles);
-        d->unreadMultipleItems->setUnread(true);
-        d->unreadMultipleItems->setUseStorage(false);
-        d->unreadMultipleItems->setNotificator(notificator());
-        QObject::connect(d->unreadMultipleItems, &Component::failed, this, &Synchronizer::setError);
-        if (!d->queuedReadArticles.isEmpty()) {
-            QObject::connect(d->unreadMultipleItems, &MarkMultipleItems::succeeded, this, &Synchronizer::notifyAboutRead);
-        } else if (!d->queuedStarredArticles.isEmpty()) {
-            QObject::connect(d->unreadMultipleItems, &MarkMultipleItems::succeeded, this, &Synchronizer::notifyAboutStarred);
-        } else if (!d->queuedUnstarredArticles.isEmpty()) {
-            QObject::connect(d->unreadMultipleItems, &MarkMultipleItems::succeeded, this, &Synchronizer::notifyAboutUnstarred);
-        } else {
-            QObject::connect(d->unreadMultipleItems, &MarkMultipleItems::succeeded, this, &Synchronizer::requestFolders);
-        }
-        d->unreadMultipleItems->execute();
+        d->enqueueUpload(SynchronizerPrivate::UploadUnread, d->queuedUnreadArticles);
     }
 }
 
@@ -218,26 +205,12 @@ void Synchronizer::notifyAboutUnread()
 void Synchronizer::notifyAboutRead()
 {
     Q_D(Synchronizer);
-    if (!d->readMultipleItems) {
+    if (!d->remainingChunks.contains(SynchronizerPrivate::UploadRead)) {
         setProgress(++d->performedActions/d->totalActions);
         //% "Synchronizing read articles"
         setCurrentAction(qtTrId("libfuoten-sync-read-articles"));
 
-        d->readMultipleItems = new MarkMultipleItems(this);
-        d->readMultipleItems->setConfiguration(d->configuration);
-        d->readMultipleItems->setItemIds(d->queuedReadArticles);
-        d->readMultipleItems->setUnread(false);
-        d->readMultipleItems->setUseStorage(false);
-        d->readMultipleItems->setNotificator(notificator());
-        QObject::connect(d->readMultipleItems, &Component::failed, this, &Synchronizer::setError);
-        if (!d->queuedStarredArticles.isEmpty()) {
-            QObject::connect(d->readMultipleItems, &MarkMultipleItems::succeeded, this, &Synchronizer::notifyAboutStarred);
-        } else if (!d->queuedUnstarredArticles.isEmpty()) {
-            QObject::connect(d->readMultipleItems, &MarkMultipleItems::succeeded, this, &Synchronizer::notifyAboutUnstarred);
-        } else {
-            QObject::connect(d->readMultipleItems, &MarkMultipleItems::succeeded, this, &Synchronizer::requestFolders);
-        }
-        d->readMultipleItems->execute();
+        d->enqueueUpload(SynchronizerPrivate::UploadRead, d->queuedReadArticles);
     }
 }
 
@@ -245,24 +218,12 @@ void Synchronizer::notifyAboutRead()
 void Synchronizer::notifyAboutStarred()
 {
     Q_D(Synchronizer);
-    if (!d->starMultipleItems) {
+    if (!d->remainingChunks.contains(SynchronizerPrivate::UploadStarred)) {
         setProgress(++d->performedActions/d->totalActions);
         //% "Synchronizing starred articles"
         setCurrentAction(qtTrId("libfuoten-sync-starred-articles"));
 
-        d->starMultipleItems = new StarMultipleItems(this);
-        d->starMultipleItems->setConfiguration(d->configuration);
-        d->starMultipleItems->setItemsToStar(d->queuedStarredArticles);
-        d->starMultipleItems->setStarred(true);
-        d->starMultipleItems->setUseStorage(false);
-        d->starMultipleItems->setNotificator(notificator());
-        QObject::connect(d->starMultipleItems, &Component::failed, this, &Synchronizer::setError);
-        if (!d->queuedUnstarredArticles.isEmpty()) {
-            QObject::connect(d->starMultipleItems, &StarMultipleItems::succeeded, this, &Synchronizer::notifyAboutUnstarred);
-        } else {
-            QObject::connect(d->starMultipleItems, &StarMultipleItems::succeeded, this, &Synchronizer::requestFolders);
-        }
-        d->starMultipleItems->execute();
+        d->enqueueUpload(SynchronizerPrivate::UploadStarred, d->queuedStarredIds, d->queuedStarredArticles);
     }
 }
 
@@ -270,20 +231,12 @@ void Synchronizer::notifyAboutStarred()
 void Synchronizer::notifyAboutUnstarred()
 {
     Q_D(Synchronizer);
-    if (!d->unstarMultipleItems) {
+    if (!d->remainingChunks.contains(SynchronizerPrivate::UploadUnstarred)) {
         setProgress(++d->performedActions/d->totalActions);
         //% "Synchronizing unstarred articles"
         setCurrentAction(qtTrId("libfuoten-sync-unstarred-articles"));
 
-        d->unstarMultipleItems = new StarMultipleItems(this);
-        d->unstarMultipleItems->setConfiguration(d->configuration);
-        d->unstarMultipleItems->setItemsToStar(d->queuedUnstarredArticles);
-        d->unstarMultipleItems->setStarred(false);
-        d->unstarMultipleItems->setUseStorage(false);
-        d->unstarMultipleItems->setNotificator(notificator());
-        QObject::connect(d->unstarMultipleItems, &Component::failed, this, &Synchronizer::setError);
-        QObject::connect(d->unstarMultipleItems, &StarMultipleItems::succeeded, this, &Synchronizer::requestFolders);
-        d->unstarMultipleItems->execute();
+        d->enqueueUpload(SynchronizerPrivate::UploadUnstarred, d->queuedUnstarredIds, d->queuedUnstarredArticles);
     }
 }
 
@@ -291,6 +244,8 @@ void Synchronizer::notifyAboutUnstarred()
 void Synchronizer::requestFolders()
 {
     Q_D(Synchronizer);
+    // folders and feeds are requested again when resuming from a checkpoint, otherwise the items of
+    // feeds added on the server could not be stored; unchanged replies are skipped without processing
     if (!d->getFolders) {
         setProgress(++d->performedActions/d->totalActions);
         //% "Requesting folders"
@@ -299,12 +254,19 @@ void Synchronizer::requestFolders()
         d->getFolders = new GetFolders(this);
         d->getFolders->setConfiguration(d->configuration);
         d->getFolders->setStorage(d->storage);
+        d->getFolders->setPriority(Component::BulkPriority);
         d->getFolders->setNotificator(notificator());
         QObject::connect(d->getFolders, &Component::failed, this, &Synchronizer::setError);
+        auto foldersFinished = [d] () {
+            d->stageFinished(SynchronizerPrivate::Folders);
+        };
         if (d->storage) {
-            QObject::connect(d->storage, &AbstractStorage::requestedFolders, this, &Synchronizer::requestFeeds);
+            // folders rarely change, so an unchanged reply does not have to be processed by the storage
+            d->getFolders->setSkipUnchanged(true);
+            QObject::connect(d->getFolders, &Component::replyUnchanged, this, foldersFinished);
+            QObject::connect(d->storage, &AbstractStorage::requestedFolders, this, foldersFinished);
         } else {
-            QObject::connect(d->getFolders, &Component::succeeded, this, &Synchronizer::requestFeeds);
+            QObject::connect(d->getFolders, &Component::processed, this, foldersFinished);
         }
         d->getFolders->execute();
     }
@@ -314,35 +276,27 @@ void Synchronizer::requestFolders()
 void Synchronizer::requestFeeds()
 {
     Q_D(Synchronizer);
+    // not part of the checkpoint, see requestFolders()
     if (!d->getFeeds) {
         setProgress(++d->performedActions/d->totalActions);
         //% "Requesting feeds"
         setCurrentAction(qtTrId("libfuoten-sync-feeds"));
 
-#ifndef QT_NO_DEBUG_OUTPUT
-        if (d->configuration->getLastSync().isValid()) {
-            qDebug() << "We have a valid last sync time. Calling GetUpdatedItems after receiving feeds.";
-        } else {
-            qDebug() << "We have no valid last sync time. Calling GetItems after receiving feeds.";
-        }
-#endif
         d->getFeeds = new GetFeeds(this);
         d->getFeeds->setConfiguration(d->configuration);
         d->getFeeds->setStorage(d->storage);
+        d->getFeeds->setPriority(Component::BulkPriority);
         d->getFeeds->setNotificator(notificator());
         QObject::connect(d->getFeeds, &Component::failed, this, &Synchronizer::setError);
+        auto feedsFinished = [d] () {
+            d->stageFinished(SynchronizerPrivate::Feeds);
+        };
         if (d->storage) {
-            if (d->configuration->getLastSync().isValid()) {
-                QObject::connect(d->storage, &AbstractStorage::requestedFeeds, this, &Synchronizer::requestUpdated);
-            } else {
-                QObject::connect(d->storage, &AbstractStorage::requestedFeeds, this, &Synchronizer::requestUnread);
-            }
+            d->getFeeds->setSkipUnchanged(true);
+            QObject::connect(d->getFeeds, &Component::replyUnchanged, this, feedsFinished);
+            QObject::connect(d->storage, &AbstractStorage::requestedFeeds, this, feedsFinished);
         } else {
-            if (d->configuration->getLastSync().isValid()) {
-                QObject::connect(d->getFeeds, &Component::succeeded, this, &Synchronizer::requestUpdated);
-            } else {
-                QObject::connect(d->getFeeds, &Component::succeeded, this, &Synchronizer::requestUnread);
-            }
+            QObject::connect(d->getFeeds, &Component::processed, this, feedsFinished);
         }
         d->getFeeds->execute();
     }
@@ -352,25 +306,50 @@ void Synchronizer::requestFeeds()
 void Synchronizer::requestUnread()
 {
     Q_D(Synchronizer);
-    if (!d->getUnread) {
+    if (d->stageCompleted(QStringLiteral("unread"))) {
+        qDebug("%s", "Unread articles have already been synchronized.");
+        setProgress(++d->performedActions/d->totalActions);
+        d->stageFinished(SynchronizerPrivate::Items);
+        return;
+    }
+
+    if (!d->getUnread && d->unreadPages.isEmpty()) {
         setProgress(++d->performedActions/d->totalActions);
         //% "Requesting unread articles"
         setCurrentAction(qtTrId("libfuoten-sync-req-articles"));
 
+        d->connectItemsStored();
+
+        if (d->pageSize > 0) {
+            qDebug("Requesting unread articles in pages of %i articles with up to %i pages in flight.", d->pageSize, d->maxPagesInFlight);
+            if (d->unreadWalks.isEmpty()) {
+                d->requestUnreadPage(0, -1);
+            } else {
+                // resume the page walks of an interrupted synchronization
+                const QMap<qint64, qint64> walks = d->unreadWalks;
+                for (auto it = walks.constBegin(); it != walks.constEnd(); ++it) {
+                    d->requestNextUnreadPage(it.value(), it.key());
+                }
+                d->stageFinished(SynchronizerPrivate::Items);
+            }
+            return;
+        }
+
         d->getUnread = new GetItems(this);
         d->getUnread->setConfiguration(d->configuration);
         d->getUnread->setStorage(d->storage);
+        d->getUnread->setPriority(Component::BulkPriority);
         d->getUnread->setType(FuotenEnums::All);
         d->getUnread->setGetRead(false);
         d->getUnread->setBatchSize(-1);
         d->getUnread->setRequestTimeout(150);
         d->getUnread->setNotificator(notificator());
         QObject::connect(d->getUnread, &Component::failed, this, &Synchronizer::setError);
-        if (d->storage) {
-            QObject::connect(d->storage, &AbstractStorage::requestedItems, this, &Synchronizer::requestStarred);
-        } else {
-            QObject::connect(d->getUnread, &Component::succeeded, this, &Synchronizer::requestStarred);
-        }
+        d->getUnread->setBatchToken(d->itemsRequestIssued());
+        QObject::connect(d->getUnread, &Component::processed, this, [d] () {
+            d->itemsRequestReceived(d->getUnread->batchToken(), SynchronizerPrivate::ReceivedItems::UnreadItems);
+            d->stageFinished(SynchronizerPrivate::Items);
+        });
         d->getUnread->execute();
     }
 }
@@ -379,24 +358,49 @@ void Synchronizer::requestUnread()
 void Synchronizer::requestStarred()
 {
     Q_D(Synchronizer);
-    if (!d->getStarred) {
+    if (!d->getStarred && !d->getUpdatedStarred) {
         setProgress(++d->performedActions/d->totalActions);
         //% "Requesting starred articles"
         setCurrentAction(qtTrId("libfuoten-sync-req-starred-articles"));
 
+        d->connectItemsStored();
+
+        // the local starred items are complete up to the watermark, only later changes have to be requested
+        const QDateTime watermark = d->storage ? d->storage->starredWatermark() : QDateTime();
+        if (watermark.isValid() && (d->storage->starred() > 0)) {
+            qDebug("Requesting starred articles modified since %s.", qUtf8Printable(watermark.toString(Qt::ISODate)));
+            d->getUpdatedStarred = new GetUpdatedItems(this);
+            d->getUpdatedStarred->setConfiguration(d->configuration);
+            d->getUpdatedStarred->setStorage(d->storage);
+            d->getUpdatedStarred->setPriority(Component::BulkPriority);
+            d->getUpdatedStarred->setLastModified(watermark);
+            d->getUpdatedStarred->setType(FuotenEnums::Starred);
+            d->getUpdatedStarred->setParentId(0);
+            d->getUpdatedStarred->setNotificator(notificator());
+            QObject::connect(d->getUpdatedStarred, &Component::failed, this, &Synchronizer::setError);
+            d->getUpdatedStarred->setBatchToken(d->itemsRequestIssued());
+            QObject::connect(d->getUpdatedStarred, &Component::processed, this, [d] () {
+                d->itemsRequestReceived(d->getUpdatedStarred->batchToken(), SynchronizerPrivate::ReceivedItems::OtherItems);
+                d->stageFinished(SynchronizerPrivate::Starred);
+            });
+            d->getUpdatedStarred->execute();
+            return;
+        }
+
         d->getStarred = new GetItems(this);
         d->getStarred->setConfiguration(d->configuration);
         d->getStarred->setStorage(d->storage);
+        d->getStarred->setPriority(Component::BulkPriority);
         d->getStarred->setType(FuotenEnums::Starred);
         d->getStarred->setGetRead(true);
         d->getStarred->setBatchSize(-1);
         d->getStarred->setNotificator(notificator());
         QObject::connect(d->getStarred, &Component::failed, this, &Synchronizer::setError);
-        if (d->storage) {
-            QObject::connect(d->storage, &AbstractStorage::requestedItems, this, &Synchronizer::finished);
-        } else {
-            QObject::connect(d->getStarred, &Component::succeeded, this, &Synchronizer::finished);
-        }
+        d->getStarred->setBatchToken(d->itemsRequestIssued());
+        QObject::connect(d->getStarred, &Component::processed, this, [d] () {
+            d->itemsRequestReceived(d->getStarred->batchToken(), SynchronizerPrivate::ReceivedItems::OtherItems);
+            d->stageFinished(SynchronizerPrivate::Starred);
+        });
         d->getStarred->execute();
     }
 }
@@ -410,19 +414,22 @@ void Synchronizer::requestUpdated()
         //% "Requesting updated and new articles"
         setCurrentAction(qtTrId("libfuoten-sync-req-updated-articles"));
 
+        d->connectItemsStored();
+
         d->getUpdated = new GetUpdatedItems(this);
         d->getUpdated->setConfiguration(d->configuration);
         d->getUpdated->setStorage(d->storage);
+        d->getUpdated->setPriority(Component::BulkPriority);
         d->getUpdated->setLastModified(d->configuration->getLastSync());
         d->getUpdated->setType(FuotenEnums::All);
         d->getUpdated->setParentId(0);
         d->getUpdated->setNotificator(notificator());
         QObject::connect(d->getUpdated, &Component::failed, this, &Synchronizer::setError);
-        if (d->storage) {
-            QObject::connect(d->storage, &AbstractStorage::requestedItems, this, &Synchronizer::finished);
-        } else {
-            QObject::connect(d->getUpdated, &Component::succeeded, this, &Synchronizer::finished);
-        }
+        d->getUpdated->setBatchToken(d->itemsRequestIssued());
+        QObject::connect(d->getUpdated, &Component::processed, this, [d] () {
+            d->itemsRequestReceived(d->getUpdated->batchToken(), SynchronizerPrivate::ReceivedItems::OtherItems);
+            d->stageFinished(SynchronizerPrivate::Items);
+        });
         d->getUpdated->execute();
     }
 }
@@ -433,6 +440,9 @@ void Synchronizer::finished()
     Q_D(Synchronizer);
     if (d->storage) {
         d->storage->clearQueue();
+        d->storage->setSyncCheckpoint(QJsonObject());
+        // changes on the server during the synchronization are requested again by the next one
+        d->storage->setStarredWatermark(d->startTime.toUTC());
     }
     setProgress(++d->performedActions/d->totalActions);
     d->configuration->setLastSync(QDateTime::currentDateTimeUtc());
@@ -534,6 +544,100 @@ void Synchronizer::setCurrentAction(const QString &nCurrentAction)
 }
 
 
+int Synchronizer::pageSize() const { Q_D(const Synchronizer); return d->pageSize; }
+
+void Synchronizer::setPageSize(int nPageSize)
+{
+    if (Q_UNLIKELY(inOperation())) {
+        qWarning("Can not change property %s, still in operation.", "pageSize");
+        return;
+    }
+
+    Q_D(Synchronizer);
+    if (nPageSize != d->pageSize) {
+        d->pageSize = nPageSize;
+        qDebug("Changed pageSize to %i.", d->pageSize);
+        Q_EMIT pageSizeChanged(d->pageSize);
+    }
+}
+
+
+int Synchronizer::maxPagesInFlight() const { Q_D(const Synchronizer); return d->maxPagesInFlight; }
+
+void Synchronizer::setMaxPagesInFlight(int nMaxPagesInFlight)
+{
+    if (Q_UNLIKELY(inOperation())) {
+        qWarning("Can not change property %s, still in operation.", "maxPagesInFlight");
+        return;
+    }
+
+    Q_D(Synchronizer);
+    nMaxPagesInFlight = qMax(1, nMaxPagesInFlight);
+    if (nMaxPagesInFlight != d->maxPagesInFlight) {
+        d->maxPagesInFlight = nMaxPagesInFlight;
+        qDebug("Changed maxPagesInFlight to %i.", d->maxPagesInFlight);
+        Q_EMIT maxPagesInFlightChanged(d->maxPagesInFlight);
+    }
+}
+
+
+int Synchronizer::maxParallelStages() const { Q_D(const Synchronizer); return d->maxParallelStages; }
+
+void Synchronizer::setMaxParallelStages(int nMaxParallelStages)
+{
+    if (Q_UNLIKELY(inOperation())) {
+        qWarning("Can not change property %s, still in operation.", "maxParallelStages");
+        return;
+    }
+
+    Q_D(Synchronizer);
+    nMaxParallelStages = qMax(1, nMaxParallelStages);
+    if (nMaxParallelStages != d->maxParallelStages) {
+        d->maxParallelStages = nMaxParallelStages;
+        qDebug("Changed maxParallelStages to %i.", d->maxParallelStages);
+        Q_EMIT maxParallelStagesChanged(d->maxParallelStages);
+    }
+}
+
+
+int Synchronizer::uploadChunkSize() const { Q_D(const Synchronizer); return d->uploadChunkSize; }
+
+void Synchronizer::setUploadChunkSize(int nUploadChunkSize)
+{
+    if (Q_UNLIKELY(inOperation())) {
+        qWarning("Can not change property %s, still in operation.", "uploadChunkSize");
+        return;
+    }
+
+    Q_D(Synchronizer);
+    nUploadChunkSize = qMax(0, nUploadChunkSize);
+    if (nUploadChunkSize != d->uploadChunkSize) {
+        d->uploadChunkSize = nUploadChunkSize;
+        qDebug("Changed uploadChunkSize to %i.", d->uploadChunkSize);
+        Q_EMIT uploadChunkSizeChanged(d->uploadChunkSize);
+    }
+}
+
+
+int Synchronizer::maxUploadsInFlight() const { Q_D(const Synchronizer); return d->maxUploadsInFlight; }
+
+void Synchronizer::setMaxUploadsInFlight(int nMaxUploadsInFlight)
+{
+    if (Q_UNLIKELY(inOperation())) {
+        qWarning("Can not change property %s, still in operation.", "maxUploadsInFlight");
+        return;
+    }
+
+    Q_D(Synchronizer);
+    nMaxUploadsInFlight = qMax(1, nMaxUploadsInFlight);
+    if (nMaxUploadsInFlight != d->maxUploadsInFlight) {
+        d->maxUploadsInFlight = nMaxUploadsInFlight;
+        qDebug("Changed maxUploadsInFlight to %i.", d->maxUploadsInFlight);
+        Q_EMIT maxUploadsInFlightChanged(d->maxUploadsInFlight);
+    }
+}
+
+
 AbstractNotificator *Synchronizer::notificator() const
 {
     Q_D(const Synchronizer);
@@ -34,6 +34,20 @@ class AbstractNotificator;
 /*!
  * \brief Combines updating of folders, feeds and articles.
  *
+ * The synchronization consists of steps that depend on each other: feeds are requested after the folders, articles
+ * are requested after the feeds and after the local queue has been uploaded. Steps that do not depend on each other,
+ * like uploading the different parts of the local queue, requesting the folders and requesting unread and starred
+ * articles, are performed in parallel, limited by maxParallelStages. So the time a synchronization takes is mostly
+ * determined by the longest chain of dependent steps.
+ *
+ * If a storage is set, the Synchronizer stores a checkpoint via AbstractStorage::setSyncCheckpoint() after every
+ * completed step and after every stored page of unread articles (see pageSize). If the synchronization fails, the
+ * next one will skip the completed steps and continue the page walks where they stopped. Uploading the local queue
+ * and requesting folders and feeds are always performed again, so that articles of feeds added since the interrupted
+ * synchronization can be stored; unchanged folder and feed replies are not processed by the storage anyway. The checkpoint is discarded if the last sync time or the page size changed in the
+ * meantime, and it is removed after a successful synchronization. Failed requests are retried by the components
+ * themselves, see Component::setMaxRetries().
+ *
  * \par Mandatory properties
  * Synchronizer::configuration
  *
@@ -124,6 +138,78 @@ class FUOTENSHARED_EXPORT Synchronizer : public QObject
      * \li void notificatorChanged(AbstractNotificator *notificator);
      */
     Q_PROPERTY(Fuoten::AbstractNotificator *notificator READ notificator WRITE setNotificator NOTIFY notificatorChanged)
+    /*!
+     * \brief Number of articles requested per page on the initial synchronization.
+     *
+     * If this is greater than \c 0, the initial synchronization will not request all unread articles in a single GetItems request,
+     * but will walk through them in pages of this size using the GetItems::offset cursor. Every page is committed to the storage
+     * as soon as it arrives, so the first articles are available early and no single request has to transfer the complete data set.
+     * See maxPagesInFlight for the number of concurrent page requests.
+     *
+     * Defaults to \c 0, that requests all unread articles at once. This property can not be changed while inOperation() returns \c true.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>pageSize() const</TD></TR><TR><TD>void</TD><TD>setPageSize(int nPageSize)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>pageSizeChanged(int pageSize)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
+    /*!
+     * \brief Maximum number of page requests performed in parallel on a paged initial synchronization.
+     *
+     * The first page is requested alone to find the newest unread articles. The remaining ID space below the lowest ID of
+     * the first page is then split into up to this number of ranges that are walked in parallel, one page request per range.
+     * Has only an effect if pageSize is greater than \c 0.
+     *
+     * Defaults to \c 4, the minimum value is \c 1. This property can not be changed while inOperation() returns \c true.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>maxPagesInFlight() const</TD></TR><TR><TD>void</TD><TD>setMaxPagesInFlight(int nMaxPagesInFlight)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>maxPagesInFlightChanged(int maxPagesInFlight)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int maxPagesInFlight READ maxPagesInFlight WRITE setMaxPagesInFlight NOTIFY maxPagesInFlightChanged)
+    /*!
+     * \brief Maximum number of synchronization steps performed in parallel.
+     *
+     * A step is started as soon as the steps it depends on have been finished. Set this to \c 1 to perform
+     * all steps one after another.
+     *
+     * Defaults to \c 4, the minimum value is \c 1. This property can not be changed while inOperation() returns \c true.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>maxParallelStages() const</TD></TR><TR><TD>void</TD><TD>setMaxParallelStages(int nMaxParallelStages)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>maxParallelStagesChanged(int maxParallelStages)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int maxParallelStages READ maxParallelStages WRITE setMaxParallelStages NOTIFY maxParallelStagesChanged)
+    /*!
+     * \brief Maximum number of queued articles sent to the server in one request.
+     *
+     * After a long offline period the local queue can contain a lot of articles. They are split into requests of this
+     * size, see maxUploadsInFlight for the number of parallel requests. After every successful request, the sent articles
+     * are removed from the local queue via AbstractStorage::dequeueItems(), so that a failed synchronization only has to
+     * send the remaining ones again. Set this to \c 0 to send every part of the queue in one request.
+     *
+     * Defaults to \c 1000. This property can not be changed while inOperation() returns \c true.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>uploadChunkSize() const</TD></TR><TR><TD>void</TD><TD>setUploadChunkSize(int nUploadChunkSize)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>uploadChunkSizeChanged(int uploadChunkSize)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int uploadChunkSize READ uploadChunkSize WRITE setUploadChunkSize NOTIFY uploadChunkSizeChanged)
+    /*!
+     * \brief Maximum number of requests sending the local queue performed in parallel.
+     *
+     * Defaults to \c 2, the minimum value is \c 1. This property can not be changed while inOperation() returns \c true.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>maxUploadsInFlight() const</TD></TR><TR><TD>void</TD><TD>setMaxUploadsInFlight(int nMaxUploadsInFlight)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>maxUploadsInFlightChanged(int maxUploadsInFlight)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int maxUploadsInFlight READ maxUploadsInFlight WRITE setMaxUploadsInFlight NOTIFY maxUploadsInFlightChanged)
 public:
     /*!
      * \brief Constructs a new Synchronizer object with the given \a parent.
@@ -176,6 +262,36 @@ public:
      */
     AbstractNotificator *notificator() const;
 
+    /*!
+     * \brief Getter function for the \link Synchronizer::pageSize pageSize \endlink property.
+     * \sa setPageSize(), pageSizeChanged()
+     */
+    int pageSize() const;
+
+    /*!
+     * \brief Getter function for the \link Synchronizer::maxPagesInFlight maxPagesInFlight \endlink property.
+     * \sa setMaxPagesInFlight(), maxPagesInFlightChanged()
+     */
+    int maxPagesInFlight() const;
+
+    /*!
+     * \brief Getter function for the \link Synchronizer::maxParallelStages maxParallelStages \endlink property.
+     * \sa setMaxParallelStages(), maxParallelStagesChanged()
+     */
+    int maxParallelStages() const;
+
+    /*!
+     * \brief Getter function for the \link Synchronizer::uploadChunkSize uploadChunkSize \endlink property.
+     * \sa setUploadChunkSize(), uploadChunkSizeChanged()
+     */
+    int uploadChunkSize() const;
+
+    /*!
+     * \brief Getter function for the \link Synchronizer::maxUploadsInFlight maxUploadsInFlight \endlink property.
+     * \sa setMaxUploadsInFlight(), maxUploadsInFlightChanged()
+     */
+    int maxUploadsInFlight() const;
+
 
 
     /*!
@@ -196,6 +312,36 @@ public:
      */
     void setNotificator(AbstractNotificator *notificator);
 
+    /*!
+     * \brief Setter function for the \link Synchronizer::pageSize pageSize \endlink property.
+     * \sa pageSize(), pageSizeChanged()
+     */
+    void setPageSize(int nPageSize);
+
+    /*!
+     * \brief Setter function for the \link Synchronizer::maxPagesInFlight maxPagesInFlight \endlink property.
+     * \sa maxPagesInFlight(), maxPagesInFlightChanged()
+     */
+    void setMaxPagesInFlight(int nMaxPagesInFlight);
+
+    /*!
+     * \brief Setter function for the \link Synchronizer::maxParallelStages maxParallelStages \endlink property.
+     * \sa maxParallelStages(), maxParallelStagesChanged()
+     */
+    void setMaxParallelStages(int nMaxParallelStages);
+
+    /*!
+     * \brief Setter function for the \link Synchronizer::uploadChunkSize uploadChunkSize \endlink property.
+     * \sa uploadChunkSize(), uploadChunkSizeChanged()
+     */
+    void setUploadChunkSize(int nUploadChunkSize);
+
+    /*!
+     * \brief Setter function for the \link Synchronizer::maxUploadsInFlight maxUploadsInFlight \endlink property.
+     * \sa maxUploadsInFlight(), maxUploadsInFlightChanged()
+     */
+    void setMaxUploadsInFlight(int nMaxUploadsInFlight);
+
     /*!
      * \brief Invokes the synchronizing process.
      *
@@ -211,7 +357,8 @@ public:
     /*!
      * \brief Invokes the synchronizing process after \a miliseconds.
      *
-     * The base implementation simply calls start() after the timeout in \a miliseconds.
+     * The base implementation simply calls start() after the timeout in \a miliseconds. See SyncScheduler
+     * for intervals that adapt to how often the feeds publish new items.
      */
     Q_INVOKABLE virtual void deferredSync(quint32 miliseconds);
 
@@ -285,6 +432,36 @@ Q_SIGNALS:
      */
     void notificatorChanged(AbstractNotificator *notificator);
 
+    /*!
+     * \brief Notifier signal for the \link Synchronizer::pageSize pageSize \endlink property.
+     * \sa setPageSize(), pageSize()
+     */
+    void pageSizeChanged(int pageSize);
+
+    /*!
+     * \brief Notifier signal for the \link Synchronizer::maxPagesInFlight maxPagesInFlight \endlink property.
+     * \sa setMaxPagesInFlight(), maxPagesInFlight()
+     */
+    void maxPagesInFlightChanged(int maxPagesInFlight);
+
+    /*!
+     * \brief Notifier signal for the \link Synchronizer::maxParallelStages maxParallelStages \endlink property.
+     * \sa setMaxParallelStages(), maxParallelStages()
+     */
+    void maxParallelStagesChanged(int maxParallelStages);
+
+    /*!
+     * \brief Notifier signal for the \link Synchronizer::uploadChunkSize uploadChunkSize \endlink property.
+     * \sa setUploadChunkSize(), uploadChunkSize()
+     */
+    void uploadChunkSizeChanged(int uploadChunkSize);
+
+    /*!
+     * \brief Notifier signal for the \link Synchronizer::maxUploadsInFlight maxUploadsInFlight \endlink property.
+     * \sa setMaxUploadsInFlight(), maxUploadsInFlight()
+     */
+    void maxUploadsInFlightChanged(int maxUploadsInFlight);
+
 protected:
     const QScopedPointer<SynchronizerPrivate> d_ptr;
 
@@ -341,11 +518,18 @@ protected Q_SLOTS:
 
     /*!
      * \brief Requests all unread articles from the News App.
+     *
+     * If pageSize is greater than \c 0, the articles are requested in pages.
      */
     void requestUnread();
 
     /*!
-     * \brief Requests all starred articles from the News App.
+     * \brief Requests starred articles from the News App.
+     *
+     * Will be called in parallel to requestUnread() on an initial synchronization. The synchronization finishes
+     * after all requested articles have been stored. If the storage already contains starred articles and has a
+     * valid AbstractStorage::starredWatermark(), only the starred articles modified since then are requested via
+     * GetUpdatedItems, otherwise all starred articles are requested via GetItems.
      */
     void requestStarred();
 
@@ -23,6 +23,7 @@
 #include "synchronizer.h"
 #include "abstractconfiguration.h"
 #include "abstractnotificator.h"
+#include "tracer.h"
 #include "../Storage/abstractstorage.h"
 #include "../API/getfolders.h"
 #include "../API/getfeeds.h"
@@ -33,6 +34,16 @@
 #include "../error.h"
 #include <QTimer>
 #include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QVariant>
+#include <QQueue>
+#include <QMap>
+#include <QStringList>
 
 namespace Fuoten {
 
@@ -40,6 +51,77 @@ class SynchronizerPrivate
 {
     Q_DECLARE_PUBLIC(Synchronizer)
 public:
+    /*
+     * Describes item requests that have been handed to the storage but have
+     * not been stored yet. The storage writes them in the same order.
+     */
+    struct ReceivedItems {
+        enum Type : quint8 {
+            UnreadItems,
+            UnreadPage,
+            OtherItems
+        };
+        Type type;
+        qint64 lowerBound;
+        qint64 nextOffset;
+    };
+
+    /*
+     * The steps of a synchronization. A stage is started as soon as all stages
+     * it depends on have been finished and less than maxParallelStages are
+     * running. With a limit of one, the stages run in the order below.
+     */
+    enum Stage : quint8 {
+        UploadUnread = 0,
+        UploadRead,
+        UploadStarred,
+        UploadUnstarred,
+        Folders,
+        Feeds,
+        Items,
+        Starred,
+        StageCount
+    };
+
+    /*
+     * A part of the local queue that is sent in one request.
+     */
+    struct UploadChunk {
+        Stage stage;
+        IdList articleIds;
+        QList<QPair<qint64, QString> > items;
+    };
+
+    static const char *stageName(Stage stage)
+    {
+        static const char *names[] = {"upload unread", "upload read", "upload starred", "upload unstarred", "folders", "feeds", "items", "starred"};
+        return names[stage];
+    }
+
+    static quint16 stageBit(Stage stage)
+    {
+        return static_cast<quint16>(1 << stage);
+    }
+
+    /*
+     * Feeds need their folders. Articles are requested after the local queue has
+     * been uploaded, otherwise the requested articles would overwrite local changes
+     * with the old state from the server.
+     */
+    static quint16 dependencies(Stage stage)
+    {
+        const quint16 uploads = stageBit(UploadUnread) | stageBit(UploadRead) | stageBit(UploadStarred) | stageBit(UploadUnstarred);
+        switch (stage) {
+        case Feeds:
+            return stageBit(Folders);
+        case Items:
+        case Starred:
+            return uploads | stageBit(Feeds);
+        default:
+            return 0;
+        }
+    }
+
     explicit SynchronizerPrivate(Synchronizer *parent) :
         q_ptr(parent)
     {}
@@ -49,6 +131,12 @@ public:
 
     void cleanup()
     {
+        if (traceBegin > -1) {
+            QVariantMap args;
+            args.insert(QStringLiteral("result"), (error && (error->type() != Error::NoError)) ? QStringLiteral("failed") : QStringLiteral("succeeded"));
+            Tracer::addAsyncSpan("sync", QStringLiteral("synchronize"), reinterpret_cast<quintptr>(this), traceBegin, Tracer::timestamp(), args);
+            traceBegin = -1;
+        }
         if (getFolders) {
             getFolders->deleteLater();
             getFolders = nullptr;
@@ -61,6 +149,10 @@ public:
             getStarred->deleteLater();
             getStarred = nullptr;
         }
+        if (getUpdatedStarred) {
+            getUpdatedStarred->deleteLater();
+            getUpdatedStarred = nullptr;
+        }
         if (getUnread) {
             getUnread->deleteLater();
             getUnread = nullptr;
@@ -69,29 +161,46 @@ public:
             getUpdated->deleteLater();
             getUpdated = nullptr;
         }
-        if (starMultipleItems) {
-            starMultipleItems->deleteLater();
-            starMultipleItems = nullptr;
+        if (!unreadPages.isEmpty()) {
+            const QList<GetItems*> pages = unreadPages.keys();
+            for (GetItems *page : pages) {
+                page->deleteLater();
+            }
+            unreadPages.clear();
         }
-        if (unstarMultipleItems) {
-            unstarMultipleItems->deleteLater();
-            unstarMultipleItems = nullptr;
-        }
-        if (readMultipleItems) {
-            readMultipleItems->deleteLater();
-            readMultipleItems = nullptr;
-        }
-        if (unreadMultipleItems) {
-            unreadMultipleItems->deleteLater();
-            unreadMultipleItems = nullptr;
+        deferredPages.clear();
+        receivedItems.clear();
+        issuedTokens.clear();
+        storedTokens.clear();
+        completedStages.clear();
+        unreadWalks.clear();
+        QObject::disconnect(itemsStoredConnection);
+        issuedItemRequests = 0;
+        receivedItemRequests = 0;
+        storedItemRequests = 0;
+        for (Component *upload : qAsConst(uploads)) {
+            upload->deleteLater();
         }
+        uploads.clear();
+        uploadChunks.clear();
+        remainingChunks.clear();
         if (storage) {
             QObject::disconnect(storage, 0, q_ptr, 0);
+            if (itemsMaintenanceDeferred) {
+                storage->deferItemsMaintenance(false);
+            }
         }
+        itemsMaintenanceDeferred = false;
+        plannedStages = 0;
+        startedStages = 0;
+        finishedStages = 0;
+        scheduleAgain = false;
         queuedUnreadArticles.clear();
         queuedReadArticles.clear();
         queuedStarredArticles.clear();
         queuedUnstarredArticles.clear();
+        queuedStarredIds.clear();
+        queuedUnstarredIds.clear();
         inOperation = false;
         progress = 0.0;
         totalActions = 0.0;
@@ -111,11 +220,526 @@ public:
         }
     }
 
+    int runningStages() const
+    {
+        int running = 0;
+        for (quint8 s = 0; s < StageCount; ++s) {
+            const quint16 bit = stageBit(static_cast<Stage>(s));
+            if ((startedStages & bit) && !(finishedStages & bit)) {
+                running++;
+            }
+        }
+        return running;
+    }
+
+    /*
+     * Starts all planned stages whose dependencies are finished, as long as the
+     * limit of parallel stages allows it. Stages that are skipped because of a
+     * checkpoint finish while they are started, so the scheduling is repeated
+     * instead of being entered recursively.
+     */
+    void scheduleStages()
+    {
+        if (scheduling) {
+            scheduleAgain = true;
+            return;
+        }
+
+        scheduling = true;
+        do {
+            scheduleAgain = false;
+            for (quint8 s = 0; s < StageCount; ++s) {
+                const Stage stage = static_cast<Stage>(s);
+                const quint16 bit = stageBit(stage);
+                if (!(plannedStages & bit) || (startedStages & bit)) {
+                    continue;
+                }
+                if ((dependencies(stage) & plannedStages & ~finishedStages) != 0) {
+                    continue;
+                }
+                if (runningStages() >= maxParallelStages) {
+                    break;
+                }
+                startedStages |= bit;
+                startStage(stage);
+            }
+        } while (scheduleAgain);
+        scheduling = false;
+    }
+
+    void startStage(Stage stage)
+    {
+        Q_Q(Synchronizer);
+        stageTraceBegin[stage] = Tracer::isEnabled() ? Tracer::timestamp() : -1;
+        switch (stage) {
+        case UploadUnread:
+            q->notifyAboutUnread();
+            break;
+        case UploadRead:
+            q->notifyAboutRead();
+            break;
+        case UploadStarred:
+            q->notifyAboutStarred();
+            break;
+        case UploadUnstarred:
+            q->notifyAboutUnstarred();
+            break;
+        case Folders:
+            q->requestFolders();
+            break;
+        case Feeds:
+            q->requestFeeds();
+            break;
+        case Items:
+            if (configuration->getLastSync().isValid()) {
+                q->requestUpdated();
+            } else {
+                q->requestUnread();
+            }
+            break;
+        case Starred:
+            q->requestStarred();
+            break;
+        default:
+            break;
+        }
+    }
+
+    void stageFinished(Stage stage)
+    {
+        const quint16 bit = stageBit(stage);
+        if (!(startedStages & bit) || (finishedStages & bit)) {
+            return;
+        }
+        finishedStages |= bit;
+        if (stageTraceBegin[stage] > -1) {
+            // every stage gets its own row in the trace viewer
+            Tracer::addAsyncSpan("sync", QLatin1String(stageName(stage)), reinterpret_cast<quintptr>(this) + stage + 1, stageTraceBegin[stage], Tracer::timestamp());
+            stageTraceBegin[stage] = -1;
+        }
+        scheduleStages();
+        checkItemsFinished();
+    }
+
+    /*
+     * Splits a part of the local queue into chunks of uploadChunkSize entries
+     * that are sent with up to maxUploadsInFlight parallel requests.
+     */
+    void enqueueUpload(Stage stage, const IdList &articleIds, const QList<QPair<qint64, QString> > &items = QList<QPair<qint64, QString> >())
+    {
+        const int total = articleIds.size();
+        const int size = (uploadChunkSize > 0) ? uploadChunkSize : total;
+        int chunks = 0;
+        for (int i = 0; i < total; i += size) {
+            UploadChunk c;
+            c.stage = stage;
+            c.articleIds = articleIds.mid(i, size);
+            if (!items.isEmpty()) {
+                c.items = items.mid(i, size);
+            }
+            uploadChunks.enqueue(c);
+            chunks++;
+        }
+        remainingChunks.insert(stage, chunks);
+
+        if (chunks == 0) {
+            stageFinished(stage);
+            return;
+        }
+
+        qDebug("Sending %i queued articles in %i requests.", total, chunks);
+
+        sendUploads();
+    }
+
+    void sendUploads()
+    {
+        Q_Q(Synchronizer);
+
+        while (!uploadChunks.isEmpty() && (uploads.size() < maxUploadsInFlight)) {
+            const UploadChunk c = uploadChunks.dequeue();
+            Component *upload = nullptr;
+            if ((c.stage == UploadUnread) || (c.stage == UploadRead)) {
+                MarkMultipleItems *mmi = new MarkMultipleItems(c.articleIds, (c.stage == UploadUnread), q);
+                QObject::connect(mmi, &MarkMultipleItems::succeeded, q, [this, mmi, c] () {
+                    uploadFinished(mmi, c);
+                });
+                upload = mmi;
+            } else {
+                StarMultipleItems *smi = new StarMultipleItems((c.stage == UploadStarred), q);
+                smi->setItemsToStar(c.items);
+                QObject::connect(smi, &StarMultipleItems::succeeded, q, [this, smi, c] () {
+                    uploadFinished(smi, c);
+                });
+                upload = smi;
+            }
+            upload->setPriority(Component::BulkPriority);
+            upload->setConfiguration(configuration);
+            upload->setUseStorage(false);
+            upload->setNotificator(q->notificator());
+            QObject::connect(upload, &Component::failed, q, &Synchronizer::setError);
+            uploads.append(upload);
+            upload->execute();
+        }
+    }
+
+    /*
+     * Removes the sent chunk from the local queue, so that a failed
+     * synchronization does not send it again.
+     */
+    void uploadFinished(Component *upload, const UploadChunk &chunk)
+    {
+        uploads.removeOne(upload);
+        upload->deleteLater();
+
+        if (storage) {
+            FuotenEnums::QueueAction action = FuotenEnums::NoQueueAction;
+            switch (chunk.stage) {
+            case UploadUnread:
+                action = FuotenEnums::MarkAsUnread;
+                break;
+            case UploadRead:
+                action = FuotenEnums::MarkAsRead;
+                break;
+            case UploadStarred:
+                action = FuotenEnums::Star;
+                break;
+            default:
+                action = FuotenEnums::Unstar;
+                break;
+            }
+            storage->dequeueItems(chunk.articleIds, action);
+        }
+
+        const int remaining = remainingChunks.value(chunk.stage) - 1;
+        remainingChunks.insert(chunk.stage, remaining);
+
+        sendUploads();
+
+        if (remaining == 0) {
+            stageFinished(chunk.stage);
+        }
+    }
+
+    /*
+     * Counts the item requests whose results have to be stored before the
+     * synchronization can finish. Without storage a request counts as stored
+     * as soon as it has been received. The requests of the synchronization
+     * are identified by the batch tokens the storage echoes after storing.
+     */
+    void connectItemsStored()
+    {
+        if (storage && !itemsStoredConnection) {
+            Q_Q(Synchronizer);
+            itemsStoredConnection = QObject::connect(storage, &AbstractStorage::itemsBatchStored, q, [this] (quint64 batchToken) {
+                itemsRequestStored(batchToken);
+            });
+            // old items are removed and counters are updated once after all pages have been stored
+            storage->deferItemsMaintenance(true);
+            itemsMaintenanceDeferred = true;
+        }
+    }
+
+    /*
+     * Returns the batch token the new item request has to pass to the storage.
+     */
+    quint64 itemsRequestIssued()
+    {
+        issuedItemRequests++;
+        if (!storage) {
+            return 0;
+        }
+        const quint64 token = storage->createBatchToken();
+        issuedTokens.insert(token);
+        return token;
+    }
+
+    void itemsRequestReceived(quint64 batchToken, ReceivedItems::Type type, qint64 lowerBound = 0, qint64 nextOffset = -1)
+    {
+        receivedItemRequests++;
+        if (!storage) {
+            storedItemRequests++;
+        } else {
+            const ReceivedItems received = {type, lowerBound, nextOffset};
+            // synchronous storages report the stored items before the request reports them as received
+            if (storedTokens.remove(batchToken)) {
+                applyStored(received);
+            } else {
+                receivedItems.insert(batchToken, received);
+            }
+        }
+    }
+
+    void itemsRequestStored(quint64 batchToken)
+    {
+        // items requested by others than this synchronization
+        if (!issuedTokens.remove(batchToken)) {
+            return;
+        }
+        storedItemRequests++;
+        if (receivedItems.contains(batchToken)) {
+            applyStored(receivedItems.take(batchToken));
+        } else {
+            storedTokens.insert(batchToken);
+        }
+        requestDeferredPages();
+        checkItemsFinished();
+    }
+
+    /*
+     * Updates the checkpoint after items have been written to the storage.
+     */
+    void applyStored(const ReceivedItems &stored)
+    {
+        if (stored.type == ReceivedItems::UnreadItems) {
+            completeStage(QStringLiteral("unread"));
+        } else if (stored.type == ReceivedItems::UnreadPage) {
+            if (stored.nextOffset < 0) {
+                unreadWalks.remove(stored.lowerBound);
+            } else {
+                unreadWalks.insert(stored.lowerBound, stored.nextOffset);
+            }
+            if (unreadWalks.isEmpty()) {
+                completeStage(QStringLiteral("unread"));
+            } else {
+                saveCheckpoint();
+            }
+        }
+    }
+
+    /*
+     * Loads the checkpoint of an interrupted synchronization from the storage.
+     * The checkpoint is only valid for the same last sync time and page size.
+     * Uploading the local queue and requesting folders and feeds are not part
+     * of the checkpoint, they are always performed again.
+     */
+    void loadCheckpoint()
+    {
+        completedStages.clear();
+        unreadWalks.clear();
+
+        if (!storage) {
+            return;
+        }
+
+        const QJsonObject cp = storage->syncCheckpoint();
+        if (cp.isEmpty()) {
+            return;
+        }
+
+        if ((cp.value(QStringLiteral("lastSync")).toVariant().toLongLong() != lastSyncTime()) || (cp.value(QStringLiteral("pageSize")).toInt() != pageSize)) {
+            qDebug("%s", "Discarding outdated synchronization checkpoint.");
+            storage->setSyncCheckpoint(QJsonObject());
+            return;
+        }
+
+        const QJsonArray stages = cp.value(QStringLiteral("stages")).toArray();
+        for (const QJsonValue &stage : stages) {
+            completedStages.append(stage.toString());
+        }
+
+        const QJsonArray walks = cp.value(QStringLiteral("unreadWalks")).toArray();
+        for (const QJsonValue &w : walks) {
+            const QJsonArray walk = w.toArray();
+            unreadWalks.insert(walk.at(0).toVariant().toLongLong(), walk.at(1).toVariant().toLongLong());
+        }
+
+        // the first page has not been stored, so the unread articles have to be requested from the start
+        if (unreadWalks.contains(-1)) {
+            unreadWalks.clear();
+        }
+
+        qDebug("Resuming synchronization with completed steps \"%s\" and %i unread page walks.", qUtf8Printable(completedStages.join(QStringLiteral(", "))), unreadWalks.size());
+    }
+
+    void saveCheckpoint()
+    {
+        if (!storage) {
+            return;
+        }
+
+        QJsonArray walks;
+        for (auto it = unreadWalks.constBegin(); it != unreadWalks.constEnd(); ++it) {
+            walks.append(QJsonArray({QJsonValue(it.key()), QJsonValue(it.value())}));
+        }
+
+        QJsonObject cp;
+        cp.insert(QStringLiteral("lastSync"), QJsonValue(lastSyncTime()));
+        cp.insert(QStringLiteral("pageSize"), pageSize);
+        cp.insert(QStringLiteral("stages"), QJsonArray::fromStringList(completedStages));
+        cp.insert(QStringLiteral("unreadWalks"), walks);
+
+        storage->setSyncCheckpoint(cp);
+    }
+
+    void completeStage(const QString &stage)
+    {
+        if (!completedStages.contains(stage)) {
+            completedStages.append(stage);
+            saveCheckpoint();
+        }
+    }
+
+    bool stageCompleted(const QString &stage) const
+    {
+        return completedStages.contains(stage);
+    }
+
+    qint64 lastSyncTime() const
+    {
+        const QDateTime lastSync = configuration->getLastSync();
+        return lastSync.isValid() ? static_cast<qint64>(lastSync.toTime_t()) : 0;
+    }
+
+    /*
+     * Requests a page of unread items that contains items with IDs lower than
+     * offset. lowerBound is the lowest ID the page walk is responsible for,
+     * -1 marks the first page that is used to split the ID space.
+     */
+    void requestUnreadPage(qint64 offset, qint64 lowerBound)
+    {
+        Q_Q(Synchronizer);
+
+        GetItems *page = new GetItems(q);
+        page->setConfiguration(configuration);
+        page->setStorage(storage);
+        page->setPriority(Component::BulkPriority);
+        page->setType(FuotenEnums::All);
+        page->setGetRead(false);
+        page->setBatchSize(pageSize);
+        page->setOffset(offset);
+        page->setNotificator(q->notificator());
+        // pages of walks with a lower border are stored by unreadPageReceived() without the items of the next walk
+        page->setUseStorage(lowerBound <= 0);
+        QObject::connect(page, &Component::failed, q, &Synchronizer::setError);
+        QObject::connect(page, &Component::processed, q, [this, page] () {
+            unreadPageReceived(page);
+        });
+
+        unreadPages.insert(page, lowerBound);
+        if (lowerBound < 0) {
+            unreadWalks.insert(-1, 0);
+        }
+        page->setBatchToken(itemsRequestIssued());
+
+        page->execute();
+    }
+
+    /*
+     * Pages that have been received but are not yet stored are limited to
+     * maxPagesInFlight, further pages wait until the storage caught up.
+     */
+    void requestNextUnreadPage(qint64 offset, qint64 lowerBound)
+    {
+        if ((receivedItemRequests - storedItemRequests) >= maxPagesInFlight) {
+            deferredPages.append(qMakePair(offset, lowerBound));
+        } else {
+            requestUnreadPage(offset, lowerBound);
+        }
+    }
+
+    void requestDeferredPages()
+    {
+        while (!deferredPages.isEmpty() && ((receivedItemRequests - storedItemRequests) < maxPagesInFlight)) {
+            const QPair<qint64, qint64> next = deferredPages.takeFirst();
+            requestUnreadPage(next.first, next.second);
+        }
+    }
+
+    /*
+     * Schedules the next page of the walk the received page belongs to. The first
+     * page splits the remaining ID space below its lowest ID into up to
+     * maxPagesInFlight ranges that are walked in parallel. The last page of a walk
+     * might reach into the range of the next walk, those items are not stored
+     * twice.
+     */
+    void unreadPageReceived(GetItems *page)
+    {
+        const qint64 lowerBound = unreadPages.take(page);
+        const qint64 offset = page->offset();
+        const quint64 batchToken = page->batchToken();
+        const ItemRecords items = page->itemRecords();
+        page->deleteLater();
+
+        qint64 lowestId = 0;
+        for (const ItemRecord &i : items) {
+            if ((lowestId == 0) || (i.id < lowestId)) {
+                lowestId = i.id;
+            }
+        }
+
+        qDebug("Received page with %i unread articles below ID %lli.", items.size(), offset);
+
+        if (lowerBound > 0) {
+            ItemRecords own;
+            own.reserve(items.size());
+            for (const ItemRecord &i : items) {
+                if (i.id >= lowerBound) {
+                    own.append(i);
+                }
+            }
+            if (own.size() < items.size()) {
+                qDebug("Skipping %i articles below ID %lli that belong to the next page walk.", items.size() - own.size(), lowerBound);
+            }
+            if (storage) {
+                storage->itemsRequested(own, batchToken);
+            }
+        }
+
+        // a short page is the last one, the same applies if the lowest ID does not move anymore
+        const bool hasMore = (items.size() >= pageSize) && (lowestId > qMax<qint64>(lowerBound, 0)) && ((offset == 0) || (lowestId < offset));
+
+        if (hasMore && (lowerBound < 0)) {
+            const qint64 ranges = qBound<qint64>(1, lowestId / pageSize, maxPagesInFlight);
+            const qint64 span = lowestId / ranges;
+            qDebug("Splitting unread articles below ID %lli into %lli parallel page walks.", lowestId, ranges);
+            QList<QPair<qint64, qint64> > walks;
+            for (qint64 i = 0; i < ranges; ++i) {
+                const qint64 upper = lowestId - (i * span);
+                const qint64 lower = (i == (ranges - 1)) ? 0 : (upper - span);
+                unreadWalks.insert(lower, upper);
+                walks.append(qMakePair(upper, lower));
+            }
+            itemsRequestReceived(batchToken, ReceivedItems::UnreadPage, lowerBound, -1);
+            for (const QPair<qint64, qint64> &walk : walks) {
+                requestNextUnreadPage(walk.first, walk.second);
+            }
+        } else if (hasMore) {
+            itemsRequestReceived(batchToken, ReceivedItems::UnreadPage, lowerBound, lowestId);
+            requestNextUnreadPage(lowestId, lowerBound);
+        } else {
+            itemsRequestReceived(batchToken, ReceivedItems::UnreadPage, lowerBound, -1);
+        }
+
+        // the remaining pages are requested by the page walks, so the stage does not block other stages anymore
+        if (lowerBound < 0) {
+            stageFinished(Items);
+        }
+
+        checkItemsFinished();
+    }
+
+    /*
+     * Finishes the synchronization after all stages have been finished
+     * and all item requests have been received and stored.
+     */
+    void checkItemsFinished()
+    {
+        if ((plannedStages != 0) && (finishedStages == plannedStages) && unreadPages.isEmpty() && deferredPages.isEmpty() && (receivedItemRequests >= issuedItemRequests) && (storedItemRequests >= issuedItemRequests)) {
+            Q_Q(Synchronizer);
+            QObject::disconnect(itemsStoredConnection);
+            qDebug("Received and stored %i item requests.", issuedItemRequests);
+            q->finished();
+        }
+    }
+
 
     QList<QPair<qint64, QString> > queuedStarredArticles;
     QList<QPair<qint64, QString> > queuedUnstarredArticles;
     IdList queuedUnreadArticles;
     IdList queuedReadArticles;
+    IdList queuedStarredIds;
+    IdList queuedUnstarredIds;
     Synchronizer * const q_ptr;
     Error *error = nullptr;
     AbstractConfiguration *configuration = nullptr;
@@ -125,18 +749,42 @@ public:
     GetItems *getUnread = nullptr;
     GetItems *getStarred = nullptr;
     GetUpdatedItems *getUpdated = nullptr;
-    StarMultipleItems *starMultipleItems = nullptr;
-    StarMultipleItems *unstarMultipleItems = nullptr;
-    MarkMultipleItems *readMultipleItems = nullptr;
-    MarkMultipleItems *unreadMultipleItems = nullptr;
+    GetUpdatedItems *getUpdatedStarred = nullptr;
+    QHash<GetItems*, qint64> unreadPages;
+    QList<QPair<qint64, qint64> > deferredPages;
+    QMetaObject::Connection itemsStoredConnection;
+    QHash<quint64, ReceivedItems> receivedItems;
+    QSet<quint64> issuedTokens;
+    QSet<quint64> storedTokens;
+    QStringList completedStages;
+    QMap<qint64, qint64> unreadWalks;
+    QList<Component*> uploads;
+    QQueue<UploadChunk> uploadChunks;
+    QHash<int, int> remainingChunks;
     QTimer *deferTimer = nullptr;
     AbstractNotificator *notificator = nullptr;
     QString currentAction;
     QDateTime startTime;
+    qint64 traceBegin = -1;
+    qint64 stageTraceBegin[StageCount] = {-1, -1, -1, -1, -1, -1, -1, -1};
     qreal progress = 0.0;
     qreal totalActions = 0.0;
     qreal performedActions = 0.0;
+    int pageSize = 0;
+    int maxPagesInFlight = 4;
+    int maxParallelStages = 4;
+    int uploadChunkSize = 1000;
+    int maxUploadsInFlight = 2;
+    int issuedItemRequests = 0;
+    int receivedItemRequests = 0;
+    int storedItemRequests = 0;
+    quint16 plannedStages = 0;
+    quint16 startedStages = 0;
+    quint16 finishedStages = 0;
+    bool scheduling = false;
+    bool scheduleAgain = false;
     bool inOperation = false;
+    bool itemsMaintenanceDeferred = false;
 };
 
 }
@@ -0,0 +1,204 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "syncscheduler_p.h"
+
+using namespace Fuoten;
+
+
+SyncScheduler::SyncScheduler(QObject *parent) :
+    QObject(parent), d_ptr(new SyncSchedulerPrivate(this))
+{
+    Q_D(SyncScheduler);
+    connect(&d->timer, &QTimer::timeout, this, &SyncScheduler::check);
+}
+
+
+SyncScheduler::~SyncScheduler()
+{
+}
+
+
+Synchronizer *SyncScheduler::synchronizer() const { Q_D(const SyncScheduler); return d->synchronizer; }
+
+void SyncScheduler::setSynchronizer(Synchronizer *synchronizer)
+{
+    Q_D(SyncScheduler);
+    if (synchronizer != d->synchronizer) {
+        if (d->synchronizer) {
+            disconnect(d->synchronizer, nullptr, this, nullptr);
+        }
+        d->synchronizer = synchronizer;
+        if (d->synchronizer) {
+            // complete synchronizations reset the update times of all feeds and bring new publication dates
+            connect(d->synchronizer, &Synchronizer::succeeded, this, [this, d] () {
+                d->feedSyncs.clear();
+                d->loadPublishDates();
+                check();
+            });
+            connect(d->synchronizer, &Synchronizer::failed, this, [d] () {
+                if (d->active) {
+                    d->scheduleAt(SyncSchedulerPrivate::now() + d->minInterval);
+                }
+            });
+        }
+        qDebug("Changed synchronizer to %p.", synchronizer);
+        Q_EMIT synchronizerChanged(synchronizer);
+    }
+}
+
+
+int SyncScheduler::minInterval() const { Q_D(const SyncScheduler); return d->minInterval; }
+
+void SyncScheduler::setMinInterval(int minInterval)
+{
+    Q_D(SyncScheduler);
+    minInterval = qMax(60, minInterval);
+    if (minInterval != d->minInterval) {
+        d->minInterval = minInterval;
+        qDebug("Changed minInterval to %i.", d->minInterval);
+        Q_EMIT minIntervalChanged(d->minInterval);
+    }
+}
+
+
+int SyncScheduler::maxInterval() const { Q_D(const SyncScheduler); return d->maxInterval; }
+
+void SyncScheduler::setMaxInterval(int maxInterval)
+{
+    Q_D(SyncScheduler);
+    maxInterval = qMax(60, maxInterval);
+    if (maxInterval != d->maxInterval) {
+        d->maxInterval = maxInterval;
+        qDebug("Changed maxInterval to %i.", d->maxInterval);
+        Q_EMIT maxIntervalChanged(d->maxInterval);
+    }
+}
+
+
+int SyncScheduler::maxFeedRequests() const { Q_D(const SyncScheduler); return d->maxFeedRequests; }
+
+void SyncScheduler::setMaxFeedRequests(int maxFeedRequests)
+{
+    Q_D(SyncScheduler);
+    maxFeedRequests = qMax(0, maxFeedRequests);
+    if (maxFeedRequests != d->maxFeedRequests) {
+        d->maxFeedRequests = maxFeedRequests;
+        qDebug("Changed maxFeedRequests to %i.", d->maxFeedRequests);
+        Q_EMIT maxFeedRequestsChanged(d->maxFeedRequests);
+    }
+}
+
+
+bool SyncScheduler::isActive() const { Q_D(const SyncScheduler); return d->active; }
+
+
+QDateTime SyncScheduler::nextCheck() const { Q_D(const SyncScheduler); return d->nextCheck; }
+
+
+int SyncScheduler::feedInterval(qint64 feedId) const
+{
+    Q_D(const SyncScheduler);
+    return d->interval(feedId, SyncSchedulerPrivate::now());
+}
+
+
+void SyncScheduler::start()
+{
+    Q_D(SyncScheduler);
+
+    if (Q_UNLIKELY(!d->synchronizer)) {
+        qWarning("%s", "Can not start the synchronization scheduling without synchronizer.");
+        return;
+    }
+
+    if (!d->active) {
+        d->active = true;
+        qDebug("%s", "Started synchronization scheduling.");
+        Q_EMIT activeChanged(true);
+    }
+
+    d->loadPublishDates();
+
+    check();
+}
+
+
+void SyncScheduler::stop()
+{
+    Q_D(SyncScheduler);
+
+    d->timer.stop();
+    d->setNextCheck(QDateTime());
+
+    if (d->active) {
+        d->active = false;
+        qDebug("%s", "Stopped synchronization scheduling.");
+        Q_EMIT activeChanged(false);
+    }
+}
+
+
+void SyncScheduler::check()
+{
+    Q_D(SyncScheduler);
+
+    if (!d->active || !d->synchronizer) {
+        return;
+    }
+
+    // the running requests check again when they have been finished
+    if (d->synchronizer->inOperation() || !d->feedRequests.isEmpty() || d->queueQuery) {
+        return;
+    }
+
+    const qint64 current = SyncSchedulerPrivate::now();
+    const qint64 lastSync = d->lastSync();
+
+    if ((lastSync == 0) || ((current - lastSync) >= d->maxInterval)) {
+        d->syncAll();
+        return;
+    }
+
+    IdList due;
+    qint64 next = lastSync + d->maxInterval;
+
+    for (auto it = d->publishDates.constBegin(); it != d->publishDates.constEnd(); ++it) {
+        const qint64 dueTime = d->lastFeedSync(it.key()) + d->interval(it.key(), current);
+        if (dueTime <= current) {
+            due.append(it.key());
+        } else {
+            next = qMin(next, dueTime);
+        }
+    }
+
+    if (due.isEmpty()) {
+        d->scheduleAt(next);
+        return;
+    }
+
+    if (due.size() > d->maxFeedRequests) {
+        d->syncAll();
+        return;
+    }
+
+    d->syncQueueOrFeeds(due, current);
+}
+
+#include "moc_syncscheduler.cpp"
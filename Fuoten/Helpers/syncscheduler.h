@@ -0,0 +1,273 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENSYNCSCHEDULER_H
+#define FUOTENSYNCSCHEDULER_H
+
+#include <QObject>
+#include <QDateTime>
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+class SyncSchedulerPrivate;
+class Synchronizer;
+
+/*!
+ * \brief Schedules synchronizations based on how often the single feeds publish new items.
+ *
+ * Synchronizer::deferredSync() starts a complete synchronization after a fixed time and every synchronization requests
+ * the updates of all feeds. Most subscriptions publish only a few items per week, while some news feeds publish several
+ * items per hour. The SyncScheduler estimates a check interval for every feed from the publication dates of the newest
+ * stored items, see AbstractStorage::getPublishDates(). Feeds are checked twice per average gap between their items.
+ * If the newest item is older than that gap, the feed became quieter and the age of the newest item is used as gap
+ * instead. The intervals are limited by minInterval and maxInterval.
+ *
+ * If only a few feeds are due, up to maxFeedRequests, their updates are requested via GetUpdatedItems with the type
+ * FuotenEnums::Feed. Otherwise, after maxInterval has elapsed since the last synchronization or if the local queue
+ * contains articles, a complete synchronization is performed by the synchronizer. The time of the last update of every
+ * feed is only kept in memory, after a restart all feeds start from AbstractConfiguration::getLastSync().
+ *
+ * \par Mandatory properties
+ * SyncScheduler::synchronizer
+ *
+ * \headerfile "" <Fuoten/Helpers/SyncScheduler>
+ */
+class FUOTENSHARED_EXPORT SyncScheduler : public QObject
+{
+    Q_OBJECT
+    /*!
+     * \brief Pointer to the Synchronizer that performs complete synchronizations.
+     *
+     * The configuration, storage and notificator of the synchronizer are also used for the feed requests.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>Synchronizer*</TD><TD>synchronizer() const</TD></TR><TR><TD>void</TD><TD>setSynchronizer(Synchronizer *synchronizer)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>synchronizerChanged(Synchronizer *synchronizer)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(Fuoten::Synchronizer *synchronizer READ synchronizer WRITE setSynchronizer NOTIFY synchronizerChanged)
+    /*!
+     * \brief Minimum time in seconds between two checks of the same feed.
+     *
+     * Defaults to \c 900, the minimum value is \c 60. A changed value will be used by the next check.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>minInterval() const</TD></TR><TR><TD>void</TD><TD>setMinInterval(int minInterval)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>minIntervalChanged(int minInterval)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int minInterval READ minInterval WRITE setMinInterval NOTIFY minIntervalChanged)
+    /*!
+     * \brief Maximum time in seconds between two complete synchronizations.
+     *
+     * This is also the check interval of feeds that have less than two stored items. Defaults to \c 14400, the minimum
+     * value is \c 60. A changed value will be used by the next check.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>maxInterval() const</TD></TR><TR><TD>void</TD><TD>setMaxInterval(int maxInterval)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>maxIntervalChanged(int maxInterval)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int maxInterval READ maxInterval WRITE setMaxInterval NOTIFY maxIntervalChanged)
+    /*!
+     * \brief Maximum number of due feeds that are requested one by one.
+     *
+     * If more feeds are due at the same time, a complete synchronization is performed instead, because it needs
+     * less requests. Set this to \c 0 to always perform complete synchronizations. Defaults to \c 5.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>int</TD><TD>maxFeedRequests() const</TD></TR><TR><TD>void</TD><TD>setMaxFeedRequests(int maxFeedRequests)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>maxFeedRequestsChanged(int maxFeedRequests)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(int maxFeedRequests READ maxFeedRequests WRITE setMaxFeedRequests NOTIFY maxFeedRequestsChanged)
+    /*!
+     * \brief Returns \c true while the scheduler is started.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>bool</TD><TD>isActive() const</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>activeChanged(bool active)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(bool active READ isActive NOTIFY activeChanged)
+    /*!
+     * \brief Time of the next scheduled check.
+     *
+     * Invalid while the scheduler is stopped or waits for running requests.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>QDateTime</TD><TD>nextCheck() const</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>nextCheckChanged(const QDateTime &nextCheck)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(QDateTime nextCheck READ nextCheck NOTIFY nextCheckChanged)
+public:
+    /*!
+     * \brief Constructs a new SyncScheduler object with the given \a parent.
+     */
+    explicit SyncScheduler(QObject *parent = nullptr);
+
+    /*!
+     * \brief Destroys the SyncScheduler object.
+     */
+    ~SyncScheduler();
+
+    /*!
+     * \brief Getter function for the \link SyncScheduler::synchronizer synchronizer \endlink property.
+     * \sa setSynchronizer(), synchronizerChanged()
+     */
+    Synchronizer *synchronizer() const;
+
+    /*!
+     * \brief Setter function for the \link SyncScheduler::synchronizer synchronizer \endlink property.
+     * \sa synchronizer(), synchronizerChanged()
+     */
+    void setSynchronizer(Synchronizer *synchronizer);
+
+    /*!
+     * \brief Getter function for the \link SyncScheduler::minInterval minInterval \endlink property.
+     * \sa setMinInterval(), minIntervalChanged()
+     */
+    int minInterval() const;
+
+    /*!
+     * \brief Setter function for the \link SyncScheduler::minInterval minInterval \endlink property.
+     * \sa minInterval(), minIntervalChanged()
+     */
+    void setMinInterval(int minInterval);
+
+    /*!
+     * \brief Getter function for the \link SyncScheduler::maxInterval maxInterval \endlink property.
+     * \sa setMaxInterval(), maxIntervalChanged()
+     */
+    int maxInterval() const;
+
+    /*!
+     * \brief Setter function for the \link SyncScheduler::maxInterval maxInterval \endlink property.
+     * \sa maxInterval(), maxIntervalChanged()
+     */
+    void setMaxInterval(int maxInterval);
+
+    /*!
+     * \brief Getter function for the \link SyncScheduler::maxFeedRequests maxFeedRequests \endlink property.
+     * \sa setMaxFeedRequests(), maxFeedRequestsChanged()
+     */
+    int maxFeedRequests() const;
+
+    /*!
+     * \brief Setter function for the \link SyncScheduler::maxFeedRequests maxFeedRequests \endlink property.
+     * \sa maxFeedRequests(), maxFeedRequestsChanged()
+     */
+    void setMaxFeedRequests(int maxFeedRequests);
+
+    /*!
+     * \brief Getter function for the \link SyncScheduler::active active \endlink property.
+     * \sa activeChanged()
+     */
+    bool isActive() const;
+
+    /*!
+     * \brief Getter function for the \link SyncScheduler::nextCheck nextCheck \endlink property.
+     * \sa nextCheckChanged()
+     */
+    QDateTime nextCheck() const;
+
+    /*!
+     * \brief Returns the estimated check interval in seconds for the feed identified by \a feedId.
+     */
+    Q_INVOKABLE int feedInterval(qint64 feedId) const;
+
+public Q_SLOTS:
+    /*!
+     * \brief Loads the publication dates from the storage and starts the scheduling.
+     *
+     * Performs a complete synchronization right away if there has been none or if the last one is older than maxInterval.
+     */
+    void start();
+
+    /*!
+     * \brief Stops the scheduling. Running requests will be finished.
+     */
+    void stop();
+
+    /*!
+     * \brief Checks which feeds are due and requests their updates.
+     *
+     * This is called automatically at the time of nextCheck. Call it manually, for example when the network connection
+     * comes back after a longer offline period. Does nothing if the scheduler is not active or if a synchronization is
+     * still running.
+     */
+    void check();
+
+Q_SIGNALS:
+    /*!
+     * \brief Notifier signal for the \link SyncScheduler::synchronizer synchronizer \endlink property.
+     * \sa setSynchronizer(), synchronizer()
+     */
+    void synchronizerChanged(Synchronizer *synchronizer);
+
+    /*!
+     * \brief Notifier signal for the \link SyncScheduler::minInterval minInterval \endlink property.
+     * \sa setMinInterval(), minInterval()
+     */
+    void minIntervalChanged(int minInterval);
+
+    /*!
+     * \brief Notifier signal for the \link SyncScheduler::maxInterval maxInterval \endlink property.
+     * \sa setMaxInterval(), maxInterval()
+     */
+    void maxIntervalChanged(int maxInterval);
+
+    /*!
+     * \brief Notifier signal for the \link SyncScheduler::maxFeedRequests maxFeedRequests \endlink property.
+     * \sa setMaxFeedRequests(), maxFeedRequests()
+     */
+    void maxFeedRequestsChanged(int maxFeedRequests);
+
+    /*!
+     * \brief Notifier signal for the \link SyncScheduler::active active \endlink property.
+     * \sa isActive()
+     */
+    void activeChanged(bool active);
+
+    /*!
+     * \brief Notifier signal for the \link SyncScheduler::nextCheck nextCheck \endlink property.
+     * \sa nextCheck()
+     */
+    void nextCheckChanged(const QDateTime &nextCheck);
+
+    /*!
+     * \brief This is emitted after the updates of the feeds identified by \a feedIds have been requested one by one.
+     *
+     * Complete synchronizations are reported by Synchronizer::succeeded().
+     */
+    void feedsSynced(const Fuoten::IdList &feedIds);
+
+protected:
+    const QScopedPointer<SyncSchedulerPrivate> d_ptr;
+
+private:
+    Q_DISABLE_COPY(SyncScheduler)
+    Q_DECLARE_PRIVATE(SyncScheduler)
+};
+
+}
+
+#endif // FUOTENSYNCSCHEDULER_H
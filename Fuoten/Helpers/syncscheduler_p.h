@@ -0,0 +1,277 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENSYNCSCHEDULER_P_H
+#define FUOTENSYNCSCHEDULER_P_H
+
+#include "syncscheduler.h"
+#include "synchronizer.h"
+#include "abstractconfiguration.h"
+#include "../Storage/abstractstorage.h"
+#include "../API/getupdateditems.h"
+#include "../article.h"
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QPointer>
+#include <algorithm>
+#include <functional>
+
+namespace Fuoten {
+
+class SyncSchedulerPrivate
+{
+    Q_DECLARE_PUBLIC(SyncScheduler)
+public:
+    /*
+     * Number of publication dates per feed used to estimate the publish rate.
+     */
+    static const int publishDatesLimit = 20;
+
+    explicit SyncSchedulerPrivate(SyncScheduler *parent) :
+        q_ptr(parent)
+    {
+        timer.setSingleShot(true);
+        timer.setTimerType(Qt::VeryCoarseTimer);
+    }
+
+    ~SyncSchedulerPrivate() {}
+
+    static qint64 now()
+    {
+        return static_cast<qint64>(QDateTime::currentDateTimeUtc().toTime_t());
+    }
+
+    qint64 lastSync() const
+    {
+        AbstractConfiguration *config = synchronizer ? synchronizer->configuration() : nullptr;
+        const QDateTime ls = config ? config->getLastSync() : QDateTime();
+        return ls.isValid() ? static_cast<qint64>(ls.toTime_t()) : 0;
+    }
+
+    /*
+     * Feeds that have been updated on their own are newer than the last complete
+     * synchronization, that might also have been started outside of the scheduler.
+     */
+    qint64 lastFeedSync(qint64 feedId) const
+    {
+        return qMax(feedSyncs.value(feedId, 0), lastSync());
+    }
+
+    /*
+     * Feeds are checked twice per expected gap between two items. The expected gap is the
+     * average gap between the newest items, or the age of the newest item if that is older.
+     */
+    int interval(qint64 feedId, qint64 current) const
+    {
+        const QList<uint> dates = publishDates.value(feedId);
+        if (dates.size() < 2) {
+            return qMax(minInterval, maxInterval);
+        }
+
+        const qint64 newest = dates.first();
+        const qint64 gap = (newest - static_cast<qint64>(dates.last())) / (dates.size() - 1);
+        const qint64 expected = qMax(gap, current - newest);
+
+        return static_cast<int>(qMax<qint64>(minInterval, qMin<qint64>(expected / 2, maxInterval)));
+    }
+
+    void loadPublishDates()
+    {
+        AbstractStorage *storage = synchronizer ? synchronizer->storage() : nullptr;
+        if (storage) {
+            publishDates = storage->getPublishDates(publishDatesLimit);
+            qDebug("Loaded publication dates of %i feeds.", publishDates.size());
+        }
+    }
+
+    /*
+     * Adds the publication dates of received items to the learned dates of the feed.
+     */
+    void addPublishDates(qint64 feedId, const ItemRecords &items)
+    {
+        QList<uint> &dates = publishDates[feedId];
+        for (const ItemRecord &i : items) {
+            if (!dates.contains(i.pubDate)) {
+                dates.append(i.pubDate);
+            }
+        }
+        std::sort(dates.begin(), dates.end(), std::greater<uint>());
+        if (dates.size() > publishDatesLimit) {
+            dates.erase(dates.begin() + publishDatesLimit, dates.end());
+        }
+    }
+
+    /*
+     * Uploading the local queue is part of the complete synchronization, feed
+     * updates would overwrite local changes. The queue is looked up in the
+     * background, afterwards either all data or only the due feeds are synchronized.
+     */
+    void syncQueueOrFeeds(const IdList &due, qint64 current)
+    {
+        AbstractStorage *storage = synchronizer->storage();
+        if (!storage) {
+            syncFeeds(due, current);
+            return;
+        }
+
+        QueryArgs qa;
+        qa.queuedOnly = true;
+        qa.limit = 1;
+
+        queueQuery = true;
+
+        // not a child of the scheduler, the result has to be deleted even if the scheduler is gone
+        QFutureWatcher<ArticleList> *watcher = new QFutureWatcher<ArticleList>;
+        QPointer<SyncScheduler> guard(q_ptr);
+        QObject::connect(watcher, &QFutureWatcherBase::finished, watcher, [this, watcher, guard, due, current] () {
+            const ArticleList queued = watcher->result();
+            const bool hasQueued = !queued.isEmpty();
+            qDeleteAll(queued);
+            watcher->deleteLater();
+
+            if (!guard) {
+                return;
+            }
+
+            queueQuery = false;
+
+            // the scheduler might have been stopped or a synchronization started in the meantime
+            if (!active || !synchronizer || synchronizer->inOperation()) {
+                return;
+            }
+
+            if (hasQueued) {
+                syncAll();
+            } else {
+                syncFeeds(due, current);
+            }
+        });
+        watcher->setFuture(storage->getArticlesFuture(qa));
+    }
+
+    void scheduleAt(qint64 time)
+    {
+        const qint64 delay = qBound<qint64>(1, time - now(), maxInterval);
+        timer.start(static_cast<int>(delay * 1000));
+        setNextCheck(QDateTime::currentDateTimeUtc().addSecs(delay));
+        qDebug("Next synchronization check in %lli seconds.", delay);
+    }
+
+    void setNextCheck(const QDateTime &nNextCheck)
+    {
+        if (nNextCheck != nextCheck) {
+            Q_Q(SyncScheduler);
+            nextCheck = nNextCheck;
+            Q_EMIT q->nextCheckChanged(nextCheck);
+        }
+    }
+
+    void syncAll()
+    {
+        qDebug("%s", "Starting complete synchronization.");
+        timer.stop();
+        setNextCheck(QDateTime());
+        synchronizer->sync();
+    }
+
+    void syncFeeds(const IdList &feedIds, qint64 current)
+    {
+        Q_Q(SyncScheduler);
+
+        qDebug("Requesting updates of %i feeds.", feedIds.size());
+
+        timer.stop();
+        setNextCheck(QDateTime());
+        failedFeedRequests = 0;
+
+        for (qint64 feedId : feedIds) {
+            GetUpdatedItems *gui = new GetUpdatedItems(q);
+            gui->setConfiguration(synchronizer->configuration());
+            gui->setStorage(synchronizer->storage());
+            gui->setNotificator(synchronizer->notificator());
+            gui->setPriority(Component::BulkPriority);
+            gui->setType(FuotenEnums::Feed);
+            gui->setParentId(feedId);
+            gui->setLastModified(QDateTime::fromTime_t(static_cast<uint>(lastFeedSync(feedId))));
+            QObject::connect(gui, &Component::processed, q, [this, gui, feedId, current] () {
+                feedSyncs.insert(feedId, current);
+                addPublishDates(feedId, gui->itemRecords());
+                syncedFeeds.append(feedId);
+                feedRequestFinished(gui);
+            });
+            QObject::connect(gui, &Component::failed, q, [this, gui] () {
+                failedFeedRequests++;
+                feedRequestFinished(gui);
+            });
+            feedRequests.append(gui);
+            gui->execute();
+        }
+    }
+
+    /*
+     * Failed feeds keep their last update time, so they would be due again right
+     * away. After a failure the next check waits for the minimum interval.
+     */
+    void feedRequestFinished(GetUpdatedItems *gui)
+    {
+        feedRequests.removeOne(gui);
+        gui->deleteLater();
+
+        if (!feedRequests.isEmpty()) {
+            return;
+        }
+
+        Q_Q(SyncScheduler);
+
+        if (!syncedFeeds.isEmpty()) {
+            const IdList synced = syncedFeeds;
+            syncedFeeds.clear();
+            Q_EMIT q->feedsSynced(synced);
+        }
+
+        if (failedFeedRequests > 0) {
+            qWarning("Failed to request the updates of %i feeds.", failedFeedRequests);
+            if (active) {
+                scheduleAt(now() + minInterval);
+            }
+        } else {
+            q->check();
+        }
+    }
+
+    SyncScheduler * const q_ptr;
+    QPointer<Synchronizer> synchronizer;
+    QTimer timer;
+    QHash<qint64, QList<uint>> publishDates;
+    QHash<qint64, qint64> feedSyncs;
+    QList<GetUpdatedItems*> feedRequests;
+    IdList syncedFeeds;
+    QDateTime nextCheck;
+    int minInterval = 900;
+    int maxInterval = 14400;
+    int maxFeedRequests = 5;
+    int failedFeedRequests = 0;
+    bool active = false;
+    bool queueQuery = false;
+};
+
+}
+
+#endif // FUOTENSYNCSCHEDULER_P_H
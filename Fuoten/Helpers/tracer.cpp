@@ -0,0 +1,272 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "tracer.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QHash>
+#include <QThread>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QFile>
+#include <QAtomicInt>
+#include <chrono>
+
+using namespace Fuoten;
+
+namespace {
+
+struct TraceEvent {
+    QString name;
+    QVariantMap args;
+    const char *category;
+    qint64 begin;
+    qint64 end;
+    quint64 id;
+    int tid;
+    char phase;
+};
+
+class TracerData
+{
+public:
+    /*
+     * Returns the small trace ID of the current thread. Threads are named
+     * after their object name or their class, so that the worker threads of
+     * the storage can be identified in the trace viewer.
+     */
+    int currentTid()
+    {
+        const Qt::HANDLE handle = QThread::currentThreadId();
+        auto it = tids.constFind(handle);
+        if (it != tids.constEnd()) {
+            return it.value();
+        }
+
+        const int tid = tids.size() + 1;
+        tids.insert(handle, tid);
+
+        QString name;
+        QThread *t = QThread::currentThread();
+        if (QCoreApplication::instance() && (t == QCoreApplication::instance()->thread())) {
+            name = QStringLiteral("main");
+        } else if (t && !t->objectName().isEmpty()) {
+            name = t->objectName();
+        } else if (t) {
+            name = QString::fromLatin1(t->metaObject()->className());
+        }
+        threadNames.insert(tid, name);
+
+        return tid;
+    }
+
+    void add(TraceEvent &e)
+    {
+        QMutexLocker locker(&mutex);
+        if (events.size() >= maxEvents) {
+            return;
+        }
+        e.tid = currentTid();
+        events.append(e);
+    }
+
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    QHash<Qt::HANDLE, int> tids;
+    QHash<int, QString> threadNames;
+    int maxEvents = 1000000;
+};
+
+QBasicAtomicInt tracerEnabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+}
+
+Q_GLOBAL_STATIC(TracerData, tracerData)
+
+
+void Tracer::setEnabled(bool enabled)
+{
+    qDebug("Setting tracer enabled to %s.", enabled ? "true" : "false");
+    tracerEnabled.storeRelease(enabled ? 1 : 0);
+}
+
+
+bool Tracer::isEnabled()
+{
+    return tracerEnabled.load() != 0;
+}
+
+
+void Tracer::setMaxEvents(int max)
+{
+    TracerData *data = tracerData();
+    QMutexLocker locker(&data->mutex);
+    data->maxEvents = max;
+}
+
+
+int Tracer::maxEvents()
+{
+    TracerData *data = tracerData();
+    QMutexLocker locker(&data->mutex);
+    return data->maxEvents;
+}
+
+
+qint64 Tracer::timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void Tracer::addSpan(const char *category, const QString &name, qint64 begin, qint64 end, const QVariantMap &args)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    TraceEvent e{name, args, category, begin, end, 0, 0, 'X'};
+    tracerData()->add(e);
+}
+
+
+void Tracer::addAsyncSpan(const char *category, const QString &name, quint64 id, qint64 begin, qint64 end, const QVariantMap &args)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    TraceEvent e{name, args, category, begin, end, id, 0, 'b'};
+    tracerData()->add(e);
+}
+
+
+void Tracer::clear()
+{
+    TracerData *data = tracerData();
+    QMutexLocker locker(&data->mutex);
+    data->events.clear();
+}
+
+
+QByteArray Tracer::toJson()
+{
+    TracerData *data = tracerData();
+    QMutexLocker locker(&data->mutex);
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray events;
+
+    for (auto it = data->threadNames.constBegin(); it != data->threadNames.constEnd(); ++it) {
+        QJsonObject o;
+        o.insert(QStringLiteral("name"), QStringLiteral("thread_name"));
+        o.insert(QStringLiteral("ph"), QStringLiteral("M"));
+        o.insert(QStringLiteral("pid"), pid);
+        o.insert(QStringLiteral("tid"), it.key());
+        QJsonObject args;
+        args.insert(QStringLiteral("name"), it.value());
+        o.insert(QStringLiteral("args"), args);
+        events.append(o);
+    }
+
+    for (const TraceEvent &e : qAsConst(data->events)) {
+        QJsonObject o;
+        o.insert(QStringLiteral("name"), e.name);
+        o.insert(QStringLiteral("cat"), QString::fromLatin1(e.category));
+        o.insert(QStringLiteral("pid"), pid);
+        o.insert(QStringLiteral("tid"), e.tid);
+        o.insert(QStringLiteral("ts"), e.begin);
+        if (!e.args.isEmpty()) {
+            o.insert(QStringLiteral("args"), QJsonObject::fromVariantMap(e.args));
+        }
+        if (e.phase == 'X') {
+            o.insert(QStringLiteral("ph"), QStringLiteral("X"));
+            o.insert(QStringLiteral("dur"), e.end - e.begin);
+            events.append(o);
+        } else {
+            const QString id = QString::number(e.id, 16);
+            o.insert(QStringLiteral("ph"), QStringLiteral("b"));
+            o.insert(QStringLiteral("id"), id);
+            events.append(o);
+            o.remove(QStringLiteral("args"));
+            o.insert(QStringLiteral("ph"), QStringLiteral("e"));
+            o.insert(QStringLiteral("ts"), e.end);
+            events.append(o);
+        }
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), events);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+
+bool Tracer::save(const QString &fileName)
+{
+    QFile f(fileName);
+    if (Q_UNLIKELY(!f.open(QIODevice::WriteOnly|QIODevice::Truncate))) {
+        qWarning("Failed to open %s to write the trace: %s", qUtf8Printable(fileName), qUtf8Printable(f.errorString()));
+        return false;
+    }
+
+    const QByteArray json = toJson();
+    if (Q_UNLIKELY(f.write(json) != json.size())) {
+        qWarning("Failed to write the trace to %s: %s", qUtf8Printable(fileName), qUtf8Printable(f.errorString()));
+        return false;
+    }
+
+    return true;
+}
+
+
+TraceSpan::TraceSpan(const char *category, const char *name) :
+    m_category(category), m_name(name), m_begin(Tracer::isEnabled() ? Tracer::timestamp() : -1)
+{
+
+}
+
+
+TraceSpan::~TraceSpan()
+{
+    end();
+}
+
+
+void TraceSpan::setArg(const QString &key, const QVariant &value)
+{
+    if (m_begin > -1) {
+        m_args.insert(key, value);
+    }
+}
+
+
+void TraceSpan::end()
+{
+    if (m_begin > -1) {
+        Tracer::addSpan(m_category, QString::fromLatin1(m_name), m_begin, Tracer::timestamp(), m_args);
+        m_begin = -1;
+    }
+}
@@ -0,0 +1,181 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENTRACER_H
+#define FUOTENTRACER_H
+
+#include <QString>
+#include <QVariantMap>
+#include <QByteArray>
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+/*!
+ * \brief Records timing spans of a synchronization that can be inspected in a trace viewer.
+ *
+ * If enabled, the Synchronizer records a span for the complete run and for every stage, every Component records
+ * a span for every request attempt and the SQLiteStorage records spans for its worker threads and their database
+ * transactions. Every span contains the thread it has been recorded in. The recorded spans can be written in the
+ * Chrome trace event format via save() or toJson() and can be opened in \c chrome://tracing or Perfetto.
+ *
+ * Tracing is disabled by default. While disabled, recording a span only costs an atomic read, so the trace points
+ * can stay in production code. The recorded spans are kept in memory until clear() is called. To limit the memory
+ * usage, no more spans are recorded after maxEvents() has been reached.
+ *
+ * \code
+ * Fuoten::Tracer::setEnabled(true);
+ * sync->start();
+ * // after the synchronization has finished
+ * Fuoten::Tracer::save(QStringLiteral("/tmp/sync.json"));
+ * \endcode
+ *
+ * All functions are thread-safe.
+ *
+ * \headerfile "" <Fuoten/Helpers/Tracer>
+ */
+class FUOTENSHARED_EXPORT Tracer
+{
+public:
+    /*!
+     * \brief Set \a enabled to \c true to start recording spans.
+     *
+     * Already recorded spans are kept when disabling the tracer.
+     * \sa isEnabled()
+     */
+    static void setEnabled(bool enabled);
+
+    /*!
+     * \brief Returns \c true if spans are recorded.
+     * \sa setEnabled()
+     */
+    static bool isEnabled();
+
+    /*!
+     * \brief Sets the maximum number of recorded trace events to \a max.
+     *
+     * Defaults to \c 1000000, what needs round about 100 MiB of memory.
+     * \sa maxEvents()
+     */
+    static void setMaxEvents(int max);
+
+    /*!
+     * \brief Returns the maximum number of recorded trace events.
+     * \sa setMaxEvents()
+     */
+    static int maxEvents();
+
+    /*!
+     * \brief Returns the current time in microseconds on the clock of the tracer.
+     *
+     * Use it to get the \a begin and \a end values for addSpan() and addAsyncSpan().
+     */
+    static qint64 timestamp();
+
+    /*!
+     * \brief Records a span in the current thread.
+     *
+     * \a category is used by the trace viewers to filter the spans, \a name is shown as label, \a begin and \a end
+     * are values returned by timestamp(). The optional \a args are shown when selecting the span. Spans recorded
+     * in the same thread have to be nested or must not overlap, use addAsyncSpan() otherwise.
+     */
+    static void addSpan(const char *category, const QString &name, qint64 begin, qint64 end, const QVariantMap &args = QVariantMap());
+
+    /*!
+     * \brief Records an asynchronous span in the current thread.
+     *
+     * Asynchronous spans can overlap other spans, like network requests that are running in parallel in the
+     * same thread. Spans with the same \a category and \a id are shown in the same row, \a id has to be unique
+     * for spans that are overlapping. See addSpan() for the other parameters.
+     */
+    static void addAsyncSpan(const char *category, const QString &name, quint64 id, qint64 begin, qint64 end, const QVariantMap &args = QVariantMap());
+
+    /*!
+     * \brief Removes all recorded spans.
+     */
+    static void clear();
+
+    /*!
+     * \brief Returns the recorded spans as Chrome trace event JSON document.
+     */
+    static QByteArray toJson();
+
+    /*!
+     * \brief Writes the recorded spans as Chrome trace event JSON document to \a fileName.
+     *
+     * Returns \c false if the file could not be written.
+     */
+    static bool save(const QString &fileName);
+
+private:
+    Tracer() = delete;
+};
+
+
+/*!
+ * \brief Records a span from its construction to its destruction or to the call of end().
+ *
+ * Does nothing if the Tracer was disabled while constructing the object.
+ *
+ * \code
+ * void ItemsWorker::run()
+ * {
+ *     Fuoten::TraceSpan span("storage", "ItemsWorker");
+ *     // ...
+ * }
+ * \endcode
+ *
+ * \headerfile "" <Fuoten/Helpers/Tracer>
+ */
+class FUOTENSHARED_EXPORT TraceSpan
+{
+    Q_DISABLE_COPY(TraceSpan)
+public:
+    /*!
+     * \brief Starts a new span with the given \a category and \a name.
+     *
+     * Both pointers have to be valid until the span has been finished, string literals should be used.
+     */
+    TraceSpan(const char *category, const char *name);
+
+    /*!
+     * \brief Finishes the span if end() has not been called.
+     */
+    ~TraceSpan();
+
+    /*!
+     * \brief Adds an argument with \a key and \a value to the span.
+     */
+    void setArg(const QString &key, const QVariant &value);
+
+    /*!
+     * \brief Finishes the span.
+     */
+    void end();
+
+private:
+    QVariantMap m_args;
+    const char *m_category;
+    const char *m_name;
+    qint64 m_begin;
+};
+
+}
+
+#endif // FUOTENTRACER_H
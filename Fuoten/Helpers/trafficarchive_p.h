@@ -0,0 +1,82 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENTRAFFICARCHIVE_P_H
+#define FUOTENTRAFFICARCHIVE_P_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDataStream>
+#include <QUrl>
+
+namespace Fuoten {
+
+/*
+ * A request and its reply in the archives written by TrafficRecorder and read
+ * by ReplayNamFactory.
+ *
+ * The archive starts with the magic number and the format version, followed
+ * by the records in the order the replies have been received. The route
+ * contains the API route and the URL query, but neither the host nor any
+ * credentials. The bodies are stored compressed with qCompress().
+ */
+struct TrafficRecord
+{
+    static const quint32 magic = 0x46545243; // FTRC
+    static const quint16 version = 1;
+
+    QString method;
+    QString route;
+    QByteArray requestBody;
+    QByteArray contentType;
+    QByteArray responseBody;
+    qint32 httpStatus = 0;
+
+    /*
+     * Returns the API route and the query of the request url, that is used
+     * to match replayed requests.
+     */
+    static QString routeFromUrl(const QUrl &url)
+    {
+        static const QString apiPath = QStringLiteral("/index.php/apps/news/api/v1-2");
+        const QString path = url.path(QUrl::FullyEncoded);
+        const int idx = path.indexOf(apiPath);
+        QString r = (idx < 0) ? path : path.mid(idx + apiPath.size());
+        if (url.hasQuery()) {
+            r.append(QLatin1Char('?')).append(url.query(QUrl::FullyEncoded));
+        }
+        return r;
+    }
+};
+
+inline QDataStream &operator<<(QDataStream &stream, const TrafficRecord &r)
+{
+    stream << r.method << r.route << r.requestBody << r.httpStatus << r.contentType << r.responseBody;
+    return stream;
+}
+
+inline QDataStream &operator>>(QDataStream &stream, TrafficRecord &r)
+{
+    stream >> r.method >> r.route >> r.requestBody >> r.httpStatus >> r.contentType >> r.responseBody;
+    return stream;
+}
+
+}
+
+#endif // FUOTENTRAFFICARCHIVE_P_H
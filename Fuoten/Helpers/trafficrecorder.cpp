@@ -0,0 +1,128 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "trafficrecorder.h"
+#include "trafficarchive_p.h"
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace Fuoten {
+
+class TrafficRecorderPrivate
+{
+public:
+    QFile file;
+    QDataStream stream;
+    mutable QMutex mutex;
+    int count = 0;
+};
+
+}
+
+using namespace Fuoten;
+
+TrafficRecorder::TrafficRecorder() :
+    d_ptr(new TrafficRecorderPrivate)
+{
+
+}
+
+
+TrafficRecorder::~TrafficRecorder()
+{
+    close();
+}
+
+
+bool TrafficRecorder::open(const QString &fileName)
+{
+    Q_D(TrafficRecorder);
+    QMutexLocker locker(&d->mutex);
+
+    if (d->file.isOpen()) {
+        d->file.close();
+    }
+
+    d->file.setFileName(fileName);
+    if (Q_UNLIKELY(!d->file.open(QIODevice::WriteOnly|QIODevice::Truncate))) {
+        qWarning("Failed to open traffic archive %s: %s", qUtf8Printable(fileName), qUtf8Printable(d->file.errorString()));
+        return false;
+    }
+
+    d->stream.setDevice(&d->file);
+    d->stream.setVersion(QDataStream::Qt_5_6);
+    d->stream << TrafficRecord::magic << TrafficRecord::version;
+    d->count = 0;
+
+    qDebug("Recording traffic to %s.", qUtf8Printable(fileName));
+
+    return true;
+}
+
+
+void TrafficRecorder::close()
+{
+    Q_D(TrafficRecorder);
+    QMutexLocker locker(&d->mutex);
+
+    if (d->file.isOpen()) {
+        d->stream.setDevice(nullptr);
+        d->file.close();
+        qDebug("Closed traffic archive with %i records.", d->count);
+    }
+}
+
+
+bool TrafficRecorder::isOpen() const
+{
+    Q_D(const TrafficRecorder);
+    QMutexLocker locker(&d->mutex);
+    return d->file.isOpen();
+}
+
+
+int TrafficRecorder::count() const
+{
+    Q_D(const TrafficRecorder);
+    QMutexLocker locker(&d->mutex);
+    return d->count;
+}
+
+
+void TrafficRecorder::record(const QString &method, const QString &route, const QByteArray &requestBody, int httpStatus, const QByteArray &contentType, const QByteArray &responseBody)
+{
+    TrafficRecord r;
+    r.method = method;
+    r.route = route;
+    r.requestBody = qCompress(requestBody);
+    r.httpStatus = httpStatus;
+    r.contentType = contentType;
+    r.responseBody = qCompress(responseBody);
+
+    Q_D(TrafficRecorder);
+    QMutexLocker locker(&d->mutex);
+
+    if (!d->file.isOpen()) {
+        return;
+    }
+
+    d->stream << r;
+    d->count++;
+}
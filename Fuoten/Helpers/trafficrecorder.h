@@ -0,0 +1,107 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENTRAFFICRECORDER_H
+#define FUOTENTRAFFICRECORDER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QScopedPointer>
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+class TrafficRecorderPrivate;
+
+/*!
+ * \brief Writes the requests and replies of all API classes to an archive file.
+ *
+ * Set the recorder via Component::setDefaultTrafficRecorder() to capture the traffic of a real
+ * synchronization, that can be replayed later with ReplayNamFactory to compare the throughput of
+ * different builds of the storage and the models with the same data.
+ *
+ * The archive contains the HTTP method, the API route with the URL query, the request body, the
+ * HTTP status code, the content type and the reply body of every request that got a reply from the
+ * server. Neither the host name nor the user name, the password or any other request header is
+ * written. The bodies are compressed.
+ *
+ * All functions are thread-safe.
+ *
+ * \code{.cpp}
+ * TrafficRecorder *recorder = new TrafficRecorder;
+ * if (recorder->open(QStringLiteral("/tmp/sync.fuotentraffic"))) {
+ *     Component::setDefaultTrafficRecorder(recorder);
+ * }
+ * \endcode
+ *
+ * \headerfile "" <Fuoten/Helpers/TrafficRecorder>
+ */
+class FUOTENSHARED_EXPORT TrafficRecorder
+{
+    Q_DISABLE_COPY(TrafficRecorder)
+public:
+    /*!
+     * \brief Constructs a new TrafficRecorder.
+     */
+    TrafficRecorder();
+
+    /*!
+     * \brief Closes the archive and destroys the TrafficRecorder.
+     */
+    ~TrafficRecorder();
+
+    /*!
+     * \brief Opens the archive \a fileName for writing.
+     *
+     * An existing file will be overwritten. Returns \c false if the file could not be opened.
+     */
+    bool open(const QString &fileName);
+
+    /*!
+     * \brief Flushes and closes the archive.
+     */
+    void close();
+
+    /*!
+     * \brief Returns \c true if the archive is open for writing.
+     */
+    bool isOpen() const;
+
+    /*!
+     * \brief Returns the number of records written to the current archive.
+     */
+    int count() const;
+
+    /*!
+     * \brief Writes a record to the archive.
+     *
+     * \a method is the HTTP method, \a route the API route including the URL query, like
+     * <TT>/items?type=3</TT>. \a requestBody is the payload of the request, \a httpStatus, \a contentType
+     * and \a responseBody describe the reply. Called by Component for every received reply.
+     */
+    void record(const QString &method, const QString &route, const QByteArray &requestBody, int httpStatus, const QByteArray &contentType, const QByteArray &responseBody);
+
+private:
+    const QScopedPointer<TrafficRecorderPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(TrafficRecorder)
+};
+
+}
+
+#endif // FUOTENTRAFFICRECORDER_H
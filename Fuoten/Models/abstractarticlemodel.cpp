@@ -86,7 +86,6 @@ void AbstractArticleModel::handleStorageChanged(AbstractStorage *old)
     AbstractStorage *s = storage();
 
     if (s) {
-        connect(s, &AbstractStorage::gotArticlesAsync, this, &AbstractArticleModel::gotArticlesAsync);
         connect(s, &AbstractStorage::requestedItems, this, &AbstractArticleModel::itemsRequested);
         connect(s, &AbstractStorage::markedReadFolder, this, &AbstractArticleModel::folderMarkedRead);
         connect(s, &AbstractStorage::markedReadFolderInQueue, this, &AbstractArticleModel::folderMarkedReadInQueue);
@@ -101,6 +100,7 @@ void AbstractArticleModel::handleStorageChanged(AbstractStorage *old)
         connect(s, &AbstractStorage::markedAllItemsRead, this, &AbstractArticleModel::allItemsMarkedRead);
         connect(s, &AbstractStorage::markedAllItemsReadInQueue, this, &AbstractArticleModel::allItemsMarkedReadInQueue);
         connect(s, &AbstractStorage::queueCleared, this, &AbstractArticleModel::queueCleared);
+        connect(s, &AbstractStorage::dequeuedItems, this, &AbstractArticleModel::itemsDequeued);
     }
 }
 
@@ -109,12 +109,18 @@ void AbstractArticleModel::load()
 {
     Q_ASSERT_X(storage(), "load articles", "no storage available");
 
-    if (!storage()->ready() || loaded() || inOperation()) {
+    Q_D(AbstractArticleModel);
+
+    // a running query is only waited for if the rows have not been cleared since it has been started
+    if (!storage()->ready() || loaded() || (inOperation() && (d->loadSeq == d->rowsSeq))) {
         return;
     }
 
     setInOperation(true);
 
+    d->loadSeq = d->rowsSeq;
+    const quint64 seq = d->rowsSeq;
+
     QueryArgs qa;
     qa.sortingRole = sortingRole();
     qa.sortOrder = sortOrder();
@@ -126,7 +132,17 @@ void AbstractArticleModel::load()
         qa.starredOnly = true;
     }
 
-    storage()->getArticlesAsync(qa);
+    whenFinished(this, storage()->getArticlesFuture(qa), [this, seq] (const ArticleList &articles) {
+        Q_D(AbstractArticleModel);
+        if (seq != d->rowsSeq) {
+            qDeleteAll(articles);
+            if (seq == d->loadSeq) {
+                setInOperation(false);
+            }
+            return;
+        }
+        gotArticlesAsync(articles);
+    });
 }
 
 
@@ -220,6 +236,10 @@ void AbstractArticleModel::clear()
 {
     Q_D(AbstractArticleModel);
 
+    // results of running queries belong to the old rows
+    ++d->rowsSeq;
+    d->itemQueries.clear();
+
     if (Q_LIKELY(!d->articles.isEmpty())) {
 
         beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
@@ -236,7 +256,8 @@ void AbstractArticleModel::itemsRequested(const IdList &updatedItems, const IdLi
 {
     Q_ASSERT_X(storage(), "update articles", "no storage available");
 
-    if (rowCount() == 0) {
+    // a running initial query might not contain the changes yet
+    if (!loaded()) {
         reload();
         return;
     }
@@ -258,17 +279,25 @@ void AbstractArticleModel::itemsRequested(const IdList &updatedItems, const IdLi
             if ((parentId() < 0) && (parentIdType() == FuotenEnums::Starred)) {
                 qa.starredOnly = true;
             }
-            const QList<Article*> upits = storage()->getArticles(qa);
 
-            if (!upits.isEmpty()) {
-                for (Article *a : upits) {
+            const quint64 seq = d->registerItemQuery(qa.inIds);
 
-                    QModelIndex idx = idxs.value(a->id());
-                    d->articles.at(idx.row())->copy(a);
-                    Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
+            whenFinished(this, storage()->getArticlesFuture(qa), [this, seq, qa] (const ArticleList &upits) {
+                Q_D(AbstractArticleModel);
+                for (Article *a : upits) {
+                    if (!d->takeItemQuery(a->id(), seq)) {
+                        continue;
+                    }
+                    // the rows might have changed while the query was running
+                    QModelIndex idx = findByID(a->id());
+                    if (idx.isValid()) {
+                        d->articles.at(idx.row())->copy(a);
+                        Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
+                    }
                 }
+                d->releaseItemQuery(qa.inIds, seq);
                 qDeleteAll(upits);
-            }
+            });
         }
     }
 
@@ -283,16 +312,33 @@ void AbstractArticleModel::itemsRequested(const IdList &updatedItems, const IdLi
         if ((parentId() < 0) && (parentIdType() == FuotenEnums::Starred)) {
             qa.starredOnly = true;
         }
-        const QList<Article*> newits = storage()->getArticles(qa);
 
-        if (!newits.isEmpty()) {
+        const quint64 seq = d->registerItemQuery(newItems);
 
-            beginInsertRows(QModelIndex(), rowCount(), rowCount() + newits.count() -1);
+        whenFinished(this, storage()->getArticlesFuture(qa), [this, seq, newItems] (const ArticleList &newits) {
 
-            d->articles.append(newits);
+            Q_D(AbstractArticleModel);
 
-            endInsertRows();
-        }
+            ArticleList insert;
+            for (Article *a : newits) {
+                // a newer query or a reload might already have added the article
+                if (d->takeItemQuery(a->id(), seq) && (d->rowByID(a->id()) < 0)) {
+                    insert.append(a);
+                } else {
+                    delete a;
+                }
+            }
+            d->releaseItemQuery(newItems, seq);
+
+            if (!insert.isEmpty()) {
+
+                beginInsertRows(QModelIndex(), rowCount(), rowCount() + insert.count() -1);
+
+                d->articles.append(insert);
+
+                endInsertRows();
+            }
+        });
     }
 
     if (!deletedItems.isEmpty()) {
@@ -653,4 +699,93 @@ void AbstractArticleModel::queueCleared()
     }
 }
 
+
+void AbstractArticleModel::itemsDequeued(const IdList &itemIds, FuotenEnums::QueueActions actions)
+{
+    if (rowCount() <= 0) {
+        return;
+    }
+
+    Q_D(AbstractArticleModel);
+
+    const QHash<qint64, QModelIndex> idxs = findByIDs(itemIds);
+
+    for (const QModelIndex &idx : idxs) {
+        Article *a = d->articles.at(idx.row());
+        a->setQueue(a->queue() & ~static_cast<int>(actions));
+    }
+}
+
+
+bool AbstractArticleModel::applyChanges(const QList<StorageChange> &changes)
+{
+    for (const StorageChange &c : changes) {
+
+        switch (c.type) {
+        case FuotenEnums::Item:
+            switch (c.operation) {
+            case StorageChange::Created:
+                itemsRequested(IdList(), c.ids, IdList());
+                break;
+            case StorageChange::Updated:
+            case StorageChange::Dequeued:
+                // the change does not contain the removed queue actions, so the items are requested again
+                itemsRequested(c.ids, IdList(), IdList());
+                break;
+            case StorageChange::Deleted:
+                itemsRequested(IdList(), IdList(), c.ids);
+                break;
+            case StorageChange::MarkedRead:
+            case StorageChange::MarkedUnread:
+                itemsMarked(c.ids, c.operation == StorageChange::MarkedUnread);
+                break;
+            case StorageChange::Starred:
+            case StorageChange::Unstarred:
+                itemsStarred(c.articles, c.operation == StorageChange::Starred);
+                break;
+            default:
+                return false;
+            }
+            break;
+        case FuotenEnums::Folder:
+            for (qint64 id : c.ids) {
+                if (c.operation == StorageChange::MarkedRead && c.queued) {
+                    folderMarkedReadInQueue(id, c.newestItemId);
+                } else if (c.operation == StorageChange::MarkedRead) {
+                    folderMarkedRead(id, c.newestItemId);
+                } else if (c.operation == StorageChange::Deleted) {
+                    folderDeleted(id);
+                }
+            }
+            break;
+        case FuotenEnums::Feed:
+            for (qint64 id : c.ids) {
+                if (c.operation == StorageChange::MarkedRead && c.queued) {
+                    feedMarkedReadInQueue(id, c.newestItemId);
+                } else if (c.operation == StorageChange::MarkedRead) {
+                    feedMarkedRead(id, c.newestItemId);
+                } else if (c.operation == StorageChange::Deleted) {
+                    feedDeleted(id);
+                }
+            }
+            break;
+        case FuotenEnums::All:
+            if (c.operation == StorageChange::MarkedRead && c.queued) {
+                allItemsMarkedReadInQueue();
+            } else if (c.operation == StorageChange::MarkedRead) {
+                allItemsMarkedRead(c.newestItemId);
+            } else if (c.operation == StorageChange::QueueCleared) {
+                queueCleared();
+            } else {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
 #include "moc_abstractarticlemodel.cpp"
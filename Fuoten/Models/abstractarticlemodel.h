@@ -301,6 +301,14 @@ protected Q_SLOTS:
      */
     void queueCleared();
 
+    /*!
+     * \brief Updates the model after queue actions have been removed from some items.
+     *
+     * Will remove the \a actions from the Article::queue property of the articles identified by \a itemIds.
+     * handleStorageChanged() will connect the AbstractStorage::dequeuedItems() signal to this slot.
+     */
+    void itemsDequeued(const IdList &itemIds, FuotenEnums::QueueActions actions);
+
 protected:
     AbstractArticleModel(AbstractArticleModelPrivate &dd, QObject *parent = nullptr);
 
@@ -319,6 +327,11 @@ protected:
      */
     void clear() override;
 
+    /*!
+     * \brief Applies the article related storage \a changes recorded while the model has been paused.
+     */
+    bool applyChanges(const QList<StorageChange> &changes) override;
+
 private:
     Q_DECLARE_PRIVATE(AbstractArticleModel)
     Q_DISABLE_COPY(AbstractArticleModel)
@@ -23,6 +23,7 @@
 #include "abstractarticlemodel.h"
 #include "basemodel_p.h"
 #include "../article.h"
+#include <QHash>
 
 namespace Fuoten {
 
@@ -79,7 +80,49 @@ public:
         return idx;
     }
 
+    /*
+     * Registers a query for the articles identified by ids and returns its
+     * sequence number. Only the result of the latest query for an article is
+     * applied, so that results arriving out of order do not overwrite newer ones.
+     */
+    quint64 registerItemQuery(const IdList &ids) {
+        const quint64 seq = ++lastQuerySeq;
+        for (qint64 id : ids) {
+            itemQueries.insert(id, seq);
+        }
+        return seq;
+    }
+
+    /*
+     * Returns true if seq is the latest query for the article identified by id
+     * and unregisters the query.
+     */
+    bool takeItemQuery(qint64 id, quint64 seq) {
+        if (itemQueries.value(id) != seq) {
+            return false;
+        }
+        itemQueries.remove(id);
+        return true;
+    }
+
+    /*
+     * Unregisters the query seq for the articles that were not part of its result.
+     */
+    void releaseItemQuery(const IdList &ids, quint64 seq) {
+        for (qint64 id : ids) {
+            if (itemQueries.value(id) == seq) {
+                itemQueries.remove(id);
+            }
+        }
+    }
+
     QList<Article*> articles;
+    QHash<qint64, quint64> itemQueries;
+    quint64 lastQuerySeq = 0;
+    // sequence number of the rows, changed by clear() to discard the results of running queries
+    quint64 rowsSeq = 0;
+    // rowsSeq at the time the running load() query has been started
+    quint64 loadSeq = 0;
     int bodyLimit = -1;
     FuotenEnums::Type parentIdType = FuotenEnums::All;
     bool starredOnly = false;
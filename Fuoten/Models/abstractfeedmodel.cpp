@@ -74,7 +74,7 @@ void AbstractFeedModel::load()
 {
     Q_ASSERT_X(storage(), "load feed model", "no storage available");
 
-    if (!storage()->ready() || loaded()) {
+    if (!storage()->ready() || loaded() || inOperation()) {
         return;
     }
 
@@ -85,26 +85,26 @@ void AbstractFeedModel::load()
     qa.sortingRole = sortingRole();
     qa.sortOrder = sortOrder();
 
-    const QList<Feed*> fs = storage()->getFeeds(qa);
+    whenFinished(this, storage()->getFeedsAsync(qa), [this] (const QList<Feed*> &fs) {
+        if (!fs.isEmpty()) {
 
-    if (!fs.isEmpty()) {
+            qDebug("Start inserting %u feeds into the model.", fs.size());
 
-        qDebug("Start inserting %u feeds into the model.", fs.size());
-
-        Q_D(AbstractFeedModel);
+            Q_D(AbstractFeedModel);
 
-        beginInsertRows(QModelIndex(), 0, fs.size() - 1);
+            beginInsertRows(QModelIndex(), 0, fs.size() - 1);
 
-        d->feeds = fs;
+            d->feeds = fs;
 
-        endInsertRows();
+            endInsertRows();
 
-        qDebug("Finished inserting %u feeds into the model.", fs.size());
-    }
+            qDebug("Finished inserting %u feeds into the model.", fs.size());
+        }
 
-    setLoaded(true);
+        setLoaded(true);
 
-    setInOperation(false);
+        setInOperation(false);
+    });
 }
 
 
@@ -179,45 +179,49 @@ void AbstractFeedModel::feedsRequested(const IdList &updatedFeeds, const IdList
             QueryArgs qa;
             qa.inIds = updIxs.keys();
             qa.inIdsType = FuotenEnums::Feed;
-            const QList<Feed*> ufs = storage()->getFeeds(qa);
 
-            if (!ufs.isEmpty()) {
+            whenFinished(this, storage()->getFeedsAsync(qa), [this] (const QList<Feed*> &ufs) {
+                if (!ufs.isEmpty()) {
+
+                    Q_D(AbstractFeedModel);
 
-                IdList movedIds;
+                    IdList movedIds;
 
-                for (Feed *f : ufs) {
-                    QModelIndex idx = updIxs.value(f->id());
+                    for (Feed *f : ufs) {
+                        // the rows might have changed while the query was running
+                        QModelIndex idx = findByID(f->id());
 
-                    if (idx.isValid()) {
-                        Feed *mf = d->feeds.at(idx.row());
+                        if (idx.isValid()) {
+                            Feed *mf = d->feeds.at(idx.row());
 
-                        if ((parentId() < 0) || (f->folderId() == parentId())) {
-                            // the feed has not moved, let's copy the new data
-                            mf->copy(f);
-                        } else {
-                            // the feed is not longer part of this folder
-                            movedIds.append(f->id()); //clazy:exclude=reserve-candidates
+                            if ((parentId() < 0) || (f->folderId() == parentId())) {
+                                // the feed has not moved, let's copy the new data
+                                mf->copy(f);
+                            } else {
+                                // the feed is not longer part of this folder
+                                movedIds.append(f->id()); //clazy:exclude=reserve-candidates
+                            }
+                            Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
                         }
-                        Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
                     }
-                }
-                qDeleteAll(ufs);
+                    qDeleteAll(ufs);
 
-                // remove moved feeds from the model
-                if (!movedIds.isEmpty()) {
-                    for (qint64 mid : movedIds) {
-                        int row = d->rowByID(mid);
-                        if (row > -1) {
+                    // remove moved feeds from the model
+                    if (!movedIds.isEmpty()) {
+                        for (qint64 mid : movedIds) {
+                            int row = d->rowByID(mid);
+                            if (row > -1) {
 
-                            beginRemoveRows(QModelIndex(), row, row);
+                                beginRemoveRows(QModelIndex(), row, row);
 
-                            delete d->feeds.takeAt(row);
+                                delete d->feeds.takeAt(row);
 
-                            endRemoveRows();
+                                endRemoveRows();
+                            }
                         }
                     }
                 }
-            }
+            });
         }
     }
 
@@ -228,16 +232,19 @@ void AbstractFeedModel::feedsRequested(const IdList &updatedFeeds, const IdList
         qa.parentId = parentId();
         qa.inIds = newFeeds;
         qa.inIdsType = FuotenEnums::Feed;
-        const QList<Feed*> nfs = storage()->getFeeds(qa);
 
-        if (!nfs.isEmpty()) {
+        whenFinished(this, storage()->getFeedsAsync(qa), [this] (const QList<Feed*> &nfs) {
+            if (!nfs.isEmpty()) {
 
-            beginInsertRows(QModelIndex(), rowCount(), rowCount() + nfs.count() - 1);
+                Q_D(AbstractFeedModel);
 
-            d->feeds.append(nfs);
+                beginInsertRows(QModelIndex(), rowCount(), rowCount() + nfs.count() - 1);
 
-            endInsertRows();
-        }
+                d->feeds.append(nfs);
+
+                endInsertRows();
+            }
+        });
     }
 
 
@@ -265,18 +272,18 @@ void AbstractFeedModel::feedCreated(qint64 id, qint64 folderId)
 
     if (parentId() < 0 || parentId() == folderId) {
 
-        Feed *f = storage()->getFeed(id);
+        whenFinished(this, storage()->getFeedAsync(id), [this] (Feed *f) {
+            if (f) {
 
-        if (f) {
+                Q_D(AbstractFeedModel);
 
-            Q_D(AbstractFeedModel);
+                beginInsertRows(QModelIndex(), rowCount(), rowCount());
 
-            beginInsertRows(QModelIndex(), rowCount(), rowCount());
-
-            d->feeds.append(f);
+                d->feeds.append(f);
 
-            endInsertRows();
-        }
+                endInsertRows();
+            }
+        });
     }
 }
 
@@ -337,47 +344,50 @@ void AbstractFeedModel::feedMoved(qint64 id, qint64 targetFolderId)
 {
     Q_ASSERT_X(storage(), "move feed", "no storage available");
 
-    Feed *f = storage()->getFeed(id);
+    whenFinished(this, storage()->getFeedAsync(id), [this, id, targetFolderId] (Feed *f) {
+        if (!f) {
+            qWarning("Can not find feed in local storage.");
+            return;
+        }
 
-    if (!f) {
-        qWarning("Can not find feed in local storage.");
-        return;
-    }
+        QModelIndex idx = findByID(id);
 
-    QModelIndex idx = findByID(id);
+        Q_D(AbstractFeedModel);
 
-    Q_D(AbstractFeedModel);
+        if (idx.isValid() && (parentId() < 0)) {
 
-    if (idx.isValid() && (parentId() < 0)) {
+            d->feeds.at(idx.row())->setFolderId(f->folderId());
+            d->feeds.at(idx.row())->setFolderName(f->folderName());
 
-        d->feeds.at(idx.row())->setFolderId(f->folderId());
-        d->feeds.at(idx.row())->setFolderName(f->folderName());
+            Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
 
-        Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
+            delete f;
 
-        delete f;
+        } else if (idx.isValid() && (parentId() != targetFolderId)) {
 
-    } else if (idx.isValid() && (parentId() != targetFolderId)) {
+            beginRemoveRows(QModelIndex(), idx.row(), idx.row());
 
-        beginRemoveRows(QModelIndex(), idx.row(), idx.row());
+            Feed *movedFeed = d->feeds.takeAt(idx.row());
 
-        Feed *movedFeed = d->feeds.takeAt(idx.row());
+            endRemoveRows();
 
-        endRemoveRows();
+            movedFeed->deleteLater();
 
-        movedFeed->deleteLater();
+            delete f;
 
-        delete f;
+        } else if (!idx.isValid() && (parentId() == targetFolderId)) {
 
-    } else if (!idx.isValid() && (parentId() == targetFolderId)) {
+            beginInsertRows(QModelIndex(), rowCount(), rowCount());
 
-        beginInsertRows(QModelIndex(), rowCount(), rowCount());
+            d->feeds.append(f);
 
-        d->feeds.append(f);
+            endInsertRows();
 
-        endInsertRows();
+        } else {
 
-    }
+            delete f;
+        }
+    });
 }
 
 
@@ -502,24 +512,24 @@ void AbstractFeedModel::itemsRquested(const IdList &updatedItems, const IdList &
     QueryArgs qa;
     qa.parentId = parentId();
 
-    const QList<Feed*> fs = storage()->getFeeds(qa);
+    whenFinished(this, storage()->getFeedsAsync(qa), [this] (const QList<Feed*> &fs) {
+        if (!fs.isEmpty()) {
 
-    if (!fs.isEmpty()) {
-
-        Q_D(AbstractFeedModel);
+            Q_D(AbstractFeedModel);
 
-        for (Feed *f : fs) {
+            for (Feed *f : fs) {
 
-            QModelIndex idx = findByID(f->id());
+                QModelIndex idx = findByID(f->id());
 
-            if (idx.isValid()) {
-                d->feeds.at(idx.row())->copy(f);
-                Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
+                if (idx.isValid()) {
+                    d->feeds.at(idx.row())->copy(f);
+                    Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
+                }
             }
-        }
 
-        qDeleteAll(fs);
-    }
+            qDeleteAll(fs);
+        }
+    });
 }
 
 
@@ -531,29 +541,29 @@ void AbstractFeedModel::itemMarked(qint64 itemId, bool unread)
 
     Q_ASSERT_X(storage(), "mark items", "no storage available");
 
-    Article *a = storage()->getArticle(itemId, -1);
+    whenFinished(this, storage()->getArticleAsync(itemId, -1), [this, unread] (Article *a) {
+        if (a) {
 
-    if (a) {
+            QModelIndex idx = findByID(a->feedId());
 
-        QModelIndex idx = findByID(a->feedId());
+            if (idx.isValid()) {
 
-        if (idx.isValid()) {
+                Q_D(AbstractFeedModel);
 
-            Q_D(AbstractFeedModel);
+                Feed *f = d->feeds.at(idx.row());
 
-            Feed *f = d->feeds.at(idx.row());
+                if (unread) {
+                    f->setUnreadCount(f->unreadCount()+1);
+                } else {
+                    f->setUnreadCount(f->unreadCount()-1);
+                }
 
-            if (unread) {
-                f->setUnreadCount(f->unreadCount()+1);
-            } else {
-                f->setUnreadCount(f->unreadCount()-1);
+                Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
             }
 
-            Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
+            delete a;
         }
-
-        delete a;
-    }
+    });
 }
 
 
@@ -568,22 +578,84 @@ void AbstractFeedModel::itemsMarked()
     QueryArgs qa;
     qa.parentId = parentId();
 
-    const QList<Feed*> fs = storage()->getFeeds(qa);
+    whenFinished(this, storage()->getFeedsAsync(qa), [this] (const QList<Feed*> &fs) {
+        if (!fs.isEmpty()) {
+            Q_D(AbstractFeedModel);
 
-    if (!fs.isEmpty()) {
-        Q_D(AbstractFeedModel);
+            for (Feed *f : fs) {
+                int row = d->rowByID(f->id());
+                if (row > -1) {
+                    d->feeds.at(row)->setUnreadCount(f->unreadCount());
+                }
+            }
 
-        for (Feed *f : fs) {
-            int row = d->rowByID(f->id());
-            if (row > -1) {
-                d->feeds.at(row)->setUnreadCount(f->unreadCount());
+            if (rowCount() > 0) {
+                Q_EMIT dataChanged(index(0, 0), index(rowCount()-1, 0), QVector<int>(1, Qt::DisplayRole));
             }
+
+            qDeleteAll(fs);
         }
+    });
+}
+
 
-        Q_EMIT dataChanged(index(0, 0), index(rowCount()-1, 0), QVector<int>(1, Qt::DisplayRole));
+bool AbstractFeedModel::applyChanges(const QList<StorageChange> &changes)
+{
+    // the unread counts of all feeds are updated only once after applying the changes
+    bool updateCounts = false;
+
+    for (const StorageChange &c : changes) {
+
+        switch (c.type) {
+        case FuotenEnums::Folder:
+            for (qint64 id : c.ids) {
+                if (c.operation == StorageChange::MarkedRead) {
+                    folderMarkedRead(id, c.newestItemId);
+                } else if (c.operation == StorageChange::Deleted) {
+                    folderDeleted(id);
+                }
+            }
+            break;
+        case FuotenEnums::Feed:
+            switch (c.operation) {
+            case StorageChange::Created:
+                feedsRequested(IdList(), c.ids, IdList());
+                break;
+            case StorageChange::Updated:
+                feedsRequested(c.ids, IdList(), IdList());
+                break;
+            case StorageChange::Deleted:
+                feedsRequested(IdList(), IdList(), c.ids);
+                break;
+            case StorageChange::Moved:
+                feedMoved(c.ids.first(), c.parentId);
+                break;
+            case StorageChange::Renamed:
+                feedRenamed(c.ids.first(), c.name);
+                break;
+            case StorageChange::MarkedRead:
+                feedMarkedRead(c.ids.first(), c.newestItemId);
+                break;
+            default:
+                return false;
+            }
+            break;
+        case FuotenEnums::Item:
+        case FuotenEnums::All:
+            if (c.fields.testFlag(StorageChange::UnreadState) || (c.operation == StorageChange::Created) || (c.operation == StorageChange::Deleted)) {
+                updateCounts = true;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
 
-        qDeleteAll(fs);
+    if (updateCounts) {
+        itemsRquested(IdList(), IdList(), IdList());
     }
+
+    return true;
 }
 
 #include "moc_abstractfeedmodel.cpp"
@@ -198,6 +198,11 @@ protected:
      */
     void clear() override;
 
+    /*!
+     * \brief Applies the feed related storage \a changes recorded while the model has been paused.
+     */
+    bool applyChanges(const QList<StorageChange> &changes) override;
+
 private:
     Q_DISABLE_COPY(AbstractFeedModel)
     Q_DECLARE_PRIVATE(AbstractFeedModel)
@@ -76,31 +76,32 @@ void AbstractFolderModel::load()
 {
     Q_ASSERT_X(storage(), "load folders", "no storage available");
 
-    if (!storage()->ready() || loaded()) {
+    if (!storage()->ready() || loaded() || inOperation()) {
         return;
     }
 
     setInOperation(true);
 
-    const QList<Folder*> fs = storage()->getFolders(FuotenEnums::Name, Qt::AscendingOrder);
-    if (!fs.isEmpty()) {
+    whenFinished(this, storage()->getFoldersAsync(FuotenEnums::Name, Qt::AscendingOrder), [this] (const QList<Folder*> &fs) {
+        if (!fs.isEmpty()) {
 
-        qDebug("Start inserting %u folders into the model.", fs.size());
+            qDebug("Start inserting %u folders into the model.", fs.size());
 
-        Q_D(AbstractFolderModel);
+            Q_D(AbstractFolderModel);
 
-        beginInsertRows(QModelIndex(), 0, fs.count() - 1);
+            beginInsertRows(QModelIndex(), 0, fs.count() - 1);
 
-        d->folders = fs;
+            d->folders = fs;
 
-        endInsertRows();
+            endInsertRows();
 
-        qDebug("Finished inserting %u folders into the model.", fs.size());
-    }
+            qDebug("Finished inserting %u folders into the model.", fs.size());
+        }
 
-    setLoaded(true);
+        setLoaded(true);
 
-    setInOperation(false);
+        setInOperation(false);
+    });
 }
 
 
@@ -196,16 +197,18 @@ void AbstractFolderModel::foldersRequested(const QList<QPair<qint64, QString> >
         }
 
         if (!nf.isEmpty()) {
-            const QList<Folder*> fs = storage()->getFolders(FuotenEnums::Name, Qt::AscendingOrder, nf);
+            whenFinished(this, storage()->getFoldersAsync(FuotenEnums::Name, Qt::AscendingOrder, nf), [this] (const QList<Folder*> &fs) {
+                if (!fs.isEmpty()) {
 
-            if (!fs.isEmpty()) {
+                    Q_D(AbstractFolderModel);
 
-                beginInsertRows(QModelIndex(), rowCount(), rowCount() + fs.count() - 1);
+                    beginInsertRows(QModelIndex(), rowCount(), rowCount() + fs.count() - 1);
 
-                d->folders.append(fs);
+                    d->folders.append(fs);
 
-                endInsertRows();
-            }
+                    endInsertRows();
+                }
+            });
         }
     }
 
@@ -276,21 +279,21 @@ void AbstractFolderModel::feedsRequested(const IdList &updatedFeeds, const IdLis
 
     if (!updatedFeeds.isEmpty() || !newFeeds.isEmpty() || !deletedFeeds.isEmpty()) {
 
-        const QList<Folder*> fs = storage()->getFolders(FuotenEnums::ID);
-
-        if (!fs.isEmpty()) {
-            Q_D(AbstractFolderModel);
-            for (const Folder *f : fs) {
-                QModelIndex i = findByID(f->id());
-                if (i.isValid()) {
-                    Folder *mf = d->folders.at(i.row());
-                    mf->setFeedCount(f->feedCount());
-                    mf->setUnreadCount(f->unreadCount());
-                    Q_EMIT dataChanged(i, i, QVector<int>(1, Qt::DisplayRole));
+        whenFinished(this, storage()->getFoldersAsync(FuotenEnums::ID), [this] (const QList<Folder*> &fs) {
+            if (!fs.isEmpty()) {
+                Q_D(AbstractFolderModel);
+                for (const Folder *f : fs) {
+                    QModelIndex i = findByID(f->id());
+                    if (i.isValid()) {
+                        Folder *mf = d->folders.at(i.row());
+                        mf->setFeedCount(f->feedCount());
+                        mf->setUnreadCount(f->unreadCount());
+                        Q_EMIT dataChanged(i, i, QVector<int>(1, Qt::DisplayRole));
+                    }
+                    delete f;
                 }
-                delete f;
             }
-        }
+        });
     }
 }
 
@@ -302,20 +305,20 @@ void AbstractFolderModel::feedMarkedRead(qint64 id)
     IdList l;
     l.append(id);
 
-    const QList<Folder*> fs = storage()->getFolders(FuotenEnums::ID, Qt::AscendingOrder, l, FuotenEnums::Feed);
-
-    if (!fs.isEmpty()) {
-        Folder *f = fs.first();
-        QModelIndex i = findByID(f->id());
-        if (i.isValid()) {
-            Q_D(AbstractFolderModel);
-            Folder *mf = d->folders.at(i.row());
-            mf->setFeedCount(f->feedCount());
-            mf->setUnreadCount(f->unreadCount());
-            Q_EMIT dataChanged(i, i, QVector<int>(1, Qt::DisplayRole));
+    whenFinished(this, storage()->getFoldersAsync(FuotenEnums::ID, Qt::AscendingOrder, l, FuotenEnums::Feed), [this] (const QList<Folder*> &fs) {
+        if (!fs.isEmpty()) {
+            Folder *f = fs.first();
+            QModelIndex i = findByID(f->id());
+            if (i.isValid()) {
+                Q_D(AbstractFolderModel);
+                Folder *mf = d->folders.at(i.row());
+                mf->setFeedCount(f->feedCount());
+                mf->setUnreadCount(f->unreadCount());
+                Q_EMIT dataChanged(i, i, QVector<int>(1, Qt::DisplayRole));
+            }
+            qDeleteAll(fs);
         }
-        delete f;
-    }
+    });
 }
 
 
@@ -328,20 +331,20 @@ void AbstractFolderModel::feedCreated(qint64 feedId, qint64 folderId)
     IdList l;
     l.append(folderId);
 
-    const QList<Folder*> fs = storage()->getFolders(FuotenEnums::Name, Qt::AscendingOrder, l);
-
-    if (!fs.isEmpty()) {
-        Folder *f = fs.first();
-        QModelIndex i = findByID(f->id());
-        if (i.isValid()) {
-            Q_D(AbstractFolderModel);
-            Folder *mf = d->folders.at(i.row());
-            mf->setFeedCount(f->feedCount());
-            mf->setUnreadCount(f->unreadCount());
-            Q_EMIT dataChanged(i, i, QVector<int>(1, Qt::DisplayRole));
+    whenFinished(this, storage()->getFoldersAsync(FuotenEnums::Name, Qt::AscendingOrder, l), [this] (const QList<Folder*> &fs) {
+        if (!fs.isEmpty()) {
+            Folder *f = fs.first();
+            QModelIndex i = findByID(f->id());
+            if (i.isValid()) {
+                Q_D(AbstractFolderModel);
+                Folder *mf = d->folders.at(i.row());
+                mf->setFeedCount(f->feedCount());
+                mf->setUnreadCount(f->unreadCount());
+                Q_EMIT dataChanged(i, i, QVector<int>(1, Qt::DisplayRole));
+            }
+            qDeleteAll(fs);
         }
-        delete f;
-    }
+    });
 }
 
 
@@ -349,21 +352,21 @@ void AbstractFolderModel::updateCountValues()
 {
     Q_ASSERT_X(storage(), "update folders", "no storage available");
 
-    const QList<Folder*> fs = storage()->getFolders();
-
-    if (!fs.isEmpty()) {
-        Q_D(AbstractFolderModel);
-        for (const Folder *f : fs) {
-            int i = d->rowByID(f->id());
-            if (i > -1) {
-                Folder *mf = d->folders.at(i);
-                mf->setFeedCount(f->feedCount());
-                mf->setUnreadCount(f->unreadCount());
+    whenFinished(this, storage()->getFoldersAsync(), [this] (const QList<Folder*> &fs) {
+        if (!fs.isEmpty()) {
+            Q_D(AbstractFolderModel);
+            for (const Folder *f : fs) {
+                int i = d->rowByID(f->id());
+                if (i > -1) {
+                    Folder *mf = d->folders.at(i);
+                    mf->setFeedCount(f->feedCount());
+                    mf->setUnreadCount(f->unreadCount());
+                }
+                delete f;
             }
-            delete f;
+            Q_EMIT dataChanged(index(0, 0), index(rowCount()-1 ,0), QVector<int>(1, Qt::DisplayRole));
         }
-        Q_EMIT dataChanged(index(0, 0), index(rowCount()-1 ,0), QVector<int>(1, Qt::DisplayRole));
-    }
+    });
 }
 
 
@@ -387,29 +390,103 @@ void AbstractFolderModel::itemMarked(qint64 itemId, bool unread)
 {
     Q_ASSERT_X(storage(), "update folders", "no storage available");
 
-    Article *a = storage()->getArticle(itemId, -1);
+    whenFinished(this, storage()->getArticleAsync(itemId, -1), [this, unread] (Article *a) {
+        if (a) {
 
-    if (a) {
+            QModelIndex idx = findByID(a->folderId());
 
-        QModelIndex idx = findByID(a->folderId());
+            if (idx.isValid()) {
 
-        if (idx.isValid()) {
+                Q_D(AbstractFolderModel);
 
-            Q_D(AbstractFolderModel);
+                Folder *f = d->folders.at(idx.row());
 
-            Folder *f = d->folders.at(idx.row());
+                if (unread) {
+                    f->setUnreadCount(f->unreadCount()+1);
+                } else {
+                    f->setUnreadCount(f->unreadCount()-1);
+                }
 
-            if (unread) {
-                f->setUnreadCount(f->unreadCount()+1);
-            } else {
-                f->setUnreadCount(f->unreadCount()-1);
+                Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
             }
 
-            Q_EMIT dataChanged(idx, idx, QVector<int>(1, Qt::DisplayRole));
+            delete a;
+        }
+    });
+}
+
+
+bool AbstractFolderModel::applyChanges(const QList<StorageChange> &changes)
+{
+    // names and counts of all folders are updated only once after applying the changes
+    bool updateFolders = false;
+
+    for (const StorageChange &c : changes) {
+
+        switch (c.type) {
+        case FuotenEnums::Folder:
+            switch (c.operation) {
+            case StorageChange::Created:
+                if (c.name.isEmpty()) {
+                    // folders created by a request are recorded without their names
+                    QList<QPair<qint64, QString>> nf;
+                    nf.reserve(c.ids.size());
+                    for (qint64 id : c.ids) {
+                        nf.append(qMakePair(id, QString()));
+                    }
+                    foldersRequested(QList<QPair<qint64, QString>>(), nf, IdList());
+                } else {
+                    folderCreated(c.ids.first(), c.name);
+                }
+                break;
+            case StorageChange::Updated:
+                updateFolders = true;
+                break;
+            case StorageChange::Deleted:
+                foldersRequested(QList<QPair<qint64, QString>>(), QList<QPair<qint64, QString>>(), c.ids);
+                break;
+            case StorageChange::Renamed:
+                folderRenamed(c.ids.first(), c.name);
+                break;
+            case StorageChange::MarkedRead:
+                folderMarkedRead(c.ids.first(), c.newestItemId);
+                break;
+            default:
+                return false;
+            }
+            break;
+        case FuotenEnums::Feed:
+        case FuotenEnums::Item:
+        case FuotenEnums::All:
+            if (c.operation != StorageChange::Renamed && c.fields != StorageChange::StarredState && c.fields != StorageChange::QueueState) {
+                updateFolders = true;
+            }
+            break;
+        default:
+            return false;
         }
+    }
 
-        delete a;
+    if (updateFolders) {
+        whenFinished(this, storage()->getFoldersAsync(), [this] (const QList<Folder*> &fs) {
+            Q_D(AbstractFolderModel);
+            for (const Folder *f : fs) {
+                int i = d->rowByID(f->id());
+                if (i > -1) {
+                    Folder *mf = d->folders.at(i);
+                    mf->setName(f->name());
+                    mf->setFeedCount(f->feedCount());
+                    mf->setUnreadCount(f->unreadCount());
+                }
+                delete f;
+            }
+            if (rowCount() > 0) {
+                Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, 0), QVector<int>(1, Qt::DisplayRole));
+            }
+        });
     }
+
+    return true;
 }
 
 #include "moc_abstractfoldermodel.cpp"
@@ -74,6 +74,11 @@ protected:
      */
     void clear() override;
 
+    /*!
+     * \brief Applies the folder related storage \a changes recorded while the model has been paused.
+     */
+    bool applyChanges(const QList<StorageChange> &changes) override;
+
 protected Q_SLOTS:
     /*!
      * \brief Takes and processes data after folders have been requested.
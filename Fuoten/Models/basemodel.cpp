@@ -18,6 +18,7 @@
  */
 
 #include "basemodel_p.h"
+#include "../Storage/abstractstorage.h"
 #include <QMetaEnum>
 
 using namespace Fuoten;
@@ -65,6 +66,11 @@ void BaseModel::setStorage(AbstractStorage *nStorage)
         Q_EMIT storageChanged(storage());
 
         handleStorageChanged(old);
+
+        if (d->paused && d->storage) {
+            d->storage->disconnect(this);
+            d->changeSequence = d->storage->changeSequence();
+        }
     }
 }
 
@@ -181,6 +187,46 @@ void BaseModel::setLimit(int nLimit)
 }
 
 
+bool BaseModel::paused() const { Q_D(const BaseModel); return d->paused; }
+
+void BaseModel::setPaused(bool nPaused)
+{
+    Q_D(BaseModel);
+    if (nPaused != d->paused) {
+        d->paused = nPaused;
+        qDebug("Changed paused to %s.", d->paused ? "true" : "false");
+
+        if (d->storage) {
+            if (d->paused) {
+                d->storage->disconnect(this);
+                d->changeSequence = d->storage->changeSequence();
+            } else {
+                handleStorageChanged(nullptr);
+
+                if (loaded()) {
+                    bool complete = false;
+                    const QList<StorageChange> changes = d->storage->changesSince(d->changeSequence, &complete);
+                    if (!complete || !applyChanges(changes)) {
+                        qDebug("%s", "Can not apply the storage changes. Reloading the model.");
+                        reload();
+                    }
+                } else if (!inOperation()) {
+                    load();
+                }
+            }
+        }
+
+        Q_EMIT pausedChanged(paused());
+    }
+}
+
+
+bool BaseModel::applyChanges(const QList<StorageChange> &changes)
+{
+    return changes.isEmpty();
+}
+
+
 void BaseModel::reload()
 {
     clear();
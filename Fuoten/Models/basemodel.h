@@ -29,6 +29,7 @@ namespace Fuoten {
 
 class BaseModelPrivate;
 class AbstractStorage;
+struct StorageChange;
 
 /*!
  * \brief Abstract base class for all data models.
@@ -135,6 +136,21 @@ class FUOTENSHARED_EXPORT BaseModel : public QAbstractItemModel
      * void loadedChanged(bool loaded)
      */
     Q_PROPERTY(bool loaded READ loaded NOTIFY loadedChanged)
+    /*!
+     * \brief This property holds \c true if the model does not follow the changes in the storage.
+     *
+     * While the model is paused, it is disconnected from the signals of the storage. If it is resumed, it
+     * will apply the changes recorded by AbstractStorage::changesSince() since it has been paused by calling
+     * applyChanges(). If the change log of the storage does not reach back far enough or if a change can not
+     * be applied, the model will be reloaded. Use this for example for views that are not visible or while the
+     * application is in the background.
+     *
+     * \par Access functions:
+     * <TABLE><TR><TD>bool</TD><TD>paused() const</TD></TR><TR><TD>void</TD><TD>setPaused(bool nPaused)</TD></TR></TABLE>
+     * \par Notifier signal:
+     * <TABLE><TR><TD>void</TD><TD>pausedChanged(bool paused)</TD></TR></TABLE>
+     */
+    Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
 public:
     /*!
      * \brief Constructs a new BaseModel object.
@@ -210,6 +226,11 @@ public:
      * \sa setLoaded(), loadedChanged()
      */
     bool loaded() const;
+    /*!
+     * \brief Getter function for the \link BaseModel::paused paused \endlink property.
+     * \sa setPaused(), pausedChanged()
+     */
+    bool paused() const;
 
 
 
@@ -254,6 +275,12 @@ public:
      * \sa BaseModel::limit(), BaseModel::limitChanged()
      */
     void setLimit(int nLimit);
+    /*!
+     * \brief Setter function for the \link BaseModel::paused paused \endlink property.
+     * Emits the pausedChanged() signal if \a nPaused is not equal to the stored value.
+     * \sa paused(), pausedChanged()
+     */
+    void setPaused(bool nPaused);
 
 public Q_SLOTS:
     /*!
@@ -352,6 +379,11 @@ Q_SIGNALS:
      * \sa loaded(), setLoaded()
      */
     void loadedChanged(bool loaded);
+    /*!
+     * \brief This is emitted if the value of the \link BaseModel::paused paused \endlink property changes.
+     * \sa paused(), setPaused()
+     */
+    void pausedChanged(bool paused);
 
 
 protected:
@@ -405,6 +437,18 @@ protected:
      */
     virtual void clear() = 0;
 
+    /*!
+     * \brief Applies the \a changes recorded by the storage while the model has been paused.
+     *
+     * Will be called when the model is resumed after setting \link BaseModel::paused paused \endlink to
+     * \c false. Reimplement this to update the model data incrementally, for example by calling the slots
+     * that are connected to the storage signals in handleStorageChanged(). Return \c false if the changes
+     * can not be applied, the model will be reloaded in that case.
+     *
+     * The default implementation returns \c false if \a changes is not empty.
+     */
+    virtual bool applyChanges(const QList<StorageChange> &changes);
+
 private:
     Q_DISABLE_COPY(BaseModel)
     Q_DECLARE_PRIVATE(BaseModel)
@@ -21,9 +21,54 @@
 #define FUOTENBASEMODEL_P_H
 
 #include "basemodel.h"
+#include <QFutureWatcher>
+#include <QPointer>
 
 namespace Fuoten {
 
+/*
+ * Deletes the objects of a query result that nobody can take over anymore.
+ */
+template<typename T>
+struct ResultDiscarder
+{
+    static void discard(const T &) {}
+};
+
+template<typename T>
+struct ResultDiscarder<T*>
+{
+    static void discard(T *object) { delete object; }
+};
+
+template<typename T>
+struct ResultDiscarder<QList<T*>>
+{
+    static void discard(const QList<T*> &objects) { qDeleteAll(objects); }
+};
+
+/*
+ * Calls the handler with the result of the future in the thread of the context
+ * object as soon as the future has finished. If the context object has been
+ * destroyed in the meantime, the result is deleted instead.
+ */
+template<typename T, typename Handler>
+void whenFinished(QObject *context, const QFuture<T> &future, Handler handler)
+{
+    // not a child of the context, the result has to be deleted even if the context is gone
+    QFutureWatcher<T> *watcher = new QFutureWatcher<T>;
+    QPointer<QObject> guard(context);
+    QObject::connect(watcher, &QFutureWatcherBase::finished, watcher, [watcher, guard, handler] () {
+        if (guard) {
+            handler(watcher->result());
+        } else {
+            ResultDiscarder<T>::discard(watcher->result());
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+}
+
 class BaseModelPrivate
 {
 public:
@@ -39,6 +84,8 @@ public:
     bool unreadOnly = false;
     bool inOperation = false;
     bool loaded = false;
+    bool paused = false;
+    quint64 changeSequence = 0;
 
 private:
     Q_DISABLE_COPY(BaseModelPrivate)
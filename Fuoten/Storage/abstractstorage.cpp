@@ -21,15 +21,148 @@
 #include "../article.h"
 #include "../Helpers/abstractconfiguration.h"
 #include "../API/component.h"
+#include "../Helpers/jsondecoder.h"
 #include <QRegularExpression>
+#include <QJsonDocument>
+#include <QJsonArray>
 
 using namespace Fuoten;
 
+/*
+ * Appends a change to the change log of the storage.
+ */
+static void recordChange(AbstractStorage *q, AbstractStoragePrivate *d, FuotenEnums::Type type, StorageChange::Operation operation, StorageChange::Fields fields, const IdList &ids, qint64 parentId = -1, qint64 newestItemId = -1, const QString &name = QString(), bool queued = false)
+{
+    StorageChange c;
+    c.type = type;
+    c.operation = operation;
+    c.fields = fields;
+    c.ids = ids;
+    c.parentId = parentId;
+    c.newestItemId = newestItemId;
+    c.name = name;
+    c.queued = queued;
+    Q_EMIT q->changeSequenceChanged(d->recordChange(c));
+}
+
+
+static void recordStarred(AbstractStorage *q, AbstractStoragePrivate *d, const QList<QPair<qint64, QString>> &articles, bool star)
+{
+    StorageChange c;
+    c.type = FuotenEnums::Item;
+    c.operation = star ? StorageChange::Starred : StorageChange::Unstarred;
+    c.fields = StorageChange::StarredState;
+    c.articles = articles;
+    Q_EMIT q->changeSequenceChanged(d->recordChange(c));
+}
+
+
+static void recordRequested(AbstractStorage *q, AbstractStoragePrivate *d, FuotenEnums::Type type, const IdList &updated, const IdList &created, const IdList &deleted)
+{
+    if (!updated.isEmpty()) {
+        recordChange(q, d, type, StorageChange::Updated, StorageChange::AllFields, updated);
+    }
+    if (!created.isEmpty()) {
+        recordChange(q, d, type, StorageChange::Created, StorageChange::AllFields, created);
+    }
+    if (!deleted.isEmpty()) {
+        recordChange(q, d, type, StorageChange::Deleted, StorageChange::NoField, deleted);
+    }
+}
+
+
+static IdList pairIds(const QList<QPair<qint64, QString>> &pairs)
+{
+    IdList ids;
+    ids.reserve(pairs.size());
+    for (const QPair<qint64, QString> &p : pairs) {
+        ids.append(p.first);
+    }
+    return ids;
+}
+
+
+/*
+ * Records a StorageChange for every signal that reports changed data.
+ */
+static void connectChangeLog(AbstractStorage *q, AbstractStoragePrivate *d)
+{
+    QObject::connect(q, &AbstractStorage::requestedFolders, q, [q, d] (const QList<QPair<qint64, QString>> &updatedFolders, const QList<QPair<qint64, QString>> &newFolders, const IdList &deletedFolders) {
+        recordRequested(q, d, FuotenEnums::Folder, pairIds(updatedFolders), pairIds(newFolders), deletedFolders);
+    });
+    QObject::connect(q, &AbstractStorage::createdFolder, q, [q, d] (qint64 id, const QString &name) {
+        recordChange(q, d, FuotenEnums::Folder, StorageChange::Created, StorageChange::AllFields, IdList({id}), -1, -1, name);
+    });
+    QObject::connect(q, &AbstractStorage::renamedFolder, q, [q, d] (qint64 id, const QString &newName) {
+        recordChange(q, d, FuotenEnums::Folder, StorageChange::Renamed, StorageChange::Name, IdList({id}), -1, -1, newName);
+    });
+    QObject::connect(q, &AbstractStorage::deletedFolder, q, [q, d] (qint64 id) {
+        recordChange(q, d, FuotenEnums::Folder, StorageChange::Deleted, StorageChange::NoField, IdList({id}));
+    });
+    QObject::connect(q, &AbstractStorage::markedReadFolder, q, [q, d] (qint64 id, qint64 newestItem) {
+        recordChange(q, d, FuotenEnums::Folder, StorageChange::MarkedRead, StorageChange::UnreadState, IdList({id}), -1, newestItem);
+    });
+    QObject::connect(q, &AbstractStorage::markedReadFolderInQueue, q, [q, d] (qint64 id, qint64 newestItem) {
+        recordChange(q, d, FuotenEnums::Folder, StorageChange::MarkedRead, StorageChange::UnreadState|StorageChange::QueueState, IdList({id}), -1, newestItem, QString(), true);
+    });
+
+    QObject::connect(q, &AbstractStorage::requestedFeeds, q, [q, d] (const IdList &updatedFeeds, const IdList &newFeeds, const IdList &deletedFeeds) {
+        recordRequested(q, d, FuotenEnums::Feed, updatedFeeds, newFeeds, deletedFeeds);
+    });
+    QObject::connect(q, &AbstractStorage::createdFeed, q, [q, d] (qint64 id, qint64 folderId) {
+        recordChange(q, d, FuotenEnums::Feed, StorageChange::Created, StorageChange::AllFields, IdList({id}), folderId);
+    });
+    QObject::connect(q, &AbstractStorage::deletedFeed, q, [q, d] (qint64 id) {
+        recordChange(q, d, FuotenEnums::Feed, StorageChange::Deleted, StorageChange::NoField, IdList({id}));
+    });
+    QObject::connect(q, &AbstractStorage::movedFeed, q, [q, d] (qint64 id, qint64 targetFolder) {
+        recordChange(q, d, FuotenEnums::Feed, StorageChange::Moved, StorageChange::Parent, IdList({id}), targetFolder);
+    });
+    QObject::connect(q, &AbstractStorage::renamedFeed, q, [q, d] (qint64 id, const QString &newName) {
+        recordChange(q, d, FuotenEnums::Feed, StorageChange::Renamed, StorageChange::Name, IdList({id}), -1, -1, newName);
+    });
+    QObject::connect(q, &AbstractStorage::markedReadFeed, q, [q, d] (qint64 id, qint64 newestItem) {
+        recordChange(q, d, FuotenEnums::Feed, StorageChange::MarkedRead, StorageChange::UnreadState, IdList({id}), -1, newestItem);
+    });
+    QObject::connect(q, &AbstractStorage::markedReadFeedInQueue, q, [q, d] (qint64 id, qint64 newestItem) {
+        recordChange(q, d, FuotenEnums::Feed, StorageChange::MarkedRead, StorageChange::UnreadState|StorageChange::QueueState, IdList({id}), -1, newestItem, QString(), true);
+    });
+
+    QObject::connect(q, &AbstractStorage::requestedItems, q, [q, d] (const IdList &updatedItems, const IdList &newItems, const IdList &deletedItems) {
+        recordRequested(q, d, FuotenEnums::Item, updatedItems, newItems, deletedItems);
+    });
+    QObject::connect(q, &AbstractStorage::markedItems, q, [q, d] (const IdList &itemIds, bool unread) {
+        recordChange(q, d, FuotenEnums::Item, unread ? StorageChange::MarkedUnread : StorageChange::MarkedRead, StorageChange::UnreadState, itemIds);
+    });
+    QObject::connect(q, &AbstractStorage::markedItem, q, [q, d] (qint64 itemId, bool unread) {
+        recordChange(q, d, FuotenEnums::Item, unread ? StorageChange::MarkedUnread : StorageChange::MarkedRead, StorageChange::UnreadState, IdList({itemId}));
+    });
+    QObject::connect(q, &AbstractStorage::starredItems, q, [q, d] (const QList<QPair<qint64, QString>> &articles, bool star) {
+        recordStarred(q, d, articles, star);
+    });
+    QObject::connect(q, &AbstractStorage::starredItem, q, [q, d] (qint64 feedId, const QString &guidHash, bool starred) {
+        recordStarred(q, d, QList<QPair<qint64, QString>>({qMakePair(feedId, guidHash)}), starred);
+    });
+    QObject::connect(q, &AbstractStorage::markedAllItemsRead, q, [q, d] (qint64 newestItemId) {
+        recordChange(q, d, FuotenEnums::All, StorageChange::MarkedRead, StorageChange::UnreadState, IdList(), -1, newestItemId);
+    });
+    QObject::connect(q, &AbstractStorage::markedAllItemsReadInQueue, q, [q, d] () {
+        recordChange(q, d, FuotenEnums::All, StorageChange::MarkedRead, StorageChange::UnreadState|StorageChange::QueueState, IdList(), -1, -1, QString(), true);
+    });
+    QObject::connect(q, &AbstractStorage::queueCleared, q, [q, d] () {
+        recordChange(q, d, FuotenEnums::All, StorageChange::QueueCleared, StorageChange::QueueState, IdList());
+    });
+    QObject::connect(q, &AbstractStorage::dequeuedItems, q, [q, d] (const IdList &itemIds) {
+        recordChange(q, d, FuotenEnums::Item, StorageChange::Dequeued, StorageChange::QueueState, itemIds);
+    });
+}
+
 AbstractStorage::AbstractStorage(QObject *parent) :
     QObject(parent), d_ptr(new AbstractStoragePrivate)
 {
     qRegisterMetaType<Fuoten::IdList>("IdList");
     qRegisterMetaType<Fuoten::ArticleList>("ArticleList");
+    connectChangeLog(this, d_ptr.data());
 }
 
 AbstractStorage::AbstractStorage(AbstractStoragePrivate &dd, QObject *parent) :
@@ -37,6 +170,7 @@ AbstractStorage::AbstractStorage(AbstractStoragePrivate &dd, QObject *parent) :
 {
     qRegisterMetaType<Fuoten::IdList>("IdList");
     qRegisterMetaType<Fuoten::ArticleList>("ArticleList");
+    connectChangeLog(this, d_ptr.data());
 }
 
 AbstractStorage::~AbstractStorage()
@@ -133,9 +267,70 @@ QString AbstractStorage::limitBody(const QString &body, int limit) const
 
 void AbstractStorage::getArticlesAsync(const QueryArgs &args)
 {
+    Q_EMIT gotArticlesAsync(getArticles(args));
+}
+
+
+QFuture<ArticleList> AbstractStorage::getArticlesFuture(const QueryArgs &args)
+{
+    return finishedFuture(getArticles(args));
+}
+
+
+QHash<qint64, QList<uint>> AbstractStorage::getPublishDates(int limit)
+{
+    QueryArgs args;
+    args.sortingRole = FuotenEnums::Time;
+    args.sortOrder = Qt::DescendingOrder;
+
+    QHash<qint64, QList<uint>> dates;
+
     const ArticleList articles = getArticles(args);
+    for (Article *a : articles) {
+        QList<uint> &feedDates = dates[a->feedId()];
+        if ((limit <= 0) || (feedDates.size() < limit)) {
+            feedDates.append(a->pubDate().toTime_t());
+        }
+    }
+    qDeleteAll(articles);
 
-    Q_EMIT gotArticlesAsync(articles);
+    return dates;
+}
+
+
+QFuture<qint64> AbstractStorage::getNewestItemIdAsync(FuotenEnums::Type type, qint64 id)
+{
+    return finishedFuture(getNewestItemId(type, id));
+}
+
+
+QFuture<QList<Folder*>> AbstractStorage::getFoldersAsync(FuotenEnums::SortingRole sortingRole, Qt::SortOrder sortOrder, const IdList &ids, FuotenEnums::Type idType, int limit)
+{
+    return finishedFuture(getFolders(sortingRole, sortOrder, ids, idType, limit));
+}
+
+
+QFuture<QList<Feed*>> AbstractStorage::getFeedsAsync(const QueryArgs &args)
+{
+    return finishedFuture(getFeeds(args));
+}
+
+
+QFuture<Feed*> AbstractStorage::getFeedAsync(qint64 id)
+{
+    return finishedFuture(getFeed(id));
+}
+
+
+QFuture<Article*> AbstractStorage::getArticleAsync(qint64 id, int bodyLimit)
+{
+    return finishedFuture(getArticle(id, bodyLimit));
+}
+
+
+QFuture<QString> AbstractStorage::getArticleBodyAsync(qint64 id)
+{
+    return finishedFuture(getArticleBody(id));
 }
 
 
@@ -224,12 +419,145 @@ void AbstractStorage::setNotificator(AbstractNotificator *notificator)
 }
 
 
+quint64 AbstractStorage::changeSequence() const { Q_D(const AbstractStorage); return d->changeSequence; }
+
+
+QList<StorageChange> AbstractStorage::changesSince(quint64 sequence, bool *complete) const
+{
+    Q_D(const AbstractStorage);
+
+    QList<StorageChange> changes;
+
+    if (sequence >= d->changeSequence) {
+        if (complete) {
+            *complete = true;
+        }
+        return changes;
+    }
+
+    // the sequence numbers in the log are contiguous, so the position of the first requested change can be calculated
+    const quint64 first = d->changeLog.isEmpty() ? (d->changeSequence + 1) : d->changeLog.first().sequence;
+
+    if (complete) {
+        *complete = (sequence + 1 >= first);
+    }
+
+    const int start = (sequence + 1 > first) ? static_cast<int>(sequence + 1 - first) : 0;
+
+    changes.reserve(d->changeLog.size() - start);
+    for (int i = start; i < d->changeLog.size(); ++i) {
+        changes.append(d->changeLog.at(i));
+    }
+
+    return changes;
+}
+
+
+int AbstractStorage::changeLogSize() const { Q_D(const AbstractStorage); return d->changeLogSize; }
+
+void AbstractStorage::setChangeLogSize(int size)
+{
+    Q_D(AbstractStorage);
+    d->changeLogSize = qMax(0, size);
+    while (d->changeLog.size() > d->changeLogSize) {
+        d->changeLog.removeFirst();
+    }
+}
+
+
+QJsonObject AbstractStorage::syncCheckpoint() const { Q_D(const AbstractStorage); return d->syncCheckpoint; }
+
+void AbstractStorage::setSyncCheckpoint(const QJsonObject &checkpoint)
+{
+    Q_D(AbstractStorage);
+    d->syncCheckpoint = checkpoint;
+}
+
+
+QByteArray AbstractStorage::replyHash(const QString &key) const { Q_D(const AbstractStorage); return d->replyHashes.value(key); }
+
+void AbstractStorage::setReplyHash(const QString &key, const QByteArray &hash)
+{
+    Q_D(AbstractStorage);
+    d->replyHashes.insert(key, hash);
+}
+
+
+QDateTime AbstractStorage::starredWatermark() const { Q_D(const AbstractStorage); return d->starredWatermark; }
+
+void AbstractStorage::setStarredWatermark(const QDateTime &watermark)
+{
+    Q_D(AbstractStorage);
+    d->starredWatermark = watermark;
+}
+
+
 void AbstractStorage::clearQueue()
 {
 
 }
 
 
+void AbstractStorage::dequeueItems(const IdList &itemIds, FuotenEnums::QueueActions actions)
+{
+    Q_UNUSED(itemIds);
+    Q_UNUSED(actions);
+}
+
+
+/*
+ * Converts the records into a JSON reply document with the records in the
+ * array identified by key.
+ */
+template<typename T, typename F>
+static QJsonDocument recordsToJson(const QVector<T> &records, const QString &key, F convert)
+{
+    QJsonArray a;
+    for (const T &r : records) {
+        a.append(convert(r));
+    }
+    QJsonObject o;
+    o.insert(key, a);
+    return QJsonDocument(o);
+}
+
+
+/*
+ * The JSON based slots might process the data asynchronously or not at all, so
+ * the default implementations can not know if the data has been stored and do
+ * not store the reply hash.
+ */
+void AbstractStorage::foldersRequested(const FolderRecords &folders, const QString &replyKey, const QByteArray &replyHash)
+{
+    Q_UNUSED(replyKey)
+    Q_UNUSED(replyHash)
+    foldersRequested(recordsToJson(folders, QStringLiteral("folders"), JsonDecoder::folderToJson));
+}
+
+
+void AbstractStorage::feedsRequested(const FeedRecords &feeds, const QString &replyKey, const QByteArray &replyHash)
+{
+    Q_UNUSED(replyKey)
+    Q_UNUSED(replyHash)
+    feedsRequested(recordsToJson(feeds, QStringLiteral("feeds"), JsonDecoder::feedToJson));
+}
+
+
+quint64 AbstractStorage::createBatchToken()
+{
+    Q_D(AbstractStorage);
+    return ++d->lastBatchToken;
+}
+
+
+void AbstractStorage::deferItemsMaintenance(bool defer, quint64 batchToken)
+{
+    if (!defer && (batchToken != 0)) {
+        Q_EMIT itemsBatchStored(batchToken);
+    }
+}
+
+
 void AbstractStorage::notify(AbstractNotificator::Type type, QtMsgType severity, const QVariant &data) const
 {
     Q_D(const AbstractStorage);
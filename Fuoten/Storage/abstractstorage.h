@@ -21,8 +21,13 @@
 #define FUOTENABSTRACTSTORAGE_H
 
 #include <QObject>
+#include <QFuture>
+#include <QHash>
+#include <QJsonObject>
+#include <QDateTime>
 #include "../fuoten.h"
 #include "../fuoten_global.h"
+#include "../records.h"
 #include "../Helpers/abstractnotificator.h"
 
 namespace Fuoten {
@@ -47,6 +52,60 @@ struct FUOTENSHARED_EXPORT QueryArgs {
     bool queuedOnly = false;                                /**< Only valid for article queries. Will only return items/articles that are queued. */
 };
 
+/*!
+ * \brief Helper struct describing a single change of the data in an AbstractStorage.
+ *
+ * AbstractStorage records a StorageChange for every signal that reports changed data and numbers them with a
+ * monotonically increasing sequence. Use AbstractStorage::changesSince() to get all changes after a known sequence
+ * and apply them incrementally instead of reloading all data. Not all members are used by every change.
+ */
+struct FUOTENSHARED_EXPORT StorageChange {
+    /*!
+     * \brief The operation that has been performed.
+     */
+    enum Operation : quint8 {
+        Invalid         = 0,    /**< Invalid change. */
+        Created         = 1,    /**< The objects in \a ids have been created. */
+        Updated         = 2,    /**< The objects in \a ids have been updated from the remote server. */
+        Deleted         = 3,    /**< The objects in \a ids have been deleted. */
+        Renamed         = 4,    /**< The object in \a ids has been renamed to \a name. */
+        Moved           = 5,    /**< The feed in \a ids has been moved to the folder \a parentId. */
+        MarkedRead      = 6,    /**< The items in \a ids or all items up to \a newestItemId in the folders or feeds in \a ids have been marked as read. */
+        MarkedUnread    = 7,    /**< The items in \a ids have been marked as unread. */
+        Starred         = 8,    /**< The items in \a articles have been starred. */
+        Unstarred       = 9,    /**< The items in \a articles have been unstarred. */
+        QueueCleared    = 10,   /**< The local queue has been cleared. */
+        Dequeued        = 11    /**< Queue actions have been removed from the items in \a ids, they might still have other queued actions. */
+    };
+
+    /*!
+     * \brief Data fields affected by the change.
+     */
+    enum Field {
+        NoField         = 0x00, /**< No specific field. */
+        Name            = 0x01, /**< Name or title. */
+        Parent          = 0x02, /**< Parent folder of a feed. */
+        UnreadState     = 0x04, /**< Unread state of items and unread counts of feeds and folders. */
+        StarredState    = 0x08, /**< Starred state of items. */
+        QueueState      = 0x10, /**< Local queue flags. */
+        AllFields       = 0xff  /**< Any field might have changed. */
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    quint64 sequence = 0;                       /**< Sequence number of this change, starting with \c 1. */
+    FuotenEnums::Type type = FuotenEnums::All;  /**< Type of the changed objects, FuotenEnums::Folder, FuotenEnums::Feed, FuotenEnums::Item or FuotenEnums::All if the change affects all objects. */
+    Operation operation = Invalid;              /**< The performed operation. */
+    Fields fields = NoField;                    /**< The fields that have been changed. */
+    IdList ids;                                 /**< IDs of the changed objects. */
+    QList<QPair<qint64, QString>> articles;     /**< Pairs of feed ID and guid hash of starred or unstarred items. */
+    qint64 parentId = -1;                       /**< ID of the parent folder for created and moved feeds. */
+    qint64 newestItemId = -1;                   /**< ID of the newest item for mark read operations on folders, feeds and all items. */
+    QString name;                               /**< The new name or title for created and renamed objects. */
+    bool queued = false;                        /**< \c true if the change has only been performed in the local queue. */
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(StorageChange::Fields)
+
 class Folder;
 class Feed;
 class Error;
@@ -205,6 +264,18 @@ public:
      * If the type does not match one of the supported or if there are not items, \c -1 is returned.
      */
     virtual qint64 getNewestItemId(FuotenEnums::Type type = FuotenEnums::All, qint64 id = -1) = 0;
+
+    /*!
+     * \brief Returns the publication dates of the newest items per feed.
+     *
+     * The returned hash maps feed IDs to the publication dates of up to \a limit items in seconds since the epoch,
+     * sorted from the newest to the oldest one. A \a limit of \c 0 returns the dates of all items. Used by
+     * SyncScheduler to estimate how often a feed publishes new items.
+     *
+     * The default implementation queries all articles via getArticles(). Reimplement it to only query the
+     * publication dates.
+     */
+    virtual QHash<qint64, QList<uint>> getPublishDates(int limit = 20);
     
     /*!
      * \brief Returns a list of Folder objects from the local storage.
@@ -260,6 +331,16 @@ public:
      */
     virtual void getArticlesAsync(const QueryArgs &args);
 
+    /*!
+     * \brief Asynchronous variant of getArticles() that reports its result to a future.
+     *
+     * Returns a future that will contain the list of Article objects limited by \a args. Other than
+     * getArticlesAsync() this does not emit the gotArticlesAsync() signal, the caller takes ownership
+     * of the returned objects. The default implementation calls getArticles() and returns an already
+     * finished future.
+     */
+    virtual QFuture<ArticleList> getArticlesFuture(const QueryArgs &args);
+
 
 
     /*!
@@ -285,6 +366,55 @@ public:
      */
     Q_INVOKABLE virtual QString getArticleBody(qint64 id) = 0;
 
+    /*!
+     * \brief Asynchronous variant of getNewestItemId().
+     *
+     * Returns a future that will contain the result of getNewestItemId() for \a type and \a id. The default
+     * implementation calls getNewestItemId() and returns an already finished future.
+     */
+    virtual QFuture<qint64> getNewestItemIdAsync(FuotenEnums::Type type = FuotenEnums::All, qint64 id = -1);
+
+    /*!
+     * \brief Asynchronous variant of getFolders().
+     *
+     * Returns a future that will contain the list of Folder objects. The default implementation calls
+     * getFolders() and returns an already finished future. Reimplementations that perform the query in a
+     * different thread should move the objects into the thread of the storage before reporting them.
+     */
+    virtual QFuture<QList<Folder*>> getFoldersAsync(FuotenEnums::SortingRole sortingRole = FuotenEnums::Name, Qt::SortOrder sortOrder = Qt::AscendingOrder, const IdList &ids = IdList(), FuotenEnums::Type idType = FuotenEnums::Folder, int limit = 0);
+
+    /*!
+     * \brief Asynchronous variant of getFeeds().
+     *
+     * Returns a future that will contain the list of Feed objects. The default implementation calls
+     * getFeeds() and returns an already finished future.
+     */
+    virtual QFuture<QList<Feed*>> getFeedsAsync(const QueryArgs &args);
+
+    /*!
+     * \brief Asynchronous variant of getFeed().
+     *
+     * Returns a future that will contain the Feed identified by \a id or a \c nullptr if it can not be found.
+     * The default implementation calls getFeed() and returns an already finished future.
+     */
+    virtual QFuture<Feed*> getFeedAsync(qint64 id);
+
+    /*!
+     * \brief Asynchronous variant of getArticle().
+     *
+     * Returns a future that will contain the Article identified by \a id or a \c nullptr if it can not be found.
+     * The default implementation calls getArticle() and returns an already finished future.
+     */
+    virtual QFuture<Article*> getArticleAsync(qint64 id, int bodyLimit = 0);
+
+    /*!
+     * \brief Asynchronous variant of getArticleBody().
+     *
+     * Returns a future that will contain the full body of the Article identified by \a id. The default
+     * implementation calls getArticleBody() and returns an already finished future.
+     */
+    virtual QFuture<QString> getArticleBodyAsync(qint64 id);
+
     /*!
      * \brief Enqueues an \a action for the given \a article.
      *
@@ -365,6 +495,105 @@ public:
      */
     void setNotificator(AbstractNotificator *notificator);
 
+    /*!
+     * \brief Returns the sequence number of the most recent change.
+     *
+     * Returns \c 0 if no changes have been recorded yet. The sequence starts with every new storage object, so
+     * only keep it during the lifetime of this object.
+     *
+     * \sa changesSince(), changeSequenceChanged()
+     */
+    quint64 changeSequence() const;
+
+    /*!
+     * \brief Returns all recorded changes with a sequence number greater than \a sequence.
+     *
+     * The changes are ordered by their sequence. Only the last changeLogSize() changes are kept. If changes
+     * after \a sequence have already been dropped from the log, \a complete will be set to \c false and the
+     * returned list only contains the changes still available; the consumer should reload all data in that case.
+     *
+     * \sa changeSequence(), setChangeLogSize()
+     */
+    QList<StorageChange> changesSince(quint64 sequence, bool *complete = nullptr) const;
+
+    /*!
+     * \brief Returns the maximum number of changes kept in the change log.
+     *
+     * Defaults to \c 1000.
+     *
+     * \sa setChangeLogSize()
+     */
+    int changeLogSize() const;
+
+    /*!
+     * \brief Sets the maximum number of changes kept in the change log to \a size.
+     *
+     * Older changes will be dropped. A \a size of \c 0 disables the change log, but the sequence will still
+     * be increased for every change.
+     *
+     * \sa changeLogSize()
+     */
+    void setChangeLogSize(int size);
+
+    /*!
+     * \brief Returns the checkpoint of an interrupted synchronization.
+     *
+     * The checkpoint is written by the Synchronizer after every completed step, so that an interrupted synchronization
+     * can resume where it stopped. Returns an empty object if there is no checkpoint.
+     *
+     * The default implementation only keeps the checkpoint in memory. Reimplement this together with setSyncCheckpoint()
+     * to persist it.
+     *
+     * \sa setSyncCheckpoint()
+     */
+    virtual QJsonObject syncCheckpoint() const;
+
+    /*!
+     * \brief Stores the synchronization \a checkpoint.
+     *
+     * An empty \a checkpoint removes the current one.
+     *
+     * \sa syncCheckpoint()
+     */
+    virtual void setSyncCheckpoint(const QJsonObject &checkpoint);
+
+    /*!
+     * \brief Returns the hash of the last processed reply for the request identified by \a key.
+     *
+     * Used by components that have Component::skipUnchanged enabled. Returns an empty byte array if no hash
+     * has been stored for \a key. The default implementation only keeps the hashes in memory.
+     *
+     * \sa setReplyHash()
+     */
+    virtual QByteArray replyHash(const QString &key) const;
+
+    /*!
+     * \brief Stores the \a hash of the last processed reply for the request identified by \a key.
+     * \sa replyHash()
+     */
+    virtual void setReplyHash(const QString &key, const QByteArray &hash);
+
+    /*!
+     * \brief Returns the time up to which the locally stored starred items match the remote server.
+     *
+     * Set by the Synchronizer after every successful synchronization. If it is valid and the storage contains
+     * starred items, a synchronization without last sync time only requests the starred items that have been
+     * modified since then instead of all starred items. Returns an invalid QDateTime if it has not been set.
+     * The default implementation only keeps the time in memory.
+     *
+     * \sa setStarredWatermark()
+     */
+    virtual QDateTime starredWatermark() const;
+
+    /*!
+     * \brief Sets the time up to which the locally stored starred items match the remote server to \a watermark.
+     *
+     * An invalid \a watermark removes the current one.
+     *
+     * \sa starredWatermark()
+     */
+    virtual void setStarredWatermark(const QDateTime &watermark);
+
     /*!
      * \brief Clears the local queue. Does not revert the action itself.
      *
@@ -373,6 +602,82 @@ public:
      */
     virtual void clearQueue();
 
+    /*!
+     * \brief Removes the queue \a actions from the items identified by \a itemIds.
+     *
+     * Will be called by the Synchronizer for every part of the local queue that has been sent successfully,
+     * so that a failed synchronization does not send these parts again. The default implementation does
+     * nothing, the complete queue will then be cleared by clearQueue() after a successful synchronization.
+     *
+     * Implementations have to emit dequeuedItems() after removing the queue actions.
+     */
+    virtual void dequeueItems(const IdList &itemIds, FuotenEnums::QueueActions actions);
+
+    /*!
+     * \brief Receives the \a folders decoded from the reply of the GetFolders request.
+     *
+     * GetFolders calls this instead of the JSON based foldersRequested() slot, so that the reply has
+     * to be decoded only once and storage implementations can use the record fields directly.
+     *
+     * The default implementation converts the records back into the JSON reply format and calls the
+     * JSON based foldersRequested() slot, so that existing implementations keep working without changes.
+     * Reimplement this for better performance and let the JSON slot convert its data with
+     * JsonDecoder::foldersFromJson() and forward it here.
+     *
+     * If \a replyHash is not empty, the reply has been requested with Component::skipUnchanged enabled.
+     * Implementations have to store it via setReplyHash() for \a replyKey after the folders have been
+     * stored successfully, but not if the data could not be processed. The default implementation can
+     * not know if the JSON based slot stored the data and does not store the hash, so unchanged replies
+     * are processed again.
+     */
+    virtual void foldersRequested(const FolderRecords &folders, const QString &replyKey = QString(), const QByteArray &replyHash = QByteArray());
+
+    /*!
+     * \brief Receives the \a feeds decoded from the reply of the GetFeeds request.
+     *
+     * GetFeeds calls this instead of the JSON based feedsRequested() slot. The default implementation
+     * converts the records back into the JSON reply format and calls the JSON based slot. The
+     * \a replyHash is handled like by foldersRequested(), the default implementation does not store it.
+     *
+     * \sa foldersRequested(const FolderRecords &folders, const QString &replyKey, const QByteArray &replyHash)
+     */
+    virtual void feedsRequested(const FeedRecords &feeds, const QString &replyKey = QString(), const QByteArray &replyHash = QByteArray());
+
+    /*!
+     * \brief Receives the \a items decoded from the reply of the GetItems or GetUpdatedItems request.
+     *
+     * GetItems and GetUpdatedItems call this instead of the JSON based itemsRequested() slot.
+     *
+     * If \a batchToken is not \c 0, implementations have to emit itemsBatchStored() with it after
+     * requestedItems() has been emitted for exactly these \a items.
+     * Only the implementation knows when a batch has been written, so there is no default implementation.
+     * Implementations that only support the JSON based slot can use JsonDecoder::itemToJson() to convert
+     * the records.
+     *
+     * \sa foldersRequested(const FolderRecords &folders, const QString &replyKey, const QByteArray &replyHash)
+     */
+    virtual void itemsRequested(const ItemRecords &items, quint64 batchToken = 0) = 0;
+
+    /*!
+     * \brief Returns a new token to identify a batch of items passed to itemsRequested().
+     *
+     * Tokens are unique for this storage and never \c 0.
+     */
+    quint64 createBatchToken();
+
+    /*!
+     * \brief Defers the maintenance after storing requested items while \a defer is \c true.
+     *
+     * The Synchronizer stores the items page by page. While the maintenance is deferred, implementations
+     * only have to write the items of every page, but can postpone removing old items according to the
+     * item deletion strategy and updating the unread counters until this is called with \a defer set to
+     * \c false again.
+     *
+     * If \a defer is \c false and \a batchToken is not \c 0, implementations have to emit itemsBatchStored()
+     * with it after the deferred maintenance has been performed. The default implementation only emits it.
+     */
+    virtual void deferItemsMaintenance(bool defer, quint64 batchToken = 0);
+
 public Q_SLOTS:
     /*!
      * \brief Receives the reply data of the GetFolders request.
@@ -816,6 +1121,13 @@ Q_SIGNALS:
      */
     void requestedItems(const IdList &updatedItems, const IdList &newItems, const IdList &deletedItems);
 
+    /*!
+     * \brief Emit this after the items passed to itemsRequested() together with \a batchToken have been stored.
+     *
+     * Has to be emitted after requestedItems(), but only if \a batchToken is not \c 0.
+     */
+    void itemsBatchStored(quint64 batchToken);
+
     /*!
      * \brief Emit this after items/articles have been marked as read or unread.
      *
@@ -910,6 +1222,20 @@ Q_SIGNALS:
      */
     void queueCleared();
 
+    /*!
+     * \brief This is emitted after the queue \a actions have been removed from the items identified by \a itemIds.
+     *
+     * Emit this in your implementation of dequeueItems().
+     */
+    void dequeuedItems(const IdList &itemIds, FuotenEnums::QueueActions actions);
+
+    /*!
+     * \brief This is emitted after a change has been recorded in the change log.
+     *
+     * Use changesSince() to get the changes after the last sequence known by the consumer.
+     */
+    void changeSequenceChanged(quint64 changeSequence);
+
 
 private:
     Q_DISABLE_COPY(AbstractStorage)
@@ -22,9 +22,24 @@
 
 #include "abstractstorage.h"
 #include "../error.h"
+#include <QFutureInterface>
+#include <QList>
+#include <QHash>
 
 namespace Fuoten {
 
+/*
+ * Returns a future that has already finished with the given result.
+ */
+template<typename T>
+QFuture<T> finishedFuture(const T &result)
+{
+    QFutureInterface<T> fi(QFutureInterfaceBase::Started);
+    fi.reportResult(result);
+    fi.reportFinished();
+    return fi.future();
+}
+
 
 class AbstractStoragePrivate
 {
@@ -33,6 +48,22 @@ public:
 
     virtual ~AbstractStoragePrivate() {}
 
+    /*
+     * Assigns the next sequence number to the change and appends it to
+     * the change log. Returns the new sequence number.
+     */
+    quint64 recordChange(StorageChange &change)
+    {
+        change.sequence = ++changeSequence;
+        if (changeLogSize > 0) {
+            changeLog.append(change);
+            while (changeLog.size() > changeLogSize) {
+                changeLog.removeFirst();
+            }
+        }
+        return changeSequence;
+    }
+
     AbstractConfiguration *configuration = nullptr;
     AbstractNotificator *notificator = nullptr;
     Error *error = nullptr;
@@ -40,6 +71,13 @@ public:
     quint16 starred = 0;
     bool ready = false;
     bool inOperation = false;
+    QList<StorageChange> changeLog;
+    quint64 changeSequence = 0;
+    quint64 lastBatchToken = 0;
+    int changeLogSize = 1000;
+    QJsonObject syncCheckpoint;
+    QHash<QString, QByteArray> replyHashes;
+    QDateTime starredWatermark;
 
 private:
     Q_DISABLE_COPY(AbstractStoragePrivate)
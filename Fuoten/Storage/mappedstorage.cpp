@@ -0,0 +1,1026 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "mappedstorage_p.h"
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <cstring>
+
+#define MAPPED_SEGMENT_MAGIC 0x46534547
+#define MAPPED_SEGMENT_VERSION 1
+#define MAPPED_META_MAGIC 0x464D4554
+#define MAPPED_META_VERSION 1
+#define MAPPED_GENERATION_MAGIC 0x46474E52
+#define MAPPED_GENERATION_VERSION 1
+#define MAPPED_META_FILE "meta.dat"
+#define MAPPED_GENERATION_FILE "segments.dat"
+#define MAPPED_ITEMS_FILE "items"
+#define MAPPED_BLOBS_FILE "blobs"
+#define MAPPED_SEGMENT_SUFFIX ".seg"
+
+using namespace Fuoten;
+
+
+static bool openSegment(QFile &file, quint32 recordSize, QString *errorString)
+{
+    if (!file.open(QIODevice::ReadWrite|QIODevice::Unbuffered)) {
+        *errorString = file.errorString();
+        return false;
+    }
+
+    MappedSegmentHeader h;
+
+    if (file.size() < static_cast<qint64>(sizeof(MappedSegmentHeader))) {
+        h.magic = MAPPED_SEGMENT_MAGIC;
+        h.version = MAPPED_SEGMENT_VERSION;
+        h.recordSize = recordSize;
+        h.reserved = 0;
+        if (!file.resize(0) || (file.write(reinterpret_cast<const char*>(&h), sizeof(h)) != sizeof(h))) {
+            *errorString = file.errorString();
+            file.close();
+            return false;
+        }
+        return true;
+    }
+
+    if ((file.read(reinterpret_cast<char*>(&h), sizeof(h)) != sizeof(h)) || (h.magic != MAPPED_SEGMENT_MAGIC) || (h.version != MAPPED_SEGMENT_VERSION) || (h.recordSize != recordSize)) {
+        *errorString = QStringLiteral("%1 is not a valid segment file.").arg(file.fileName());
+        file.close();
+        return false;
+    }
+
+    // drop a partially written record at the end of the segment
+    const qint64 tail = (file.size() - sizeof(MappedSegmentHeader)) % recordSize;
+    if (tail > 0) {
+        qWarning("Truncating %lli bytes of incomplete data at the end of %s.", tail, qUtf8Printable(file.fileName()));
+        file.resize(file.size() - tail);
+    }
+
+    return true;
+}
+
+
+
+MappedCompactionWorker::MappedCompactionWorker(const QString &blobsPath, const QString &newItemsPath, const QString &newBlobsPath, const QVector<MappedItemRecord> &records, QObject *parent) :
+    QThread(parent), m_blobsPath(blobsPath), m_newItemsPath(newItemsPath), m_newBlobsPath(newBlobsPath), m_records(records)
+{
+
+}
+
+
+void MappedCompactionWorker::run()
+{
+    QFile oldBlobs(m_blobsPath);
+    if (!oldBlobs.open(QIODevice::ReadOnly)) {
+        qWarning("Failed to open blob segment for compaction: %s", qUtf8Printable(oldBlobs.errorString()));
+        return;
+    }
+
+    const qint64 oldSize = oldBlobs.size();
+    const uchar *oldMap = oldBlobs.map(0, oldSize);
+    if (!oldMap) {
+        qWarning("Failed to map blob segment for compaction: %s", qUtf8Printable(oldBlobs.errorString()));
+        return;
+    }
+
+    // the segments of the next generation only get their final names when they have been
+    // written completely, they are not used before finishCompaction() has recorded the generation
+    QSaveFile newItems(m_newItemsPath);
+    QSaveFile newBlobs(m_newBlobsPath);
+
+    if (!newItems.open(QIODevice::WriteOnly) || !newBlobs.open(QIODevice::WriteOnly)) {
+        qWarning("Failed to create compacted segments: %s %s", qUtf8Printable(newItems.errorString()), qUtf8Printable(newBlobs.errorString()));
+        return;
+    }
+
+    MappedSegmentHeader h;
+    h.magic = MAPPED_SEGMENT_MAGIC;
+    h.version = MAPPED_SEGMENT_VERSION;
+    h.reserved = 0;
+    h.recordSize = sizeof(MappedItemRecord);
+    newItems.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    h.recordSize = 1;
+    newBlobs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    quint64 blobPos = sizeof(MappedSegmentHeader);
+
+    m_refs.reserve(m_records.size());
+
+    for (MappedItemRecord &r : m_records) {
+        for (int idx = 0; idx < MappedStringCount; ++idx) {
+            MappedBlobRef &ref = r.refs.strings[idx];
+            if ((ref.offset + ref.size) > static_cast<quint64>(oldSize)) {
+                qWarning("Invalid blob reference for item %lli.", r.id);
+                ref.size = 0;
+            }
+            if (ref.size > 0) {
+                newBlobs.write(reinterpret_cast<const char*>(oldMap + ref.offset), ref.size);
+            }
+            ref.offset = blobPos;
+            blobPos += ref.size;
+        }
+        newItems.write(reinterpret_cast<const char*>(&r), sizeof(r));
+        m_refs.insert(r.id, r.refs);
+    }
+
+    m_succeeded = newBlobs.commit() && newItems.commit();
+
+    qDebug("Compacted %i item records.", m_records.size());
+}
+
+
+
+
+QString MappedStoragePrivate::filePath(const QString &fileName) const
+{
+    return QDir(storageDir).absoluteFilePath(fileName);
+}
+
+
+
+/*
+ * Returns the path of the segment file name for the generation gen. Generation 0
+ * uses the plain file names of storages that have never been compacted.
+ */
+QString MappedStoragePrivate::segmentPath(const char *name, quint32 gen) const
+{
+    QString fileName = QLatin1String(name);
+    if (gen > 0) {
+        fileName += QLatin1Char('.') + QString::number(gen);
+    }
+    fileName += QLatin1String(MAPPED_SEGMENT_SUFFIX);
+    return filePath(fileName);
+}
+
+
+
+bool MappedStoragePrivate::open(QString *errorString)
+{
+    if (!QDir().mkpath(storageDir)) {
+        *errorString = QStringLiteral("Can not create storage directory %1.").arg(storageDir);
+        return false;
+    }
+
+    if (!readGeneration(errorString)) {
+        return false;
+    }
+
+    removeStaleSegments();
+
+    return openSegments(errorString);
+}
+
+
+
+bool MappedStoragePrivate::openSegments(QString *errorString)
+{
+    itemsFile.setFileName(segmentPath(MAPPED_ITEMS_FILE, generation));
+    blobFile.setFileName(segmentPath(MAPPED_BLOBS_FILE, generation));
+
+    if (!openSegment(itemsFile, sizeof(MappedItemRecord), errorString)) {
+        return false;
+    }
+
+    if (!openSegment(blobFile, 1, errorString)) {
+        itemsFile.close();
+        return false;
+    }
+
+    blobEnd = blobFile.size();
+
+    return true;
+}
+
+
+
+bool MappedStoragePrivate::readGeneration(QString *errorString)
+{
+    generation = 0;
+
+    QFile f(filePath(QStringLiteral(MAPPED_GENERATION_FILE)));
+
+    // the storage has never been compacted
+    if (!f.exists()) {
+        return true;
+    }
+
+    if (!f.open(QIODevice::ReadOnly)) {
+        *errorString = f.errorString();
+        return false;
+    }
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version >> generation;
+
+    if ((in.status() != QDataStream::Ok) || (magic != MAPPED_GENERATION_MAGIC) || (version != MAPPED_GENERATION_VERSION)) {
+        *errorString = QStringLiteral("%1 is not a valid segment generation file.").arg(f.fileName());
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/*
+ * Atomically records newGeneration as the generation of the segments to use.
+ * This is the commit point of a compaction.
+ */
+bool MappedStoragePrivate::writeGeneration(quint32 newGeneration)
+{
+    QSaveFile f(filePath(QStringLiteral(MAPPED_GENERATION_FILE)));
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning("Failed to open segment generation file: %s", qUtf8Printable(f.errorString()));
+        return false;
+    }
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << static_cast<quint32>(MAPPED_GENERATION_MAGIC) << static_cast<quint16>(MAPPED_GENERATION_VERSION) << newGeneration;
+
+    if (!f.commit()) {
+        qWarning("Failed to write segment generation file: %s", qUtf8Printable(f.errorString()));
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/*
+ * Removes the segment files of other generations, left over by a compaction
+ * that has been interrupted or has failed.
+ */
+void MappedStoragePrivate::removeStaleSegments() const
+{
+    const QString itemsPath = segmentPath(MAPPED_ITEMS_FILE, generation);
+    const QString blobsPath = segmentPath(MAPPED_BLOBS_FILE, generation);
+
+    const QDir dir(storageDir);
+    const QStringList files = dir.entryList({QStringLiteral(MAPPED_ITEMS_FILE "*" MAPPED_SEGMENT_SUFFIX), QStringLiteral(MAPPED_BLOBS_FILE "*" MAPPED_SEGMENT_SUFFIX)}, QDir::Files);
+
+    for (const QString &file : files) {
+        const QString path = dir.absoluteFilePath(file);
+        if ((path != itemsPath) && (path != blobsPath)) {
+            qDebug("Removing stale segment file %s.", qUtf8Printable(path));
+            QFile::remove(path);
+        }
+    }
+}
+
+
+
+bool MappedStoragePrivate::load(QString *errorString)
+{
+    QFile meta(filePath(QStringLiteral(MAPPED_META_FILE)));
+
+    if (meta.exists()) {
+
+        if (!meta.open(QIODevice::ReadOnly)) {
+            *errorString = meta.errorString();
+            return false;
+        }
+
+        QDataStream in(&meta);
+        in.setVersion(QDataStream::Qt_5_0);
+
+        quint32 magic = 0;
+        quint16 version = 0;
+        in >> magic >> version;
+
+        if ((magic != MAPPED_META_MAGIC) || (version != MAPPED_META_VERSION)) {
+            *errorString = QStringLiteral("%1 is not a valid meta data file.").arg(meta.fileName());
+            return false;
+        }
+
+        qint32 folderCount = 0;
+        in >> folderCount;
+        for (qint32 n = 0; (n < folderCount) && (in.status() == QDataStream::Ok); ++n) {
+            qint64 id = 0;
+            QString name;
+            in >> id >> name;
+            insertFolder(id, name);
+        }
+
+        qint32 feedCount = 0;
+        in >> feedCount;
+        for (qint32 n = 0; (n < feedCount) && (in.status() == QDataStream::Ok); ++n) {
+            FeedRecord f;
+            in >> f.id >> f.folderId >> f.title >> f.url >> f.link >> f.added >> f.ordering >> f.pinned >> f.updateErrorCount >> f.lastUpdateError >> f.faviconLink;
+            insertFeed(f);
+        }
+
+        if (in.status() != QDataStream::Ok) {
+            *errorString = QStringLiteral("Failed to read %1.").arg(meta.fileName());
+            return false;
+        }
+    }
+
+    const qint64 itemsSize = itemsFile.size();
+    const qint64 count = (itemsSize - static_cast<qint64>(sizeof(MappedSegmentHeader))) / static_cast<qint64>(sizeof(MappedItemRecord));
+
+    writtenRecords = static_cast<quint32>(count);
+
+    if (count > 0) {
+
+        uchar *itemsMap = itemsFile.map(0, itemsSize);
+        if (!itemsMap) {
+            *errorString = itemsFile.errorString();
+            return false;
+        }
+
+        if (!remapBlob()) {
+            itemsFile.unmap(itemsMap);
+            *errorString = blobFile.errorString();
+            return false;
+        }
+
+        const MappedItemRecord *records = reinterpret_cast<const MappedItemRecord*>(itemsMap + sizeof(MappedSegmentHeader));
+
+        // later records supersede earlier ones
+        QHash<qint64, const MappedItemRecord*> latest;
+        latest.reserve(static_cast<int>(count));
+        for (qint64 n = 0; n < count; ++n) {
+            latest.insert(records[n].id, &records[n]);
+        }
+
+        for (const MappedItemRecord *r : qAsConst(latest)) {
+
+            if ((r->flags & MappedRemoved) || !feeds.contains(r->feedId)) {
+                continue;
+            }
+
+            bool valid = true;
+            for (int idx = 0; idx < MappedStringCount; ++idx) {
+                if ((r->refs.strings[idx].offset + r->refs.strings[idx].size) > static_cast<quint64>(blobMapSize)) {
+                    valid = false;
+                    break;
+                }
+            }
+
+            if (Q_UNLIKELY(!valid)) {
+                qWarning("Skipping item %lli with invalid blob references.", r->id);
+                continue;
+            }
+
+            ItemRecord i;
+            i.id = r->id;
+            i.feedId = r->feedId;
+            i.pubDate = r->pubDate;
+            i.lastModified = r->lastModified;
+            i.unread = (r->flags & MappedUnread);
+            i.starred = (r->flags & MappedStarred);
+            i.queue = FuotenEnums::QueueActions(QFlag(r->queue));
+
+            // only the keys of the guid hash and title indexes are kept in memory,
+            // all other strings are decoded from the mapping when an article is created
+            for (int idx = 0; idx < MappedStringCount; ++idx) {
+                if (isResidentString(idx)) {
+                    setItemString(i, idx, mappedString(r->refs.strings[idx]));
+                }
+            }
+
+            insertItem(i);
+            itemRefs.insert(i.id, r->refs);
+        }
+
+        itemsFile.unmap(itemsMap);
+    }
+
+    recountAll();
+
+    qDebug("Loaded %i folders, %i feeds and %i items from %s.", folders.size(), feeds.size(), items.size(), qUtf8Printable(storageDir));
+
+    return true;
+}
+
+
+
+void MappedStoragePrivate::close()
+{
+    if (blobMap) {
+        blobFile.unmap(blobMap);
+        blobMap = nullptr;
+        blobMapSize = 0;
+    }
+    blobFile.close();
+    itemsFile.close();
+}
+
+
+
+bool MappedStoragePrivate::remapBlob() const
+{
+    if (blobMap) {
+        blobFile.unmap(blobMap);
+        blobMap = nullptr;
+        blobMapSize = 0;
+    }
+
+    const qint64 size = blobFile.size();
+    blobMap = blobFile.map(0, size);
+    if (!blobMap) {
+        qWarning("Failed to map blob segment: %s", qUtf8Printable(blobFile.errorString()));
+        return false;
+    }
+
+    blobMapSize = size;
+
+    return true;
+}
+
+
+
+QString MappedStoragePrivate::itemBody(const ItemRecord &i) const
+{
+    if (!i.body.isEmpty()) {
+        return i.body;
+    }
+
+    auto it = itemRefs.constFind(i.id);
+    if (it == itemRefs.constEnd()) {
+        return QString();
+    }
+
+    return mappedString(it.value().strings[MappedBody]);
+}
+
+
+
+MemoryStoragePrivate::ItemRecord MappedStoragePrivate::itemWithStrings(const ItemRecord &i) const
+{
+    auto it = itemRefs.constFind(i.id);
+    if (it == itemRefs.constEnd()) {
+        return i;
+    }
+
+    ItemRecord r = i;
+
+    // strings set by an update that is not journaled yet take precedence over the mapped ones
+    for (int idx = 0; idx < MappedStringCount; ++idx) {
+        if ((idx != MappedBody) && itemString(r, idx).isEmpty()) {
+            setItemString(r, idx, mappedString(it.value().strings[idx]));
+        }
+    }
+
+    return r;
+}
+
+
+
+void MappedStoragePrivate::itemRemoved(qint64 id)
+{
+    pendingRemovals.append(id);
+}
+
+
+
+QString MappedStoragePrivate::mappedString(const MappedBlobRef &ref) const
+{
+    if (ref.size == 0) {
+        return QString();
+    }
+
+    if (((ref.offset + ref.size) > static_cast<quint64>(blobMapSize)) && (!remapBlob() || ((ref.offset + ref.size) > static_cast<quint64>(blobMapSize)))) {
+        return QString();
+    }
+
+    return QString::fromUtf8(reinterpret_cast<const char*>(blobMap + ref.offset), ref.size);
+}
+
+
+
+bool MappedStoragePrivate::writeMeta()
+{
+    QSaveFile f(filePath(QStringLiteral(MAPPED_META_FILE)));
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning("Failed to open meta data file: %s", qUtf8Printable(f.errorString()));
+        return false;
+    }
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << static_cast<quint32>(MAPPED_META_MAGIC) << static_cast<quint16>(MAPPED_META_VERSION);
+
+    out << static_cast<qint32>(folders.size());
+    for (const FolderRecord &fo : qAsConst(folders)) {
+        out << fo.id << fo.name;
+    }
+
+    out << static_cast<qint32>(feeds.size());
+    for (const FeedRecord &fe : qAsConst(feeds)) {
+        out << fe.id << fe.folderId << fe.title << fe.url << fe.link << fe.added << fe.ordering << fe.pinned << fe.updateErrorCount << fe.lastUpdateError << fe.faviconLink;
+    }
+
+    if (!f.commit()) {
+        qWarning("Failed to write meta data file: %s", qUtf8Printable(f.errorString()));
+        return false;
+    }
+
+    return true;
+}
+
+
+
+bool MappedStoragePrivate::appendBuffers(const QByteArray &blobs, const QByteArray &records)
+{
+    // blobs are written first, so that a record never references data that is not on disk
+    if (!blobs.isEmpty()) {
+        if (!blobFile.seek(blobEnd) || (blobFile.write(blobs) != blobs.size())) {
+            qWarning("Failed to write to blob segment: %s", qUtf8Printable(blobFile.errorString()));
+            return false;
+        }
+        blobEnd += blobs.size();
+    }
+
+    if (!records.isEmpty()) {
+        if (!itemsFile.seek(itemsFile.size()) || (itemsFile.write(records) != records.size())) {
+            qWarning("Failed to write to item segment: %s", qUtf8Printable(itemsFile.errorString()));
+            return false;
+        }
+        writtenRecords += records.size() / sizeof(MappedItemRecord);
+    }
+
+    return true;
+}
+
+
+
+bool MappedStoragePrivate::appendItems(const IdList &ids, bool withStrings)
+{
+    if (ids.isEmpty()) {
+        return true;
+    }
+
+    QByteArray blobs;
+    QByteArray records;
+    records.reserve(ids.size() * sizeof(MappedItemRecord));
+
+    for (qint64 id : ids) {
+        auto it = items.find(id);
+        if (it == items.end()) {
+            continue;
+        }
+
+        ItemRecord &i = it.value();
+        const bool known = itemRefs.contains(id);
+        MappedItemRefs &refs = itemRefs[id];
+
+        for (int idx = 0; idx < MappedStringCount; ++idx) {
+            // the guid never changes and the body is only set for new items,
+            // all other strings are set again by every update of the item
+            bool write = !known;
+            if (known) {
+                if (idx == MappedBody) {
+                    write = !i.body.isEmpty();
+                } else if ((idx != MappedGuid) && (idx != MappedGuidHash)) {
+                    write = withStrings;
+                }
+            }
+            if (write) {
+                const QByteArray bytes = itemString(i, idx).toUtf8();
+                refs.strings[idx].offset = blobEnd + blobs.size();
+                refs.strings[idx].size = bytes.size();
+                refs.strings[idx].reserved = 0;
+                blobs.append(bytes);
+            }
+        }
+
+        // the strings now live in the blob segment
+        releaseStrings(i);
+
+        const MappedItemRecord r = createRecord(i, refs);
+        records.append(reinterpret_cast<const char*>(&r), sizeof(r));
+
+        if (compactionWorker) {
+            changedDuringCompaction.insert(id);
+        }
+    }
+
+    return appendBuffers(blobs, records);
+}
+
+
+
+bool MappedStoragePrivate::appendRemovals(const IdList &ids)
+{
+    if (ids.isEmpty()) {
+        return true;
+    }
+
+    QByteArray records;
+    records.reserve(ids.size() * sizeof(MappedItemRecord));
+
+    for (qint64 id : ids) {
+        MappedItemRecord r;
+        std::memset(&r, 0, sizeof(r));
+        r.id = id;
+        r.flags = MappedRemoved;
+        records.append(reinterpret_cast<const char*>(&r), sizeof(r));
+
+        itemRefs.remove(id);
+
+        if (compactionWorker) {
+            changedDuringCompaction.insert(id);
+        }
+    }
+
+    return appendBuffers(QByteArray(), records);
+}
+
+
+
+bool MappedStoragePrivate::appendPendingRemovals()
+{
+    const IdList ids = pendingRemovals;
+    pendingRemovals.clear();
+    return appendRemovals(ids);
+}
+
+
+
+IdList MappedStoragePrivate::itemIdsForFeed(qint64 feedId) const
+{
+    return itemsByFeed.values(feedId);
+}
+
+
+
+IdList MappedStoragePrivate::itemIdsForFolder(qint64 folderId) const
+{
+    IdList ids;
+    const IdList feedIds = feedsByFolder.values(folderId);
+    for (qint64 feedId : feedIds) {
+        ids.append(itemsByFeed.values(feedId));
+    }
+    return ids;
+}
+
+
+
+QVector<MappedItemRecord> MappedStoragePrivate::compactionSnapshot() const
+{
+    QVector<MappedItemRecord> records;
+    records.reserve(items.size());
+
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        auto rit = itemRefs.constFind(it.key());
+        if (rit != itemRefs.constEnd()) {
+            records.push_back(createRecord(it.value(), rit.value()));
+        }
+    }
+
+    return records;
+}
+
+
+
+bool MappedStoragePrivate::finishCompaction()
+{
+    MappedCompactionWorker *worker = compactionWorker;
+    compactionWorker = nullptr;
+
+    const quint32 oldGeneration = generation;
+    const quint32 newGeneration = generation + 1;
+    const QString newItemsPath = segmentPath(MAPPED_ITEMS_FILE, newGeneration);
+    const QString newBlobsPath = segmentPath(MAPPED_BLOBS_FILE, newGeneration);
+
+    if (!worker || !worker->succeeded()) {
+        QFile::remove(newItemsPath);
+        QFile::remove(newBlobsPath);
+        changedDuringCompaction.clear();
+        return false;
+    }
+
+    // items changed while the compaction was running have to be written again to the new segments,
+    // their current strings are only available in the old blob segment
+    IdList changedItems;
+    IdList removedItems;
+
+    for (qint64 id : qAsConst(changedDuringCompaction)) {
+        auto it = items.find(id);
+        if (it == items.end()) {
+            removedItems.append(id);
+            continue;
+        }
+        changedItems.append(id);
+        ItemRecord &i = it.value();
+        const QString body = itemBody(i);
+        i = itemWithStrings(i);
+        i.body = body;
+    }
+
+    changedDuringCompaction.clear();
+
+    // the old segments and references stay valid until the new generation has been recorded
+    const QHash<qint64, MappedItemRefs> oldRefs = itemRefs;
+    const quint32 oldWrittenRecords = writtenRecords;
+
+    close();
+
+    generation = newGeneration;
+    itemRefs = worker->refs();
+    writtenRecords = itemRefs.size();
+
+    for (qint64 id : qAsConst(changedItems)) {
+        itemRefs.remove(id);
+    }
+
+    QString errorString;
+    if (openSegments(&errorString) && remapBlob() && appendItems(changedItems, true) && appendRemovals(removedItems) && itemsFile.flush() && blobFile.flush() && writeGeneration(newGeneration)) {
+        QFile::remove(segmentPath(MAPPED_ITEMS_FILE, oldGeneration));
+        QFile::remove(segmentPath(MAPPED_BLOBS_FILE, oldGeneration));
+        return true;
+    }
+
+    qWarning("Failed to switch to the compacted segments in %s: %s", qUtf8Printable(storageDir), qUtf8Printable(errorString));
+
+    close();
+    QFile::remove(newItemsPath);
+    QFile::remove(newBlobsPath);
+
+    generation = oldGeneration;
+    itemRefs = oldRefs;
+    writtenRecords = oldWrittenRecords;
+
+    if (!openSegments(&errorString) || !remapBlob()) {
+        qWarning("Failed to reopen segment files: %s", qUtf8Printable(errorString));
+    }
+
+    return false;
+}
+
+
+
+MappedItemRecord MappedStoragePrivate::createRecord(const ItemRecord &i, const MappedItemRefs &refs)
+{
+    MappedItemRecord r;
+    std::memset(&r, 0, sizeof(r));
+    r.id = i.id;
+    r.feedId = i.feedId;
+    r.pubDate = i.pubDate;
+    r.lastModified = i.lastModified;
+    r.flags = (i.unread ? MappedUnread : 0) | (i.starred ? MappedStarred : 0);
+    r.queue = static_cast<quint8>(int(i.queue));
+    r.refs = refs;
+    return r;
+}
+
+
+
+bool MappedStoragePrivate::isResidentString(int idx)
+{
+    return (idx == MappedGuidHash) || (idx == MappedTitle);
+}
+
+
+
+void MappedStoragePrivate::releaseStrings(ItemRecord &i)
+{
+    i.guid.clear();
+    i.url.clear();
+    i.author.clear();
+    i.body.clear();
+    i.enclosureMime.clear();
+    i.enclosureLink.clear();
+    i.fingerprint.clear();
+}
+
+
+
+QString MappedStoragePrivate::itemString(const ItemRecord &i, int idx)
+{
+    switch (idx) {
+    case MappedGuid:
+        return i.guid;
+    case MappedGuidHash:
+        return i.guidHash;
+    case MappedUrl:
+        return i.url.toString();
+    case MappedTitle:
+        return i.title;
+    case MappedAuthor:
+        return i.author;
+    case MappedBody:
+        return i.body;
+    case MappedEnclosureMime:
+        return i.enclosureMime;
+    case MappedEnclosureLink:
+        return i.enclosureLink.toString();
+    case MappedFingerprint:
+        return i.fingerprint;
+    default:
+        return QString();
+    }
+}
+
+
+
+void MappedStoragePrivate::setItemString(ItemRecord &i, int idx, const QString &value)
+{
+    switch (idx) {
+    case MappedGuid:
+        i.guid = value;
+        break;
+    case MappedGuidHash:
+        i.guidHash = value;
+        break;
+    case MappedUrl:
+        i.url = QUrl(value);
+        break;
+    case MappedTitle:
+        i.title = value;
+        break;
+    case MappedAuthor:
+        i.author = value;
+        break;
+    case MappedBody:
+        i.body = value;
+        break;
+    case MappedEnclosureMime:
+        i.enclosureMime = value;
+        break;
+    case MappedEnclosureLink:
+        i.enclosureLink = QUrl(value);
+        break;
+    case MappedFingerprint:
+        i.fingerprint = value;
+        break;
+    default:
+        break;
+    }
+}
+
+
+
+
+static void compactIfNeeded(MappedStorage *q, MappedStoragePrivate *d)
+{
+    if (!d->needsCompaction()) {
+        return;
+    }
+
+    qDebug("Start compacting %u item records in %s.", d->writtenRecords, qUtf8Printable(d->storageDir));
+
+    d->compactionWorker = new MappedCompactionWorker(d->segmentPath(MAPPED_BLOBS_FILE, d->generation),
+                                                     d->segmentPath(MAPPED_ITEMS_FILE, d->generation + 1),
+                                                     d->segmentPath(MAPPED_BLOBS_FILE, d->generation + 1),
+                                                     d->compactionSnapshot(), q);
+    MappedCompactionWorker *worker = d->compactionWorker;
+    QObject::connect(worker, &QThread::finished, q, [d, worker] () {
+        if (!d->finishCompaction()) {
+            qWarning("Failed to compact the segments in %s.", qUtf8Printable(d->storageDir));
+        }
+        worker->deleteLater();
+    });
+    worker->start(QThread::LowPriority);
+}
+
+
+static void journalItems(MappedStorage *q, MappedStoragePrivate *d, const IdList &ids, bool withStrings)
+{
+    d->appendItems(ids, withStrings);
+    compactIfNeeded(q, d);
+}
+
+
+
+MappedStorage::MappedStorage(const QString &storageDir, QObject *parent) :
+    MemoryStorage(* new MappedStoragePrivate(storageDir), parent)
+{
+    Q_D(MappedStorage);
+
+    // every change made by MemoryStorage is announced by a signal, use them to journal the changes
+
+    // removed items are collected by MappedStoragePrivate::itemRemoved(), that also catches
+    // the items removed together with their feed or folder
+    connect(this, &AbstractStorage::requestedItems, this, [this, d] (const IdList &updatedItems, const IdList &newItems) {
+        d->appendItems(newItems, true);
+        d->appendItems(updatedItems, true);
+        d->appendPendingRemovals();
+        compactIfNeeded(this, d);
+    });
+
+    connect(this, &AbstractStorage::markedItems, this, [this, d] (const IdList &itemIds) {
+        journalItems(this, d, itemIds, false);
+    });
+
+    connect(this, &AbstractStorage::markedItem, this, [this, d] (qint64 itemId) {
+        journalItems(this, d, IdList({itemId}), false);
+    });
+
+    connect(this, &AbstractStorage::dequeuedItems, this, [this, d] (const IdList &itemIds) {
+        journalItems(this, d, itemIds, false);
+    });
+
+    connect(this, &AbstractStorage::starredItems, this, [this, d] (const QList<QPair<qint64, QString>> &articles) {
+        IdList ids;
+        ids.reserve(articles.size());
+        for (const QPair<qint64, QString> &a : articles) {
+            const qint64 id = d->itemsByGuidHash.value(a, -1);
+            if (id > -1) {
+                ids.append(id);
+            }
+        }
+        journalItems(this, d, ids, false);
+    });
+
+    connect(this, &AbstractStorage::starredItem, this, [this, d] (qint64 feedId, const QString &guidHash) {
+        const qint64 id = d->itemsByGuidHash.value(qMakePair(feedId, guidHash), -1);
+        if (id > -1) {
+            journalItems(this, d, IdList({id}), false);
+        }
+    });
+
+    auto journalFeed = [this, d] (qint64 feedId) {
+        journalItems(this, d, d->itemIdsForFeed(feedId), false);
+    };
+    connect(this, &AbstractStorage::markedReadFeed, this, journalFeed);
+    connect(this, &AbstractStorage::markedReadFeedInQueue, this, journalFeed);
+
+    auto journalFolder = [this, d] (qint64 folderId) {
+        journalItems(this, d, d->itemIdsForFolder(folderId), false);
+    };
+    connect(this, &AbstractStorage::markedReadFolder, this, journalFolder);
+    connect(this, &AbstractStorage::markedReadFolderInQueue, this, journalFolder);
+
+    auto journalAll = [this, d] () {
+        journalItems(this, d, d->items.keys(), false);
+    };
+    connect(this, &AbstractStorage::markedAllItemsRead, this, journalAll);
+    connect(this, &AbstractStorage::markedAllItemsReadInQueue, this, journalAll);
+    connect(this, &AbstractStorage::queueCleared, this, journalAll);
+
+    auto writeMeta = [d] () {
+        d->writeMeta();
+    };
+    // the items of deleted feeds and folders get removal records before the meta data is
+    // written, otherwise they would come back if a feed with the same ID is added later
+    auto writeRemovalsAndMeta = [this, d] () {
+        d->appendPendingRemovals();
+        d->writeMeta();
+        compactIfNeeded(this, d);
+    };
+    connect(this, &AbstractStorage::requestedFolders, this, [writeRemovalsAndMeta] (const QList<QPair<qint64, QString>> &updatedFolders, const QList<QPair<qint64, QString>> &newFolders, const IdList &deletedFolders) {
+        if (!updatedFolders.isEmpty() || !newFolders.isEmpty() || !deletedFolders.isEmpty()) {
+            writeRemovalsAndMeta();
+        }
+    });
+    connect(this, &AbstractStorage::createdFolder, this, writeMeta);
+    connect(this, &AbstractStorage::renamedFolder, this, writeMeta);
+    connect(this, &AbstractStorage::deletedFolder, this, writeRemovalsAndMeta);
+    connect(this, &AbstractStorage::requestedFeeds, this, [writeRemovalsAndMeta] (const IdList &updatedFeeds, const IdList &newFeeds, const IdList &deletedFeeds) {
+        if (!updatedFeeds.isEmpty() || !newFeeds.isEmpty() || !deletedFeeds.isEmpty()) {
+            writeRemovalsAndMeta();
+        }
+    });
+    connect(this, &AbstractStorage::createdFeed, this, writeMeta);
+    connect(this, &AbstractStorage::deletedFeed, this, writeRemovalsAndMeta);
+    connect(this, &AbstractStorage::movedFeed, this, writeMeta);
+    connect(this, &AbstractStorage::renamedFeed, this, writeMeta);
+}
+
+
+
+void MappedStorage::init()
+{
+    Q_D(MappedStorage);
+
+    QString errorString;
+
+    if (!d->open(&errorString) || !d->load(&errorString)) {
+        d->close();
+        //% "Failed to open the storage files."
+        setError(new Error(Error::StorageError, Error::Critical, qtTrId("libfuoten-err-mapped-storage-open"), errorString, this));
+        notify(error());
+        return;
+    }
+
+    MemoryStorage::init();
+}
+
+#include "moc_mappedstorage.cpp"
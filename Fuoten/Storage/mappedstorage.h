@@ -0,0 +1,82 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENMAPPEDSTORAGE_H
+#define FUOTENMAPPEDSTORAGE_H
+
+#include <QObject>
+#include "memorystorage.h"
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+class MappedStoragePrivate;
+
+/*!
+ * \brief Persistent storage built on memory-mapped, append-only segment files.
+ *
+ * MappedStorage is an alternative to SQLiteStorage for read-heavy clients. It uses the indexes of
+ * MemoryStorage to answer queries and persists every change to files in the storage directory:
+ *
+ * \li \c meta.dat contains the folders and feeds and is rewritten atomically on every change
+ * \li \c items.seg contains fixed-width item records that are only ever appended, the last record for an item wins
+ * \li \c blobs.seg contains the UTF-8 encoded strings and article bodies referenced by the item records
+ * \li \c segments.dat contains the generation of the segment files, it is rewritten atomically by a compaction
+ *
+ * The blob segment is mapped into memory. Items only keep the offsets of their strings into the mapping,
+ * except for the GUID hash and the title that are needed by the lookup and sort indexes. All other strings
+ * and the bodies are decoded from the mapping when an article is created, so they do not occupy heap memory.
+ * Removing a feed or folder writes removal records for all of its items, items whose feed does not exist
+ * anymore are dropped on load as well.
+ * When the item segment contains much more records than there are live items, the segments are compacted
+ * in a background thread into the files of the next generation, like \c items.1.seg and \c blobs.1.seg.
+ * The new generation is only used after it has been recorded in \c segments.dat, so an interrupted
+ * compaction leaves the previous segments untouched.
+ *
+ * The storage backend is selected by constructing either a SQLiteStorage or a MappedStorage object, both
+ * implement the same signal contract. The storage directory will be created if it does not exist.
+ * Call init() before using the storage.
+ *
+ * \headerfile "" <Fuoten/Storage/MappedStorage>
+ */
+class FUOTENSHARED_EXPORT MappedStorage : public MemoryStorage
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Constructs a new MappedStorage object that keeps its segment files in \a storageDir.
+     */
+    explicit MappedStorage(const QString &storageDir, QObject *parent = nullptr);
+
+    /*!
+     * \brief Initializes the storage.
+     *
+     * Opens the segment files in the storage directory and loads the folders, feeds and items.
+     * Will set the storage to ready on success.
+     */
+    void init() override;
+
+private:
+    Q_DECLARE_PRIVATE(MappedStorage)
+    Q_DISABLE_COPY(MappedStorage)
+};
+
+}
+
+#endif // FUOTENMAPPEDSTORAGE_H
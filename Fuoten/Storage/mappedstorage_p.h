@@ -0,0 +1,183 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENMAPPEDSTORAGE_P_H
+#define FUOTENMAPPEDSTORAGE_P_H
+
+#include "mappedstorage.h"
+#include "memorystorage_p.h"
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QThread>
+#include <QVector>
+
+namespace Fuoten {
+
+enum MappedString : quint8 {
+    MappedGuid = 0,
+    MappedGuidHash,
+    MappedUrl,
+    MappedTitle,
+    MappedAuthor,
+    MappedBody,
+    MappedEnclosureMime,
+    MappedEnclosureLink,
+    MappedFingerprint,
+    MappedStringCount
+};
+
+// all segment structures use the native byte order, the segment files are a local cache
+struct MappedSegmentHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 recordSize;
+    quint32 reserved;
+};
+
+struct MappedBlobRef {
+    quint64 offset;
+    quint32 size;
+    quint32 reserved;
+};
+
+struct MappedItemRefs {
+    MappedBlobRef strings[MappedStringCount];
+};
+
+struct MappedItemRecord {
+    qint64 id;
+    qint64 feedId;
+    quint32 pubDate;
+    quint32 lastModified;
+    quint8 flags;
+    quint8 queue;
+    quint16 reserved1;
+    quint32 reserved2;
+    MappedItemRefs refs;
+};
+
+static_assert(sizeof(MappedSegmentHeader) == 16, "unexpected size of MappedSegmentHeader");
+static_assert(sizeof(MappedItemRecord) == 176, "unexpected size of MappedItemRecord");
+
+enum MappedItemFlag : quint8 {
+    MappedUnread    = 0x01,
+    MappedStarred   = 0x02,
+    MappedRemoved   = 0x80
+};
+
+
+class MappedCompactionWorker : public QThread
+{
+    Q_OBJECT
+public:
+    MappedCompactionWorker(const QString &blobsPath, const QString &newItemsPath, const QString &newBlobsPath, const QVector<MappedItemRecord> &records, QObject *parent = nullptr);
+
+    bool succeeded() const { return m_succeeded; }
+    QHash<qint64, MappedItemRefs> refs() const { return m_refs; }
+
+protected:
+    void run() override;
+
+private:
+    QString m_blobsPath;
+    QString m_newItemsPath;
+    QString m_newBlobsPath;
+    QVector<MappedItemRecord> m_records;
+    QHash<qint64, MappedItemRefs> m_refs;
+    bool m_succeeded = false;
+};
+
+
+
+
+class MappedStoragePrivate : public MemoryStoragePrivate
+{
+public:
+    MappedStoragePrivate(const QString &_storageDir) :
+        MemoryStoragePrivate(),
+        storageDir(_storageDir)
+    {
+    }
+
+    ~MappedStoragePrivate() override
+    {
+        if (compactionWorker) {
+            compactionWorker->wait();
+        }
+    }
+
+    QString itemBody(const ItemRecord &i) const override;
+    ItemRecord itemWithStrings(const ItemRecord &i) const override;
+    void itemRemoved(qint64 id) override;
+
+    bool open(QString *errorString);
+    bool load(QString *errorString);
+    void close();
+    bool openSegments(QString *errorString);
+
+    bool readGeneration(QString *errorString);
+    bool writeGeneration(quint32 newGeneration);
+    void removeStaleSegments() const;
+
+    bool remapBlob() const;
+    bool writeMeta();
+    bool appendBuffers(const QByteArray &blobs, const QByteArray &records);
+    bool appendItems(const IdList &ids, bool withStrings);
+    bool appendRemovals(const IdList &ids);
+    bool appendPendingRemovals();
+    IdList itemIdsForFeed(qint64 feedId) const;
+    IdList itemIdsForFolder(qint64 folderId) const;
+
+    bool needsCompaction() const
+    {
+        return !compactionWorker && (writtenRecords > 1024) && (writtenRecords > (2 * static_cast<quint32>(items.size())));
+    }
+
+    QVector<MappedItemRecord> compactionSnapshot() const;
+    bool finishCompaction();
+
+    QString mappedString(const MappedBlobRef &ref) const;
+
+    static MappedItemRecord createRecord(const ItemRecord &i, const MappedItemRefs &refs);
+    static bool isResidentString(int idx);
+    static void releaseStrings(ItemRecord &i);
+    static QString itemString(const ItemRecord &i, int idx);
+    static void setItemString(ItemRecord &i, int idx, const QString &value);
+
+    QString filePath(const QString &fileName) const;
+    QString segmentPath(const char *name, quint32 gen) const;
+
+    QString storageDir;
+    QFile itemsFile;
+    mutable QFile blobFile;
+    mutable uchar *blobMap = nullptr;
+    mutable qint64 blobMapSize = 0;
+    qint64 blobEnd = 0;
+    quint32 writtenRecords = 0;
+    quint32 generation = 0;
+    QHash<qint64, MappedItemRefs> itemRefs;
+    IdList pendingRemovals;
+    QSet<qint64> changedDuringCompaction;
+    MappedCompactionWorker *compactionWorker = nullptr;
+};
+
+}
+
+#endif // FUOTENMAPPEDSTORAGE_P_H
@@ -0,0 +1,1698 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "memorystorage_p.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QDateTime>
+#include <QSet>
+#include <QRegularExpression>
+#include <functional>
+#include "../folder.h"
+#include "../feed.h"
+#include "../article.h"
+#include "../Helpers/abstractconfiguration.h"
+#include "../Helpers/jsondecoder.h"
+
+using namespace Fuoten;
+
+
+static Feed *createFeed(const MemoryStoragePrivate *d, const MemoryStoragePrivate::FeedRecord &f)
+{
+    return new Feed(f.id,
+                    f.folderId,
+                    f.title,
+                    f.url,
+                    f.link,
+                    QDateTime::fromTime_t(f.added),
+                    f.unreadCount,
+                    (Feed::FeedOrdering)f.ordering,
+                    f.pinned,
+                    f.updateErrorCount,
+                    f.lastUpdateError,
+                    f.faviconLink,
+                    d->folders.value(f.folderId).name);
+}
+
+
+static Article *createArticle(const MemoryStoragePrivate *d, const MemoryStoragePrivate::ItemRecord &record, const QString &body)
+{
+    const MemoryStoragePrivate::ItemRecord i = d->itemWithStrings(record);
+    const MemoryStoragePrivate::FeedRecord fe = d->feeds.value(i.feedId);
+    const MemoryStoragePrivate::FolderRecord fo = d->folders.value(fe.folderId);
+
+    return new Article(i.id,
+                       i.feedId,
+                       fe.title,
+                       i.guid,
+                       i.guidHash,
+                       i.url,
+                       i.title,
+                       i.author,
+                       QDateTime::fromTime_t(i.pubDate),
+                       body,
+                       i.enclosureMime,
+                       i.enclosureLink,
+                       i.unread,
+                       i.starred,
+                       QDateTime::fromTime_t(i.lastModified),
+                       i.fingerprint,
+                       fo.id,
+                       fo.name,
+                       i.queue);
+}
+
+
+static bool itemLessThan(const MemoryStoragePrivate *d, FuotenEnums::SortingRole role, qint64 a, qint64 b)
+{
+    // the const operator[] and value() would return copies of the records
+    const MemoryStoragePrivate::ItemRecord &ia = d->items.constFind(a).value();
+    const MemoryStoragePrivate::ItemRecord &ib = d->items.constFind(b).value();
+
+    switch (role) {
+    case FuotenEnums::ID:
+        return a < b;
+    case FuotenEnums::Name:
+        return ia.title < ib.title;
+    case FuotenEnums::FolderName:
+    {
+        const auto fa = d->folders.constFind(d->folderIdForFeed(ia.feedId));
+        const auto fb = d->folders.constFind(d->folderIdForFeed(ib.feedId));
+        const QString na = (fa != d->folders.constEnd()) ? fa.value().name : QString();
+        const QString nb = (fb != d->folders.constEnd()) ? fb.value().name : QString();
+        return na < nb;
+    }
+    default:
+        return ia.pubDate < ib.pubDate;
+    }
+}
+
+
+MemoryStorage::MemoryStorage(QObject *parent) :
+    AbstractStorage(* new MemoryStoragePrivate, parent)
+{
+}
+
+
+MemoryStorage::MemoryStorage(MemoryStoragePrivate &dd, QObject *parent) :
+    AbstractStorage(dd, parent)
+{
+}
+
+
+void MemoryStorage::init()
+{
+    Q_D(MemoryStorage);
+
+    if (!d->folders.contains(0)) {
+        d->insertFolder(0, QString());
+    }
+
+    setTotalUnread(d->countUnread());
+    setStarred(d->countStarred());
+
+    setReady(true);
+}
+
+
+qint64 MemoryStorage::getNewestItemId(FuotenEnums::Type type, qint64 id)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return -1;
+    }
+
+    if ((type == FuotenEnums::Folder) && (id <= 0)) {
+        //% "The folder ID is not valid."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-folder-id"), QString(), this));
+        notify(error());
+        return -1;
+    }
+
+    if ((type == FuotenEnums::Feed) && (id <= 0)) {
+        //% "The feed ID is not valid."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-feed-id"), QString(), this));
+        notify(error());
+        return -1;
+    }
+
+    Q_D(MemoryStorage);
+
+    qint64 newest = -1;
+
+    switch (type) {
+    case FuotenEnums::Feed:
+    {
+        auto it = d->itemsByFeed.constFind(id);
+        while (it != d->itemsByFeed.constEnd() && it.key() == id) {
+            newest = qMax(newest, it.value());
+            ++it;
+        }
+        break;
+    }
+    case FuotenEnums::Folder:
+    {
+        const IdList feedIds = d->feedsByFolder.values(id);
+        for (qint64 feedId : feedIds) {
+            auto it = d->itemsByFeed.constFind(feedId);
+            while (it != d->itemsByFeed.constEnd() && it.key() == feedId) {
+                newest = qMax(newest, it.value());
+                ++it;
+            }
+        }
+        break;
+    }
+    case FuotenEnums::All:
+    {
+        for (auto it = d->items.constBegin(); it != d->items.constEnd(); ++it) {
+            newest = qMax(newest, it.key());
+        }
+        break;
+    }
+    default:
+        return -1;
+    }
+
+    return newest;
+}
+
+
+QHash<qint64, QList<uint>> MemoryStorage::getPublishDates(int limit)
+{
+    Q_D(MemoryStorage);
+
+    QHash<qint64, QList<uint>> dates;
+    dates.reserve(d->feeds.size());
+
+    for (const MemoryStoragePrivate::ItemRecord &i : qAsConst(d->items)) {
+        dates[i.feedId].append(i.pubDate);
+    }
+
+    for (auto it = dates.begin(); it != dates.end(); ++it) {
+        QList<uint> &feedDates = it.value();
+        std::sort(feedDates.begin(), feedDates.end(), std::greater<uint>());
+        if ((limit > 0) && (feedDates.size() > limit)) {
+            feedDates.erase(feedDates.begin() + limit, feedDates.end());
+        }
+    }
+
+    return dates;
+}
+
+
+
+void MemoryStorage::foldersRequested(const QJsonDocument &json)
+{
+    if (json.isEmpty() || json.isNull()) {
+        return;
+    }
+
+    foldersRequested(JsonDecoder::foldersFromJson(json));
+}
+
+
+
+void MemoryStorage::foldersRequested(const FolderRecords &folders, const QString &replyKey, const QByteArray &replyHash)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    qDebug("Processing %i folders requested from the remote server.", folders.size());
+
+    QHash<qint64, QString> reqFolders({{0, QStringLiteral("")}});
+    reqFolders.reserve(folders.size() + 1);
+
+    for (const FolderRecord &f : folders) {
+        reqFolders.insert(f.id, f.name);
+    }
+
+    IdList deletedIds;
+    QStringList deletedFolderNames;
+    QList<QPair<qint64, QString>> newFolders;
+    QStringList newFolderNames;
+    QList<QPair<qint64, QString>> updatedFolders;
+    QStringList updatedFolderNames;
+
+    for (auto i = d->folders.constBegin(); i != d->folders.constEnd(); ++i) {
+        if (reqFolders.contains(i.key())) {
+            const QString newFolderName = reqFolders.value(i.key());
+            if (newFolderName != i.value().name) {
+                updatedFolders.push_back(qMakePair(i.key(), newFolderName));
+                updatedFolderNames.push_back(newFolderName);
+            }
+        } else {
+            deletedIds.push_back(i.key());
+            deletedFolderNames.push_back(i.value().name);
+        }
+    }
+
+    for (auto i = reqFolders.constBegin(); i != reqFolders.constEnd(); ++i) {
+        if (!d->folders.contains(i.key())) {
+            newFolders.push_back(qMakePair(i.key(), i.value()));
+            newFolderNames.push_back(i.value());
+        }
+    }
+
+    if (!deletedIds.empty() || !newFolders.empty() || !updatedFolders.empty()) {
+
+        for (qint64 id : qAsConst(deletedIds)) {
+            d->removeFolder(id);
+        }
+
+        for (const QPair<qint64, QString> &p : qAsConst(updatedFolders)) {
+            d->folders[p.first].name = p.second;
+        }
+
+        for (const QPair<qint64, QString> &p : qAsConst(newFolders)) {
+            d->insertFolder(p.first, p.second);
+        }
+
+        setTotalUnread(d->countUnread());
+        setStarred(d->countStarred());
+
+        if (notificator()) {
+            QVariantList notifyData;
+            notifyData.push_back(newFolderNames);
+            notifyData.push_back(updatedFolderNames);
+            notifyData.push_back(deletedFolderNames);
+            notificator()->notify(AbstractNotificator::FoldersRequested, QtInfoMsg, notifyData);
+        }
+    }
+
+    if (!replyHash.isEmpty()) {
+        setReplyHash(replyKey, replyHash);
+    }
+
+    Q_EMIT requestedFolders(updatedFolders, newFolders, deletedIds);
+}
+
+
+
+void MemoryStorage::folderCreated(const QJsonDocument &json)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (json.isEmpty() || json.isNull()) {
+        qWarning("Can not add folder to memory storage. JSON data is not valid.");
+        return;
+    }
+
+    const QJsonObject o = json.object().value(QStringLiteral("folders")).toArray().first().toObject();
+
+    if (o.isEmpty()) {
+        qWarning("Can not add folder to memory storage. JSON object is empty.");
+        return;
+    }
+
+    const qint64 id = o.value(QStringLiteral("id")).toVariant().toLongLong();
+    if (id == 0) {
+        qWarning("Can not add folder to memory storage. Invalid ID.");
+        return;
+    }
+
+    const QString name = o.value(QStringLiteral("name")).toString();
+
+    Q_D(MemoryStorage);
+
+    d->insertFolder(id, name);
+
+    if (notificator()) {
+        notificator()->notify(AbstractNotificator::FolderCreated, QtInfoMsg, name);
+    }
+
+    Q_EMIT createdFolder(id, name);
+}
+
+
+
+void MemoryStorage::folderRenamed(qint64 id, const QString &newName)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (newName.isEmpty()) {
+        //% "The folder name can not be empty."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-empty-folder-name"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    if ((id == 0) || !d->folders.contains(id)) {
+        //% "The folder ID is not valid."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-folder-id"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    MemoryStoragePrivate::FolderRecord &f = d->folders[id];
+    const QString oldName = f.name;
+    f.name = newName;
+
+    if (notificator()) {
+        notificator()->notify(AbstractNotificator::FolderRenamed, QtInfoMsg, QStringList({oldName, newName}));
+    }
+
+    Q_EMIT renamedFolder(id, newName);
+}
+
+
+
+QList<Folder*> MemoryStorage::getFolders(FuotenEnums::SortingRole sortingRole, Qt::SortOrder sortOrder, const IdList &ids, FuotenEnums::Type idType, int limit)
+{
+    QList<Fuoten::Folder*> folders;
+
+    if (!ready()) {
+        qWarning("Memory storage not ready. Can not query folders.");
+        return folders;
+    }
+
+    Q_D(MemoryStorage);
+
+    QSet<qint64> folderIds;
+    if (!ids.isEmpty()) {
+        for (qint64 id : ids) {
+            folderIds.insert((idType == FuotenEnums::Feed) ? d->folderIdForFeed(id) : id);
+        }
+    }
+
+    QVector<MemoryStoragePrivate::FolderRecord> records;
+    records.reserve(d->folders.size());
+    for (const MemoryStoragePrivate::FolderRecord &f : qAsConst(d->folders)) {
+        if ((f.id > 0) && (folderIds.isEmpty() || folderIds.contains(f.id))) {
+            records.push_back(f);
+        }
+    }
+
+    std::sort(records.begin(), records.end(), [sortingRole] (const MemoryStoragePrivate::FolderRecord &a, const MemoryStoragePrivate::FolderRecord &b) {
+        switch (sortingRole) {
+        case FuotenEnums::ID:
+            return a.id < b.id;
+        case FuotenEnums::UnreadCount:
+            return a.unreadCount < b.unreadCount;
+        case FuotenEnums::FeedCount:
+            return a.feedCount < b.feedCount;
+        default:
+            return a.name < b.name;
+        }
+    });
+
+    if (sortOrder == Qt::DescendingOrder) {
+        std::reverse(records.begin(), records.end());
+    }
+
+    if ((limit > 0) && (records.size() > limit)) {
+        records.resize(limit);
+    }
+
+    for (const MemoryStoragePrivate::FolderRecord &f : qAsConst(records)) {
+        folders.append(new Folder(f.id, f.name, f.feedCount, f.unreadCount));
+    }
+
+    return folders;
+}
+
+
+
+void MemoryStorage::folderDeleted(qint64 id)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    if ((id <= 0) || !d->folders.contains(id)) {
+        //% "The folder ID is not valid."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-folder-id"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    const QString name = d->folders.value(id).name;
+
+    d->removeFolder(id);
+
+    setTotalUnread(d->countUnread());
+    setStarred(d->countStarred());
+
+    if (notificator()) {
+        notificator()->notify(AbstractNotificator::FolderDeleted, QtInfoMsg, name);
+    }
+
+    Q_EMIT deletedFolder(id);
+}
+
+
+
+void MemoryStorage::folderMarkedRead(qint64 id, qint64 newestItem)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+    const IdList feedIds = d->feedsByFolder.values(id);
+
+    for (qint64 feedId : feedIds) {
+        auto it = d->itemsByFeed.constFind(feedId);
+        while (it != d->itemsByFeed.constEnd() && it.key() == feedId) {
+            MemoryStoragePrivate::ItemRecord &i = d->items[it.value()];
+            if (i.unread && ((newestItem <= 0) || (i.id <= newestItem))) {
+                i.unread = false;
+                i.lastModified = now;
+            }
+            ++it;
+        }
+        d->recountFeed(feedId);
+    }
+
+    d->recountFolder(id);
+
+    setTotalUnread(d->countUnread());
+
+    if (notificator()) {
+        notificator()->notify(AbstractNotificator::FolderMarkedRead, QtInfoMsg, d->folders.value(id).name);
+    }
+
+    Q_EMIT markedReadFolder(id, newestItem);
+}
+
+
+
+QList<Feed*> MemoryStorage::getFeeds(const QueryArgs &args)
+{
+    QList<Fuoten::Feed*> feeds;
+
+    if (!ready()) {
+        qWarning("Memory storage not ready. Can not query feeds.");
+        return feeds;
+    }
+
+    Q_D(MemoryStorage);
+
+    QVector<MemoryStoragePrivate::FeedRecord> records;
+    records.reserve(d->feeds.size());
+
+    const bool filterInIds = !args.inIds.isEmpty() && ((args.inIdsType == FuotenEnums::Feed) || (args.inIdsType == FuotenEnums::Folder));
+
+    for (const MemoryStoragePrivate::FeedRecord &f : qAsConst(d->feeds)) {
+        if ((args.parentId > -1) && (f.folderId != args.parentId)) {
+            continue;
+        }
+        if (filterInIds && !args.inIds.contains((args.inIdsType == FuotenEnums::Folder) ? f.folderId : f.id)) {
+            continue;
+        }
+        if (args.unreadOnly && (f.unreadCount == 0)) {
+            continue;
+        }
+        records.push_back(f);
+    }
+
+    std::sort(records.begin(), records.end(), [d, &args] (const MemoryStoragePrivate::FeedRecord &a, const MemoryStoragePrivate::FeedRecord &b) {
+        switch (args.sortingRole) {
+        case FuotenEnums::FolderName:
+            return d->folders.value(a.folderId).name < d->folders.value(b.folderId).name;
+        case FuotenEnums::ID:
+            return a.id < b.id;
+        case FuotenEnums::UnreadCount:
+            return a.unreadCount < b.unreadCount;
+        default:
+            return a.title < b.title;
+        }
+    });
+
+    if (args.sortOrder == Qt::DescendingOrder) {
+        std::reverse(records.begin(), records.end());
+    }
+
+    if ((args.limit > 0) && (records.size() > args.limit)) {
+        records.resize(args.limit);
+    }
+
+    for (const MemoryStoragePrivate::FeedRecord &f : qAsConst(records)) {
+        feeds.append(createFeed(d, f));
+    }
+
+    return feeds;
+}
+
+
+
+Feed *MemoryStorage::getFeed(qint64 id)
+{
+    if (!ready()) {
+        qWarning("Memory storage not ready. Can not query feed.");
+        return nullptr;
+    }
+
+    Q_D(MemoryStorage);
+
+    auto it = d->feeds.constFind(id);
+    if (Q_LIKELY(it != d->feeds.constEnd())) {
+        return createFeed(d, it.value());
+    } else {
+        qWarning("Can not find the the feed in the memory storage.");
+        return nullptr;
+    }
+}
+
+
+
+void MemoryStorage::feedsRequested(const QJsonDocument &json)
+{
+    if (json.isEmpty() || json.isNull()) {
+        return;
+    }
+
+    feedsRequested(JsonDecoder::feedsFromJson(json));
+}
+
+
+
+void MemoryStorage::feedsRequested(const FeedRecords &feeds, const QString &replyKey, const QByteArray &replyHash)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    qDebug("Processing %i feeds requested from the remote server.", feeds.size());
+
+    IdList updatedFeedIds;
+    QStringList updatedFeedNames;
+    IdList newFeedIds;
+    QStringList newFeedNames;
+    IdList deletedFeedIds;
+    QStringList deletedFeedNames;
+
+    if (feeds.isEmpty() && d->feeds.isEmpty()) {
+        qDebug("%s", "Nothing to do. Local feeds and remote feeds are empty.");
+        if (!replyHash.isEmpty()) {
+            setReplyHash(replyKey, replyHash);
+        }
+
+        Q_EMIT requestedFeeds(updatedFeedIds, newFeedIds, deletedFeedIds);
+        return;
+    }
+
+    QSet<qint64> requestedFeedIds;
+
+    for (const FeedRecord &feed : feeds) {
+
+        const MemoryStoragePrivate::FeedRecord r = MemoryStoragePrivate::feedFromRecord(feed);
+        requestedFeedIds.insert(r.id);
+
+        auto it = d->feeds.find(r.id);
+        if (it == d->feeds.end()) {
+
+            qDebug("Adding new feed \"%s\" with ID %lli to the memory storage.", qUtf8Printable(r.title), r.id);
+
+            newFeedIds.push_back(r.id);
+            newFeedNames.push_back(r.title);
+            d->insertFeed(r);
+
+        } else {
+
+            MemoryStoragePrivate::FeedRecord &f = it.value();
+
+            if ((f.title != r.title) || (f.faviconLink != r.faviconLink) || (f.folderId != r.folderId) || (f.ordering != r.ordering) || (f.link != r.link) || (f.pinned != r.pinned) || (f.updateErrorCount != r.updateErrorCount) || (f.lastUpdateError != r.lastUpdateError)) {
+
+                qDebug("Updating feed \"%s\" with ID %lli in the memory storage.", qUtf8Printable(f.title), r.id);
+
+                updatedFeedIds.push_back(r.id);
+                updatedFeedNames.push_back(r.title);
+
+                if (f.folderId != r.folderId) {
+                    d->moveFeed(r.id, r.folderId);
+                }
+
+                f.title = r.title;
+                f.link = r.link;
+                f.ordering = r.ordering;
+                f.pinned = r.pinned;
+                f.updateErrorCount = r.updateErrorCount;
+                f.lastUpdateError = r.lastUpdateError;
+                f.faviconLink = r.faviconLink;
+            }
+        }
+    }
+
+    for (auto i = d->feeds.constBegin(); i != d->feeds.constEnd(); ++i) {
+        if (!requestedFeedIds.contains(i.key())) {
+            deletedFeedIds.push_back(i.key());
+            deletedFeedNames.push_back(i.value().title);
+        }
+    }
+
+    for (qint64 id : qAsConst(deletedFeedIds)) {
+        d->removeFeed(id);
+    }
+
+    for (auto i = d->folders.constBegin(); i != d->folders.constEnd(); ++i) {
+        d->recountFolder(i.key());
+    }
+
+    setTotalUnread(d->countUnread());
+    setStarred(d->countStarred());
+
+    if (!newFeedNames.empty() || !updatedFeedNames.empty() || !deletedFeedNames.empty()) {
+        if (notificator()) {
+            QVariantList data;
+            data.push_back(newFeedNames);
+            data.push_back(updatedFeedNames);
+            data.push_back(deletedFeedNames);
+            notificator()->notify(AbstractNotificator::FeedsRequested, QtInfoMsg, data);
+        }
+    }
+
+    if (!replyHash.isEmpty()) {
+        setReplyHash(replyKey, replyHash);
+    }
+
+    Q_EMIT requestedFeeds(updatedFeedIds, newFeedIds, deletedFeedIds);
+}
+
+
+
+void MemoryStorage::feedCreated(const QJsonDocument &json)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (json.isEmpty() || json.isNull()) {
+        qWarning("Can not add feed to memory storage. JSON data is not valid.");
+        return;
+    }
+
+    const QJsonObject o = json.object().value(QStringLiteral("feeds")).toArray().first().toObject();
+
+    if (o.isEmpty()) {
+        qWarning("Can not add feed to memory storage. JSON object is empty.");
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    const MemoryStoragePrivate::FeedRecord f = MemoryStoragePrivate::feedFromRecord(JsonDecoder::feedFromJson(o));
+
+    d->insertFeed(f);
+    d->recountFolder(f.folderId);
+
+    if (notificator()) {
+        notificator()->notify(AbstractNotificator::FeedCreated, QtInfoMsg, f.title);
+    }
+
+    Q_EMIT createdFeed(f.id, f.folderId);
+}
+
+
+
+void MemoryStorage::feedDeleted(qint64 id)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    if ((id <= 0) || !d->feeds.contains(id)) {
+        //% "The feed ID is not valid."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-feed-id"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    const MemoryStoragePrivate::FeedRecord f = d->feeds.value(id);
+
+    d->removeFeed(id);
+    d->recountFolder(f.folderId);
+
+    setTotalUnread(d->countUnread());
+    setStarred(d->countStarred());
+
+    if (notificator()) {
+        notificator()->notify(AbstractNotificator::FeedDeleted, QtInfoMsg, f.title);
+    }
+
+    Q_EMIT deletedFeed(id);
+}
+
+
+
+void MemoryStorage::feedMoved(qint64 id, qint64 targetFolder)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    if ((id <= 0) || !d->feeds.contains(id)) {
+        //% "The feed ID is not valid."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-feed-id"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (targetFolder < 0) {
+        //% "The folder ID is not valid."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-folder-id"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    const qint64 oldFolderId = d->folderIdForFeed(id);
+
+    d->moveFeed(id, targetFolder);
+    d->recountFolder(oldFolderId);
+    d->recountFolder(targetFolder);
+
+    if (notificator() && notificator()->isEnabled()) {
+        QVariantList data;
+        data.push_back(d->feeds.value(id).title);
+        data.push_back(d->folders.value(oldFolderId).name);
+        data.push_back(d->folders.value(targetFolder).name);
+        notificator()->notify(AbstractNotificator::FeedMoved, QtInfoMsg, data);
+    }
+
+    Q_EMIT movedFeed(id, targetFolder);
+}
+
+
+
+void MemoryStorage::feedRenamed(qint64 id, const QString &newTitle)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (newTitle.isEmpty()) {
+        //% "The feed name can not be empty."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-empty-feed-name"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    if ((id <= 0) || !d->feeds.contains(id)) {
+        //% "The feed ID is not valid."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-feed-id"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    MemoryStoragePrivate::FeedRecord &f = d->feeds[id];
+    const QString oldTitle = f.title;
+    f.title = newTitle;
+
+    if (notificator()) {
+        QVariantList data;
+        data.push_back(oldTitle);
+        data.push_back(newTitle);
+        notificator()->notify(AbstractNotificator::FeedRenamed, QtInfoMsg, data);
+    }
+
+    Q_EMIT renamedFeed(id, newTitle);
+}
+
+
+
+void MemoryStorage::feedMarkedRead(qint64 id, qint64 newestItem)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (id <= 0) {
+        //% "The feed ID is not valid."
+        setError(new Error(Error::InputError, Error::Critical, qtTrId("libfuoten-err-invalid-feed-id"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (newestItem <= 0) {
+        //% "The item ID is not valid."
+        setError(new Error(Error::InputError, Error::Critical, qtTrId("libfuoten-err-invalid-item-id"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+
+    auto it = d->itemsByFeed.constFind(id);
+    while (it != d->itemsByFeed.constEnd() && it.key() == id) {
+        MemoryStoragePrivate::ItemRecord &i = d->items[it.value()];
+        if (i.unread && (i.id <= newestItem)) {
+            i.unread = false;
+            i.lastModified = now;
+        }
+        ++it;
+    }
+
+    d->recountFeed(id);
+    d->recountFolder(d->folderIdForFeed(id));
+
+    setTotalUnread(d->countUnread());
+
+    if (notificator()) {
+        notificator()->notify(AbstractNotificator::FeedMarkedRead, QtInfoMsg, d->feeds.value(id).title);
+    }
+
+    Q_EMIT markedReadFeed(id, newestItem);
+}
+
+
+
+Article *MemoryStorage::getArticle(qint64 id, int bodyLimit)
+{
+    if (!ready()) {
+        qWarning("Memory storage not ready. Can not query article.");
+        return nullptr;
+    }
+
+    Q_D(MemoryStorage);
+
+    auto it = d->items.constFind(id);
+    if (Q_UNLIKELY(it == d->items.constEnd())) {
+        qWarning("Can not find the the article in the memory storage.");
+        return nullptr;
+    }
+
+    QString body;
+
+    if (bodyLimit == 0) {
+        body = d->itemBody(it.value());
+    } else if (bodyLimit > 0) {
+        body = limitBody(d->itemBody(it.value()), bodyLimit);
+    }
+
+    return createArticle(d, it.value(), body);
+}
+
+
+
+QList<Article*> MemoryStorage::getArticles(const QueryArgs &args)
+{
+    QList<Article*> articles;
+
+    if (!ready()) {
+        qWarning("Memory storage not ready. Can not query articles.");
+        return articles;
+    }
+
+    Q_D(MemoryStorage);
+
+    const QVector<qint64> *index = nullptr;
+    QVector<qint64> candidates;
+
+    if (!args.inIds.isEmpty() && (args.inIdsType != FuotenEnums::Folder) && (args.inIdsType != FuotenEnums::Feed)) {
+        // the ID list is the smallest candidate set we can get
+        candidates.reserve(args.inIds.size());
+        for (qint64 id : args.inIds) {
+            if (d->items.contains(id)) {
+                candidates.push_back(id);
+            }
+        }
+    } else if ((args.parentId > -1) && (args.parentIdType == FuotenEnums::Feed)) {
+        candidates = d->itemsByFeed.values(args.parentId).toVector();
+    } else {
+        d->ensureSortIndexes();
+        switch (args.sortingRole) {
+        case FuotenEnums::ID:
+            index = &d->itemsById;
+            break;
+        case FuotenEnums::Name:
+            index = &d->itemsByTitle;
+            break;
+        case FuotenEnums::FolderName:
+            candidates = d->itemsById;
+            break;
+        default:
+            index = &d->itemsByTime;
+            break;
+        }
+    }
+
+    QVector<qint64> result;
+
+    if (index) {
+
+        // walk the sorted index in the requested direction and stop as soon as the limit is reached
+        const int count = index->size();
+        for (int n = 0; n < count; ++n) {
+            const qint64 id = (args.sortOrder == Qt::AscendingOrder) ? index->at(n) : index->at(count - n - 1);
+            if (d->itemMatches(d->items[id], args)) {
+                result.push_back(id);
+                if ((args.limit > 0) && (result.size() >= args.limit)) {
+                    break;
+                }
+            }
+        }
+
+    } else {
+
+        result.reserve(candidates.size());
+        for (qint64 id : qAsConst(candidates)) {
+            if (d->itemMatches(d->items[id], args)) {
+                result.push_back(id);
+            }
+        }
+
+        std::sort(result.begin(), result.end());
+        const FuotenEnums::SortingRole role = args.sortingRole;
+        std::stable_sort(result.begin(), result.end(), [d, role] (qint64 a, qint64 b) {
+            return itemLessThan(d, role, a, b);
+        });
+
+        if (args.sortOrder == Qt::DescendingOrder) {
+            std::reverse(result.begin(), result.end());
+        }
+
+        if ((args.limit > 0) && (result.size() > args.limit)) {
+            result.resize(args.limit);
+        }
+    }
+
+    qDebug("Found %i articles in the memory storage.", result.size());
+
+    articles.reserve(result.size());
+
+    const QRegularExpression tagRegex(QStringLiteral("<[^>]*>"));
+
+    for (qint64 id : qAsConst(result)) {
+        const MemoryStoragePrivate::ItemRecord &i = d->items[id];
+
+        QString body;
+
+        if (args.bodyLimit > -1) {
+
+            body = d->itemBody(i);
+
+            if (args.bodyLimit > 0) {
+                body.replace(tagRegex, QStringLiteral(" "));
+                body = body.simplified();
+                body = body.left(args.bodyLimit);
+            }
+        }
+
+        articles.append(createArticle(d, i, body));
+    }
+
+    return articles;
+}
+
+
+
+void MemoryStorage::itemsRequested(const QJsonDocument &json)
+{
+    itemsRequested(JsonDecoder::itemsFromJson(json));
+}
+
+
+
+void MemoryStorage::itemsRequested(const ItemRecords &items, quint64 batchToken)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    IdList updatedItemIds;
+    IdList newItemIds;
+    IdList removedItemIds;
+
+    if (items.isEmpty()) {
+        qDebug("%s", "Nothing to do. No Items.");
+        Q_EMIT requestedItems(updatedItemIds, newItemIds, removedItemIds);
+        if (batchToken != 0) {
+            Q_EMIT itemsBatchStored(batchToken);
+        }
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    AbstractNotificator *n = notificator();
+    const bool publishArticles = (n && n->isArticlePublishingEnabled());
+    QVector<QJsonObject> articlesToPublish;
+    quint32 newUnreadItems = 0;
+
+    for (const ItemRecord &r : items) {
+
+        const qint64 id = r.id;
+
+        auto it = d->items.find(id);
+        if (it != d->items.end()) {
+
+            MemoryStoragePrivate::ItemRecord &i = it.value();
+
+            if (i.lastModified < r.lastModified) {
+
+                qDebug("Updating the article \"%s\" with ID %lli in the memory storage.", qUtf8Printable(r.title), id);
+
+                updatedItemIds.append(id);
+
+                const bool sortKeysChanged = (i.title != r.title) || (i.pubDate != r.pubDate);
+
+                i.title = r.title;
+                i.url = QUrl(r.url);
+                i.author = r.author;
+                i.pubDate = r.pubDate;
+                i.enclosureMime = r.enclosureMime;
+                i.enclosureLink = QUrl(r.enclosureLink);
+                i.unread = r.unread;
+                i.starred = r.starred;
+                i.lastModified = r.lastModified;
+                i.fingerprint = r.fingerprint;
+                i.queue = FuotenEnums::QueueActions();
+                if (sortKeysChanged) {
+                    d->itemSortKeysChanged(id);
+                }
+            }
+
+        } else {
+
+            const MemoryStoragePrivate::ItemRecord i = MemoryStoragePrivate::itemFromRecord(r);
+
+            qDebug("Adding new article \"%s\" with ID %lli to the memory storage.", qUtf8Printable(i.title), id);
+
+            newItemIds.append(id);
+            if (i.unread) {
+                newUnreadItems++;
+            }
+
+            d->insertItem(i);
+
+            if (publishArticles && i.unread) {
+                const QJsonObject o = JsonDecoder::itemToJson(r);
+                if (n->checkForPublishing(o)) {
+                    articlesToPublish.push_back(o);
+                }
+            }
+        }
+    }
+
+    AbstractConfiguration *config = configuration();
+
+    if (Q_LIKELY(config)) {
+
+        const IdList feedIds = d->feeds.keys();
+
+        for (qint64 fId : feedIds) {
+
+            const FuotenEnums::ItemDeletionStrategy delStrat = config->getPerFeedDeletionStrategy(fId);
+            const quint16 delVal = config->getPerFeedDeletionValue(fId);
+
+            if ((delStrat == FuotenEnums::NoItemDeletion) || (delVal == 0)) {
+                continue;
+            }
+
+            IdList toDelete;
+
+            if (delStrat == FuotenEnums::DeleteItemsByCount) {
+
+                IdList iIds;
+                auto it = d->itemsByFeed.constFind(fId);
+                while (it != d->itemsByFeed.constEnd() && it.key() == fId) {
+                    if (!d->items.value(it.value()).starred) {
+                        iIds.append(it.value());
+                    }
+                    ++it;
+                }
+
+                if (iIds.count() > delVal) {
+                    qDebug("Removing all items from feed with ID %lli, keeping only %i most recent items.", fId, delVal);
+                    std::sort(iIds.begin(), iIds.end(), std::greater<qint64>());
+                    toDelete = iIds.mid(delVal);
+                }
+
+            } else {
+
+                const uint tt = QDateTime::currentDateTimeUtc().addDays(delVal * -1).toTime_t();
+
+                auto it = d->itemsByFeed.constFind(fId);
+                while (it != d->itemsByFeed.constEnd() && it.key() == fId) {
+                    const MemoryStoragePrivate::ItemRecord &i = d->items[it.value()];
+                    if (!i.starred && (i.pubDate < tt)) {
+                        toDelete.append(i.id);
+                    }
+                    ++it;
+                }
+            }
+
+            for (qint64 id : qAsConst(toDelete)) {
+                d->removeItem(id);
+            }
+            removedItemIds.append(toDelete);
+        }
+    }
+
+    d->recountAll();
+
+    setTotalUnread(d->countUnread());
+    setStarred(d->countStarred());
+
+    Q_EMIT requestedItems(updatedItemIds, newItemIds, removedItemIds);
+    if (batchToken != 0) {
+        Q_EMIT itemsBatchStored(batchToken);
+    }
+
+    if (publishArticles && !articlesToPublish.empty()) {
+        for (const QJsonObject &o : qAsConst(articlesToPublish)) {
+            const qint64 itemId = o.value(QStringLiteral("id")).toVariant().toLongLong();
+            if (!removedItemIds.contains(itemId)) {
+                n->publishArticle(o, d->feeds.value(o.value(QStringLiteral("feedId")).toVariant().toLongLong()).title);
+            }
+        }
+    }
+
+    if (n && (newUnreadItems > 0)) {
+        n->notify(AbstractNotificator::ItemsRequested, QtInfoMsg, newUnreadItems);
+    }
+}
+
+
+
+void MemoryStorage::itemsMarked(const IdList &itemIds, bool unread)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (itemIds.isEmpty()) {
+        qWarning("List of marked articles is empty.");
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+    QSet<qint64> feedIds;
+
+    for (qint64 id : itemIds) {
+        auto it = d->items.find(id);
+        if (it != d->items.end()) {
+            it.value().unread = unread;
+            it.value().lastModified = now;
+            feedIds.insert(it.value().feedId);
+        }
+    }
+
+    QSet<qint64> folderIds;
+    for (qint64 feedId : qAsConst(feedIds)) {
+        d->recountFeed(feedId);
+        folderIds.insert(d->folderIdForFeed(feedId));
+    }
+
+    for (qint64 folderId : qAsConst(folderIds)) {
+        d->recountFolder(folderId);
+    }
+
+    setTotalUnread(d->countUnread());
+
+    Q_EMIT markedItems(itemIds, unread);
+}
+
+
+
+void MemoryStorage::itemsStarred(const QList<QPair<qint64, QString> > &articles, bool star)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    if (articles.isEmpty()) {
+        qWarning("No articles in the list. Can not update local storage.");
+    }
+
+    Q_D(MemoryStorage);
+
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+
+    for (const QPair<qint64,QString> &p : articles) {
+        MemoryStoragePrivate::ItemRecord *i = d->itemByGuidHash(p.first, p.second);
+        if (i) {
+            i->starred = star;
+            i->lastModified = now;
+        }
+    }
+
+    setStarred(d->countStarred());
+
+    Q_EMIT starredItems(articles, star);
+}
+
+
+
+void MemoryStorage::itemMarked(qint64 itemId, bool unread)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    auto it = d->items.find(itemId);
+    if (it != d->items.end()) {
+        MemoryStoragePrivate::ItemRecord &i = it.value();
+        i.lastModified = QDateTime::currentDateTimeUtc().toTime_t();
+        if (i.unread != unread) {
+            i.unread = unread;
+            d->recountFeed(i.feedId);
+            d->recountFolder(d->folderIdForFeed(i.feedId));
+            setTotalUnread(unread ? totalUnread() + 1 : totalUnread() - 1);
+        }
+    }
+
+    Q_EMIT markedItem(itemId, unread);
+}
+
+
+
+void MemoryStorage::itemStarred(qint64 feedId, const QString &guidHash, bool star)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    MemoryStoragePrivate::ItemRecord *i = d->itemByGuidHash(feedId, guidHash);
+    if (i) {
+        i->lastModified = QDateTime::currentDateTimeUtc().toTime_t();
+        if (i->starred != star) {
+            i->starred = star;
+            setStarred(star ? starred() + 1 : starred() - 1);
+        }
+    }
+
+    Q_EMIT starredItem(feedId, guidHash, star);
+}
+
+
+
+void MemoryStorage::allItemsMarkedRead(qint64 newestItemId)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    const uint now = QDateTime::currentDateTimeUtc().toTime_t();
+
+    for (auto it = d->items.begin(); it != d->items.end(); ++it) {
+        if (it.value().unread && (it.key() <= newestItemId)) {
+            it.value().unread = false;
+            it.value().lastModified = now;
+        }
+    }
+
+    d->recountAll();
+
+    setTotalUnread(d->countUnread());
+
+    Q_EMIT markedAllItemsRead(newestItemId);
+}
+
+
+
+QString MemoryStorage::getArticleBody(qint64 id)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return QString();
+    }
+
+    Q_D(const MemoryStorage);
+
+    auto it = d->items.constFind(id);
+    return (it != d->items.constEnd()) ? d->itemBody(it.value()) : QString();
+}
+
+
+
+bool MemoryStorage::enqueueItem(FuotenEnums::QueueAction action, Article *article)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    if (!article) {
+        //% "Invalid article object."
+        setError(new Error(Error::ApplicationError, Error::Critical, qtTrId("libfuoten-err-invalid-article-object"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    Q_D(MemoryStorage);
+
+    MemoryStoragePrivate::ItemRecord *i = nullptr;
+
+    if ((action == FuotenEnums::MarkAsUnread) || (action == FuotenEnums::MarkAsRead)) {
+        auto it = d->items.find(article->id());
+        if (it != d->items.end()) {
+            i = &it.value();
+        }
+    } else {
+        i = d->itemByGuidHash(article->feedId(), article->guidHash());
+    }
+
+    FuotenEnums::QueueActions aq = article->queue();
+
+    switch (action) {
+    case FuotenEnums::MarkAsRead:
+        if (aq.testFlag(FuotenEnums::MarkAsUnread)) {
+            aq ^= FuotenEnums::MarkAsUnread;
+        } else {
+            aq |= FuotenEnums::MarkAsRead;
+        }
+        break;
+    case FuotenEnums::MarkAsUnread:
+        if (aq.testFlag(FuotenEnums::MarkAsRead)) {
+            aq ^= FuotenEnums::MarkAsRead;
+        } else {
+            aq |= FuotenEnums::MarkAsUnread;
+        }
+        break;
+    case FuotenEnums::Star:
+        if (aq.testFlag(FuotenEnums::Unstar)) {
+            aq ^= FuotenEnums::Unstar;
+        } else {
+            aq |= FuotenEnums::Star;
+        }
+        break;
+    case FuotenEnums::Unstar:
+        if (aq.testFlag(FuotenEnums::Star)) {
+            aq ^= FuotenEnums::Star;
+        } else {
+            aq |= FuotenEnums::Unstar;
+        }
+        break;
+    default:
+        qWarning("Invalid queue action.");
+        return false;
+    }
+
+    if (i) {
+        i->queue = aq;
+        i->lastModified = QDateTime::currentDateTimeUtc().toTime_t() - 10;
+        if ((action == FuotenEnums::MarkAsUnread) || (action == FuotenEnums::MarkAsRead)) {
+            i->unread = (action == FuotenEnums::MarkAsUnread);
+            d->recountFeed(i->feedId);
+            d->recountFolder(d->folderIdForFeed(i->feedId));
+        } else {
+            i->starred = (action == FuotenEnums::Star);
+        }
+    }
+
+    article->setQueue(aq);
+
+    switch (action) {
+    case FuotenEnums::MarkAsRead:
+        Q_EMIT markedItem(article->id(), false);
+        setTotalUnread(d->countUnread());
+        break;
+    case FuotenEnums::MarkAsUnread:
+        Q_EMIT markedItem(article->id(), true);
+        setTotalUnread(d->countUnread());
+        break;
+    case FuotenEnums::Star:
+        Q_EMIT starredItem(article->feedId(), article->guidHash(), true);
+        setStarred(d->countStarred());
+        break;
+    default:
+        Q_EMIT starredItem(article->feedId(), article->guidHash(), false);
+        setStarred(d->countStarred());
+        break;
+    }
+
+    return true;
+}
+
+
+
+bool MemoryStorage::enqueueMarkFeedRead(qint64 feedId, qint64 newestItemId)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    if (feedId <= 0) {
+        //% "The feed ID is not valid."
+        setError(new Error(Error::InputError, Error::Critical, qtTrId("libfuoten-err-invalid-feed-id"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    if (newestItemId <= 0) {
+        //% "The item ID is not valid."
+        setError(new Error(Error::InputError, Error::Critical, qtTrId("libfuoten-err-invalid-item-id"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    Q_D(MemoryStorage);
+
+    auto it = d->itemsByFeed.constFind(feedId);
+    while (it != d->itemsByFeed.constEnd() && it.key() == feedId) {
+        MemoryStoragePrivate::ItemRecord &i = d->items[it.value()];
+        if (i.unread && (i.id <= newestItemId)) {
+            if (i.queue.testFlag(FuotenEnums::MarkAsUnread)) {
+                i.queue ^= FuotenEnums::MarkAsUnread;
+            } else {
+                i.queue |= FuotenEnums::MarkAsRead;
+            }
+            i.unread = false;
+        }
+        ++it;
+    }
+
+    d->recountFeed(feedId);
+    d->recountFolder(d->folderIdForFeed(feedId));
+
+    setTotalUnread(d->countUnread());
+
+    Q_EMIT markedReadFeedInQueue(feedId, newestItemId);
+
+    return true;
+}
+
+
+
+bool MemoryStorage::enqueueMarkFolderRead(qint64 folderId, qint64 newestItemId)
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    if (folderId < 0) {
+        //% "The folder ID is not valid."
+        setError(new Error(Error::InputError, Error::Critical, qtTrId("libfuoten-err-invalid-folder-id"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    if (newestItemId <= 0) {
+        //% "The item ID is not valid."
+        setError(new Error(Error::InputError, Error::Critical, qtTrId("libfuoten-err-invalid-item-id"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    Q_D(MemoryStorage);
+
+    const IdList feedIds = d->feedsByFolder.values(folderId);
+
+    for (qint64 feedId : feedIds) {
+        auto it = d->itemsByFeed.constFind(feedId);
+        while (it != d->itemsByFeed.constEnd() && it.key() == feedId) {
+            MemoryStoragePrivate::ItemRecord &i = d->items[it.value()];
+            if (i.unread && (i.id <= newestItemId)) {
+                if (i.queue.testFlag(FuotenEnums::MarkAsUnread)) {
+                    i.queue ^= FuotenEnums::MarkAsUnread;
+                } else {
+                    i.queue |= FuotenEnums::MarkAsRead;
+                }
+                i.unread = false;
+            }
+            ++it;
+        }
+        d->recountFeed(feedId);
+    }
+
+    d->recountFolder(folderId);
+
+    setTotalUnread(d->countUnread());
+
+    Q_EMIT markedReadFolderInQueue(folderId, newestItemId);
+
+    return true;
+}
+
+
+
+bool MemoryStorage::enqueueMarkAllItemsRead()
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return false;
+    }
+
+    Q_D(MemoryStorage);
+
+    for (auto it = d->items.begin(); it != d->items.end(); ++it) {
+        MemoryStoragePrivate::ItemRecord &i = it.value();
+        if (i.unread) {
+            if (i.queue.testFlag(FuotenEnums::MarkAsUnread)) {
+                i.queue ^= FuotenEnums::MarkAsUnread;
+            } else {
+                i.queue |= FuotenEnums::MarkAsRead;
+            }
+            i.unread = false;
+        }
+    }
+
+    d->recountAll();
+
+    setTotalUnread(0);
+
+    Q_EMIT markedAllItemsReadInQueue();
+
+    return true;
+}
+
+
+
+void MemoryStorage::clearQueue()
+{
+    if (!ready()) {
+        //% "The storage is not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-storage-not-ready"), QString(), this));
+        notify(error());
+        return;
+    }
+
+    Q_D(MemoryStorage);
+
+    for (auto it = d->items.begin(); it != d->items.end(); ++it) {
+        it.value().queue = FuotenEnums::QueueActions();
+    }
+
+    Q_EMIT queueCleared();
+}
+
+
+void MemoryStorage::dequeueItems(const IdList &itemIds, FuotenEnums::QueueActions actions)
+{
+    Q_D(MemoryStorage);
+
+    for (qint64 id : itemIds) {
+        auto it = d->items.find(id);
+        if (it != d->items.end()) {
+            it.value().queue &= ~static_cast<int>(actions);
+        }
+    }
+
+    Q_EMIT dequeuedItems(itemIds, actions);
+}
+
+#include "moc_memorystorage.cpp"
@@ -0,0 +1,209 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENMEMORYSTORAGE_H
+#define FUOTENMEMORYSTORAGE_H
+
+#include <QObject>
+#include "abstractstorage.h"
+#include "../fuoten.h"
+#include "../fuoten_global.h"
+
+namespace Fuoten {
+
+class MemoryStoragePrivate;
+class Folder;
+class Feed;
+class Article;
+
+/*!
+ * \brief Storage that keeps all data in the memory of the current process.
+ *
+ * Folders, feeds and items are stored in hash tables identified by their ID. Items are additionally
+ * indexed by feed, by the combination of feed ID and GUID hash and by sorted lists of IDs for the
+ * different sorting roles, so that queries via QueryArgs do not have to scan the complete item table.
+ * The sorted indexes are built by the first article query. Afterwards added and removed items and items
+ * whose title or publication date changed are recorded and merged into the existing indexes by the next query,
+ * the indexes are not sorted again.
+ *
+ * MemoryStorage implements the same signal contract as SQLiteStorage, but all operations are performed
+ * synchronously in the thread the object lives in. The data is lost when the object is destroyed, so it
+ * is mostly useful for ephemeral sessions, as a test double and as a baseline when comparing storage
+ * backends.
+ *
+ * Call init() before using the storage.
+ *
+ * \headerfile "" <Fuoten/Storage/MemoryStorage>
+ */
+class FUOTENSHARED_EXPORT MemoryStorage : public AbstractStorage
+{
+    Q_OBJECT
+public:
+    /*!
+     * \brief Constructs a new empty MemoryStorage object with the given \a parent.
+     */
+    explicit MemoryStorage(QObject *parent = nullptr);
+
+    /*!
+     * \brief Initializes the storage.
+     *
+     * Creates the base folder with ID \c 0 and sets the storage to ready.
+     */
+    void init() override;
+
+    /*!
+     * \brief Returns a list of Folder objects from the folders table.
+     */
+    QList<Folder*> getFolders(FuotenEnums::SortingRole sortingRole = FuotenEnums::Name, Qt::SortOrder sortOrder = Qt::AscendingOrder, const IdList &ids = IdList(), FuotenEnums::Type idType = FuotenEnums::Folder, int limit = 0) override;
+
+    /*!
+     * \brief Returns a list of Feed objects from the feeds table.
+     */
+    QList<Feed*> getFeeds(const QueryArgs &args) override;
+
+    /*!
+     * \brief Returns a list of Article objects from the items table.
+     */
+    QList<Article*> getArticles(const QueryArgs &args) override;
+
+    /*!
+     * \brief Returns the Feed identified by \a id.
+     *
+     * Returns a \c nullptr if the Feed can not be found.
+     */
+    Feed *getFeed(qint64 id) override;
+
+    /*!
+     * \brief Returns the Article identified by \a id.
+     *
+     * Returns a \c nullptr if the Article can not be found.
+     */
+    Article *getArticle(qint64 id, int bodyLimit = 0) override;
+
+    /*!
+     * \brief Returns the newest/highest item/article ID fo the given \a type.
+     *
+     * Supported Types: FuotenEnums::Feed, FuotenEnums::Folder, FuotenEnums::All. For folder and feed type
+     * a valid \a id has be provided that identifieds the folder or feed.
+     *
+     * If the type does not match one of the supported or if there are not items, \c -1 is returned.
+     */
+    qint64 getNewestItemId(FuotenEnums::Type type = FuotenEnums::All, qint64 id = -1) override;
+
+    /*!
+     * \brief Returns the publication dates of the newest items per feed.
+     */
+    QHash<qint64, QList<uint>> getPublishDates(int limit = 20) override;
+
+    /*!
+     * \brief Returns the full body of an Article identified by \a id.
+     */
+    Q_INVOKABLE QString getArticleBody(qint64 id) override;
+
+    /*!
+     * \brief Enqueues the \a action for the given \a article.
+     *
+     * Will update the queue flags of the item and also will perform the action locally.
+     */
+    bool enqueueItem(FuotenEnums::QueueAction action, Article *article) override;
+
+    /*!
+     * \brief Adds all articles older than \a newestItemId in the feed identified by \a feedId as read to the local queue.
+     *
+     * Will emit the AbstractStorage::markedReadFeedInQueue() signal on success.
+     */
+    bool enqueueMarkFeedRead(qint64 feedId, qint64 newestItemId) override;
+
+    /*!
+     * \brief Adds all articles older than \a newestItemId in the folder identified by \a folderId as read to the local queue.
+     *
+     * Will emit the AbstractStorage::markedReadFolderInQueue() signal on success.
+     */
+    bool enqueueMarkFolderRead(qint64 folderId, qint64 newestItemId) override;
+
+    /*!
+     * \brief Adds all local articles that are unread to the queue and marks them as read.
+     *
+     * Will emit the AbstractStorage::markedAllItemsReadInQueue() signal on success.
+     */
+    bool enqueueMarkAllItemsRead() override;
+
+    /*!
+     * \brief Resets the queue flags of all items after the queue has been worked.
+     */
+    void clearQueue() override;
+
+    /*!
+     * \brief Removes the queue \a actions from the items identified by \a itemIds.
+     */
+    void dequeueItems(const IdList &itemIds, FuotenEnums::QueueActions actions) override;
+
+    /*!
+     * \brief Stores the \a folders requested from the remote server.
+     *
+     * Stores the \a replyHash for \a replyKey after the folders have been stored.
+     */
+    void foldersRequested(const FolderRecords &folders, const QString &replyKey = QString(), const QByteArray &replyHash = QByteArray()) override;
+
+    /*!
+     * \brief Stores the \a feeds requested from the remote server.
+     *
+     * Stores the \a replyHash for \a replyKey after the feeds have been stored.
+     */
+    void feedsRequested(const FeedRecords &feeds, const QString &replyKey = QString(), const QByteArray &replyHash = QByteArray()) override;
+
+    /*!
+     * \brief Stores the \a items requested from the remote server.
+     *
+     * Emits itemsBatchStored() with the \a batchToken after the items have been stored.
+     */
+    void itemsRequested(const ItemRecords &items, quint64 batchToken = 0) override;
+
+public Q_SLOTS:
+    void foldersRequested(const QJsonDocument &json) override;
+    void folderCreated(const QJsonDocument &json) override;
+    void folderRenamed(qint64 id, const QString &newName) override;
+    void folderDeleted(qint64 id) override;
+    void folderMarkedRead(qint64 id, qint64 newestItem) override;
+
+    void feedsRequested(const QJsonDocument &json) override;
+    void feedCreated(const QJsonDocument &json) override;
+    void feedDeleted(qint64 id) override;
+    void feedMoved(qint64 id, qint64 targetFolder) override;
+    void feedRenamed(qint64 id, const QString &newTitle) override;
+    void feedMarkedRead(qint64 id, qint64 newestItem) override;
+
+    void itemsRequested(const QJsonDocument &json) override;
+    void itemsMarked(const IdList &itemIds, bool unread) override;
+    void itemsStarred(const QList<QPair<qint64, QString>> &articles, bool star) override;
+    void itemMarked(qint64 itemId, bool unread) override;
+    void itemStarred(qint64 feedId, const QString &guidHash, bool star) override;
+    void allItemsMarkedRead(qint64 newestItemId) override;
+
+protected:
+    MemoryStorage(MemoryStoragePrivate &dd, QObject *parent = nullptr);
+
+private:
+    Q_DECLARE_PRIVATE(MemoryStorage)
+    Q_DISABLE_COPY(MemoryStorage)
+};
+
+}
+
+#endif // FUOTENMEMORYSTORAGE_H
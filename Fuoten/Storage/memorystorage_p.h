@@ -0,0 +1,507 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENMEMORYSTORAGE_P_H
+#define FUOTENMEMORYSTORAGE_P_H
+
+#include "memorystorage.h"
+#include "abstractstorage_p.h"
+#include <QHash>
+#include <QMultiHash>
+#include <QSet>
+#include <QVector>
+#include <QPair>
+#include <QUrl>
+#include <QVariant>
+#include <algorithm>
+
+namespace Fuoten {
+
+class MemoryStoragePrivate : public AbstractStoragePrivate
+{
+public:
+    struct FolderRecord {
+        qint64 id = 0;
+        QString name;
+        uint feedCount = 0;
+        uint unreadCount = 0;
+    };
+
+    struct FeedRecord {
+        qint64 id = 0;
+        qint64 folderId = 0;
+        QString title;
+        QUrl url;
+        QUrl link;
+        uint added = 0;
+        uint unreadCount = 0;
+        quint8 ordering = 0;
+        bool pinned = false;
+        uint updateErrorCount = 0;
+        QString lastUpdateError;
+        QUrl faviconLink;
+    };
+
+    struct ItemRecord {
+        qint64 id = 0;
+        qint64 feedId = 0;
+        QString guid;
+        QString guidHash;
+        QUrl url;
+        QString title;
+        QString author;
+        uint pubDate = 0;
+        QString body;
+        QString enclosureMime;
+        QUrl enclosureLink;
+        bool unread = false;
+        bool starred = false;
+        uint lastModified = 0;
+        QString fingerprint;
+        FuotenEnums::QueueActions queue;
+    };
+
+    MemoryStoragePrivate() : AbstractStoragePrivate() {}
+
+    static FeedRecord feedFromRecord(const Fuoten::FeedRecord &r)
+    {
+        FeedRecord f;
+        f.id = r.id;
+        f.folderId = r.folderId;
+        f.title = r.title;
+        f.url = QUrl(r.url);
+        f.link = QUrl(r.link);
+        f.added = r.added;
+        f.ordering = r.ordering;
+        f.pinned = r.pinned;
+        f.updateErrorCount = r.updateErrorCount;
+        f.lastUpdateError = r.lastUpdateError;
+        f.faviconLink = QUrl(r.faviconLink);
+        return f;
+    }
+
+    static ItemRecord itemFromRecord(const Fuoten::ItemRecord &r)
+    {
+        ItemRecord i;
+        i.id = r.id;
+        i.feedId = r.feedId;
+        i.guid = r.guid;
+        i.guidHash = r.guidHash;
+        i.url = QUrl(r.url);
+        i.title = r.title;
+        i.author = r.author;
+        i.pubDate = r.pubDate;
+        i.body = r.body;
+        i.enclosureMime = r.enclosureMime;
+        i.enclosureLink = QUrl(r.enclosureLink);
+        i.unread = r.unread;
+        i.starred = r.starred;
+        i.lastModified = r.lastModified;
+        i.fingerprint = r.fingerprint;
+        return i;
+    }
+
+    void insertFolder(qint64 id, const QString &name)
+    {
+        FolderRecord f;
+        f.id = id;
+        f.name = name;
+        folders.insert(id, f);
+    }
+
+    void removeFolder(qint64 id)
+    {
+        const IdList feedIds = feedsByFolder.values(id);
+        for (qint64 feedId : feedIds) {
+            removeFeed(feedId);
+        }
+        folders.remove(id);
+    }
+
+    void insertFeed(const FeedRecord &f)
+    {
+        feeds.insert(f.id, f);
+        feedsByFolder.insert(f.folderId, f.id);
+    }
+
+    void removeFeed(qint64 id)
+    {
+        if (!feeds.contains(id)) {
+            return;
+        }
+        const IdList itemIds = itemsByFeed.values(id);
+        for (qint64 itemId : itemIds) {
+            removeItem(itemId);
+        }
+        feedsByFolder.remove(feeds.value(id).folderId, id);
+        feeds.remove(id);
+    }
+
+    void moveFeed(qint64 id, qint64 targetFolder)
+    {
+        FeedRecord &f = feeds[id];
+        feedsByFolder.remove(f.folderId, id);
+        f.folderId = targetFolder;
+        feedsByFolder.insert(targetFolder, id);
+    }
+
+    void insertItem(const ItemRecord &i)
+    {
+        items.insert(i.id, i);
+        itemsByFeed.insert(i.feedId, i.id);
+        itemsByGuidHash.insert(qMakePair(i.feedId, i.guidHash), i.id);
+        sortIndexAdded(i.id);
+    }
+
+    void removeItem(qint64 id)
+    {
+        const ItemRecord i = items.take(id);
+        itemsByFeed.remove(i.feedId, id);
+        itemsByGuidHash.remove(qMakePair(i.feedId, i.guidHash));
+        sortIndexRemoved(id);
+        itemRemoved(id);
+    }
+
+    /*
+     * Called for every removed item, also for the items removed together
+     * with their feed or folder.
+     */
+    virtual void itemRemoved(qint64 id)
+    {
+        Q_UNUSED(id)
+    }
+
+    /*
+     * Has to be called after the title or the publication date of an
+     * indexed item changed.
+     */
+    void itemSortKeysChanged(qint64 id)
+    {
+        sortIndexRemoved(id);
+        sortIndexAdded(id);
+    }
+
+    ItemRecord *itemByGuidHash(qint64 feedId, const QString &guidHash)
+    {
+        const qint64 id = itemsByGuidHash.value(qMakePair(feedId, guidHash), -1);
+        if (id < 0) {
+            return nullptr;
+        }
+        auto it = items.find(id);
+        return (it != items.end()) ? &it.value() : nullptr;
+    }
+
+    void recountFeed(qint64 feedId)
+    {
+        auto fit = feeds.find(feedId);
+        if (fit == feeds.end()) {
+            return;
+        }
+        uint unread = 0;
+        auto it = itemsByFeed.constFind(feedId);
+        while (it != itemsByFeed.constEnd() && it.key() == feedId) {
+            if (items.value(it.value()).unread) {
+                unread++;
+            }
+            ++it;
+        }
+        fit.value().unreadCount = unread;
+    }
+
+    void recountFolder(qint64 folderId)
+    {
+        auto fit = folders.find(folderId);
+        if (fit == folders.end()) {
+            return;
+        }
+        uint unread = 0;
+        uint count = 0;
+        auto it = feedsByFolder.constFind(folderId);
+        while (it != feedsByFolder.constEnd() && it.key() == folderId) {
+            unread += feeds.value(it.value()).unreadCount;
+            count++;
+            ++it;
+        }
+        fit.value().unreadCount = unread;
+        fit.value().feedCount = count;
+    }
+
+    void recountAll()
+    {
+        for (auto it = feeds.begin(); it != feeds.end(); ++it) {
+            it.value().unreadCount = 0;
+        }
+        for (const ItemRecord &i : qAsConst(items)) {
+            if (i.unread) {
+                auto fit = feeds.find(i.feedId);
+                if (fit != feeds.end()) {
+                    fit.value().unreadCount++;
+                }
+            }
+        }
+        for (auto it = folders.begin(); it != folders.end(); ++it) {
+            it.value().unreadCount = 0;
+            it.value().feedCount = 0;
+        }
+        for (const FeedRecord &f : qAsConst(feeds)) {
+            auto fit = folders.find(f.folderId);
+            if (fit != folders.end()) {
+                fit.value().unreadCount += f.unreadCount;
+                fit.value().feedCount++;
+            }
+        }
+    }
+
+    quint16 countUnread() const
+    {
+        quint16 c = 0;
+        for (const ItemRecord &i : items) {
+            if (i.unread) {
+                c++;
+            }
+        }
+        return c;
+    }
+
+    quint16 countStarred() const
+    {
+        quint16 c = 0;
+        for (const ItemRecord &i : items) {
+            if (i.starred) {
+                c++;
+            }
+        }
+        return c;
+    }
+
+    /*
+     * Returns the body of the item. Subclasses that keep the bodies outside
+     * of the item records have to reimplement this.
+     */
+    virtual QString itemBody(const ItemRecord &i) const
+    {
+        return i.body;
+    }
+
+    /*
+     * Returns the item with all strings except the body. Subclasses that
+     * keep the strings outside of the item records have to reimplement this.
+     */
+    virtual ItemRecord itemWithStrings(const ItemRecord &i) const
+    {
+        return i;
+    }
+
+    qint64 folderIdForFeed(qint64 feedId) const
+    {
+        const auto it = feeds.constFind(feedId);
+        return (it != feeds.constEnd()) ? it.value().folderId : 0;
+    }
+
+    /*
+     * Changes of the items are only recorded and applied to the sorted
+     * indexes by the next query. An item that is added and removed again
+     * before that never touches the indexes.
+     */
+    void sortIndexAdded(qint64 id)
+    {
+        if (!sortIndexesDirty) {
+            sortIndexAdds.insert(id);
+        }
+    }
+
+    void sortIndexRemoved(qint64 id)
+    {
+        if (!sortIndexesDirty && !sortIndexAdds.remove(id)) {
+            sortIndexRemovals.insert(id);
+        }
+    }
+
+    static bool timeLess(const ItemRecord *a, const ItemRecord *b)
+    {
+        return (a->pubDate < b->pubDate) || ((a->pubDate == b->pubDate) && (a->id < b->id));
+    }
+
+    static bool titleLess(const ItemRecord *a, const ItemRecord *b)
+    {
+        const int c = QString::compare(a->title, b->title);
+        return (c < 0) || ((c == 0) && (a->id < b->id));
+    }
+
+    static bool idLess(const ItemRecord *a, const ItemRecord *b)
+    {
+        return a->id < b->id;
+    }
+
+    /*
+     * Merges the already sorted records into the sorted index. Every ID of
+     * the index is only looked up once.
+     */
+    void mergeSortIndex(QVector<qint64> &index, const QVector<const ItemRecord*> &added, bool (*less)(const ItemRecord*, const ItemRecord*)) const
+    {
+        QVector<qint64> merged;
+        merged.reserve(index.size() + added.size());
+
+        auto ait = added.cbegin();
+        for (qint64 id : qAsConst(index)) {
+            const ItemRecord *r = &items.constFind(id).value();
+            while ((ait != added.cend()) && less(*ait, r)) {
+                merged.push_back((*ait)->id);
+                ++ait;
+            }
+            merged.push_back(id);
+        }
+        for (; ait != added.cend(); ++ait) {
+            merged.push_back((*ait)->id);
+        }
+
+        index = merged;
+    }
+
+    static QVector<qint64> idsOf(const QVector<const ItemRecord*> &records)
+    {
+        QVector<qint64> ids;
+        ids.reserve(records.size());
+        for (const ItemRecord *r : records) {
+            ids.push_back(r->id);
+        }
+        return ids;
+    }
+
+    /*
+     * Builds the sorted indexes on the first query and afterwards only
+     * removes and merges the items that changed since the last query.
+     * The comparisons work on pointers to the records, so that no record
+     * has to be looked up or copied while sorting.
+     */
+    void ensureSortIndexes()
+    {
+        if (sortIndexesDirty) {
+            QVector<const ItemRecord*> records;
+            records.reserve(items.size());
+            for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+                records.push_back(&it.value());
+            }
+
+            std::sort(records.begin(), records.end(), idLess);
+            itemsById = idsOf(records);
+
+            std::sort(records.begin(), records.end(), timeLess);
+            itemsByTime = idsOf(records);
+
+            std::sort(records.begin(), records.end(), titleLess);
+            itemsByTitle = idsOf(records);
+
+            sortIndexAdds.clear();
+            sortIndexRemovals.clear();
+            sortIndexesDirty = false;
+            return;
+        }
+
+        if (!sortIndexRemovals.isEmpty()) {
+            const auto removed = [this] (qint64 id) { return sortIndexRemovals.contains(id); };
+            for (QVector<qint64> *index : {&itemsById, &itemsByTime, &itemsByTitle}) {
+                index->erase(std::remove_if(index->begin(), index->end(), removed), index->end());
+            }
+            sortIndexRemovals.clear();
+        }
+
+        if (!sortIndexAdds.isEmpty()) {
+            QVector<const ItemRecord*> added;
+            added.reserve(sortIndexAdds.size());
+            for (qint64 id : qAsConst(sortIndexAdds)) {
+                added.push_back(&items.constFind(id).value());
+            }
+            sortIndexAdds.clear();
+
+            std::sort(added.begin(), added.end(), idLess);
+            mergeSortIndex(itemsById, added, idLess);
+
+            std::sort(added.begin(), added.end(), timeLess);
+            mergeSortIndex(itemsByTime, added, timeLess);
+
+            std::sort(added.begin(), added.end(), titleLess);
+            mergeSortIndex(itemsByTitle, added, titleLess);
+        }
+    }
+
+    bool itemMatches(const ItemRecord &i, const QueryArgs &args) const
+    {
+        if (args.parentId > -1) {
+            if (args.parentIdType == FuotenEnums::Feed) {
+                if (i.feedId != args.parentId) {
+                    return false;
+                }
+            } else if (folderIdForFeed(i.feedId) != args.parentId) {
+                return false;
+            }
+        }
+
+        if (!args.inIds.isEmpty()) {
+            switch (args.inIdsType) {
+            case FuotenEnums::Folder:
+                if (!args.inIds.contains(folderIdForFeed(i.feedId))) {
+                    return false;
+                }
+                break;
+            case FuotenEnums::Feed:
+                if (!args.inIds.contains(i.feedId)) {
+                    return false;
+                }
+                break;
+            default:
+                if (!args.inIds.contains(i.id)) {
+                    return false;
+                }
+                break;
+            }
+        }
+
+        if (args.unreadOnly && !i.unread) {
+            return false;
+        }
+
+        if (args.starredOnly && !i.starred) {
+            return false;
+        }
+
+        if (args.queuedOnly && (i.queue == FuotenEnums::QueueActions(FuotenEnums::NoQueueAction))) {
+            return false;
+        }
+
+        return true;
+    }
+
+    QHash<qint64, FolderRecord> folders;
+    QHash<qint64, FeedRecord> feeds;
+    QHash<qint64, ItemRecord> items;
+    QMultiHash<qint64, qint64> feedsByFolder;
+    QMultiHash<qint64, qint64> itemsByFeed;
+    QHash<QPair<qint64, QString>, qint64> itemsByGuidHash;
+    QVector<qint64> itemsById;
+    QVector<qint64> itemsByTime;
+    QVector<qint64> itemsByTitle;
+    QSet<qint64> sortIndexAdds;
+    QSet<qint64> sortIndexRemovals;
+    bool sortIndexesDirty = true;
+};
+
+}
+
+#endif // FUOTENMEMORYSTORAGE_P_H
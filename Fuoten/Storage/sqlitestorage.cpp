@@ -23,13 +23,18 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QHash>
+#include <QSet>
 #include <QSqlQuery>
 #include <QDateTime>
 #include <QVariant>
 #include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
 #include "../folder.h"
 #include "../feed.h"
 #include "../article.h"
+#include "../Helpers/tracer.h"
+#include "../Helpers/jsondecoder.h"
 
 using namespace Fuoten;
 
@@ -37,6 +42,33 @@ using namespace Fuoten;
 #define SEL_TOTAL_STARRED "SELECT * FROM total_starred"
 
 
+/*
+ * Counts the unread and starred items and persists the counters in the system
+ * table, marking them as up to date. Has to be called inside the transaction
+ * that updated the unread counters of the feeds and folders.
+ */
+static bool persistTotals(QSqlQuery &q, quint16 &totalUnread, quint16 &starred)
+{
+    if (!q.exec(QStringLiteral(SEL_TOTAL_UNREAD)) || !q.next()) {
+        return false;
+    }
+    totalUnread = q.value(0).value<quint16>();
+
+    if (!q.exec(QStringLiteral(SEL_TOTAL_STARRED)) || !q.next()) {
+        return false;
+    }
+    starred = q.value(0).value<quint16>();
+
+    if (!q.prepare(QStringLiteral("INSERT OR REPLACE INTO system (key, value) VALUES ('total_unread', ?), ('total_starred', ?), ('counters_dirty', '0')"))) {
+        return false;
+    }
+    q.addBindValue(QString::number(totalUnread));
+    q.addBindValue(QString::number(starred));
+
+    return q.exec();
+}
+
+
 SQLiteStorageManager::SQLiteStorageManager(const QString &dbpath, QObject *parent) :
     QThread(parent), m_currentDbVersion(0)
 {
@@ -61,6 +93,9 @@ void SQLiteStorageManager::setFailed(const QSqlError &sqlError, const QString &t
 
 void SQLiteStorageManager::run()
 {
+    QElapsedTimer timer;
+    timer.start();
+
     bool result = m_db.open();
     Q_ASSERT_X(result, "init database", "failed to open database");
 
@@ -70,185 +105,623 @@ void SQLiteStorageManager::run()
     result = q.exec(QStringLiteral("PRAGMA foreign_keys = ON"));
     Q_ASSERT_X(result, "init database", "failed to activate foreign keys");
 
-    result = m_db.transaction();
-    Q_ASSERT_X(result, "init dtabase", "failed to start transaction");
-
-    result = q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS system "
-                                   "(id INTEGER PRIMARY KEY NOT NULL, "
-                                   "key TEXT NOT NULL, "
-                                   "value TEXT NO NULL)"
-                                   ));
-    Q_ASSERT_X(result, "init database", "failed to create system table");
-
-    result = q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS folders "
-                                   "(id INTEGER PRIMARY KEY NOT NULL, "
-                                   "name TEXT NOT NULL, "
-                                   "unreadCount INTEGER DEFAULT 0, "
-                                   "feedCount INTEGER DEFAULT 0)"
-                                   ));
-    Q_ASSERT_X(result, "init database", "failed to create folders table");
-
-    result = q.exec(QStringLiteral("INSERT OR IGNORE INTO folders (id, name) VALUES (0, '')"));
-    Q_ASSERT_X(result, "init database", "failed to inser base folder into database");
-
-
-    result = q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS feeds "
-                                   "(id INTEGER PRIMARY KEY NOT NULL, "
-                                   "folderId INTEGER NOT NULL, "
-                                   "title TEXT NOT NULL, "
-                                   "url TEXT NOT NULL, "
-                                   "link TEXT NOT NULL, "
-                                   "added INTEGER NOT NULL, "
-                                   "unreadCount INTEGER DEFAULT 0, "
-                                   "ordering INTEGER NOT NULL, "
-                                   "pinned INTEGER NOT NULL, "
-                                   "updateErrorCount INTEGER NOT NULL, "
-                                   "lastUpdateError TEXT, "
-                                   "faviconLink TEXT, "
-                                   "FOREIGN KEY(folderId) REFERENCES folders(id) ON DELETE CASCADE)"
-                                   ));
-    Q_ASSERT_X(result, "init database", "failed to create feeds table");
-
-    result = q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS items "
-                                   "(id INTEGER PRIMARY KEY NOT NULL, "
-                                   "feedId INTEGER NOT NULL, "
-                                   "guid TEXT NOT NULL, "
-                                   "guidHash TEXT NOT NULL, "
-                                   "url TEXT NOT NULL, "
-                                   "title TEXT NOT NULL, "
-                                   "author TEXT NOT NULL, "
-                                   "pubDate INTEGER NOT NULL, "
-                                   "body TEXT NOT NULL, "
-                                   "enclosureMime TEXT, "
-                                   "enclosureLink TEXT, "
-                                   "unread INTEGER NOT NULL, "
-                                   "starred INTEGER NOT NULL, "
-                                   "lastModified INTEGER NOT NULL, "
-                                   "fingerprint TEXT NOT NULL, "
-                                   "queue INTEGER DEFAULT 0, "
-                                   "FOREIGN KEY(feedId) REFERENCES feeds(id) ON DELETE CASCADE)"
-                                   ));
-    Q_ASSERT_X(result, "init database", "failed to create items table");
-
-    result = q.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS feeds_folder_id_index ON feeds (folderId)"));
-    Q_ASSERT_X(result, "init database", "failed to create feeds_folder_id_index");
-
-    result = q.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS items_item_guid ON items (guidHash, feedId)"));
-    Q_ASSERT_X(result, "init database", "failed to create items_item_guid index");
-
-    result = q.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS items_feed_id_index ON items (feedId)"));
-    Q_ASSERT_X(result, "init database", "failed to create items_feed_id_index");
-
-
-//    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS feeds_unreadCount_update_item AFTER UPDATE OF unread ON items "
-//                               "BEGIN "
-//                               "UPDATE feeds SET unreadCount = (SELECT COUNT(id) FROM items WHERE unread = 1 AND feedId = old.feedId) WHERE id = old.feedId; "
-//                               "END"
-//                               ))) {
-//        //% "Failed to execute database query."
-//        setFailed(q.lastError(), qtTrId("fuoten-error-failed-execute-query"));
-//        return;
-//    }
-
-//    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS feeds_unreadCount_delete_item AFTER DELETE ON items "
-//                               "BEGIN "
-//                               "UPDATE feeds SET unreadCount = (SELECT COUNT(id) FROM items WHERE unread = 1 AND feedId = old.feedId) WHERE id = old.feedId; "
-//                               "END"
-//                               ))) {
-//        //% "Failed to execute database query."
-//        setFailed(q.lastError(), qtTrId("fuoten-error-failed-execute-query"));
-//        return;
-//    }
-
-//    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS feeds_unreadCount_insert_item AFTER INSERT ON items "
-//                               "BEGIN "
-//                               "UPDATE feeds SET unreadCount = (SELECT COUNT(id) FROM items WHERE unread = 1 AND feedId = new.feedId) WHERE id = new.feedId; "
-//                               "END"
-//                               ))) {
-//        //% "Failed to execute database query."
-//        setFailed(q.lastError(), qtTrId("fuoten-error-failed-execute-query"));
-//        return;
-//    }
-
-//    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS folders_unreadCount_update_feed AFTER UPDATE OF unreadCount ON feeds "
-//                               "BEGIN "
-//                               "UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = old.folderId) WHERE id = old.folderId; "
-//                               "END"
-//                               ))) {
-//        //% "Failed to execute database query."
-//        setFailed(q.lastError(), qtTrId("fuoten-error-failed-execute-query"));
-//        return;
-//    }
-
-//    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS folders_counts_delete_feed AFTER DELETE ON feeds "
-//                               "BEGIN "
-//                               "UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = old.folderId) WHERE id = old.folderId; "
-//                               "UPDATE folders SET feedCount = (SELECT COUNT(id) FROM feeds WHERE folderId = old.folderId) WHERE id = old.folderId; "
-//                               "END"))) {
-//        //% "Failed to execute database query."
-//        setFailed(q.lastError(), qtTrId("fuoten-error-failed-execute-query"));
-//        return;
-//    }
-
-//    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS folders_counts_insert_feed AFTER INSERT ON feeds "
-//                               "BEGIN "
-//                               "UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = new.folderId) WHERE id = new.folderId; "
-//                               "UPDATE folders SET feedCount = (SELECT COUNT(id) FROM feeds WHERE folderId = new.folderId) WHERE id = new.folderId; "
-//                               "END"
-//                               ))) {
-//        //% "Failed to execute database query."
-//        setFailed(q.lastError(), qtTrId("fuoten-error-failed-execute-query"));
-//        return;
-//    }
-
-//    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS folders_counts_move_feed AFTER UPDATE OF folderId ON feeds "
-//                               "BEGIN "
-//                               "UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = new.folderId) WHERE id = new.folderId; "
-//                               "UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = old.folderId) WHERE id = old.folderId; "
-//                               "UPDATE folders SET feedCount = (SELECT COUNT(id) FROM feeds WHERE folderId = new.folderId) WHERE id = new.folderId; "
-//                               "UPDATE folders SET feedCount = (SELECT COUNT(id) FROM feeds WHERE folderId = old.folderId) WHERE id = old.folderId; "
-//                               "END"))) {
-//        //% "Failed to execute database query."
-//        setFailed(q.lastError(), qtTrId("fuoten-error-failed-execute-query"));
-//        return;
-//    }
+    // a missing system table means that the database is empty or has been created before the schema got versioned
+    if (q.exec(QStringLiteral("SELECT value FROM system WHERE key = 'schema_version'")) && q.next()) {
+        m_currentDbVersion = q.value(0).toUInt();
+    }
+
+    if (Q_UNLIKELY(m_currentDbVersion > schemaVersion)) {
+        //% "The database schema version %1 is newer than the supported version %2."
+        setFailed(QSqlError(), qtTrId("libfuoten-err-sqlite-schema-too-new").arg(m_currentDbVersion).arg(schemaVersion));
+        return;
+    }
+
+    while (m_currentDbVersion < schemaVersion) {
+
+        const quint16 nextVersion = m_currentDbVersion + 1;
+
+        qDebug("Migrating database schema from version %u to version %u.", m_currentDbVersion, nextVersion);
+
+        result = m_db.transaction();
+        Q_ASSERT_X(result, "migrate database", "failed to start transaction");
+
+        if (Q_UNLIKELY(!migrate(nextVersion, q))) {
+            const QSqlError sqlError = q.lastError();
+            m_db.rollback();
+            //% "Failed to migrate the database schema to version %1."
+            setFailed(sqlError, qtTrId("libfuoten-err-sqlite-schema-migration").arg(nextVersion));
+            return;
+        }
+
+        if (!q.exec(QStringLiteral("UPDATE system SET value = '%1' WHERE key = 'schema_version'").arg(nextVersion)) || (q.numRowsAffected() < 1)) {
+            result = q.exec(QStringLiteral("INSERT INTO system (key, value) VALUES ('schema_version', '%1')").arg(nextVersion));
+            Q_ASSERT_X(result, "migrate database", "failed to insert schema version into database");
+        }
+
+        result = m_db.commit();
+        Q_ASSERT_X(result, "migrate database", "failed to commit database migration");
+
+        m_currentDbVersion = nextVersion;
+    }
+
+    quint16 totalUnread = 0;
+    quint16 starred = 0;
+    bool countersDirty = true;
+
+    result = q.exec(QStringLiteral("SELECT key, value FROM system WHERE key IN ('total_unread', 'total_starred', 'counters_dirty')"));
+    Q_ASSERT_X(result, "init database", "failed to query persisted counters");
+
+    while (q.next()) {
+        const QString key = q.value(0).toString();
+        if (key == QLatin1String("total_unread")) {
+            totalUnread = q.value(1).value<quint16>();
+        } else if (key == QLatin1String("total_starred")) {
+            starred = q.value(1).value<quint16>();
+        } else {
+            countersDirty = (q.value(1).toString() != QLatin1String("0"));
+        }
+    }
+
+    // items have been changed after the counters had been persisted the last time
+    if (countersDirty) {
+
+        qDebug("%s", "Persisted counters are outdated, counting the items again.");
+
+        result = m_db.transaction();
+        Q_ASSERT_X(result, "init database", "failed to start transaction");
+
+        if (Q_UNLIKELY(!recountCounters(q, totalUnread, starred))) {
+            const QSqlError sqlError = q.lastError();
+            m_db.rollback();
+            //% "Failed to update the unread and starred counters."
+            setFailed(sqlError, qtTrId("libfuoten-err-sqlite-recount-counters"));
+            return;
+        }
+
+        result = m_db.commit();
+        Q_ASSERT_X(result, "init database", "failed to commit updated counters");
+    }
+
+    Q_EMIT succeeded(totalUnread, starred);
+
+    qDebug("Finished checking database scheme in %lli ms.", timer.elapsed());
+}
+
+
+
+bool SQLiteStorageManager::migrate(quint16 toVersion, QSqlQuery &q)
+{
+    switch (toVersion) {
+    case 1:
+        return migrateTo1(q);
+    case 2:
+        return migrateTo2(q);
+    case 3:
+        return migrateTo3(q);
+    case 4:
+        return migrateTo4(q);
+    default:
+        return false;
+    }
+}
+
+
+
+/*
+ * Initial database layout. Uses IF NOT EXISTS to also work on databases
+ * that have been created before the schema got versioned.
+ */
+bool SQLiteStorageManager::migrateTo1(QSqlQuery &q)
+{
+    if (!q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS system "
+                               "(id INTEGER PRIMARY KEY NOT NULL, "
+                               "key TEXT NOT NULL, "
+                               "value TEXT NO NULL)"
+                               ))) {
+        return false;
+    }
 
+    if (!q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS folders "
+                               "(id INTEGER PRIMARY KEY NOT NULL, "
+                               "name TEXT NOT NULL, "
+                               "unreadCount INTEGER DEFAULT 0, "
+                               "feedCount INTEGER DEFAULT 0)"
+                               ))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("INSERT OR IGNORE INTO folders (id, name) VALUES (0, '')"))) {
+        return false;
+    }
+
+
+    if (!q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS feeds "
+                               "(id INTEGER PRIMARY KEY NOT NULL, "
+                               "folderId INTEGER NOT NULL, "
+                               "title TEXT NOT NULL, "
+                               "url TEXT NOT NULL, "
+                               "link TEXT NOT NULL, "
+                               "added INTEGER NOT NULL, "
+                               "unreadCount INTEGER DEFAULT 0, "
+                               "ordering INTEGER NOT NULL, "
+                               "pinned INTEGER NOT NULL, "
+                               "updateErrorCount INTEGER NOT NULL, "
+                               "lastUpdateError TEXT, "
+                               "faviconLink TEXT, "
+                               "FOREIGN KEY(folderId) REFERENCES folders(id) ON DELETE CASCADE)"
+                               ))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE TABLE IF NOT EXISTS items "
+                               "(id INTEGER PRIMARY KEY NOT NULL, "
+                               "feedId INTEGER NOT NULL, "
+                               "guid TEXT NOT NULL, "
+                               "guidHash TEXT NOT NULL, "
+                               "url TEXT NOT NULL, "
+                               "title TEXT NOT NULL, "
+                               "author TEXT NOT NULL, "
+                               "pubDate INTEGER NOT NULL, "
+                               "body TEXT NOT NULL, "
+                               "enclosureMime TEXT, "
+                               "enclosureLink TEXT, "
+                               "unread INTEGER NOT NULL, "
+                               "starred INTEGER NOT NULL, "
+                               "lastModified INTEGER NOT NULL, "
+                               "fingerprint TEXT NOT NULL, "
+                               "queue INTEGER DEFAULT 0, "
+                               "FOREIGN KEY(feedId) REFERENCES feeds(id) ON DELETE CASCADE)"
+                               ))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS feeds_folder_id_index ON feeds (folderId)"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS items_item_guid ON items (guidHash, feedId)"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS items_feed_id_index ON items (feedId)"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE VIEW IF NOT EXISTS total_unread AS SELECT COUNT(id) FROM items WHERE unread = 1"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE VIEW IF NOT EXISTS total_starred AS SELECT COUNT(id) FROM items WHERE starred = 1"))) {
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/*
+ * Removes the triggers used by older versions and persists the total
+ * unread and starred counters in the system table.
+ */
+bool SQLiteStorageManager::migrateTo2(QSqlQuery &q)
+{
     for (const QString &trigger : {QStringLiteral("feeds_unreadCount_update_item"), QStringLiteral("feeds_unreadCount_delete_item"), QStringLiteral("feeds_unreadCount_insert_item"), QStringLiteral("folders_unreadCount_update_feed"), QStringLiteral("folders_counts_delete_feed"), QStringLiteral("folders_counts_insert_feed"), QStringLiteral("folders_counts_move_feed")}) {
-        result = q.exec(QStringLiteral("DROP TRIGGER IF EXISTS %1").arg(trigger));
-        Q_ASSERT_X(result, "init database", "failed to drop obsolete trigger");
+        if (!q.exec(QStringLiteral("DROP TRIGGER IF EXISTS %1").arg(trigger))) {
+            return false;
+        }
+    }
+
+    // remove duplicate keys before adding the unique index
+    if (!q.exec(QStringLiteral("DELETE FROM system WHERE id NOT IN (SELECT MIN(id) FROM system GROUP BY key)"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE UNIQUE INDEX IF NOT EXISTS system_key_index ON system (key)"))) {
+        return false;
     }
 
-    result = q.exec(QStringLiteral("CREATE VIEW IF NOT EXISTS total_unread AS SELECT COUNT(id) FROM items WHERE unread = 1"));
-    Q_ASSERT_X(result, "init database", "failed to create total_unread view");
+    if (!q.exec(QStringLiteral("INSERT OR REPLACE INTO system (key, value) SELECT 'total_unread', COUNT(id) FROM items WHERE unread = 1"))) {
+        return false;
+    }
 
-    result = q.exec(QStringLiteral("CREATE VIEW IF NOT EXISTS total_starred AS SELECT COUNT(id) FROM items WHERE starred = 1"));
-    Q_ASSERT_X(result, "init database", "failed to create total_starred view");
+    if (!q.exec(QStringLiteral("INSERT OR REPLACE INTO system (key, value) SELECT 'total_starred', COUNT(id) FROM items WHERE starred = 1"))) {
+        return false;
+    }
 
-    result = m_db.commit();
-    Q_ASSERT_X(result, "init database", "failed to commit database queries");
+    return true;
+}
 
-    result = q.exec(QStringLiteral("SELECT value FROM system WHERE key = 'schema_version'"));
-    Q_ASSERT_X(result, "init database", "failed to query installed schema version");
 
-    if (Q_LIKELY(q.next())) {
-        m_currentDbVersion = q.value(0).toUInt();
+
+/*
+ * Adds a hash of the feed fields, so that unchanged feeds do not have to be
+ * compared field by field when the feeds are requested. Existing feeds get
+ * their hash on the next request.
+ */
+bool SQLiteStorageManager::migrateTo3(QSqlQuery &q)
+{
+    return q.exec(QStringLiteral("ALTER TABLE feeds ADD COLUMN hash TEXT"));
+}
+
+
+
+/*
+ * Adds triggers that mark the persisted counters as outdated in the same
+ * transaction that changes the unread or starred state of items. The counters
+ * are only marked as up to date again when they are persisted, so that init()
+ * counts the items again if the application stopped in between.
+ */
+bool SQLiteStorageManager::migrateTo4(QSqlQuery &q)
+{
+    // counters persisted by older versions might be outdated
+    if (!q.exec(QStringLiteral("INSERT OR REPLACE INTO system (key, value) VALUES ('counters_dirty', '1')"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS items_counters_insert AFTER INSERT ON items "
+                               "WHEN NEW.unread = 1 OR NEW.starred = 1 "
+                               "BEGIN UPDATE system SET value = '1' WHERE key = 'counters_dirty' AND value != '1'; END"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS items_counters_update AFTER UPDATE OF unread, starred ON items "
+                               "WHEN OLD.unread != NEW.unread OR OLD.starred != NEW.starred "
+                               "BEGIN UPDATE system SET value = '1' WHERE key = 'counters_dirty' AND value != '1'; END"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS items_counters_delete AFTER DELETE ON items "
+                               "WHEN OLD.unread = 1 OR OLD.starred = 1 "
+                               "BEGIN UPDATE system SET value = '1' WHERE key = 'counters_dirty' AND value != '1'; END"))) {
+        return false;
+    }
+
+    return true;
+}
+
+
+
+/*
+ * Updates the unread counters of all feeds and folders and persists the
+ * total unread and starred counters.
+ */
+bool SQLiteStorageManager::recountCounters(QSqlQuery &q, quint16 &totalUnread, quint16 &starred)
+{
+    if (!q.exec(QStringLiteral("UPDATE feeds SET unreadCount = (SELECT COUNT(id) FROM items WHERE unread = 1 AND feedId = feeds.id)"))) {
+        return false;
+    }
+
+    if (!q.exec(QStringLiteral("UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = folders.id)"))) {
+        return false;
+    }
+
+    return persistTotals(q, totalUnread, starred);
+}
+
+
+
+bool SQLiteStoragePrivate::articleData(qint64 id, ArticleData &data)
+{
+    QMutexLocker locker(&articleCacheMutex);
+
+    const ArticleData *cached = articleCache.object(id);
+    if (cached) {
+        articleCacheHits++;
+        data = *cached;
+        return true;
+    }
+
+    articleCacheMisses++;
+
+    // the row might be changed and its cache entry invalidated while the lock is released
+    const quint64 generation = articleCacheGeneration;
+
+    locker.unlock();
+
+    QSqlQuery q(connection());
+
+    bool qresult = q.prepare(QStringLiteral("SELECT it.id, it.feedId, fe.title, it.guid, it.guidHash, it.url, it.title, it.author, it.pubDate, it.body, it.enclosureMime, it.enclosureLink, it.unread, it.starred, it.lastModified, it.fingerprint, fo.id, fo.name, it.queue FROM items it LEFT JOIN feeds fe ON fe.id = it.feedId LEFT JOIN folders fo on fo.id = fe.folderId WHERE it.id = ?"));
+    Q_ASSERT_X(qresult, "get article", "failed to prepare database query");
+
+    q.addBindValue(id);
+
+    qresult = q.exec();
+    Q_ASSERT_X(qresult, "get article", "failed to execute database query");
+
+    if (!q.next()) {
+        return false;
+    }
+
+    data.id = q.value(0).toLongLong();
+    data.feedId = q.value(1).toLongLong();
+    data.feedTitle = q.value(2).toString();
+    data.guid = q.value(3).toString();
+    data.guidHash = q.value(4).toString();
+    data.url = QUrl(q.value(5).toString());
+    data.title = q.value(6).toString();
+    data.author = q.value(7).toString();
+    data.pubDate = q.value(8).toUInt();
+    data.body = q.value(9).toString();
+    data.enclosureMime = q.value(10).toString();
+    data.enclosureLink = QUrl(q.value(11).toString());
+    data.unread = q.value(12).toBool();
+    data.starred = q.value(13).toBool();
+    data.lastModified = q.value(14).toUInt();
+    data.fingerprint = q.value(15).toString();
+    data.folderId = q.value(16).toLongLong();
+    data.folderName = q.value(17).toString();
+    data.queue = q.value(18).toInt();
+
+    locker.relock();
+
+    const int cost = data.cost();
+    if ((generation == articleCacheGeneration) && (cost <= articleCache.maxCost())) {
+        articleCache.insert(id, new ArticleData(data), cost);
+
+        // drop the keys of evicted articles before they outnumber the cached ones
+        if (articleCacheKeys.size() > 2 * qMax(articleCache.size(), 64)) {
+            auto it = articleCacheKeys.begin();
+            while (it != articleCacheKeys.end()) {
+                if (articleCache.contains(it.key())) {
+                    ++it;
+                } else {
+                    it = articleCacheKeys.erase(it);
+                }
+            }
+        }
+
+        ArticleCacheKey &key = articleCacheKeys[id];
+        key.feedId = data.feedId;
+        key.folderId = data.folderId;
+        key.guidHash = data.guidHash;
+    }
+
+    return true;
+}
+
+
+
+
+void SQLiteStoragePrivate::persistCounters(quint16 totalUnread, quint16 starred)
+{
+    // items written by the items worker are only counted by the worker itself, deferred batches
+    // not before the finishing batch, so the counters are not up to date before all of them are done
+    const bool upToDate = !itemsMaintenancePending && !itemsWriterActive && itemsWriteQueue.isEmpty();
+
+    QSqlQuery q(db);
+
+    // a single statement, so that the counters can not be marked as up to date without being written
+    bool qresult = q.prepare(QStringLiteral("INSERT OR REPLACE INTO system (key, value) VALUES ('total_unread', ?), ('total_starred', ?), ('counters_dirty', ?)"));
+    Q_ASSERT_X(qresult, "persist counters", "failed to prepare database query");
+    q.addBindValue(QString::number(totalUnread));
+    q.addBindValue(QString::number(starred));
+    q.addBindValue(upToDate ? QStringLiteral("0") : QStringLiteral("1"));
+
+    // on failure the flag set by the item triggers stays in place, init() will count the items again
+    countersOutdated = !q.exec();
+
+    if (Q_UNLIKELY(countersOutdated)) {
+        qWarning("Failed to persist counters: %s", qUtf8Printable(q.lastError().text()));
+    }
+}
+
+
+void SQLiteStoragePrivate::persistSystemValue(const QString &key, const QString &value)
+{
+    QSqlQuery q(db);
+
+    bool qresult = false;
+    if (value.isNull()) {
+        qresult = q.prepare(QStringLiteral("DELETE FROM system WHERE key = ?"));
+        Q_ASSERT_X(qresult, "persist system value", "failed to prepare database query");
+        q.addBindValue(key);
+    } else {
+        qresult = q.prepare(QStringLiteral("INSERT OR REPLACE INTO system (key, value) VALUES (?, ?)"));
+        Q_ASSERT_X(qresult, "persist system value", "failed to prepare database query");
+        q.addBindValue(key);
+        q.addBindValue(value);
+    }
+
+    if (Q_UNLIKELY(!q.exec())) {
+        qWarning("Failed to persist %s: %s", qUtf8Printable(key), qUtf8Printable(q.lastError().text()));
+    }
+}
+
+
+QString SQLiteStoragePrivate::feedHash(qint64 folderId, const QString &title, const QString &url, const QString &link, uint added, int ordering, bool pinned, int updateErrorCount, const QString &lastUpdateError, const QString &faviconLink)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(folderId));
+    for (const QString &s : {title, url, link, lastUpdateError, faviconLink}) {
+        hash.addData("\x1f", 1);
+        hash.addData(s.toUtf8());
+    }
+    hash.addData(QStringLiteral("\x1f%1\x1f%2\x1f%3\x1f%4").arg(added).arg(ordering).arg(pinned ? 1 : 0).arg(updateErrorCount).toLatin1());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+
+QThreadStorage<QString> SQLiteStoragePrivate::threadConnectionName;
+
+
+QSqlDatabase SQLiteStoragePrivate::connection() const
+{
+    if (threadConnectionName.hasLocalData() && !threadConnectionName.localData().isEmpty()) {
+        return QSqlDatabase::database(threadConnectionName.localData(), false);
+    }
+    return db;
+}
+
+
+
+SQLiteQueryWorker::SQLiteQueryWorker(const QString &dbpath, const std::function<void ()> &query) :
+    QRunnable(), m_dbpath(dbpath), m_query(query)
+{
+
+}
+
+
+void SQLiteQueryWorker::run()
+{
+    TraceSpan span("storage", "SQLiteQueryWorker");
+
+    // every query gets its own connection, a connection can only be used in the thread that created it
+    const QString connectionName = QStringLiteral("fuotendb-query-%1").arg(reinterpret_cast<quintptr>(this));
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connectionName);
+        db.setDatabaseName(m_dbpath);
+
+        bool result = db.open();
+        Q_ASSERT_X(result, "query worker", "failed to open database");
+
+        QSqlQuery q(db);
+        result = q.exec(QStringLiteral("PRAGMA foreign_keys = ON"));
+        Q_ASSERT_X(result, "query worker", "failed to enable foreign keys support");
+
+        SQLiteStoragePrivate::threadConnectionName.setLocalData(connectionName);
+
+        m_query();
+
+        db.close();
     }
 
-    if (Q_UNLIKELY(m_currentDbVersion == 0)) {
-        result = q.exec(QStringLiteral("INSERT INTO system (key, value) VALUES ('schema_version', '1')"));
-        Q_ASSERT_X(result, "init database", "failed to insert schema version into database");
+    // the pool thread is reused for other queries, maybe of other storages
+    SQLiteStoragePrivate::threadConnectionName.setLocalData(QString());
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+
+
+template<typename T>
+static void moveResultToThread(const QList<T*> &objects, QThread *thread)
+{
+    for (T *o : objects) {
+        o->moveToThread(thread);
     }
+}
 
-    Q_EMIT succeeded();
 
-    qDebug("%s", "Finished checking databsae scheme.");
+/*
+ * Runs the query function in the query thread pool of the storage and returns a
+ * future that reports the return value of the function.
+ */
+template<typename T>
+static QFuture<T> runQuery(SQLiteStoragePrivate *d, const std::function<T ()> &query)
+{
+    QFutureInterface<T> fi(QFutureInterfaceBase::Started);
+
+    d->queryPool.start(new SQLiteQueryWorker(d->db.databaseName(), [fi, query] () mutable {
+        fi.reportResult(query());
+        fi.reportFinished();
+    }));
+
+    return fi.future();
 }
 
 
 
+
 SQLiteStorage::SQLiteStorage(const QString &dbpath, QObject *parent) :
     AbstractStorage(* new SQLiteStoragePrivate(dbpath), parent)
 {
+    Q_D(SQLiteStorage);
+
+    // keep the article cache in sync with the changes announced by the storage signals
+
+    connect(this, &AbstractStorage::requestedItems, this, [d] (const IdList &updatedItems, const IdList &newItems, const IdList &deletedItems) {
+        Q_UNUSED(newItems)
+        d->invalidateArticles(updatedItems);
+        d->invalidateArticles(deletedItems);
+    });
+
+    connect(this, &AbstractStorage::markedItems, this, [d] (const IdList &itemIds) {
+        d->invalidateArticles(itemIds);
+    });
+
+    connect(this, &AbstractStorage::markedItem, this, [d] (qint64 itemId) {
+        d->invalidateArticles(IdList({itemId}));
+    });
+
+    connect(this, &AbstractStorage::dequeuedItems, this, [d] (const IdList &itemIds) {
+        d->invalidateArticles(itemIds);
+    });
+
+    connect(this, &AbstractStorage::starredItems, this, [d] (const QList<QPair<qint64, QString>> &articles) {
+        d->invalidateArticles([&articles] (const SQLiteStoragePrivate::ArticleCacheKey &a) {
+            return articles.contains(qMakePair(a.feedId, a.guidHash));
+        });
+    });
+
+    connect(this, &AbstractStorage::starredItem, this, [d] (qint64 feedId, const QString &guidHash) {
+        d->invalidateArticles([feedId, &guidHash] (const SQLiteStoragePrivate::ArticleCacheKey &a) {
+            return (a.feedId == feedId) && (a.guidHash == guidHash);
+        });
+    });
+
+    auto invalidateFeed = [d] (qint64 feedId) {
+        d->invalidateArticles([feedId] (const SQLiteStoragePrivate::ArticleCacheKey &a) {
+            return a.feedId == feedId;
+        });
+    };
+    connect(this, &AbstractStorage::markedReadFeed, this, invalidateFeed);
+    connect(this, &AbstractStorage::markedReadFeedInQueue, this, invalidateFeed);
+    connect(this, &AbstractStorage::deletedFeed, this, invalidateFeed);
+    connect(this, &AbstractStorage::movedFeed, this, invalidateFeed);
+    connect(this, &AbstractStorage::renamedFeed, this, invalidateFeed);
+
+    connect(this, &AbstractStorage::requestedFeeds, this, [d] (const IdList &updatedFeeds, const IdList &newFeeds, const IdList &deletedFeeds) {
+        Q_UNUSED(newFeeds)
+        if (!updatedFeeds.isEmpty() || !deletedFeeds.isEmpty()) {
+            d->invalidateArticles([&updatedFeeds, &deletedFeeds] (const SQLiteStoragePrivate::ArticleCacheKey &a) {
+                return updatedFeeds.contains(a.feedId) || deletedFeeds.contains(a.feedId);
+            });
+        }
+    });
+
+    auto invalidateFolder = [d] (qint64 folderId) {
+        d->invalidateArticles([folderId] (const SQLiteStoragePrivate::ArticleCacheKey &a) {
+            return a.folderId == folderId;
+        });
+    };
+    connect(this, &AbstractStorage::markedReadFolder, this, invalidateFolder);
+    connect(this, &AbstractStorage::markedReadFolderInQueue, this, invalidateFolder);
+    connect(this, &AbstractStorage::deletedFolder, this, invalidateFolder);
+    connect(this, &AbstractStorage::renamedFolder, this, invalidateFolder);
+
+    connect(this, &AbstractStorage::requestedFolders, this, [d] (const QList<QPair<qint64, QString>> &updatedFolders, const QList<QPair<qint64, QString>> &newFolders, const IdList &deletedFolders) {
+        Q_UNUSED(newFolders)
+        if (!updatedFolders.isEmpty() || !deletedFolders.isEmpty()) {
+            d->invalidateArticles([&updatedFolders, &deletedFolders] (const SQLiteStoragePrivate::ArticleCacheKey &a) {
+                if (deletedFolders.contains(a.folderId)) {
+                    return true;
+                }
+                for (const QPair<qint64, QString> &f : updatedFolders) {
+                    if (f.first == a.folderId) {
+                        return true;
+                    }
+                }
+                return false;
+            });
+        }
+    });
+
+    auto invalidateAll = [d] () {
+        QMutexLocker locker(&d->articleCacheMutex);
+        d->clearArticleCache();
+    };
+    connect(this, &AbstractStorage::markedAllItemsRead, this, invalidateAll);
+    connect(this, &AbstractStorage::markedAllItemsReadInQueue, this, invalidateAll);
+    connect(this, &AbstractStorage::queueCleared, this, invalidateAll);
+}
+
+
+SQLiteStorage::~SQLiteStorage()
+{
+    Q_D(SQLiteStorage);
+    // the running queries call the getters of this object
+    d->queryPool.waitForDone();
 }
 
 
@@ -257,7 +730,7 @@ void SQLiteStorage::init()
     Q_D(SQLiteStorage);
 
     SQLiteStorageManager *sm = new SQLiteStorageManager(d->db.databaseName(), this);
-    connect(sm, &SQLiteStorageManager::succeeded, this, [=] () {
+    connect(sm, &SQLiteStorageManager::succeeded, this, [=] (quint16 totalUnread, quint16 starred) {
         bool result = d->db.open();
         Q_ASSERT_X(result, "init database", "failed to open database");
 
@@ -266,15 +739,27 @@ void SQLiteStorage::init()
         result = q.exec(QStringLiteral("PRAGMA foreign_keys = ON"));
         Q_ASSERT_X(result, "init databse", "failed to enable foreign keys support");
 
-        result = (q.exec(QStringLiteral(SEL_TOTAL_UNREAD)) && q.next());
-        Q_ASSERT_X(result, "init database", "failed to query unread items from database");
+        // the manager only counts the items if they changed after the counters have been persisted
+        setTotalUnread(totalUnread);
+        setStarred(starred);
 
-        setTotalUnread(q.value(0).toInt());
+        result = q.exec(QStringLiteral("SELECT value FROM system WHERE key = 'sync_checkpoint'"));
+        Q_ASSERT_X(result, "init database", "failed to query synchronization checkpoint");
+        if (q.next()) {
+            AbstractStorage::setSyncCheckpoint(QJsonDocument::fromJson(q.value(0).toString().toUtf8()).object());
+        }
 
-        result = (q.exec(QStringLiteral(SEL_TOTAL_STARRED)) && q.next());
-        Q_ASSERT_X(result, "init database", "failed to query starred items from database");
+        result = q.exec(QStringLiteral("SELECT key, value FROM system WHERE key LIKE 'reply_hash:%'"));
+        Q_ASSERT_X(result, "init database", "failed to query reply hashes");
+        while (q.next()) {
+            AbstractStorage::setReplyHash(q.value(0).toString().mid(11), QByteArray::fromHex(q.value(1).toString().toLatin1()));
+        }
 
-        setStarred(q.value(0).toInt());
+        result = q.exec(QStringLiteral("SELECT value FROM system WHERE key = 'starred_watermark'"));
+        Q_ASSERT_X(result, "init database", "failed to query starred watermark");
+        if (q.next()) {
+            AbstractStorage::setStarredWatermark(QDateTime::fromTime_t(q.value(0).toUInt(), Qt::UTC));
+        }
 
         setReady(true);
     });
@@ -286,6 +771,71 @@ void SQLiteStorage::init()
 
 
 
+void SQLiteStorage::setTotalUnread(quint16 nTotalUnread)
+{
+    const bool changed = (nTotalUnread != totalUnread());
+
+    AbstractStorage::setTotalUnread(nTotalUnread);
+
+    Q_D(SQLiteStorage);
+
+    if ((changed || d->countersOutdated) && ready()) {
+        d->persistCounters(nTotalUnread, starred());
+    }
+}
+
+
+void SQLiteStorage::setSyncCheckpoint(const QJsonObject &checkpoint)
+{
+    AbstractStorage::setSyncCheckpoint(checkpoint);
+
+    if (ready()) {
+        Q_D(SQLiteStorage);
+        d->persistSystemValue(QStringLiteral("sync_checkpoint"), checkpoint.isEmpty() ? QString() : QString::fromUtf8(QJsonDocument(checkpoint).toJson(QJsonDocument::Compact)));
+    }
+}
+
+
+void SQLiteStorage::setReplyHash(const QString &key, const QByteArray &hash)
+{
+    if (hash == replyHash(key)) {
+        return;
+    }
+
+    AbstractStorage::setReplyHash(key, hash);
+
+    if (ready()) {
+        Q_D(SQLiteStorage);
+        d->persistSystemValue(QStringLiteral("reply_hash:") + key, hash.isEmpty() ? QString() : QString::fromLatin1(hash.toHex()));
+    }
+}
+
+
+void SQLiteStorage::setStarredWatermark(const QDateTime &watermark)
+{
+    AbstractStorage::setStarredWatermark(watermark);
+
+    if (ready()) {
+        Q_D(SQLiteStorage);
+        d->persistSystemValue(QStringLiteral("starred_watermark"), watermark.isValid() ? QString::number(watermark.toTime_t()) : QString());
+    }
+}
+
+
+void SQLiteStorage::setStarred(quint16 nStarred)
+{
+    const bool changed = (nStarred != starred());
+
+    AbstractStorage::setStarred(nStarred);
+
+    Q_D(SQLiteStorage);
+
+    if ((changed || d->countersOutdated) && ready()) {
+        d->persistCounters(totalUnread(), nStarred);
+    }
+}
+
+
 qint64 SQLiteStorage::getNewestItemId(FuotenEnums::Type type, qint64 id)
 {
     if (!ready()) {
@@ -317,6 +867,7 @@ qint64 SQLiteStorage::getNewestItemId(FuotenEnums::Type type, qint64 id)
         break;
     case FuotenEnums::All:
         qs = QStringLiteral("SELECT id FROM items ORDER BY id DESC LIMIT 1");
+        break;
     case FuotenEnums::Folder:
         qs = QStringLiteral("SELECT id FROM items WHERE feedId IN (SELECT id FROM feeds WHERE folderId = ?) ORDER BY id DESC LIMIT 1");
         break;
@@ -326,7 +877,7 @@ qint64 SQLiteStorage::getNewestItemId(FuotenEnums::Type type, qint64 id)
 
     Q_D(SQLiteStorage);
 
-    QSqlQuery q(d->db);
+    QSqlQuery q(d->connection());
     bool qresult = true;
 
     if (type == FuotenEnums::All) {
@@ -334,27 +885,81 @@ qint64 SQLiteStorage::getNewestItemId(FuotenEnums::Type type, qint64 id)
         qresult = q.exec(qs);
         Q_ASSERT_X(qresult, "get newest item ID", "failed to execute database query");
 
-    } else {
+    } else {
+
+        qresult = q.prepare(qs);
+        Q_ASSERT_X(qresult, "get newest item ID", "failed to prepare database query");
+
+        q.addBindValue(id);
+
+        qresult = q.exec();
+        Q_ASSERT_X(qresult, "get newest item ID", "failed to execute database query");
+    }
+
+    if (q.next()) {
+        return q.value(0).toLongLong();
+    } else {
+        return -1;
+    }
+}
+
+
+QHash<qint64, QList<uint>> SQLiteStorage::getPublishDates(int limit)
+{
+    QHash<qint64, QList<uint>> dates;
+
+    if (!ready()) {
+        //% "SQLite database not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-sqlite-db-not-ready"), QString(), this));
+        notify(error());
+        return dates;
+    }
+
+    Q_D(SQLiteStorage);
 
-        qresult = q.prepare(qs);
-        Q_ASSERT_X(qresult, "get newest item ID", "failed to prepare database query");
+    QSqlQuery q(d->connection());
+    q.setForwardOnly(true);
 
-        q.addBindValue(id);
+    const bool qresult = q.exec(QStringLiteral("SELECT feedId, pubDate FROM items ORDER BY feedId, pubDate DESC"));
+    Q_ASSERT_X(qresult, "get publish dates", "failed to execute database query");
 
-        qresult = q.exec();
-        Q_ASSERT_X(qresult, "get newest item ID", "failed to execute database query");
+    // the rows are ordered by feed, so the dates of a feed can be collected before they are inserted
+    qint64 feedId = -1;
+    QList<uint> feedDates;
+    while (q.next()) {
+        const qint64 id = q.value(0).toLongLong();
+        if (id != feedId) {
+            if (!feedDates.isEmpty()) {
+                dates.insert(feedId, feedDates);
+                feedDates.clear();
+            }
+            feedId = id;
+        }
+        if ((limit <= 0) || (feedDates.size() < limit)) {
+            feedDates.append(q.value(1).toUInt());
+        }
     }
 
-    if (q.next()) {
-        return q.value(0).toLongLong();
-    } else {
-        return -1;
+    if (!feedDates.isEmpty()) {
+        dates.insert(feedId, feedDates);
     }
+
+    return dates;
 }
 
 
 
 void SQLiteStorage::foldersRequested(const QJsonDocument &json)
+{
+    if (json.isEmpty() || json.isNull()) {
+        return;
+    }
+
+    foldersRequested(JsonDecoder::foldersFromJson(json));
+}
+
+
+void SQLiteStorage::foldersRequested(const FolderRecords &folders, const QString &replyKey, const QByteArray &replyHash)
 {
     Q_D(SQLiteStorage);
 
@@ -365,21 +970,13 @@ void SQLiteStorage::foldersRequested(const QJsonDocument &json)
         return;
     }
 
-    if (json.isEmpty() || json.isNull()) {
-        return;
-    }
-
-    const QJsonArray folders = json.object().value(QStringLiteral("folders")).toArray();
-
     qDebug("Processing %i folders requested from the remote server.", folders.size());
 
     QHash<qint64, QString> reqFolders({{0, QStringLiteral("")}});
+    reqFolders.reserve(folders.size() + 1);
 
-    for (const QJsonValue &f : folders) {
-        const QJsonObject o = f.toObject();
-        if (Q_LIKELY(!o.isEmpty())) {
-            reqFolders.insert(o.value(QStringLiteral("id")).toVariant().toLongLong(), o.value(QStringLiteral("name")).toString());
-        }
+    for (const FolderRecord &f : folders) {
+        reqFolders.insert(f.id, f.name);
     }
 
     QSqlQuery q(d->db);
@@ -532,6 +1129,10 @@ void SQLiteStorage::foldersRequested(const QJsonDocument &json)
         }
     }
 
+    if (!replyHash.isEmpty()) {
+        setReplyHash(replyKey, replyHash);
+    }
+
     Q_EMIT requestedFolders(updatedFolders, newFolders, deletedIds);
 }
 
@@ -695,7 +1296,7 @@ QList<Folder*> SQLiteStorage::getFolders(FuotenEnums::SortingRole sortingRole, Q
         qs.append(QLatin1String(" LIMIT ")).append(QString::number(limit));
     }
 
-    QSqlQuery q(d->db);
+    QSqlQuery q(d->connection());
     q.setForwardOnly(true);
 
     bool qresult = q.exec(qs);
@@ -912,7 +1513,7 @@ QList<Feed*> SQLiteStorage::getFeeds(const QueryArgs &args)
         qs.append(QLatin1String(" LIMIT ")).append(QString::number(args.limit));
     }
 
-    QSqlQuery q(d->db);
+    QSqlQuery q(d->connection());
     q.setForwardOnly(true);
     bool qresult = q.exec(qs);
     Q_ASSERT_X(qresult, "get feeds", "failed to query feeds from database");
@@ -949,7 +1550,7 @@ Feed *SQLiteStorage::getFeed(qint64 id)
 
     Q_D(SQLiteStorage);
 
-    QSqlQuery q(d->db);
+    QSqlQuery q(d->connection());
 
     bool qresult = q.prepare(QStringLiteral("SELECT fe.id, fe.folderId, fe.title, fe.url, fe.link, fe.added, fe.unreadCount, fe.ordering, fe.pinned, fe.updateErrorCount, fe.lastUpdateError, fe.faviconLink, fo.name AS folderName FROM feeds fe LEFT JOIN folders fo ON fo.id = fe.folderId WHERE fe.id = ?"));
     Q_ASSERT_X(qresult, "get feed", "failed to prepare database query");
@@ -989,6 +1590,16 @@ Feed *SQLiteStorage::getFeed(qint64 id)
 
 
 void SQLiteStorage::feedsRequested(const QJsonDocument &json)
+{
+    if (json.isEmpty() || json.isNull()) {
+        return;
+    }
+
+    feedsRequested(JsonDecoder::feedsFromJson(json));
+}
+
+
+void SQLiteStorage::feedsRequested(const FeedRecords &feeds, const QString &replyKey, const QByteArray &replyHash)
 {
     Q_D(SQLiteStorage);
 
@@ -999,19 +1610,38 @@ void SQLiteStorage::feedsRequested(const QJsonDocument &json)
         return;
     }
 
-    if (json.isEmpty() || json.isNull()) {
-        return;
-    }
-
     QSqlQuery q(d->db);
     bool qresult = true;
 
-    const QJsonArray feeds = json.object().value(QStringLiteral("feeds")).toArray();
-
     qDebug("Processing %i feeds requested from the remote server.", feeds.size());
 
-    QueryArgs qa;
-    const QList<Feed*> currentFeeds = getFeeds(qa);
+    // only IDs, titles and hashes of the local feeds are loaded, the fields are only read for feeds without hash
+    QHash<qint64, QString> currentTitles;
+    QHash<qint64, QString> currentHashes;
+    QSet<qint64> unhashedFeedIds;
+
+    q.setForwardOnly(true);
+    qresult = q.exec(QStringLiteral("SELECT id, title, hash FROM feeds"));
+    Q_ASSERT_X(qresult, "feeds requested", "failed to query current feeds from database");
+
+    while (q.next()) {
+        const qint64 id = q.value(0).toLongLong();
+        currentTitles.insert(id, q.value(1).toString());
+        if (q.value(2).isNull()) {
+            unhashedFeedIds.insert(id);
+        } else {
+            currentHashes.insert(id, q.value(2).toString());
+        }
+    }
+
+    if (!unhashedFeedIds.isEmpty()) {
+        qresult = q.exec(QStringLiteral("SELECT id, folderId, title, url, link, added, ordering, pinned, updateErrorCount, lastUpdateError, faviconLink FROM feeds WHERE hash IS NULL"));
+        Q_ASSERT_X(qresult, "feeds requested", "failed to query feeds without hash from database");
+
+        while (q.next()) {
+            currentHashes.insert(q.value(0).toLongLong(), SQLiteStoragePrivate::feedHash(q.value(1).toLongLong(), q.value(2).toString(), q.value(3).toString(), q.value(4).toString(), q.value(5).toUInt(), q.value(6).toInt(), q.value(7).toBool(), q.value(8).toInt(), q.value(9).toString(), q.value(10).toString()));
+        }
+    }
 
     IdList updatedFeedIds;
     QStringList updatedFeedNames;
@@ -1020,167 +1650,118 @@ void SQLiteStorage::feedsRequested(const QJsonDocument &json)
     IdList deletedFeedIds;
     QStringList deletedFeedNames;
 
-    if (feeds.isEmpty() && currentFeeds.isEmpty()) {
+    if (feeds.isEmpty() && currentTitles.isEmpty()) {
 
         qDebug("%s", "Nothing to do. Local feeds and remote feeds are empty.");
 
+        if (!replyHash.isEmpty()) {
+            setReplyHash(replyKey, replyHash);
+        }
+
         Q_EMIT requestedFeeds(updatedFeedIds, newFeedIds, deletedFeedIds);
         return;
 
-    } else if (feeds.isEmpty() && !currentFeeds.isEmpty()) {
+    } else if (feeds.isEmpty() && !currentTitles.isEmpty()) {
 
         qDebug("%s", "All feeds have been deleted on the server. Deleting local ones.");
 
-        deletedFeedIds.reserve(currentFeeds.size());
-        deletedFeedNames.reserve(currentFeeds.size());
-        for (Feed *f : currentFeeds) {
-            deletedFeedIds.push_back(f->id());
-            deletedFeedNames.push_back(f->title());
+        deletedFeedIds.reserve(currentTitles.size());
+        deletedFeedNames.reserve(currentTitles.size());
+        for (auto i = currentTitles.constBegin(); i != currentTitles.constEnd(); ++i) {
+            deletedFeedIds.push_back(i.key());
+            deletedFeedNames.push_back(i.value());
         }
 
         qresult = q.exec(QStringLiteral("DELETE FROM feeds"));
         Q_ASSERT_X(qresult, "feeds requested", "failed to delete all feeds from database");
 
-    } else if (!feeds.isEmpty() && currentFeeds.isEmpty()) {
+    } else {
 
-        qDebug("%s", "No local feeds. Adding all requested feeds as new feeds.");
+        qDebug("%s", "Checking for updated, new and deleted feeds.");
 
-        newFeedIds.reserve(feeds.size());
-        newFeedNames.reserve(feeds.size());
+        QSet<qint64> requestedFeedIds;
+        requestedFeedIds.reserve(feeds.size());
 
         qresult = d->db.transaction();
         Q_ASSERT_X(qresult, "feeds requested", "failed to start database transaction");
 
-        for (const QJsonValue &f : feeds) {
-            const QJsonObject o = f.toObject();
-            if (Q_LIKELY(!o.isEmpty())) {
-                const qlonglong feedId = o.value(QStringLiteral("id")).toVariant().toLongLong();
-                const QString feedTitle = o.value(QStringLiteral("title")).toString();
-                newFeedIds.push_back(feedId);
-                newFeedNames.push_back(feedTitle);
-
-                qresult = q.prepare(QStringLiteral("INSERT INTO feeds (id, folderId, title, url, link, added, ordering, pinned, updateErrorCount, lastUpdateError, faviconLink) "
-                                                   "VALUES (?,?,?,?,?,?,?,?,?,?,?)"
-                                                   ));
-                Q_ASSERT_X(qresult, "feeds requested", "failed to prepare to insert new feed into database");
-
-                q.addBindValue(feedId);
-                q.addBindValue(o.value(QStringLiteral("folderId")).toVariant().toLongLong());
-                q.addBindValue(feedTitle);
-                q.addBindValue(o.value(QStringLiteral("url")).toString());
-                q.addBindValue(o.value(QStringLiteral("link")).toString());
-                q.addBindValue(o.value(QStringLiteral("added")).toVariant().toUInt());
-                q.addBindValue(o.value(QStringLiteral("ordering")).toInt());
-                q.addBindValue(o.value(QStringLiteral("pinned")).toBool());
-                q.addBindValue(o.value(QStringLiteral("updateErrorCount")).toInt());
-                q.addBindValue(o.value(QStringLiteral("lastUpdateError")).toString());
-                q.addBindValue(o.value(QStringLiteral("faviconLink")).toString());
-
-                qresult = q.exec();
-                Q_ASSERT_X(qresult, "feeds requested", "failed to insert new feed into database");
-            }
-        }
-
-        qresult = d->db.commit();
-        Q_ASSERT_X(qresult, "feeds requested", "failed to commit database transaction");
-
+        for (const FeedRecord &f : feeds) {
+            const qint64 id = f.id;
+            const QString hash = SQLiteStoragePrivate::feedHash(f.folderId, f.title, f.url, f.link, f.added, f.ordering, f.pinned, f.updateErrorCount, f.lastUpdateError, f.faviconLink);
 
-    } else {
+            requestedFeedIds.insert(id);
 
+            if (!currentTitles.contains(id)) {
+                newFeedIds.push_back(id);
+                newFeedNames.push_back(f.title);
 
-        qDebug("%s", "Checking for updated, new and deleted feeds.");
+                qDebug("Adding new feed \"%s\" with ID %lli to the database.", qUtf8Printable(f.title), id);
 
-        QHash<qint64, Feed*> cfh; // current feeds hash
-        IdList requestedFeedIds;
+                qresult = q.prepare(QStringLiteral("INSERT INTO feeds (id, folderId, title, url, link, added, ordering, pinned, updateErrorCount, lastUpdateError, faviconLink, hash) "
+                                                   "VALUES (?,?,?,?,?,?,?,?,?,?,?,?)"
+                                                   ));
+                Q_ASSERT_X(qresult, "feeds requested", "failed to prepare inserting new feed into database");
 
-        for (Feed *f : currentFeeds) {
-            cfh.insert(f->id(), f);
-        }
+                q.addBindValue(id);
+                q.addBindValue(f.folderId);
+                q.addBindValue(f.title);
+                q.addBindValue(f.url);
+                q.addBindValue(f.link);
+                q.addBindValue(f.added);
+                q.addBindValue(static_cast<int>(f.ordering));
+                q.addBindValue(f.pinned);
+                q.addBindValue(f.updateErrorCount);
+                q.addBindValue(f.lastUpdateError);
+                q.addBindValue(f.faviconLink);
+                q.addBindValue(hash);
 
-        qresult = d->db.transaction();
-        Q_ASSERT_X(qresult, "feeds requested", "failed to start database transaction");
+                qresult = q.exec();
+                Q_ASSERT_X(qresult, "feeds requested", "failed to insert new feed into database");
 
-        for (const QJsonValue &f : feeds) {
-            const QJsonObject o = f.toObject();
-            if (Q_UNLIKELY(!o.isEmpty())) {
-                const qint64 id = o.value(QStringLiteral("id")).toVariant().toLongLong();
-                const QString title = o.value(QStringLiteral("title")).toString();
-                requestedFeedIds.push_back(id);
-
-                if (!cfh.contains(id)) {
-                    newFeedIds.push_back(id);
-                    newFeedNames.push_back(title);
-
-                    qDebug("Adding new feed \"%s\" with ID %lli to the database.", qUtf8Printable(o.value(QStringLiteral("title")).toString()), id);
-
-                    qresult = q.prepare(QStringLiteral("INSERT INTO feeds (id, folderId, title, url, link, added, ordering, pinned, updateErrorCount, lastUpdateError, faviconLink) "
-                                                       "VALUES (?,?,?,?,?,?,?,?,?,?,?)"
-                                                       ));
-                    Q_ASSERT_X(qresult, "feeds requested", "failed to prepare inserting new feed into database");
-
-                    q.addBindValue(id);
-                    q.addBindValue(o.value(QStringLiteral("folderId")).toVariant().toLongLong());
-                    q.addBindValue(title);
-                    q.addBindValue(o.value(QStringLiteral("url")).toString());
-                    q.addBindValue(o.value(QStringLiteral("link")).toString());
-                    q.addBindValue(o.value(QStringLiteral("added")).toVariant().toUInt());
-                    q.addBindValue(o.value(QStringLiteral("ordering")).toInt());
-                    q.addBindValue(o.value(QStringLiteral("pinned")).toBool());
-                    q.addBindValue(o.value(QStringLiteral("updateErrorCount")).toInt());
-                    q.addBindValue(o.value(QStringLiteral("lastUpdateError")).toString());
-                    q.addBindValue(o.value(QStringLiteral("faviconLink")).toString());
-
-                    qresult = q.exec();
-                    Q_ASSERT_X(qresult, "feeds requested", "failed to insert new feed into database");
+            } else if (currentHashes.value(id) != hash) {
 
-                } else {
+                qDebug("Updating feed \"%s\" with ID %lli in the database.", qUtf8Printable(f.title), id);
 
-                    const QUrl rFaviconLink = QUrl(o.value(QStringLiteral("faviconLink")).toString());
-                    const qint64 rFolderId = o.value(QStringLiteral("folderId")).toVariant().toLongLong();
-                    const Feed::FeedOrdering rOrdering = (Feed::FeedOrdering)o.value(QStringLiteral("ordering")).toInt();
-                    const QUrl rLink = QUrl(o.value(QStringLiteral("link")).toString());
-                    const bool rPinned = o.value(QStringLiteral("pinned")).toBool();
-                    const uint rUpdateErrorCount = o.value(QStringLiteral("updateErrorCount")).toInt();
-                    const QString rLastUpdateError = o.value(QStringLiteral("lastUpdateError")).toString();
+                updatedFeedIds.push_back(id);
+                updatedFeedNames.push_back(f.title);
 
-                    Feed *f = cfh.value(id);
+                qresult = q.prepare(QStringLiteral("UPDATE feeds SET folderId = ?, title = ?, url = ?, link = ?, added = ?, ordering = ?, pinned = ?, updateErrorCount = ?, lastUpdateError = ?, faviconLink = ?, hash = ? WHERE id = ?"));
+                Q_ASSERT_X(qresult, "feeds requested", "failed to prepare updating feed in database");
 
-                    if ((f->title() != title) || (f->faviconLink() != rFaviconLink) || (f->folderId() != rFolderId) || (f->ordering() != rOrdering) || (f->link() != rLink) || (f->pinned() != rPinned) || (f->updateErrorCount() != rUpdateErrorCount) || (f->lastUpdateError() != rLastUpdateError)) {
+                q.addBindValue(f.folderId);
+                q.addBindValue(f.title);
+                q.addBindValue(f.url);
+                q.addBindValue(f.link);
+                q.addBindValue(f.added);
+                q.addBindValue(static_cast<int>(f.ordering));
+                q.addBindValue(f.pinned);
+                q.addBindValue(f.updateErrorCount);
+                q.addBindValue(f.lastUpdateError);
+                q.addBindValue(f.faviconLink);
+                q.addBindValue(hash);
+                q.addBindValue(id);
 
-                        qDebug("Updating feed \"%s\" with ID %lli in the database.", qUtf8Printable(f->title()), id);
+                qresult = q.exec();
+                Q_ASSERT_X(qresult, "feeds requested", "failed to update feed in database");
 
-                        updatedFeedIds.push_back(id);
-                        updatedFeedNames.push_back(title);
+            } else if (unhashedFeedIds.contains(id)) {
 
-                        qresult = q.prepare(QStringLiteral("UPDATE feeds SET folderId = ?, title = ?, link = ?, ordering = ?, pinned = ?, updateErrorCount = ?, lastUpdateError = ?, faviconLink = ? WHERE id = ?"));
-                        Q_ASSERT_X(qresult, "feeds requested", "failed to prepare updating feed in database");
+                qresult = q.prepare(QStringLiteral("UPDATE feeds SET hash = ? WHERE id = ?"));
+                Q_ASSERT_X(qresult, "feeds requested", "failed to prepare storing feed hash in database");
 
-                        q.addBindValue(rFolderId);
-                        q.addBindValue(title);
-                        q.addBindValue(rLink.toString());
-                        q.addBindValue((int)rOrdering);
-                        q.addBindValue(rPinned);
-                        q.addBindValue(rUpdateErrorCount);
-                        q.addBindValue(rLastUpdateError);
-                        q.addBindValue(rFaviconLink.toString());
-                        q.addBindValue(id);
+                q.addBindValue(hash);
+                q.addBindValue(id);
 
-                        qresult = q.exec();
-                        Q_ASSERT_X(qresult, "feeds requested", "failed to update feed in database");
-                    }
-                }
+                qresult = q.exec();
+                Q_ASSERT_X(qresult, "feeds requested", "failed to store feed hash in database");
             }
         }
 
-
-
-        QHash<qint64, Feed*>::const_iterator i = cfh.constBegin();
-        while (i != cfh.constEnd()) {
+        for (auto i = currentTitles.constBegin(); i != currentTitles.constEnd(); ++i) {
             if (!requestedFeedIds.contains(i.key())) {
                 deletedFeedIds.push_back(i.key());
-                deletedFeedNames.push_back(i.value()->title());
+                deletedFeedNames.push_back(i.value());
             }
-            ++i;
         }
 
         if (!deletedFeedIds.isEmpty()) {
@@ -1199,12 +1780,8 @@ void SQLiteStorage::feedsRequested(const QJsonDocument &json)
 
         qresult = d->db.commit();
         Q_ASSERT_X(qresult, "feeds requested", "failed to commit changes to database");
-
-        cfh.clear();
     }
 
-    qDeleteAll(currentFeeds);
-
     q.setForwardOnly(true);
     qresult = q.exec(QStringLiteral("SELECT id FROM folders"));
     Q_ASSERT(qresult);
@@ -1243,6 +1820,10 @@ void SQLiteStorage::feedsRequested(const QJsonDocument &json)
         }
     }
 
+    if (!replyHash.isEmpty()) {
+        setReplyHash(replyKey, replyHash);
+    }
+
     Q_EMIT requestedFeeds(updatedFeedIds, newFeedIds, deletedFeedIds);
 }
 
@@ -1411,7 +1992,7 @@ void SQLiteStorage::feedMoved(qint64 id, qint64 targetFolder)
     Q_ASSERT(qresult);
     const qint64 oldFolderId = q.value(0).value<qint64>();
 
-    qresult = q.prepare(QStringLiteral("UPDATE feeds SET folderId = ? WHERE id = ?"));
+    qresult = q.prepare(QStringLiteral("UPDATE feeds SET folderId = ?, hash = NULL WHERE id = ?"));
     Q_ASSERT_X(qresult, "feed moved", "failed to prepare database query");
 
     q.addBindValue(targetFolder);
@@ -1497,7 +2078,7 @@ void SQLiteStorage::feedRenamed(qint64 id, const QString &newTitle)
     Q_ASSERT_X(qresult, "feed renamed", "failed to query old feed title");
     const QString oldTitle = q.value(0).toString();
 
-    qresult = q.prepare(QStringLiteral("UPDATE feeds SET title = ? WHERE id = ?"));
+    qresult = q.prepare(QStringLiteral("UPDATE feeds SET title = ?, hash = NULL WHERE id = ?"));
     Q_ASSERT_X(qresult, "feed renamed", "failed to prepare database query");
 
     q.addBindValue(newTitle);
@@ -1606,45 +2187,37 @@ Article *SQLiteStorage::getArticle(qint64 id, int bodyLimit)
 
     Q_D(SQLiteStorage);
 
-    QSqlQuery q(d->db);
-
-    bool qresult = q.prepare(QStringLiteral("SELECT it.id, it.feedId, fe.title, it.guid, it.guidHash, it.url, it.title, it.author, it.pubDate, it.body, it.enclosureMime, it.enclosureLink, it.unread, it.starred, it.lastModified, it.fingerprint, fo.id, fo.name, it.queue FROM items it LEFT JOIN feeds fe ON fe.id = it.feedId LEFT JOIN folders fo on fo.id = fe.folderId WHERE it.id = ?"));
-    Q_ASSERT_X(qresult, "get article", "failed to prepare database query");
-
-    q.addBindValue(id);
-
-    qresult = q.exec();
-    Q_ASSERT_X(qresult, "get article", "failed to execute database query");
+    SQLiteStoragePrivate::ArticleData data;
 
-    QString body;
+    if (Q_LIKELY(d->articleData(id, data))) {
 
-    if (bodyLimit == 0) {
-        body = q.value(9).toString();
-    } else if (bodyLimit > 0) {
-        body = limitBody(q.value(9).toString(), bodyLimit);
-    }
+        QString body;
 
+        if (bodyLimit == 0) {
+            body = data.body;
+        } else if (bodyLimit > 0) {
+            body = limitBody(data.body, bodyLimit);
+        }
 
-    if (Q_LIKELY(q.next())) {
-        Article *a = new Article(q.value(0).toLongLong(),
-                                 q.value(1).toLongLong(),
-                                 q.value(2).toString(),
-                                 q.value(3).toString(),
-                                 q.value(4).toString(),
-                                 QUrl(q.value(5).toString()),
-                                 q.value(6).toString(),
-                                 q.value(7).toString(),
-                                 QDateTime::fromTime_t(q.value(8).toUInt()),
+        Article *a = new Article(data.id,
+                                 data.feedId,
+                                 data.feedTitle,
+                                 data.guid,
+                                 data.guidHash,
+                                 data.url,
+                                 data.title,
+                                 data.author,
+                                 QDateTime::fromTime_t(data.pubDate),
                                  body,
-                                 q.value(10).toString(),
-                                 QUrl(q.value(11).toString()),
-                                 q.value(12).toBool(),
-                                 q.value(13).toBool(),
-                                 QDateTime::fromTime_t(q.value(14).toUInt()),
-                                 q.value(15).toString(),
-                                 q.value(16).toLongLong(),
-                                 q.value(17).toString(),
-                                 FuotenEnums::QueueActions(q.value(18).toInt())
+                                 data.enclosureMime,
+                                 data.enclosureLink,
+                                 data.unread,
+                                 data.starred,
+                                 QDateTime::fromTime_t(data.lastModified),
+                                 data.fingerprint,
+                                 data.folderId,
+                                 data.folderName,
+                                 FuotenEnums::QueueActions(data.queue)
                                  );
         return a;
 
@@ -1751,7 +2324,7 @@ QList<Article*> SQLiteStorage::getArticles(const QueryArgs &args)
 
     qDebug("Start to query articles from the local SQLite database using the following query: %s", qUtf8Printable(qs));
 
-    QSqlQuery q(d->db);
+    QSqlQuery q(d->connection());
     q.setForwardOnly(true);
 
     bool qresult = q.exec(qs);
@@ -1800,194 +2373,145 @@ QList<Article*> SQLiteStorage::getArticles(const QueryArgs &args)
 
 
 
-GetArticlesAsyncWorker::GetArticlesAsyncWorker(const QString &dbpath, const QueryArgs &args, QObject *parent) :
-    QThread(parent), m_args(args)
+void SQLiteStorage::getArticlesAsync(const QueryArgs &args)
 {
-    if (!QSqlDatabase::connectionNames().contains(QStringLiteral("fuotendb"))) {
-        m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("fuotendb"));
-        m_db.setDatabaseName(dbpath);
-    } else {
-        m_db = QSqlDatabase::database(QStringLiteral("fuotendb"));
+    if (!ready()) {
+        qWarning("SQLite database not ready. Can not query articles from database.");
+        Q_EMIT gotArticlesAsync(QList<Article*>());
+        return;
     }
-}
 
+    Q_D(SQLiteStorage);
 
+    d->queryPool.start(new SQLiteQueryWorker(d->db.databaseName(), [this, args] () {
+        Q_EMIT gotArticlesAsync(getArticles(args));
+    }));
+}
 
-void GetArticlesAsyncWorker::run()
-{
-    QList<Article*> articles;
-
-    QSqlQuery q(m_db);
-
-    bool qresult = q.exec(QStringLiteral("PRAGMA foreign_keys = ON"));
-    Q_ASSERT_X(qresult, "get articles async", "failed to enable foreign keys support");
-
-    QString qs = QStringLiteral("SELECT it.id, it.feedId, fe.title, it.guid, it.guidHash, it.url, it.title, it.author, it.pubDate, it.body, it.enclosureMime, it.enclosureLink, it.unread, it.starred, it.lastModified, it.fingerprint, fo.id, fo.name, it.queue FROM items it LEFT JOIN feeds fe ON fe.id = it.feedId LEFT JOIN folders fo on fo.id = fe.folderId");
-
-    if (!m_args.inIds.isEmpty() || m_args.unreadOnly || m_args.starredOnly || (m_args.parentId > -1) || m_args.queuedOnly) {
-        qs.append(QLatin1String(" WHERE"));
-    }
 
-    if (m_args.parentId > -1) {
-        if (m_args.parentIdType == FuotenEnums::Feed) {
-            qs.append(QStringLiteral(" it.feedId = %1").arg(QString::number(m_args.parentId)));
-        } else {
-            qs.append(QStringLiteral(" it.feedId IN (SELECT id FROM feeds WHERE folderId = %1)").arg(m_args.parentId));
-        }
+QFuture<ArticleList> SQLiteStorage::getArticlesFuture(const QueryArgs &args)
+{
+    if (!ready()) {
+        qWarning("SQLite database not ready. Can not query articles from database.");
+        return finishedFuture(ArticleList());
     }
 
-    if (!m_args.inIds.isEmpty()) {
-        if (m_args.parentId > -1) {
-            qs.append(QLatin1String(" AND"));
-        }
+    Q_D(SQLiteStorage);
 
-        QString idListString;
-        if (m_args.inIds.count() == 1) {
-            idListString = QString::number(m_args.inIds.first());
-        } else {
-            const IdList ids = m_args.inIds;
-            QStringList sl;
-            sl.reserve(ids.size());
-            for (qint64 id : ids) {
-                sl.append(QString::number(id));
-            }
-            idListString = sl.join(QChar(','));
-        }
+    return runQuery<ArticleList>(d, [this, args] () {
+        const ArticleList articles = getArticles(args);
+        moveResultToThread(articles, thread());
+        return articles;
+    });
+}
 
 
-        switch(m_args.inIdsType) {
-        case FuotenEnums::Folder:
-            qs.append(QStringLiteral(" it.feedId IN (SELECT id FROM feeds WHERE folderId IN (%1))").arg(idListString));
-            break;
-        case FuotenEnums::Feed:
-            qs.append(QStringLiteral(" it.feedId IN (%1)").arg(idListString));
-            break;
-        default:
-            qs.append(QStringLiteral(" it.id IN (%1)").arg(idListString));
-            break;
-        }
-    }
 
-    if (m_args.unreadOnly) {
-        if ((m_args.parentId > -1) || !m_args.inIds.isEmpty()) {
-            qs.append(QLatin1String(" AND"));
-        }
-        qs.append(QLatin1String(" it.unread = 1"));
+QFuture<qint64> SQLiteStorage::getNewestItemIdAsync(FuotenEnums::Type type, qint64 id)
+{
+    // errors have to be reported from the thread of the storage
+    if (!ready() || (((type == FuotenEnums::Folder) || (type == FuotenEnums::Feed)) && (id <= 0))) {
+        return finishedFuture(getNewestItemId(type, id));
     }
 
-    if (m_args.starredOnly) {
-        if ((m_args.parentId > -1) || !m_args.inIds.isEmpty() || m_args.unreadOnly) {
-            qs.append(QLatin1String(" AND"));
-        }
-        qs.append(QLatin1String(" it.starred = 1"));
-    }
+    Q_D(SQLiteStorage);
 
-    if (m_args.queuedOnly) {
-        if ((m_args.parentId > -1) || !m_args.inIds.isEmpty() || m_args.unreadOnly || m_args.starredOnly) {
-            qs.append(QLatin1String(" AND"));
-        }
-        qs.append(QStringLiteral(" it.queue > 0"));
-    }
+    return runQuery<qint64>(d, [this, type, id] () {
+        return getNewestItemId(type, id);
+    });
+}
 
-    switch(m_args.sortingRole) {
-    case FuotenEnums::Time:
-        qs.append(QLatin1String(" ORDER BY it.pubDate"));
-        break;
-    case FuotenEnums::ID:
-        qs.append(QLatin1String(" ORDER BY it.id"));
-        break;
-    case FuotenEnums::Name:
-        qs.append(QLatin1String(" ORDER BY it.title"));
-        break;
-    case FuotenEnums::FolderName:
-        qs.append(QLatin1String(" ORDER BY fo.name"));
-        break;
-    default:
-        qs.append(QLatin1String(" ORDER BY it.pubDate"));
-        break;
-    }
 
-    if (m_args.sortOrder== Qt::AscendingOrder) {
-        qs.append(QLatin1String(" ASC"));
-    } else {
-        qs.append(QLatin1String(" DESC"));
-    }
 
-    if (m_args.limit > 0) {
-        qs.append(QLatin1String(" LIMIT ")).append(QString::number(m_args.limit));
+QFuture<QList<Folder*>> SQLiteStorage::getFoldersAsync(FuotenEnums::SortingRole sortingRole, Qt::SortOrder sortOrder, const IdList &ids, FuotenEnums::Type idType, int limit)
+{
+    if (!ready()) {
+        return finishedFuture(getFolders(sortingRole, sortOrder, ids, idType, limit));
     }
 
-    qDebug("Start to query articles fromt the local SQLite database using the following query: %s", qUtf8Printable(qs));
-
-    q.setForwardOnly(true);
-    qresult = q.exec(qs);
-    Q_ASSERT_X(qresult, "get articles async", "failed to execute database query");
-
-    while (q.next()) {
-        QString body;
+    Q_D(SQLiteStorage);
 
-        if (m_args.bodyLimit > -1) {
+    return runQuery<QList<Folder*>>(d, [this, sortingRole, sortOrder, ids, idType, limit] () {
+        const QList<Folder*> folders = getFolders(sortingRole, sortOrder, ids, idType, limit);
+        moveResultToThread(folders, thread());
+        return folders;
+    });
+}
 
-            body = q.value(9).toString();
 
-            if (m_args.bodyLimit > 0) {
 
-                body.replace(QRegularExpression(QStringLiteral("<[^>]*>")), QStringLiteral(" "));
-                body = body.simplified();
-                body = body.left(m_args.bodyLimit);
-            }
+QFuture<QList<Feed*>> SQLiteStorage::getFeedsAsync(const QueryArgs &args)
+{
+    if (!ready()) {
+        return finishedFuture(getFeeds(args));
+    }
 
-        }
+    Q_D(SQLiteStorage);
 
-        articles.append(new Article(q.value(0).toLongLong(),
-                                 q.value(1).toLongLong(),
-                                 q.value(2).toString(),
-                                 q.value(3).toString(),
-                                 q.value(4).toString(),
-                                 QUrl(q.value(5).toString()),
-                                 q.value(6).toString(),
-                                 q.value(7).toString(),
-                                 QDateTime::fromTime_t(q.value(8).toUInt()),
-                                 body,
-                                 q.value(10).toString(),
-                                 QUrl(q.value(11).toString()),
-                                 q.value(12).toBool(),
-                                 q.value(13).toBool(),
-                                 QDateTime::fromTime_t(q.value(14).toUInt()),
-                                 q.value(15).toString(),
-                                 q.value(16).toLongLong(),
-                                 q.value(17).toString(),
-                                 FuotenEnums::QueueActions(q.value(18).toInt())
-                                 ));
+    return runQuery<QList<Feed*>>(d, [this, args] () {
+        const QList<Feed*> feeds = getFeeds(args);
+        moveResultToThread(feeds, thread());
+        return feeds;
+    });
+}
+
+
+
+QFuture<Feed*> SQLiteStorage::getFeedAsync(qint64 id)
+{
+    if (!ready()) {
+        return finishedFuture(getFeed(id));
     }
 
-    Q_EMIT gotArticles(articles);
+    Q_D(SQLiteStorage);
+
+    return runQuery<Feed*>(d, [this, id] () {
+        Feed *f = getFeed(id);
+        if (f) {
+            f->moveToThread(thread());
+        }
+        return f;
+    });
 }
 
 
 
-void SQLiteStorage::getArticlesAsync(const QueryArgs &args)
+QFuture<Article*> SQLiteStorage::getArticleAsync(qint64 id, int bodyLimit)
 {
     if (!ready()) {
-        qWarning("SQLite database not ready. Can not query articles from database.");
-        Q_EMIT gotArticlesAsync(QList<Article*>());
-        return;
+        return finishedFuture(getArticle(id, bodyLimit));
     }
 
     Q_D(SQLiteStorage);
 
-    GetArticlesAsyncWorker *worker = new GetArticlesAsyncWorker(d->db.databaseName(), args, this);
-    connect(worker, &GetArticlesAsyncWorker::gotArticles, this, &AbstractStorage::gotArticlesAsync);
-    connect(worker, &GetArticlesAsyncWorker::failed, this, [=] (Error *e) {setError(e);});
-    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
-    worker->start();
+    return runQuery<Article*>(d, [this, id, bodyLimit] () {
+        Article *a = getArticle(id, bodyLimit);
+        if (a) {
+            a->moveToThread(thread());
+        }
+        return a;
+    });
+}
+
+
+
+QFuture<QString> SQLiteStorage::getArticleBodyAsync(qint64 id)
+{
+    if (!ready()) {
+        return finishedFuture(getArticleBody(id));
+    }
+
+    Q_D(SQLiteStorage);
 
+    return runQuery<QString>(d, [this, id] () {
+        return getArticleBody(id);
+    });
 }
 
 
 
-ItemsRequestedWorker::ItemsRequestedWorker(const QString &dbpath, const QJsonDocument &json, AbstractConfiguration *config, AbstractNotificator *notificator, QObject *parent) :
-    QThread(parent), m_json(json), m_config(config), m_notificator(notificator)
+ItemsRequestedWorker::ItemsRequestedWorker(const QString &dbpath, const ItemsWriteBatch &batch, AbstractConfiguration *config, AbstractNotificator *notificator, QObject *parent) :
+    QThread(parent), m_batch(batch), m_config(config), m_notificator(notificator)
 {
     if (!QSqlDatabase::connectionNames().contains(QStringLiteral("fuotendb"))) {
         m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("fuotendb"));
@@ -2001,284 +2525,339 @@ ItemsRequestedWorker::ItemsRequestedWorker(const QString &dbpath, const QJsonDoc
 
 void ItemsRequestedWorker::run()
 {
+    TraceSpan span("storage", "ItemsRequestedWorker");
+
     QSqlQuery q(m_db);
 
     bool qresult = q.exec(QStringLiteral("PRAGMA foreign_keys = ON"));
     Q_ASSERT_X(qresult, "items requested worker", "failed to enable foreign keys support");
     q.setForwardOnly(true);
 
-    const QJsonArray items = m_json.object().value(QStringLiteral("items")).toArray();
-
     IdList updatedItemIds;
     IdList newItemIds;
     IdList removedItemIds;
 
+    if (m_batch.finish) {
+
+        qDebug("%s", "Finishing deferred maintenance of requested items.");
+
+        IdList feedIds;
+        qresult = q.exec(QStringLiteral("SELECT id FROM feeds"));
+        Q_ASSERT(qresult);
+        while (q.next()) {
+            feedIds.push_back(q.value(0).value<qint64>());
+        }
+
+        removeOldItems(feedIds, removedItemIds);
+        updateCounters(IdList());
+
+        Q_EMIT requestedItems(updatedItemIds, newItemIds, removedItemIds);
+        return;
+    }
+
+    if (!m_batch.json.isNull()) {
+        m_batch.items = JsonDecoder::itemsFromJson(m_batch.json);
+        m_batch.json = QJsonDocument();
+    }
+
+    const ItemRecords &items = m_batch.items;
+    span.setArg(QStringLiteral("items"), items.size());
+
     if (items.isEmpty()) {
         Q_EMIT requestedItems(updatedItemIds, newItemIds, removedItemIds);
         qDebug("%s", "Nothing to do. No Items.");
         return;
     }
 
-    QHash<qint64, uint> currentItems; // contains the ids and last modified time stamps of the local items
+    IdList pageItemIds;
+    pageItemIds.reserve(items.size());
+    QSet<qint64> pageFeedIdSet;
+    for (const ItemRecord &i : items) {
+        pageItemIds.push_back(i.id);
+        pageFeedIdSet.insert(i.feedId);
+    }
+    const IdList pageFeedIds = pageFeedIdSet.toList();
+
+    QHash<qint64, uint> currentItems; // contains the ids and last modified time stamps of the local items of this page
 
-    qresult = q.exec(QStringLiteral("SELECT id, lastModified FROM items"));
+    qresult = q.exec(QStringLiteral("SELECT id, lastModified FROM items WHERE id IN (%1)").arg(SQLiteStoragePrivate::intListToString(pageItemIds)));
     Q_ASSERT_X(qresult, "items requested worker", "failed to query current items from database");
 
     while(q.next()) {
         currentItems.insert(q.value(0).toLongLong(), q.value(1).toUInt());
     }
 
+    QVector<QJsonObject> articlesToPublish;
+    const bool publishArticles = (m_notificator && m_notificator->isArticlePublishingEnabled());
+
     QHash<qint64,QString> feedsIdTitleMap;
-    qresult = q.exec(QStringLiteral("SELECT id, title FROM feeds"));
-    Q_ASSERT(qresult);
+    if (publishArticles) {
+        qresult = q.exec(QStringLiteral("SELECT id, title FROM feeds WHERE id IN (%1)").arg(SQLiteStoragePrivate::intListToString(pageFeedIds)));
+        Q_ASSERT(qresult);
 
-    while(q.next()) {
-        feedsIdTitleMap.insert(q.value(0).value<qint64>(), q.value(1).toString());
+        while(q.next()) {
+            feedsIdTitleMap.insert(q.value(0).value<qint64>(), q.value(1).toString());
+        }
     }
 
 
+    TraceSpan transaction("storage", "store items transaction");
     qresult = m_db.transaction();
     Q_ASSERT_X(qresult, "items requested worker", "failed to start database transaction");
 
     quint32 newUnreadItems = 0;
 
-    QVector<QJsonObject> articlesToPublish;
-    const bool publishArticles = (m_notificator && m_notificator->isArticlePublishingEnabled());
+    // the statements are prepared once and only get new values bound for every item
+    QSqlQuery updateQuery(m_db);
+    qresult = updateQuery.prepare(QStringLiteral("UPDATE items SET "
+                                                 "title = ?, "
+                                                 "url = ?, "
+                                                 "author = ?, "
+                                                 "pubDate = ?, "
+                                                 "enclosureMime = ?, "
+                                                 "enclosureLink = ?, "
+                                                 "unread = ?, "
+                                                 "starred = ?, "
+                                                 "lastModified = ?,"
+                                                 "fingerprint = ?, "
+                                                 "queue = 0 "
+                                                 "WHERE id = ?"
+                                                 ));
+    Q_ASSERT_X(qresult, "items requested worker", "failed to prepare update of item into database");
+
+    QSqlQuery insertQuery(m_db);
+    qresult = insertQuery.prepare(QStringLiteral("INSERT INTO items (id, feedId, guid, guidHash, url, title, author, pubDate, body, enclosureMime, enclosureLink, unread, starred, lastModified, fingerprint) "
+                                                 "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+                                                 ));
+    Q_ASSERT_X(qresult, "items requested worker", "failed to prepare insertion of new item into database");
+
+    for (const ItemRecord &i : items) {
+
+        if (!currentItems.isEmpty() && currentItems.contains(i.id)) {
+
+            if (currentItems.value(i.id) < i.lastModified) {
+
+                updatedItemIds.append(i.id);
+
+                qDebug("Updating the article \"%s\" with ID %lli in the database.", qUtf8Printable(i.title), i.id);
+
+                updateQuery.addBindValue(i.title);
+                updateQuery.addBindValue(i.url);
+                updateQuery.addBindValue(i.author);
+                updateQuery.addBindValue(i.pubDate);
+                updateQuery.addBindValue(i.enclosureMime);
+                updateQuery.addBindValue(i.enclosureLink);
+                updateQuery.addBindValue(i.unread);
+                updateQuery.addBindValue(i.starred);
+                updateQuery.addBindValue(i.lastModified);
+                updateQuery.addBindValue(i.fingerprint);
+                updateQuery.addBindValue(i.id);
+
+                qresult = updateQuery.exec();
+                Q_ASSERT_X(qresult, "items requested worker", "failed to update item in databae");
+            }
 
-    for (const QJsonValue &i : items) {
-        const QJsonObject o = i.toObject();
-        if (Q_LIKELY(!o.isEmpty())) {
-            qint64 id = o.value(QStringLiteral("id")).toVariant().toLongLong();
-
-            if (!currentItems.isEmpty() && currentItems.contains(id)) {
-
-                uint lastMod = o.value(QStringLiteral("lastModified")).toInt();
-
-                if (currentItems.value(id) < lastMod) {
-
-                    updatedItemIds.append(id);
-
-
-                    qDebug("Updating the article \"%s\" with ID %lli in the database.", qUtf8Printable(o.value(QStringLiteral("title")).toString()), id);
-
-                    qresult = q.prepare(QStringLiteral("UPDATE items SET "
-                                                       "title = ?, "
-                                                       "url = ?, "
-                                                       "author = ?, "
-                                                       "pubDate = ?, "
-                                                       "enclosureMime = ?, "
-                                                       "enclosureLink = ?, "
-                                                       "unread = ?, "
-                                                       "starred = ?, "
-                                                       "lastModified = ?,"
-                                                       "fingerprint = ?, "
-                                                       "queue = 0 "
-                                                       "WHERE id = ?"
-                                                       ));
-                    Q_ASSERT_X(qresult, "items requested worker", "failed to prepare update of item into database");
-
-                    q.addBindValue(o.value(QStringLiteral("title")).toString());
-                    q.addBindValue(o.value(QStringLiteral("url")).toString());
-                    q.addBindValue(o.value(QStringLiteral("author")).toString());
-                    q.addBindValue(o.value(QStringLiteral("pubDate")).toInt());
-                    q.addBindValue(o.value(QStringLiteral("enclosureMime")).toString());
-                    q.addBindValue(o.value(QStringLiteral("enclosureLink")).toString());
-                    q.addBindValue(o.value(QStringLiteral("unread")).toBool());
-                    q.addBindValue(o.value(QStringLiteral("starred")).toBool());
-                    q.addBindValue(lastMod);
-                    q.addBindValue(o.value(QStringLiteral("fingerprint")).toString());
-                    q.addBindValue(id);
-
-                    qresult = q.exec();
-                    Q_ASSERT_X(qresult, "items requested worker", "failed to update item in databae");
-                }
+        } else {
 
-            } else {
+            newItemIds.append(i.id);
+            if (i.unread) {
+                newUnreadItems++;
+            }
 
-                newItemIds.append(id);
-                const bool unread = o.value(QStringLiteral("unread")).toBool();
-                if (unread) {
-                    newUnreadItems++;
+            qDebug("Adding new article \"%s\" with ID %lli to the database.", qUtf8Printable(i.title), i.id);
+
+            insertQuery.addBindValue(i.id);
+            insertQuery.addBindValue(i.feedId);
+            insertQuery.addBindValue(i.guid);
+            insertQuery.addBindValue(i.guidHash);
+            insertQuery.addBindValue(i.url);
+            insertQuery.addBindValue(i.title);
+            insertQuery.addBindValue(i.author);
+            insertQuery.addBindValue(i.pubDate);
+            insertQuery.addBindValue(i.body);
+            insertQuery.addBindValue(i.enclosureMime);
+            insertQuery.addBindValue(i.enclosureLink);
+            insertQuery.addBindValue(i.unread);
+            insertQuery.addBindValue(i.starred);
+            insertQuery.addBindValue(i.lastModified);
+            insertQuery.addBindValue(i.fingerprint);
+
+            qresult = insertQuery.exec();
+            Q_ASSERT_X(qresult, "items requested worker", "failed to execute insertion of new item into database");
+
+            if (publishArticles && i.unread) {
+                const QJsonObject o = JsonDecoder::itemToJson(i);
+                if (m_notificator->checkForPublishing(o)) {
+                    articlesToPublish.push_back(o);
                 }
+            }
+        }
+    }
 
-                qDebug("Adding new article \"%s\" with ID %lli to the database.", qUtf8Printable(o.value(QStringLiteral("title")).toString()), id);
+    updateQuery.finish();
+    insertQuery.finish();
 
-                qresult = q.prepare(QStringLiteral("INSERT INTO items (id, feedId, guid, guidHash, url, title, author, pubDate, body, enclosureMime, enclosureLink, unread, starred, lastModified, fingerprint) "
-                                                   "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
-                                                   ));
-                Q_ASSERT_X(qresult, "items requested worker", "failed to prepare insertion of new item into database");
+    qresult = m_db.commit();
+    Q_ASSERT_X(qresult, "items requested worker", "failed to commit database transaction");
+    transaction.end();
 
-                q.addBindValue(id);
-                q.addBindValue(o.value(QStringLiteral("feedId")).toVariant().toLongLong());
-                q.addBindValue(o.value(QStringLiteral("guid")).toString());
-                q.addBindValue(o.value(QStringLiteral("guidHash")).toString());
-                q.addBindValue(o.value(QStringLiteral("url")).toString());
-                q.addBindValue(o.value(QStringLiteral("title")).toString());
-                q.addBindValue(o.value(QStringLiteral("author")).toString());
-                q.addBindValue(o.value(QStringLiteral("pubDate")).toInt());
-                q.addBindValue(o.value(QStringLiteral("body")).toString());
-                q.addBindValue(o.value(QStringLiteral("enclosureMime")).toString());
-                q.addBindValue(o.value(QStringLiteral("enclosureLink")).toString());
-                q.addBindValue(unread);
-                q.addBindValue(o.value(QStringLiteral("starred")).toBool());
-                q.addBindValue(o.value(QStringLiteral("lastModified")).toInt());
-                q.addBindValue(o.value(QStringLiteral("fingerprint")).toString());
+    if (!m_batch.deferred) {
+        removeOldItems(pageFeedIds, removedItemIds);
+        updateCounters(pageFeedIds);
+    }
 
-                qresult = q.exec();
-                Q_ASSERT_X(qresult, "items requested worker", "failed to execute insertion of new item into database");
+    Q_EMIT requestedItems(updatedItemIds, newItemIds, removedItemIds);
 
-                if (publishArticles && unread) {
-                    if (m_notificator->checkForPublishing(o)) {
-                        articlesToPublish.push_back(o);
-                    }
-                }
+    if (publishArticles && !articlesToPublish.empty()) {
+        for (auto i = articlesToPublish.constBegin(); i != articlesToPublish.constEnd(); ++i) {
+            const QJsonObject o = *i;
+            if (!removedItemIds.contains(o.value(QStringLiteral("id")).toVariant().value<qint64>())) {
+                m_notificator->publishArticle(o, feedsIdTitleMap.value(o.value(QStringLiteral("feedId")).toVariant().value<qint64>()));
             }
         }
     }
 
-    qresult = m_db.commit();
-    Q_ASSERT_X(qresult, "items requested worker", "failed to commit database transaction");
+    if (m_notificator && (newUnreadItems > 0)) {
+        m_notificator->notify(AbstractNotificator::ItemsRequested, QtInfoMsg, newUnreadItems);
+    }
+}
 
-    const IdList feedIds = feedsIdTitleMap.keys();
 
-    // cleaning feeds by deleting items over threshold
-    // but check for valid configuration object first
 
-    if (Q_LIKELY(m_config)) {
 
-        if (Q_LIKELY(!feedIds.isEmpty())) {
+/*
+ * Removes the items of the feeds identified by feedIds according to their
+ * deletion strategy and appends the IDs of the removed items to removedItemIds.
+ */
+void ItemsRequestedWorker::removeOldItems(const IdList &feedIds, IdList &removedItemIds)
+{
+    // check for valid configuration object first
+    if (Q_UNLIKELY(!m_config) || feedIds.isEmpty()) {
+        return;
+    }
 
-            IdList iIds; // item IDs
-            for (qint64 fId : feedIds) {
+    QSqlQuery q(m_db);
+    q.setForwardOnly(true);
+    bool qresult = false;
 
-                const FuotenEnums::ItemDeletionStrategy delStrat = m_config->getPerFeedDeletionStrategy(fId);
-                const quint16 delVal = m_config->getPerFeedDeletionValue(fId);
+    IdList iIds; // item IDs
+    for (qint64 fId : feedIds) {
 
-                if ((delStrat != FuotenEnums::NoItemDeletion) && (delVal > 0)) {
+        const FuotenEnums::ItemDeletionStrategy delStrat = m_config->getPerFeedDeletionStrategy(fId);
+        const quint16 delVal = m_config->getPerFeedDeletionValue(fId);
 
-                    if (delStrat == FuotenEnums::DeleteItemsByCount) {
+        if ((delStrat != FuotenEnums::NoItemDeletion) && (delVal > 0)) {
 
-                        qresult = q.prepare(QStringLiteral("SELECT id FROM items WHERE feedId = ? AND starred = 0 ORDER BY id DESC"));
-                        Q_ASSERT_X(qresult, "items requested worker", "failed to preparey querying item IDs from database");
+            if (delStrat == FuotenEnums::DeleteItemsByCount) {
 
-                        q.addBindValue(fId);
+                qresult = q.prepare(QStringLiteral("SELECT id FROM items WHERE feedId = ? AND starred = 0 ORDER BY id DESC"));
+                Q_ASSERT_X(qresult, "items requested worker", "failed to preparey querying item IDs from database");
 
-                        qresult = q.exec();
-                        Q_ASSERT_X(qresult, "items requested worker", "failed to execute querying item IDs from database");
+                q.addBindValue(fId);
 
-                        iIds.clear();
-                        while (q.next()) {
-                            iIds.append(q.value(0).toLongLong());
-                        }
+                qresult = q.exec();
+                Q_ASSERT_X(qresult, "items requested worker", "failed to execute querying item IDs from database");
 
-                        if (iIds.count() > delVal) {
+                iIds.clear();
+                while (q.next()) {
+                    iIds.append(q.value(0).toLongLong());
+                }
 
-                            qDebug("Removing all items from feed with ID %lli, keeping only %i most recent items.", fId, delVal);
+                if (iIds.count() > delVal) {
 
-                            QStringList iIdsToDelete;
-                            for (int i = 0; i < iIds.count(); ++i) {
-                                if (i >= delVal) {
-                                    iIdsToDelete.append(QString::number(iIds.at(i)));
-                                    removedItemIds.append(iIds.at(i));
-                                }
-                            }
+                    qDebug("Removing all items from feed with ID %lli, keeping only %i most recent items.", fId, delVal);
 
-                            if (!iIdsToDelete.isEmpty()) {
-                                qresult = q.exec(QStringLiteral("DELETE FROM items WHERE id IN (%1)").arg(iIdsToDelete.join(QChar(','))));
-                                Q_ASSERT_X(qresult, "items requested worker", "failed to delete items from database");
-                            }
+                    QStringList iIdsToDelete;
+                    for (int i = 0; i < iIds.count(); ++i) {
+                        if (i >= delVal) {
+                            iIdsToDelete.append(QString::number(iIds.at(i)));
+                            removedItemIds.append(iIds.at(i));
                         }
+                    }
+
+                    if (!iIdsToDelete.isEmpty()) {
+                        qresult = q.exec(QStringLiteral("DELETE FROM items WHERE id IN (%1)").arg(iIdsToDelete.join(QChar(','))));
+                        Q_ASSERT_X(qresult, "items requested worker", "failed to delete items from database");
+                    }
+                }
 
-                    } else {
+            } else {
 
-                        const QDateTime tt = QDateTime::currentDateTimeUtc().addDays(delVal * -1);
+                const QDateTime tt = QDateTime::currentDateTimeUtc().addDays(delVal * -1);
 
-                        qDebug("Removing all items older thant %s from the feed with ID %lli.", qUtf8Printable(tt.toString(Qt::ISODate)), fId);
+                qDebug("Removing all items older thant %s from the feed with ID %lli.", qUtf8Printable(tt.toString(Qt::ISODate)), fId);
 
-                        qresult = q.prepare(QStringLiteral("SELECT id FROM items WHERE feedId = ? AND starred = 0 AND pubDate < ?"));
-                        Q_ASSERT_X(qresult, "items requested worker", "failed to prepare selecting item IDs from database");
+                qresult = q.prepare(QStringLiteral("SELECT id FROM items WHERE feedId = ? AND starred = 0 AND pubDate < ?"));
+                Q_ASSERT_X(qresult, "items requested worker", "failed to prepare selecting item IDs from database");
 
-                        q.addBindValue(fId);
-                        q.addBindValue(tt.toTime_t());
+                q.addBindValue(fId);
+                q.addBindValue(tt.toTime_t());
 
-                        qresult = q.exec();
-                        Q_ASSERT_X(qresult, "items requested worker", "failed to selecting item IDs from database");
+                qresult = q.exec();
+                Q_ASSERT_X(qresult, "items requested worker", "failed to selecting item IDs from database");
 
-                        while (q.next()) {
-                            removedItemIds.append(q.value(0).toLongLong());
-                        }
+                while (q.next()) {
+                    removedItemIds.append(q.value(0).toLongLong());
+                }
 
-                        qresult = q.prepare(QStringLiteral("DELETE FROM items WHERE feedId = ? AND starred = 0 AND pubDate < ?"));
-                        Q_ASSERT_X(qresult, "items requested worker", "failed to prepare item deletion from database");
+                qresult = q.prepare(QStringLiteral("DELETE FROM items WHERE feedId = ? AND starred = 0 AND pubDate < ?"));
+                Q_ASSERT_X(qresult, "items requested worker", "failed to prepare item deletion from database");
 
-                        q.addBindValue(fId);
-                        q.addBindValue(tt.toTime_t());
+                q.addBindValue(fId);
+                q.addBindValue(tt.toTime_t());
 
-                        qresult = q.exec();
-                        Q_ASSERT_X(qresult, "items requested worker", "failed to execute item deletion from database");
-                    }
-                }
+                qresult = q.exec();
+                Q_ASSERT_X(qresult, "items requested worker", "failed to execute item deletion from database");
             }
         }
     }
+}
 
-    if (!feedIds.empty()) {
-        qresult = m_db.transaction();
-        Q_ASSERT(qresult);
-        for (const qint64 id : feedIds) {
-            qresult = q.prepare(QStringLiteral("UPDATE feeds SET unreadCount = (SELECT COUNT(id) FROM items WHERE unread = 1 AND feedId = :feedId) WHERE id = :feedId"));
-            Q_ASSERT(qresult);
-            q.bindValue(QStringLiteral(":feedId"), id);
-            qresult = q.exec();
-            Q_ASSERT(qresult);
-        }
-        qresult = m_db.commit();
-        Q_ASSERT(qresult);
-    }
 
-    IdList folderIds;
-    qresult = q.exec(QStringLiteral("SELECT id FROM folders"));
+
+/*
+ * Updates the unread counters of the feeds identified by feedIds and of
+ * their folders. If feedIds is empty, all feeds and folders are updated.
+ * The total counters are persisted in the same transaction.
+ */
+void ItemsRequestedWorker::updateCounters(const IdList &feedIds)
+{
+    TraceSpan transaction("storage", "update counters transaction");
+
+    QSqlQuery q(m_db);
+
+    bool qresult = m_db.transaction();
     Q_ASSERT(qresult);
-    while (q.next()) {
-        folderIds.push_back(q.value(0).value<qint64>());
-    }
 
-    if (!folderIds.empty()) {
-        qresult = m_db.transaction();
+    if (feedIds.isEmpty()) {
+
+        qresult = q.exec(QStringLiteral("UPDATE feeds SET unreadCount = (SELECT COUNT(id) FROM items WHERE unread = 1 AND feedId = feeds.id)"));
         Q_ASSERT(qresult);
-        for (const qint64 id : folderIds) {
-            qresult = q.prepare(QStringLiteral("UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = :folderId) WHERE id = :folderId"));
-            Q_ASSERT(qresult);
-            q.bindValue(QStringLiteral(":folderId"), id);
-            qresult = q.exec();
-            Q_ASSERT(qresult);
-        }
-        qresult = m_db.commit();
+
+        qresult = q.exec(QStringLiteral("UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = folders.id)"));
         Q_ASSERT(qresult);
-    }
 
-    qresult = (q.exec(QStringLiteral(SEL_TOTAL_UNREAD)) && q.next());
-    Q_ASSERT_X(qresult, "items requested worker", "failed to select total unread item count from database");
-    Q_EMIT gotTotalUnread(q.value(0).toUInt());
+    } else {
 
-    qresult = (q.exec(QStringLiteral(SEL_TOTAL_STARRED)) && q.next());
-    Q_ASSERT_X(qresult, "items requested worker", "failed to select total starred item count from database");
-    Q_EMIT gotStarred(q.value(0).toUInt());
+        const QString feedIdsString = SQLiteStoragePrivate::intListToString(feedIds);
 
-    Q_EMIT requestedItems(updatedItemIds, newItemIds, removedItemIds);
+        qresult = q.exec(QStringLiteral("UPDATE feeds SET unreadCount = (SELECT COUNT(id) FROM items WHERE unread = 1 AND feedId = feeds.id) WHERE id IN (%1)").arg(feedIdsString));
+        Q_ASSERT(qresult);
 
-    if (publishArticles && !articlesToPublish.empty()) {
-        for (auto i = articlesToPublish.constBegin(); i != articlesToPublish.constEnd(); ++i) {
-            const QJsonObject o = *i;
-            if (!removedItemIds.contains(o.value(QStringLiteral("id")).toVariant().value<qint64>())) {
-                m_notificator->publishArticle(o, feedsIdTitleMap.value(o.value(QStringLiteral("feedId")).toVariant().value<qint64>()));
-            }
-        }
+        qresult = q.exec(QStringLiteral("UPDATE folders SET unreadCount = (SELECT SUM(unreadCount) FROM feeds WHERE folderId = folders.id) WHERE id IN (SELECT folderId FROM feeds WHERE id IN (%1))").arg(feedIdsString));
+        Q_ASSERT(qresult);
     }
 
-    if (m_notificator && (newUnreadItems > 0)) {
-        m_notificator->notify(AbstractNotificator::ItemsRequested, QtInfoMsg, newUnreadItems);
-    }
+    quint16 totalUnread = 0;
+    quint16 starred = 0;
+    qresult = persistTotals(q, totalUnread, starred);
+    Q_ASSERT_X(qresult, "items requested worker", "failed to persist total unread and starred counters");
+
+    qresult = m_db.commit();
+    Q_ASSERT(qresult);
+
+    Q_EMIT gotTotalUnread(totalUnread);
+    Q_EMIT gotStarred(starred);
 }
 
 
@@ -2299,11 +2878,105 @@ void SQLiteStorage::itemsRequested(const QJsonDocument &json)
         return;
     }
 
-    ItemsRequestedWorker *worker = new ItemsRequestedWorker(d->db.databaseName(), json, configuration(), notificator(), this);
-    connect(worker, &ItemsRequestedWorker::requestedItems, this, &SQLiteStorage::requestedItems);
-    connect(worker, &ItemsRequestedWorker::gotStarred, this, &SQLiteStorage::setStarred);
-    connect(worker, &ItemsRequestedWorker::gotTotalUnread, this, &SQLiteStorage::setTotalUnread);
+    ItemsWriteBatch batch;
+    batch.json = json;
+    batch.deferred = d->itemsMaintenanceDeferred;
+    d->itemsMaintenancePending |= batch.deferred;
+    d->itemsWriteQueue.enqueue(batch);
+
+    if (!d->itemsWriterActive) {
+        writeNextItems();
+    } else {
+        qDebug("Queued requested items for writing, %i batches are waiting.", d->itemsWriteQueue.size());
+    }
+}
+
+
+
+void SQLiteStorage::itemsRequested(const ItemRecords &items, quint64 batchToken)
+{
+    Q_D(SQLiteStorage);
+
+    if (!ready()) {
+        //% "SQLite database not ready. Can not process requested data."
+        setError(new Error(Error::StorageError, Error::Warning, qtTrId("libfuoten-err-sqlite-db-not-ready"), QString(), this));
+        return;
+    }
+
+    ItemsWriteBatch batch;
+    batch.items = items;
+    batch.token = batchToken;
+    batch.deferred = d->itemsMaintenanceDeferred;
+    d->itemsMaintenancePending |= batch.deferred;
+    d->itemsWriteQueue.enqueue(batch);
+
+    if (!d->itemsWriterActive) {
+        writeNextItems();
+    } else {
+        qDebug("Queued requested items for writing, %i batches are waiting.", d->itemsWriteQueue.size());
+    }
+}
+
+
+
+void SQLiteStorage::deferItemsMaintenance(bool defer, quint64 batchToken)
+{
+    Q_D(SQLiteStorage);
+
+    d->itemsMaintenanceDeferred = defer;
+
+    if (defer) {
+        return;
+    }
+
+    if (!d->itemsMaintenancePending || !ready()) {
+        d->itemsMaintenancePending = false;
+        if (batchToken != 0) {
+            Q_EMIT itemsBatchStored(batchToken);
+        }
+        return;
+    }
+
+    d->itemsMaintenancePending = false;
+
+    ItemsWriteBatch batch;
+    batch.finish = true;
+    batch.token = batchToken;
+    d->itemsWriteQueue.enqueue(batch);
+
+    if (!d->itemsWriterActive) {
+        writeNextItems();
+    }
+}
+
+
+
+void SQLiteStorage::writeNextItems()
+{
+    Q_D(SQLiteStorage);
+
+    if (d->itemsWriteQueue.isEmpty()) {
+        d->itemsWriterActive = false;
+        return;
+    }
+
+    d->itemsWriterActive = true;
+
+    const ItemsWriteBatch batch = d->itemsWriteQueue.dequeue();
+    const quint64 token = batch.token;
+
+    ItemsRequestedWorker *worker = new ItemsRequestedWorker(d->db.databaseName(), batch, configuration(), notificator(), this);
+    connect(worker, &ItemsRequestedWorker::requestedItems, this, [this, token] (const IdList &updatedItems, const IdList &newItems, const IdList &deletedItems) {
+        Q_EMIT requestedItems(updatedItems, newItems, deletedItems);
+        if (token != 0) {
+            Q_EMIT itemsBatchStored(token);
+        }
+    });
+    // the worker already persisted the counters together with the feed and folder counters
+    connect(worker, &ItemsRequestedWorker::gotStarred, this, [this] (quint16 st) {AbstractStorage::setStarred(st);});
+    connect(worker, &ItemsRequestedWorker::gotTotalUnread, this, [this] (quint16 tu) {AbstractStorage::setTotalUnread(tu);});
     connect(worker, &ItemsRequestedWorker::failed, this, [=] (Error *e) {setError(e);});
+    connect(worker, &QThread::finished, this, &SQLiteStorage::writeNextItems);
     connect(worker, &QThread::finished, worker, &QObject::deleteLater);
     worker->start();
 }
@@ -2583,18 +3256,10 @@ QString SQLiteStorage::getArticleBody(qint64 id)
 
     Q_D(SQLiteStorage);
 
-    QSqlQuery q(d->db);
-
-    bool qresult = q.prepare(QStringLiteral("SELECT body FROM items WHERE id = ?"));
-    Q_ASSERT_X(qresult, "get article body", "failed to prepare database transaction");
-
-    q.addBindValue(id);
-
-    qresult = q.exec();
-    Q_ASSERT_X(qresult, "get article body", "failed to execute database query");
+    SQLiteStoragePrivate::ArticleData data;
 
-    if (Q_LIKELY(q.next())) {
-        body = q.value(0).toString();
+    if (Q_LIKELY(d->articleData(id, data))) {
+        body = data.body;
     }
 
     return body;
@@ -2747,6 +3412,8 @@ EnqueueMarkReadWorker::EnqueueMarkReadWorker(const QString &dbpath, qint64 id, F
 
 void EnqueueMarkReadWorker::run()
 {
+    TraceSpan span("storage", "EnqueueMarkReadWorker");
+
     QSqlQuery q(m_db);
     q.setForwardOnly(true);
 
@@ -2806,6 +3473,7 @@ void EnqueueMarkReadWorker::run()
         ++i;
     }
 
+    TraceSpan transaction("storage", "enqueue mark read transaction");
     qresult = m_db.transaction();
     Q_ASSERT_X(qresult, "equeue mark read worker", "failed to start database transaction");
 
@@ -2826,6 +3494,7 @@ void EnqueueMarkReadWorker::run()
 
     qresult = m_db.commit();
     Q_ASSERT_X(qresult, "enqueue mark read worker", "failed to commit database transaction");
+    transaction.end();
 
     qresult = q.exec(QStringLiteral("SELECT id FROM feeds"));
     Q_ASSERT(qresult);
@@ -2834,6 +3503,7 @@ void EnqueueMarkReadWorker::run()
         feedIds.push_back(q.value(0).value<qint64>());
     }
     if (!feedIds.empty()) {
+        TraceSpan transaction("storage", "update feed counters transaction");
         qresult = m_db.transaction();
         Q_ASSERT(qresult);
         for (const qint64 id : feedIds) {
@@ -2854,6 +3524,7 @@ void EnqueueMarkReadWorker::run()
         folderIds.push_back(q.value(0).value<qint64>());
     }
     if (!folderIds.empty()) {
+        TraceSpan transaction("storage", "update folder counters transaction");
         qresult = m_db.transaction();
         Q_ASSERT(qresult);
         for (const qint64 id : folderIds) {
@@ -3021,6 +3692,8 @@ ClearQueueWorker::ClearQueueWorker(const QString &dbpath, QObject *parent) :
 
 void ClearQueueWorker::run()
 {
+    TraceSpan span("storage", "ClearQueueWorker");
+
     QSqlQuery q(m_db);
 
     bool qresult = q.exec(QStringLiteral("PRAGMA foreign_keys = ON"));
@@ -3060,4 +3733,59 @@ void SQLiteStorage::clearQueue()
     worker->start();
 }
 
+
+
+void SQLiteStorage::dequeueItems(const IdList &itemIds, FuotenEnums::QueueActions actions)
+{
+    if (!ready() || itemIds.isEmpty()) {
+        return;
+    }
+
+    Q_D(SQLiteStorage);
+
+    QSqlQuery q(d->db);
+    bool qresult = q.prepare(QStringLiteral("UPDATE items SET queue = (queue & ~?) WHERE id IN (%1)").arg(d->intListToString(itemIds)));
+    Q_ASSERT_X(qresult, "dequeue items", "failed to prepare database query");
+
+    q.addBindValue(static_cast<int>(actions));
+
+    qresult = q.exec();
+    Q_ASSERT_X(qresult, "dequeue items", "failed to execute database query");
+
+    qDebug("Removed queue actions 0x%x from %i items.", static_cast<int>(actions), itemIds.size());
+
+    Q_EMIT dequeuedItems(itemIds, actions);
+}
+
+
+
+void SQLiteStorage::setArticleCacheSize(int bytes)
+{
+    Q_D(SQLiteStorage);
+    QMutexLocker locker(&d->articleCacheMutex);
+    if (bytes != d->articleCache.maxCost()) {
+        d->articleCache.setMaxCost(qMax(bytes, 0));
+        qDebug("Changed article cache size to %i bytes.", d->articleCache.maxCost());
+    }
+}
+
+
+int SQLiteStorage::articleCacheSize() const { Q_D(const SQLiteStorage); QMutexLocker locker(&d->articleCacheMutex); return d->articleCache.maxCost(); }
+
+
+quint64 SQLiteStorage::articleCacheHits() const { Q_D(const SQLiteStorage); QMutexLocker locker(&d->articleCacheMutex); return d->articleCacheHits; }
+
+
+quint64 SQLiteStorage::articleCacheMisses() const { Q_D(const SQLiteStorage); QMutexLocker locker(&d->articleCacheMutex); return d->articleCacheMisses; }
+
+
+void SQLiteStorage::clearArticleCache()
+{
+    Q_D(SQLiteStorage);
+    QMutexLocker locker(&d->articleCacheMutex);
+    d->clearArticleCache();
+    d->articleCacheHits = 0;
+    d->articleCacheMisses = 0;
+}
+
 #include "moc_sqlitestorage.cpp"
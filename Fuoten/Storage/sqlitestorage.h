@@ -51,10 +51,17 @@ public:
      */
     SQLiteStorage(const QString &dbpath, QObject *parent = nullptr);
 
+    /*!
+     * \brief Destroys the SQLiteStorage object after waiting for running asynchronous queries.
+     */
+    ~SQLiteStorage();
+
     /*!
      * \brief Initializes the SQLite database.
      *
-     * This will create/check the table layout.
+     * This will create the table layout or migrate it step by step to the current schema version stored
+     * in the system table. If the schema is already up to date, the storage will be set to ready without
+     * further schema work, using the unread and starred counters persisted in the database.
      */
     void init() override;
 
@@ -76,14 +83,49 @@ public:
     /*!
      * \brief Invokes an asynchronous query for articles in a different thread.
      *
-     * Will emit the AbstractStorage::gotArticlesAsync() signal after the query finished. The signal
-     * will contain a list of Article objects. When connecting to this signal, be aware that the objects
-     * in the list have been created in a different thread.
+     * Will emit the AbstractStorage::gotArticlesAsync() signal after the query finished.
      *
      * \param args query arguments
      */
     void getArticlesAsync(const QueryArgs &args) override;
 
+    /*!
+     * \brief Queries a list of Article objects in a different thread.
+     *
+     * The objects will be moved into the thread of the storage before they are reported to the returned future.
+     */
+    QFuture<ArticleList> getArticlesFuture(const QueryArgs &args) override;
+
+    /*!
+     * \brief Queries the newest item ID in a different thread.
+     */
+    QFuture<qint64> getNewestItemIdAsync(FuotenEnums::Type type = FuotenEnums::All, qint64 id = -1) override;
+
+    /*!
+     * \brief Queries a list of Folder objects in a different thread.
+     */
+    QFuture<QList<Folder*>> getFoldersAsync(FuotenEnums::SortingRole sortingRole = FuotenEnums::Name, Qt::SortOrder sortOrder = Qt::AscendingOrder, const IdList &ids = IdList(), FuotenEnums::Type idType = FuotenEnums::Folder, int limit = 0) override;
+
+    /*!
+     * \brief Queries a list of Feed objects in a different thread.
+     */
+    QFuture<QList<Feed*>> getFeedsAsync(const QueryArgs &args) override;
+
+    /*!
+     * \brief Queries the Feed identified by \a id in a different thread.
+     */
+    QFuture<Feed*> getFeedAsync(qint64 id) override;
+
+    /*!
+     * \brief Queries the Article identified by \a id in a different thread.
+     */
+    QFuture<Article*> getArticleAsync(qint64 id, int bodyLimit = 0) override;
+
+    /*!
+     * \brief Queries the full body of the Article identified by \a id in a different thread.
+     */
+    QFuture<QString> getArticleBodyAsync(qint64 id) override;
+
     /*!
      * \brief Returns the Feed identified by \a id.
      *
@@ -108,6 +150,11 @@ public:
      */
     qint64 getNewestItemId(FuotenEnums::Type type = FuotenEnums::All, qint64 id = -1) override;
 
+    /*!
+     * \brief Returns the publication dates of the newest items per feed.
+     */
+    QHash<qint64, QList<uint>> getPublishDates(int limit = 20) override;
+
     /*!
      * \brief Returns the full body of an Article identified by \a id.
      */
@@ -166,6 +213,97 @@ public:
      */
     void clearQueue() override;
 
+    /*!
+     * \brief Removes the queue \a actions from the queue column of the items identified by \a itemIds.
+     */
+    void dequeueItems(const IdList &itemIds, FuotenEnums::QueueActions actions) override;
+
+    /*!
+     * \brief Sets the maximum size of the article cache in bytes.
+     *
+     * getArticle() and getArticleBody() read through a LRU cache that keeps the most recently requested
+     * articles together with their full body. The cache is invalidated for the affected articles whenever
+     * they are changed or removed by one of the storage slots. The default size is 4 MiB, a size of \c 0
+     * disables the cache.
+     *
+     * \sa articleCacheSize()
+     */
+    void setArticleCacheSize(int bytes);
+
+    /*!
+     * \brief Returns the maximum size of the article cache in bytes.
+     *
+     * \sa setArticleCacheSize()
+     */
+    int articleCacheSize() const;
+
+    /*!
+     * \brief Returns the number of article requests that have been answered from the cache.
+     */
+    quint64 articleCacheHits() const;
+
+    /*!
+     * \brief Returns the number of article requests that had to query the database.
+     */
+    quint64 articleCacheMisses() const;
+
+    /*!
+     * \brief Removes all articles from the cache and resets the statistics.
+     */
+    void clearArticleCache();
+
+    /*!
+     * \brief Stores the synchronization \a checkpoint in the system table of the database.
+     *
+     * The stored checkpoint will be loaded again by init().
+     */
+    void setSyncCheckpoint(const QJsonObject &checkpoint) override;
+
+    /*!
+     * \brief Stores the reply \a hash for \a key in the system table of the database.
+     *
+     * The stored hashes will be loaded again by init().
+     */
+    void setReplyHash(const QString &key, const QByteArray &hash) override;
+
+    /*!
+     * \brief Stores the starred \a watermark in the system table of the database.
+     *
+     * The stored watermark will be loaded again by init().
+     */
+    void setStarredWatermark(const QDateTime &watermark) override;
+
+    /*!
+     * \brief Stores the \a folders requested from the remote server in the database.
+     *
+     * Stores the \a replyHash for \a replyKey after the folders have been stored.
+     */
+    void foldersRequested(const FolderRecords &folders, const QString &replyKey = QString(), const QByteArray &replyHash = QByteArray()) override;
+
+    /*!
+     * \brief Stores the \a feeds requested from the remote server in the database.
+     *
+     * Stores the \a replyHash for \a replyKey after the feeds have been stored.
+     */
+    void feedsRequested(const FeedRecords &feeds, const QString &replyKey = QString(), const QByteArray &replyHash = QByteArray()) override;
+
+    /*!
+     * \brief Queues the \a items requested from the remote server for writing into the database.
+     *
+     * The items are written by a worker thread, batches are written one after another. After the items
+     * have been written, itemsBatchStored() is emitted with the \a batchToken.
+     */
+    void itemsRequested(const ItemRecords &items, quint64 batchToken = 0) override;
+
+    /*!
+     * \brief Defers removing old items and updating the unread counters while \a defer is \c true.
+     *
+     * While deferred, every batch only writes its items. When \a defer is set to \c false again, a final
+     * batch removes old items of all feeds and updates all counters, if items have been written meanwhile.
+     * itemsBatchStored() is emitted with the \a batchToken after the final batch has been written.
+     */
+    void deferItemsMaintenance(bool defer, quint64 batchToken = 0) override;
+
 public Q_SLOTS:
     void foldersRequested(const QJsonDocument &json) override;
     void folderCreated(const QJsonDocument &json) override;
@@ -187,7 +325,20 @@ public Q_SLOTS:
     void itemStarred(qint64 feedId, const QString &guidHash, bool star) override;
     void allItemsMarkedRead(qint64 newestItemId) override;
 
+protected:
+    /*!
+     * \brief Sets the total unread counter to \a nTotalUnread and persists it in the database.
+     */
+    void setTotalUnread(quint16 nTotalUnread) override;
+
+    /*!
+     * \brief Sets the starred counter to \a nStarred and persists it in the database.
+     */
+    void setStarred(quint16 nStarred) override;
+
 private:
+    void writeNextItems();
+
     Q_DECLARE_PRIVATE(SQLiteStorage)
     Q_DISABLE_COPY(SQLiteStorage)
 };
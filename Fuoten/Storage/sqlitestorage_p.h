@@ -28,8 +28,18 @@
 #include <QSqlError>
 #include <QStringList>
 #include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
 #include <QJsonDocument>
 #include <QSqlQuery>
+#include <QCache>
+#include <QHash>
+#include <QUrl>
+#include <QMutex>
+#include <QThreadStorage>
+#include <QQueue>
+#include <QFutureInterface>
+#include <functional>
 
 namespace Fuoten {
 
@@ -39,16 +49,28 @@ class SQLiteStorageManager : public QThread {
 public:
     explicit SQLiteStorageManager(const QString &dbpath, QObject *parent = nullptr);
 
+    /*
+     * The schema version the current code expects. Increase this and add
+     * a migration step to migrate() when changing the database layout.
+     */
+    static const quint16 schemaVersion = 4;
+
 private:
     QSqlDatabase m_db;
     quint16 m_currentDbVersion;
     void setFailed(const QSqlError &sqlError, const QString &text);
+    bool migrate(quint16 toVersion, QSqlQuery &q);
+    bool migrateTo1(QSqlQuery &q);
+    bool migrateTo2(QSqlQuery &q);
+    bool migrateTo3(QSqlQuery &q);
+    bool migrateTo4(QSqlQuery &q);
+    bool recountCounters(QSqlQuery &q, quint16 &totalUnread, quint16 &starred);
 
 protected:
     void run() override;
 
 Q_SIGNALS:
-    void succeeded();
+    void succeeded(quint16 totalUnread, quint16 starred);
     void failed(Error *error);
 };
 
@@ -57,10 +79,69 @@ Q_SIGNALS:
 
 
 
+/*
+ * Requested items waiting to be written. Items received as JSON reply are
+ * only converted into records by the worker thread.
+ */
+struct ItemsWriteBatch {
+    QJsonDocument json;
+    ItemRecords items;
+    // only write the items, cleanup and counters are done by a later finishing batch
+    bool deferred = false;
+    // echoed by itemsBatchStored() after the items have been written
+    quint64 token = 0;
+    // contains no items, cleans up all feeds and updates all counters
+    bool finish = false;
+};
+
+
+
+
 class SQLiteStoragePrivate : public AbstractStoragePrivate {
 public:
+    struct ArticleData {
+        qint64 id = 0;
+        qint64 feedId = 0;
+        QString feedTitle;
+        QString guid;
+        QString guidHash;
+        QUrl url;
+        QString title;
+        QString author;
+        uint pubDate = 0;
+        QString body;
+        QString enclosureMime;
+        QUrl enclosureLink;
+        bool unread = false;
+        bool starred = false;
+        uint lastModified = 0;
+        QString fingerprint;
+        qint64 folderId = 0;
+        QString folderName;
+        int queue = 0;
+
+        int cost() const
+        {
+            return sizeof(ArticleData) + 2 * (feedTitle.size() + guid.size() + guidHash.size() + title.size() + author.size() + body.size() + enclosureMime.size() + fingerprint.size() + folderName.size());
+        }
+    };
+
+    /*
+     * The fields of a cached article that are used to find the articles
+     * affected by a change of a feed, folder or starred state.
+     */
+    struct ArticleCacheKey {
+        qint64 feedId = 0;
+        qint64 folderId = 0;
+        QString guidHash;
+    };
+
     SQLiteStoragePrivate(const QString &_dbpath) : AbstractStoragePrivate()
     {
+        articleCache.setMaxCost(4 * 1024 * 1024);
+        // SQLite serializes most of the work on the database file, more threads would only wait for each other
+        queryPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), 4));
+
         if (!QSqlDatabase::connectionNames().contains(QStringLiteral("fuotendb"))) {
             db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("fuotendb"));
             db.setDatabaseName(_dbpath);
@@ -69,7 +150,7 @@ public:
         }
     }
 
-    QStringList intListToStringList(const IdList &ints) const
+    static QStringList intListToStringList(const IdList &ints)
     {
         QStringList sl;
 
@@ -85,7 +166,7 @@ public:
         return sl;
     }
 
-    QString intListToString(const IdList &ints) const
+    static QString intListToString(const IdList &ints)
     {
         if (ints.isEmpty()) {
             return QString();
@@ -101,8 +182,95 @@ public:
         return QSqlQuery(db);
     }
 
+    bool articleData(qint64 id, ArticleData &data);
+
+    QSqlDatabase connection() const;
+
+    /*
+     * Stores the total unread and total starred counters in the system table.
+     * They are only marked as up to date if no items are waiting to be written
+     * or counted by the items worker, so that init() does not have to count
+     * the items again.
+     */
+    void persistCounters(quint16 totalUnread, quint16 starred);
+
+    /*
+     * Stores value for key in the system table. A null value removes the key.
+     */
+    void persistSystemValue(const QString &key, const QString &value);
+
+    /*
+     * Returns a hash over the feed fields that are stored in the database. Used
+     * to only compare and write feeds that changed on the server.
+     */
+    static QString feedHash(qint64 folderId, const QString &title, const QString &url, const QString &link, uint added, int ordering, bool pinned, int updateErrorCount, const QString &lastUpdateError, const QString &faviconLink);
+
+    /*
+     * Removes the cached articles matching pred. The predicate is applied to
+     * the cache keys, because QCache::object() would move every visited
+     * article to the front of the LRU list. Has to be called with the
+     * articleCacheMutex not locked.
+     */
+    template<typename Predicate>
+    void invalidateArticles(Predicate pred)
+    {
+        QMutexLocker locker(&articleCacheMutex);
+        articleCacheGeneration++;
+        auto it = articleCacheKeys.begin();
+        while (it != articleCacheKeys.end()) {
+            if (!articleCache.contains(it.key())) {
+                // already evicted by the cache
+                it = articleCacheKeys.erase(it);
+            } else if (pred(it.value())) {
+                articleCache.remove(it.key());
+                it = articleCacheKeys.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void invalidateArticles(const IdList &ids)
+    {
+        QMutexLocker locker(&articleCacheMutex);
+        articleCacheGeneration++;
+        for (qint64 id : ids) {
+            articleCache.remove(id);
+            articleCacheKeys.remove(id);
+        }
+    }
+
+    /*
+     * Has to be called with the articleCacheMutex locked.
+     */
+    void clearArticleCache()
+    {
+        articleCacheGeneration++;
+        articleCache.clear();
+        articleCacheKeys.clear();
+    }
+
+    static QThreadStorage<QString> threadConnectionName;
+
     QSqlDatabase db;
     QThread worker;
+    // requested items are written one after another to not block each other on the database lock
+    QQueue<ItemsWriteBatch> itemsWriteQueue;
+    bool itemsWriterActive = false;
+    bool itemsMaintenanceDeferred = false;
+    // items have been written while the maintenance was deferred
+    bool itemsMaintenancePending = false;
+    // the last attempt to persist the counters failed
+    bool countersOutdated = false;
+    // runs the queries of the asynchronous getters
+    QThreadPool queryPool;
+    QCache<qint64, ArticleData> articleCache;
+    QHash<qint64, ArticleCacheKey> articleCacheKeys;
+    // incremented by every invalidation, articles read while it changed are not cached
+    quint64 articleCacheGeneration = 0;
+    mutable QMutex articleCacheMutex;
+    quint64 articleCacheHits = 0;
+    quint64 articleCacheMisses = 0;
 };
 
 
@@ -113,7 +281,7 @@ class ItemsRequestedWorker : public QThread
 {
     Q_OBJECT
 public:
-    ItemsRequestedWorker(const QString &dbpath, const QJsonDocument &json, AbstractConfiguration *config = nullptr, AbstractNotificator *notificator = nullptr, QObject *parent = nullptr);
+    ItemsRequestedWorker(const QString &dbpath, const ItemsWriteBatch &batch, AbstractConfiguration *config = nullptr, AbstractNotificator *notificator = nullptr, QObject *parent = nullptr);
 
 Q_SIGNALS:
     void requestedItems(const IdList &updatedItems, const IdList &newItems, const IdList &deletedItems);
@@ -125,8 +293,11 @@ protected:
     void run() override;
 
 private:
+    void removeOldItems(const IdList &feedIds, IdList &removedItemIds);
+    void updateCounters(const IdList &feedIds);
+
     QSqlDatabase m_db;
-    QJsonDocument m_json;
+    ItemsWriteBatch m_batch;
     AbstractConfiguration *m_config;
     AbstractNotificator *m_notificator;
 };
@@ -134,22 +305,21 @@ private:
 
 
 
-class GetArticlesAsyncWorker : public QThread
+/*
+ * Runs a read-only query in a thread of the query pool with its own database connection.
+ * While the query function runs, SQLiteStoragePrivate::connection() returns the connection
+ * of the query, so the synchronous getters of SQLiteStorage can be used.
+ */
+class SQLiteQueryWorker : public QRunnable
 {
-    Q_OBJECT
 public:
-    GetArticlesAsyncWorker(const QString &dbpath, const QueryArgs &args, QObject *parent = nullptr);
+    SQLiteQueryWorker(const QString &dbpath, const std::function<void ()> &query);
 
-Q_SIGNALS:
-    void gotArticles(const ArticleList &articles);
-    void failed(Error *e);
-
-protected:
     void run() override;
 
 private:
-    QSqlDatabase m_db;
-    QueryArgs m_args;
+    QString m_dbpath;
+    std::function<void ()> m_query;
 };
 
 
@@ -21,6 +21,7 @@
 #include "API/component.h"
 #include "API/markitem.h"
 #include "API/staritem.h"
+#include "Helpers/requestcoalescer.h"
 #include "fuoten.h"
 #include "error.h"
 
@@ -343,6 +344,10 @@ void Article::mark(bool unread, AbstractConfiguration *config, AbstractStorage *
             setError(storage->error());
         }
 
+    } else if (RequestCoalescer *rc = Component::defaultCoalescer()) {
+
+        rc->mark(this, unread, config, storage);
+
     } else {
 
         MarkItem *mi = new MarkItem(id(), unread, this);
@@ -388,6 +393,10 @@ void Article::star(bool starred, AbstractConfiguration *config, AbstractStorage
             setError(storage->error());
         }
 
+    } else if (RequestCoalescer *rc = Component::defaultCoalescer()) {
+
+        rc->star(this, starred, config, storage);
+
     } else {
 
         StarItem *si = new StarItem(feedId(), guidHash(), starred, this);
@@ -30,6 +30,7 @@
 namespace Fuoten {
 
 class ArticlePrivate;
+class RequestCoalescer;
 
 /*!
  * \brief Contains information about a single article/item.
@@ -450,6 +451,9 @@ public:
      * \param config    pointer to an AbstractConfiguration object that containts the authentication credentials
      * \param storage   pointer to an AbstractStorage object to update the local storage after successful request
      * \param enqueue   \c true to enqueue the marking local up to the next sync, valid \c storage has to be available
+     *
+     * If not enqueued and a RequestCoalescer has been set via Component::setDefaultCoalescer(), the action will be
+     * added to the coalescer and sent together with other actions.
      */
     Q_INVOKABLE void mark(bool unread, Fuoten::AbstractConfiguration *config, Fuoten::AbstractStorage *storage = nullptr, bool enqueue = false);
 
@@ -471,6 +475,9 @@ public:
      * \param config    pointer to an AbstractConfiguration object that containts the authentication credentials
      * \param storage   pointer to an AbstractStorage object to update the local storage after successful request
      * \param enqueue   \c true to enqueue the un/starring local up to the next sync, valid \c storage has to be available
+     *
+     * If not enqueued and a RequestCoalescer has been set via Component::setDefaultCoalescer(), the action will be
+     * added to the coalescer and sent together with other actions.
      */
     Q_INVOKABLE void star(bool starred, Fuoten::AbstractConfiguration *config, Fuoten::AbstractStorage *storage = nullptr, bool enqueue = false);
 
@@ -586,6 +593,7 @@ protected:
 private:
     Q_DISABLE_COPY(Article)
     Q_DECLARE_PRIVATE(Article)
+    friend class RequestCoalescer;
 
 };
 
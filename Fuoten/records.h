@@ -0,0 +1,195 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENRECORDS_H
+#define FUOTENRECORDS_H
+
+#include <QString>
+#include <QVector>
+#include "fuoten_global.h"
+
+namespace Fuoten {
+
+/*!
+ * \brief Compact representation of a folder as returned by the News App API.
+ *
+ * Records are filled by a JsonDecoder directly from the reply data of GetFolders.
+ */
+struct FolderRecord
+{
+    /*!
+     * \brief ID of the folder.
+     */
+    qint64 id = 0;
+    /*!
+     * \brief Name of the folder.
+     */
+    QString name;
+};
+
+/*!
+ * \brief Compact representation of a feed as returned by the News App API.
+ *
+ * Records are filled by a JsonDecoder directly from the reply data of GetFeeds. URLs are kept
+ * as strings, so that storages can bind them without a round trip through QUrl.
+ */
+struct FeedRecord
+{
+    /*!
+     * \brief ID of the feed.
+     */
+    qint64 id = 0;
+    /*!
+     * \brief ID of the folder the feed is part of, \c 0 for the root folder.
+     */
+    qint64 folderId = 0;
+    /*!
+     * \brief Title of the feed.
+     */
+    QString title;
+    /*!
+     * \brief URL of the feed source.
+     */
+    QString url;
+    /*!
+     * \brief URL of the web site the feed belongs to.
+     */
+    QString link;
+    /*!
+     * \brief URL of the favicon of the feed.
+     */
+    QString faviconLink;
+    /*!
+     * \brief Last error that occurred when the server updated the feed.
+     */
+    QString lastUpdateError;
+    /*!
+     * \brief Time the feed has been added, in seconds since the epoch.
+     */
+    uint added = 0;
+    /*!
+     * \brief Number of unread items as reported by the server.
+     */
+    uint unreadCount = 0;
+    /*!
+     * \brief Number of failed updates on the server.
+     */
+    uint updateErrorCount = 0;
+    /*!
+     * \brief Ordering of the feed items, see FuotenEnums::FeedOrdering.
+     */
+    quint8 ordering = 0;
+    /*!
+     * \brief \c true if the feed is pinned.
+     */
+    bool pinned = false;
+};
+
+/*!
+ * \brief Compact representation of an item/article as returned by the News App API.
+ *
+ * Records are filled by a JsonDecoder directly from the reply data of GetItems and GetUpdatedItems.
+ * URLs are kept as strings, so that storages can bind them without a round trip through QUrl.
+ */
+struct ItemRecord
+{
+    /*!
+     * \brief ID of the item.
+     */
+    qint64 id = 0;
+    /*!
+     * \brief ID of the feed the item belongs to.
+     */
+    qint64 feedId = 0;
+    /*!
+     * \brief GUID of the item.
+     */
+    QString guid;
+    /*!
+     * \brief Hash of the GUID, unique per feed.
+     */
+    QString guidHash;
+    /*!
+     * \brief URL of the item.
+     */
+    QString url;
+    /*!
+     * \brief Title of the item.
+     */
+    QString title;
+    /*!
+     * \brief Author of the item.
+     */
+    QString author;
+    /*!
+     * \brief Full body of the item.
+     */
+    QString body;
+    /*!
+     * \brief MIME type of the enclosure, if any.
+     */
+    QString enclosureMime;
+    /*!
+     * \brief URL of the enclosure, if any.
+     */
+    QString enclosureLink;
+    /*!
+     * \brief Fingerprint of the item content.
+     */
+    QString fingerprint;
+    /*!
+     * \brief Publication time of the item, in seconds since the epoch.
+     */
+    uint pubDate = 0;
+    /*!
+     * \brief Time of the last modification on the server, in seconds since the epoch.
+     */
+    uint lastModified = 0;
+    /*!
+     * \brief \c true if the item is unread.
+     */
+    bool unread = false;
+    /*!
+     * \brief \c true if the item is starred.
+     */
+    bool starred = false;
+};
+
+/*!
+ * \brief List of folder records in the order of the API reply.
+ */
+typedef QVector<FolderRecord> FolderRecords;
+
+/*!
+ * \brief List of feed records in the order of the API reply.
+ */
+typedef QVector<FeedRecord> FeedRecords;
+
+/*!
+ * \brief List of item records in the order of the API reply.
+ */
+typedef QVector<ItemRecord> ItemRecords;
+
+}
+
+Q_DECLARE_TYPEINFO(Fuoten::FolderRecord, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(Fuoten::FeedRecord, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(Fuoten::ItemRecord, Q_MOVABLE_TYPE);
+
+#endif // FUOTENRECORDS_H
@@ -2,8 +2,8 @@ TARGET = fuoten
 TEMPLATE = lib
 
 VER_MAJ = 0
-VER_MIN = 6
-VER_PAT = 1
+VER_MIN = 7
+VER_PAT = 0
 VERSION = $${VER_MAJ}.$${VER_MIN}.$${VER_PAT}
 
 QT += network sql
@@ -54,6 +54,10 @@ isEmpty(INSTALL_TRANSLATIONS_DIR): INSTALL_TRANSLATIONS_DIR = $$[QT_INSTALL_TRAN
         Fuoten/Storage/abstractstorage.h \
         Fuoten/Storage/sqlitestorage.h \
         Fuoten/Storage/AbstractStorage \
+        Fuoten/Storage/MemoryStorage \
+        Fuoten/Storage/memorystorage.h \
+        Fuoten/Storage/MappedStorage \
+        Fuoten/Storage/mappedstorage.h \
         Fuoten/error.h \
         Fuoten/fuoten_global.h \
         Fuoten/fuoten.h \
@@ -135,7 +139,26 @@ isEmpty(INSTALL_TRANSLATIONS_DIR): INSTALL_TRANSLATIONS_DIR = $$[QT_INSTALL_TRAN
         Fuoten/Helpers/abstractnamfactory.h \
         Fuoten/Helpers/AbstractNamFactory \
         Fuoten/Helpers/abstractnotificator.h \
-        Fuoten/Helpers/AbstractNotificator
+        Fuoten/Helpers/AbstractNotificator \
+        Fuoten/Helpers/requestcoalescer.h \
+        Fuoten/Helpers/RequestCoalescer \
+        Fuoten/Helpers/syncscheduler.h \
+        Fuoten/Helpers/SyncScheduler \
+        Fuoten/Helpers/abstractmetricssink.h \
+        Fuoten/Helpers/AbstractMetricsSink \
+        Fuoten/Helpers/metricsaggregator.h \
+        Fuoten/Helpers/MetricsAggregator \
+        Fuoten/Helpers/tracer.h \
+        Fuoten/Helpers/Tracer \
+        Fuoten/Helpers/trafficrecorder.h \
+        Fuoten/Helpers/TrafficRecorder \
+        Fuoten/Helpers/replaynamfactory.h \
+        Fuoten/Helpers/ReplayNamFactory \
+        Fuoten/records.h \
+        Fuoten/Helpers/jsondecoder.h \
+        Fuoten/Helpers/JsonDecoder \
+        Fuoten/Helpers/fastjsondecoder.h \
+        Fuoten/Helpers/FastJsonDecoder
 
     basePath = $${dirname(PWD)}
     for(header, INSTALL_HEADERS) {
@@ -205,6 +228,8 @@ HEADERS += \
     Fuoten/error_p.h \
     Fuoten/API/component.h \
     Fuoten/API/component_p.h \
+    Fuoten/API/networksession_p.h \
+    Fuoten/API/payloadwriter_p.h \
     Fuoten/API/getversion.h \
     Fuoten/API/getversion_p.h \
     Fuoten/API/getstatus.h \
@@ -226,6 +251,10 @@ HEADERS += \
     Fuoten/Storage/abstractstorage_p.h \
     Fuoten/Storage/sqlitestorage.h \
     Fuoten/Storage/sqlitestorage_p.h \
+    Fuoten/Storage/memorystorage.h \
+    Fuoten/Storage/memorystorage_p.h \
+    Fuoten/Storage/mappedstorage.h \
+    Fuoten/Storage/mappedstorage_p.h \
     Fuoten/Models/basemodel_p.h \
     Fuoten/Models/basemodel.h \
     Fuoten/Models/abstractfoldermodel.h \
@@ -289,11 +318,29 @@ HEADERS += \
     Fuoten/API/markallitemsread_p.h \
     Fuoten/Helpers/abstractnamfactory.h \
     Fuoten/Helpers/abstractnotificator.h \
-    Fuoten/Helpers/abstractnotificator_p.h
+    Fuoten/Helpers/abstractnotificator_p.h \
+    Fuoten/Helpers/requestcoalescer.h \
+    Fuoten/Helpers/requestcoalescer_p.h \
+    Fuoten/Helpers/syncscheduler.h \
+    Fuoten/Helpers/syncscheduler_p.h \
+    Fuoten/Helpers/abstractmetricssink.h \
+    Fuoten/Helpers/metricsaggregator.h \
+    Fuoten/Helpers/metricsaggregator_p.h \
+    Fuoten/Helpers/tracer.h \
+    Fuoten/Helpers/trafficarchive_p.h \
+    Fuoten/Helpers/trafficrecorder.h \
+    Fuoten/Helpers/replaynamfactory.h \
+    Fuoten/Helpers/replaynamfactory_p.h \
+    Fuoten/records.h \
+    Fuoten/Helpers/jsondecoder.h \
+    Fuoten/Helpers/jsondecoder_p.h \
+    Fuoten/Helpers/fastjsondecoder.h \
+    Fuoten/Helpers/fastjsondecoder_p.h
 
 SOURCES += \
     Fuoten/error.cpp \
     Fuoten/API/component.cpp \
+    Fuoten/API/networksession.cpp \
     Fuoten/API/getversion.cpp \
     Fuoten/API/getstatus.cpp \
     Fuoten/API/getuser.cpp \
@@ -304,6 +351,8 @@ SOURCES += \
     Fuoten/API/getfolders.cpp \
     Fuoten/Helpers/synchronizer.cpp \
     Fuoten/Storage/sqlitestorage.cpp \
+    Fuoten/Storage/memorystorage.cpp \
+    Fuoten/Storage/mappedstorage.cpp \
     Fuoten/Models/basemodel.cpp \
     Fuoten/Models/abstractfoldermodel.cpp \
     Fuoten/Models/folderlistmodel.cpp \
@@ -336,7 +385,16 @@ SOURCES += \
     Fuoten/API/starmultipleitems.cpp \
     Fuoten/API/markallitemsread.cpp \
     Fuoten/Helpers/abstractnamfactory.cpp \
-    Fuoten/Helpers/abstractnotificator.cpp
+    Fuoten/Helpers/abstractnotificator.cpp \
+    Fuoten/Helpers/requestcoalescer.cpp \
+    Fuoten/Helpers/syncscheduler.cpp \
+    Fuoten/Helpers/abstractmetricssink.cpp \
+    Fuoten/Helpers/metricsaggregator.cpp \
+    Fuoten/Helpers/tracer.cpp \
+    Fuoten/Helpers/trafficrecorder.cpp \
+    Fuoten/Helpers/replaynamfactory.cpp \
+    Fuoten/Helpers/jsondecoder.cpp \
+    Fuoten/Helpers/fastjsondecoder.cpp
 
 DISTFILES += \
     fuoten.pc.in \
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+#
+# libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+# Copyright (C) 2016-2017 Matthias Fehring
+# https://github.com/Huessenbergnetz/libfuoten
+#
+# This library is free software: you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 3 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library.  If not, see
+# <http://www.gnu.org/licenses/>.
+
+"""
+Generates a deterministic synthetic News App data set.
+
+The written files contain the same JSON documents the GetFolders, GetFeeds
+and GetItems requests return and can be fed directly into the
+AbstractStorage::foldersRequested(), AbstractStorage::feedsRequested() and
+AbstractStorage::itemsRequested() slots to profile storage implementations.
+
+  folders.json        reply of GetFolders
+  feeds.json          reply of GetFeeds
+  items.json          reply of GetItems for the initial synchronization
+  items-update.json   reply of GetUpdatedItems containing changed and new items
+
+With --page-size the initial items are split into the replies of a paged
+synchronization, items-0001.json, items-0002.json and so on, instead of
+items.json. Big data sets need this, because a single reply would exceed the
+maximum size of a QByteArray.
+
+The same seed and size always produce identical files.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import random
+import sys
+
+SIZES = {
+    '1k': 1000,
+    '100k': 100000,
+    '1m': 1000000,
+}
+
+WORDS = ('lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod tempor '
+         'incididunt ut labore et dolore magna aliqua enim ad minim veniam quis nostrud '
+         'exercitation ullamco laboris nisi aliquip ex ea commodo consequat duis aute irure '
+         'in reprehenderit voluptate velit esse cillum fugiat nulla pariatur excepteur sint '
+         'occaecat cupidatat non proident sunt culpa qui officia deserunt mollit anim id est').split()
+
+BASE_TIME = 1500000000
+
+
+def words(rnd, count):
+    return ' '.join(rnd.choice(WORDS) for _ in range(count))
+
+
+def body(rnd):
+    # body sizes of real feeds follow roughly a log-normal distribution with a
+    # median of about 2 KiB and a long tail of full text articles
+    size = min(int(rnd.lognormvariate(7.6, 0.9)), 256 * 1024)
+    parts = []
+    length = 0
+    while length < size:
+        p = '<p>%s</p>' % words(rnd, rnd.randint(20, 80))
+        parts.append(p)
+        length += len(p)
+    return ''.join(parts)
+
+
+def folders(rnd, count):
+    return [{'id': i, 'name': words(rnd, 2).title()} for i in range(1, count + 1)]
+
+
+def feeds(rnd, count, folder_count):
+    result = []
+    for i in range(1, count + 1):
+        host = 'feed%d.example.com' % i
+        result.append({
+            'id': i,
+            'url': 'https://%s/rss.xml' % host,
+            'title': words(rnd, 3).title(),
+            'faviconLink': 'https://%s/favicon.ico' % host,
+            'added': BASE_TIME + i * 60,
+            'folderId': rnd.randint(0, folder_count),
+            'unreadCount': 0,
+            'ordering': 0,
+            'link': 'https://%s/' % host,
+            'pinned': False,
+            'updateErrorCount': 0,
+            'lastUpdateError': None,
+        })
+    return result
+
+
+def item(seed, item_id, feed_count, last_modified):
+    # every item has its own generator so that updated items keep their base data
+    rnd = random.Random(seed * 1000003 + item_id)
+    feed_id = rnd.randint(1, feed_count)
+    guid = 'https://feed%d.example.com/?p=%d' % (feed_id, item_id)
+    has_enclosure = rnd.random() < 0.05
+    return {
+        'id': item_id,
+        'guid': guid,
+        'guidHash': hashlib.md5(guid.encode('utf-8')).hexdigest(),
+        'url': guid,
+        'title': words(rnd, rnd.randint(3, 12)).capitalize(),
+        'author': words(rnd, 2).title(),
+        'pubDate': BASE_TIME + item_id * 37,
+        'body': body(rnd),
+        'enclosureMime': 'audio/mpeg' if has_enclosure else None,
+        'enclosureLink': ('https://feed%d.example.com/%d.mp3' % (feed_id, item_id)) if has_enclosure else None,
+        'feedId': feed_id,
+        'unread': rnd.random() < 0.3,
+        'starred': rnd.random() < 0.02,
+        'lastModified': last_modified,
+        'fingerprint': hashlib.md5(('%d-%d' % (item_id, last_modified)).encode('utf-8')).hexdigest(),
+    }
+
+
+def write_items(path, items):
+    # stream the items to keep the memory usage low for big data sets
+    with open(path, 'w', encoding='utf-8') as f:
+        f.write('{"items":[')
+        first = True
+        for i in items:
+            if not first:
+                f.write(',')
+            json.dump(i, f, ensure_ascii=False, separators=(',', ':'))
+            first = False
+        f.write(']}')
+
+
+def write_item_pages(outdir, items, page_size):
+    page = []
+    number = 0
+    for i in items:
+        page.append(i)
+        if len(page) == page_size:
+            number += 1
+            write_items(os.path.join(outdir, 'items-%04d.json' % number), page)
+            page = []
+    if page:
+        number += 1
+        write_items(os.path.join(outdir, 'items-%04d.json' % number), page)
+    return number
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generates a deterministic synthetic News App data set.')
+    parser.add_argument('size', choices=sorted(SIZES.keys()), help='number of items to generate')
+    parser.add_argument('outdir', help='directory the JSON files will be written to')
+    parser.add_argument('--seed', type=int, default=1, help='seed for the random number generator (default: 1)')
+    parser.add_argument('--update-ratio', type=float, default=0.05,
+                        help='ratio of items that will be changed or added in items-update.json (default: 0.05)')
+    parser.add_argument('--page-size', type=int, default=0,
+                        help='split the initial items into pages of this size, 0 writes a single items.json (default: 0)')
+    args = parser.parse_args()
+
+    item_count = SIZES[args.size]
+    feed_count = max(10, item_count // 500)
+    folder_count = max(3, feed_count // 20)
+
+    os.makedirs(args.outdir, exist_ok=True)
+
+    rnd = random.Random(args.seed)
+
+    with open(os.path.join(args.outdir, 'folders.json'), 'w', encoding='utf-8') as f:
+        json.dump({'folders': folders(rnd, folder_count)}, f, separators=(',', ':'))
+
+    with open(os.path.join(args.outdir, 'feeds.json'), 'w', encoding='utf-8') as f:
+        json.dump({'feeds': feeds(rnd, feed_count, folder_count), 'starredCount': 0, 'newestItemId': item_count}, f,
+                  separators=(',', ':'))
+
+    if args.page_size > 0:
+        # newest items first, like the pages requested by the Synchronizer
+        write_item_pages(args.outdir, (item(args.seed, i, feed_count, BASE_TIME + i * 37) for i in range(item_count, 0, -1)),
+                         args.page_size)
+    else:
+        write_items(os.path.join(args.outdir, 'items.json'),
+                    (item(args.seed, i, feed_count, BASE_TIME + i * 37) for i in range(1, item_count + 1)))
+
+    # the incremental update changes existing items and adds new ones with a newer lastModified time
+    update_count = max(1, int(item_count * args.update_ratio))
+    changed = sorted(rnd.sample(range(1, item_count + 1), update_count // 2))
+    added = range(item_count + 1, item_count + 1 + update_count - len(changed))
+    last_modified = BASE_TIME + (item_count + 1) * 37
+
+    def updates():
+        for i in changed:
+            # changed items toggle their unread state like it happens when reading on another device
+            u = item(args.seed, i, feed_count, last_modified)
+            u['unread'] = not u['unread']
+            yield u
+        for i in added:
+            yield item(args.seed, i, feed_count, last_modified)
+
+    write_items(os.path.join(args.outdir, 'items-update.json'), updates())
+
+    sys.stdout.write('Generated %d folders, %d feeds, %d items and %d updated items in %s\n'
+                     % (folder_count, feed_count, item_count, update_count, args.outdir))
+
+
+if __name__ == '__main__':
+    main()
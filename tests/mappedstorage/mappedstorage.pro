@@ -0,0 +1,21 @@
+TARGET = tst_mappedstorage
+TEMPLATE = app
+
+QT += network sql testlib
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += c++11
+CONFIG += no_keywords
+CONFIG += testcase
+
+# the directory containing libfuoten, defaults to the Qt library directory
+isEmpty(FUOTEN_LIB_DIR): FUOTEN_LIB_DIR = $$[QT_INSTALL_LIBS]
+
+INCLUDEPATH += $$PWD/../..
+LIBS += -L$${FUOTEN_LIB_DIR} -lfuoten
+QMAKE_RPATHDIR += $${FUOTEN_LIB_DIR}
+
+SOURCES += \
+    tst_mappedstorage.cpp
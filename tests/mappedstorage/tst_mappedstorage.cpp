@@ -0,0 +1,253 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QScopedPointer>
+#include <Fuoten/Storage/MappedStorage>
+#include <Fuoten/Article>
+
+using namespace Fuoten;
+
+static const int itemCount = 100;
+static const int recordSize = 176;
+static const int headerSize = 16;
+
+
+/*
+ * Tests the persistence of MappedStorage: replaying the journal on load,
+ * recovering from partially written records and compacting the segments.
+ */
+class MappedStorageTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void journalReplay();
+    void truncatedRecord();
+    void compaction();
+    void staleSegments();
+
+private:
+    MappedStorage *openStorage();
+    void fill(MappedStorage *storage);
+    void verifyItems(MappedStorage *storage, const QSet<qint64> &readItems);
+    QString path(const QString &fileName) const;
+
+    QScopedPointer<QTemporaryDir> m_dir;
+};
+
+
+void MappedStorageTest::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+}
+
+
+void MappedStorageTest::cleanup()
+{
+    m_dir.reset();
+}
+
+
+QString MappedStorageTest::path(const QString &fileName) const
+{
+    return QDir(m_dir->path()).absoluteFilePath(fileName);
+}
+
+
+MappedStorage *MappedStorageTest::openStorage()
+{
+    MappedStorage *storage = new MappedStorage(m_dir->path(), this);
+    storage->init();
+    return storage;
+}
+
+
+void MappedStorageTest::fill(MappedStorage *storage)
+{
+    FolderRecord folder;
+    folder.id = 1;
+    folder.name = QStringLiteral("Folder");
+    storage->foldersRequested(FolderRecords({folder}));
+
+    FeedRecord feed;
+    feed.id = 1;
+    feed.folderId = 1;
+    feed.title = QStringLiteral("Feed");
+    storage->feedsRequested(FeedRecords({feed}));
+
+    ItemRecords items;
+    for (int n = 1; n <= itemCount; ++n) {
+        ItemRecord i;
+        i.id = n;
+        i.feedId = 1;
+        i.guid = QStringLiteral("guid-%1").arg(n);
+        i.guidHash = QStringLiteral("hash-%1").arg(n);
+        i.title = QStringLiteral("Title %1").arg(n);
+        i.body = QStringLiteral("<p>Body of item %1</p>").arg(n);
+        i.pubDate = 1500000000 + n;
+        i.lastModified = 1500000000 + n;
+        i.unread = true;
+        items.append(i);
+    }
+
+    QSignalSpy spy(storage, &AbstractStorage::requestedItems);
+    storage->itemsRequested(items);
+    QVERIFY(!spy.isEmpty() || spy.wait());
+}
+
+
+/*
+ * Verifies that all items are there with their strings and that only the
+ * items in readItems are marked as read.
+ */
+void MappedStorageTest::verifyItems(MappedStorage *storage, const QSet<qint64> &readItems)
+{
+    QueryArgs args;
+    args.bodyLimit = 0;
+
+    const QList<Article*> articles = storage->getArticles(args);
+    QCOMPARE(articles.size(), itemCount);
+
+    for (Article *a : articles) {
+        QCOMPARE(a->title(), QStringLiteral("Title %1").arg(a->id()));
+        QCOMPARE(a->body(), QStringLiteral("<p>Body of item %1</p>").arg(a->id()));
+        QCOMPARE(a->unread(), !readItems.contains(a->id()));
+    }
+
+    qDeleteAll(articles);
+
+    QCOMPARE(static_cast<int>(storage->totalUnread()), itemCount - readItems.size());
+}
+
+
+void MappedStorageTest::journalReplay()
+{
+    {
+        QScopedPointer<MappedStorage> storage(openStorage());
+        QVERIFY(storage->ready());
+        fill(storage.data());
+        storage->itemsMarked(IdList({1, 2, 3}), false);
+        storage->itemMarked(2, true);
+    }
+
+    QScopedPointer<MappedStorage> storage(openStorage());
+    QVERIFY(storage->ready());
+    verifyItems(storage.data(), QSet<qint64>({1, 3}));
+}
+
+
+void MappedStorageTest::truncatedRecord()
+{
+    {
+        QScopedPointer<MappedStorage> storage(openStorage());
+        fill(storage.data());
+        storage->itemMarked(5, false);
+    }
+
+    // a record that has only been written partially when the application stopped
+    QFile items(path(QStringLiteral("items.seg")));
+    QVERIFY(items.open(QIODevice::Append));
+    QVERIFY(items.write(QByteArray(recordSize / 2, '\xff')) == recordSize / 2);
+    items.close();
+
+    QScopedPointer<MappedStorage> storage(openStorage());
+    QVERIFY(storage->ready());
+    verifyItems(storage.data(), QSet<qint64>({5}));
+
+    // the incomplete record has been dropped
+    QCOMPARE((QFileInfo(path(QStringLiteral("items.seg"))).size() - headerSize) % recordSize, static_cast<qint64>(0));
+}
+
+
+void MappedStorageTest::compaction()
+{
+    IdList ids;
+    for (int n = 1; n <= itemCount; ++n) {
+        ids.append(n);
+    }
+
+    {
+        QScopedPointer<MappedStorage> storage(openStorage());
+        fill(storage.data());
+
+        // every round appends a record per item, the segments are compacted once
+        // there are more than 1024 records and more than twice as many as items
+        for (int round = 0; round < 12; ++round) {
+            storage->itemsMarked(ids, (round % 2) == 1);
+        }
+
+        // changed while the compaction might still be running
+        storage->itemMarked(7, false);
+
+        QTRY_VERIFY_WITH_TIMEOUT(QFile::exists(path(QStringLiteral("segments.dat"))), 30000);
+        QTRY_VERIFY(!QFile::exists(path(QStringLiteral("items.seg"))));
+
+        QVERIFY(QFile::exists(path(QStringLiteral("items.1.seg"))));
+        QVERIFY(QFile::exists(path(QStringLiteral("blobs.1.seg"))));
+        QVERIFY(!QFile::exists(path(QStringLiteral("blobs.seg"))));
+
+        // one record per item, plus the records written after the snapshot has been taken
+        const qint64 records = (QFileInfo(path(QStringLiteral("items.1.seg"))).size() - headerSize) / recordSize;
+        QVERIFY(records >= itemCount);
+        QVERIFY(records < 4 * itemCount);
+
+        verifyItems(storage.data(), QSet<qint64>({7}));
+    }
+
+    QScopedPointer<MappedStorage> storage(openStorage());
+    QVERIFY(storage->ready());
+    verifyItems(storage.data(), QSet<qint64>({7}));
+}
+
+
+void MappedStorageTest::staleSegments()
+{
+    {
+        QScopedPointer<MappedStorage> storage(openStorage());
+        fill(storage.data());
+    }
+
+    // segments of a compaction that has been interrupted before it recorded the new generation
+    for (const QString &fileName : {QStringLiteral("items.1.seg"), QStringLiteral("blobs.1.seg")}) {
+        QFile f(path(fileName));
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        QVERIFY(f.write(QByteArray(headerSize + recordSize, '\0')) > 0);
+    }
+
+    QScopedPointer<MappedStorage> storage(openStorage());
+    QVERIFY(storage->ready());
+    verifyItems(storage.data(), QSet<qint64>());
+
+    QVERIFY(QFile::exists(path(QStringLiteral("items.seg"))));
+    QVERIFY(!QFile::exists(path(QStringLiteral("items.1.seg"))));
+    QVERIFY(!QFile::exists(path(QStringLiteral("blobs.1.seg"))));
+}
+
+
+QTEST_GUILESS_MAIN(MappedStorageTest)
+
+#include "tst_mappedstorage.moc"
@@ -0,0 +1,354 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QScopedPointer>
+#include <Fuoten/Storage/MemoryStorage>
+#include <Fuoten/Article>
+#include <algorithm>
+
+using namespace Fuoten;
+
+static const int itemCount = 30;
+
+
+/*
+ * Tests the queries of MemoryStorage: sorting by the different roles,
+ * filtering, limiting the result and keeping the sorted indexes up to
+ * date after the items changed.
+ */
+class MemoryStorageTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void sorting_data();
+    void sorting();
+    void filters();
+    void limit_data();
+    void limit();
+    void indexUpdates();
+
+private:
+    static ItemRecord item(int n);
+    IdList query(const QueryArgs &args);
+    IdList expected(const ItemRecords &items, const QueryArgs &args) const;
+    void store(const ItemRecords &items);
+
+    QScopedPointer<MemoryStorage> m_storage;
+    ItemRecords m_items;
+};
+
+
+/*
+ * Three feeds in two folders. Two items always share their publication
+ * date, so the sort order of equal values is covered, too.
+ */
+ItemRecord MemoryStorageTest::item(int n)
+{
+    ItemRecord i;
+    i.id = n;
+    i.feedId = (n % 3) + 1;
+    i.guid = QStringLiteral("guid-%1").arg(n);
+    i.guidHash = QStringLiteral("hash-%1").arg(n);
+    i.title = QStringLiteral("Title %1").arg((n * 11) % itemCount, 2, 10, QLatin1Char('0'));
+    i.pubDate = 1500000000 + ((n * 7) % itemCount) / 2;
+    i.lastModified = 1500000000;
+    i.unread = (n % 2) == 0;
+    i.starred = (n % 5) == 0;
+    return i;
+}
+
+
+void MemoryStorageTest::init()
+{
+    m_storage.reset(new MemoryStorage);
+    m_storage->init();
+    QVERIFY(m_storage->ready());
+
+    FolderRecords folders;
+    for (int n = 1; n <= 2; ++n) {
+        FolderRecord f;
+        f.id = n;
+        f.name = QStringLiteral("Folder %1").arg(n);
+        folders.append(f);
+    }
+    m_storage->foldersRequested(folders);
+
+    FeedRecords feeds;
+    for (int n = 1; n <= 3; ++n) {
+        FeedRecord f;
+        f.id = n;
+        f.folderId = (n == 3) ? 2 : 1;
+        f.title = QStringLiteral("Feed %1").arg(n);
+        feeds.append(f);
+    }
+    m_storage->feedsRequested(feeds);
+
+    m_items.clear();
+    for (int n = 1; n <= itemCount; ++n) {
+        m_items.append(item(n));
+    }
+    store(m_items);
+}
+
+
+void MemoryStorageTest::cleanup()
+{
+    m_storage.reset();
+}
+
+
+void MemoryStorageTest::store(const ItemRecords &items)
+{
+    QSignalSpy spy(m_storage.data(), &AbstractStorage::requestedItems);
+    m_storage->itemsRequested(items);
+    QCOMPARE(spy.count(), 1);
+}
+
+
+IdList MemoryStorageTest::query(const QueryArgs &args)
+{
+    const QList<Article*> articles = m_storage->getArticles(args);
+    IdList ids;
+    for (Article *a : articles) {
+        ids.append(a->id());
+    }
+    qDeleteAll(articles);
+    return ids;
+}
+
+
+/*
+ * Filters and sorts the records like the storage is expected to do it.
+ * Equal values are sorted by ID in the requested direction.
+ */
+IdList MemoryStorageTest::expected(const ItemRecords &items, const QueryArgs &args) const
+{
+    ItemRecords result;
+    for (const ItemRecord &i : items) {
+        const qint64 folderId = (i.feedId == 3) ? 2 : 1;
+        if ((args.parentIdType == FuotenEnums::Feed) && (args.parentId > -1) && (i.feedId != args.parentId)) {
+            continue;
+        }
+        if ((args.parentIdType == FuotenEnums::Folder) && (args.parentId > -1) && (folderId != args.parentId)) {
+            continue;
+        }
+        if ((args.unreadOnly && !i.unread) || (args.starredOnly && !i.starred)) {
+            continue;
+        }
+        result.append(i);
+    }
+
+    const FuotenEnums::SortingRole role = args.sortingRole;
+    std::sort(result.begin(), result.end(), [role] (const ItemRecord &a, const ItemRecord &b) {
+        if ((role == FuotenEnums::Name) && (a.title != b.title)) {
+            return a.title < b.title;
+        }
+        if ((role == FuotenEnums::Time) && (a.pubDate != b.pubDate)) {
+            return a.pubDate < b.pubDate;
+        }
+        return a.id < b.id;
+    });
+
+    if (args.sortOrder == Qt::DescendingOrder) {
+        std::reverse(result.begin(), result.end());
+    }
+
+    if ((args.limit > 0) && (result.size() > args.limit)) {
+        result = result.mid(0, args.limit);
+    }
+
+    IdList ids;
+    for (const ItemRecord &i : qAsConst(result)) {
+        ids.append(i.id);
+    }
+    return ids;
+}
+
+
+void MemoryStorageTest::sorting_data()
+{
+    QTest::addColumn<int>("role");
+    QTest::addColumn<bool>("descending");
+    QTest::addColumn<qint64>("feedId");
+
+    // all items use the sorted indexes, the items of a feed are sorted on every query
+    QTest::newRow("id-asc") << static_cast<int>(FuotenEnums::ID) << false << static_cast<qint64>(-1);
+    QTest::newRow("id-desc") << static_cast<int>(FuotenEnums::ID) << true << static_cast<qint64>(-1);
+    QTest::newRow("time-asc") << static_cast<int>(FuotenEnums::Time) << false << static_cast<qint64>(-1);
+    QTest::newRow("time-desc") << static_cast<int>(FuotenEnums::Time) << true << static_cast<qint64>(-1);
+    QTest::newRow("name-asc") << static_cast<int>(FuotenEnums::Name) << false << static_cast<qint64>(-1);
+    QTest::newRow("name-desc") << static_cast<int>(FuotenEnums::Name) << true << static_cast<qint64>(-1);
+    QTest::newRow("feed-time-asc") << static_cast<int>(FuotenEnums::Time) << false << static_cast<qint64>(2);
+    QTest::newRow("feed-time-desc") << static_cast<int>(FuotenEnums::Time) << true << static_cast<qint64>(2);
+    QTest::newRow("feed-name-asc") << static_cast<int>(FuotenEnums::Name) << false << static_cast<qint64>(2);
+}
+
+
+void MemoryStorageTest::sorting()
+{
+    QFETCH(int, role);
+    QFETCH(bool, descending);
+    QFETCH(qint64, feedId);
+
+    QueryArgs args;
+    args.sortingRole = static_cast<FuotenEnums::SortingRole>(role);
+    args.sortOrder = descending ? Qt::DescendingOrder : Qt::AscendingOrder;
+    if (feedId > -1) {
+        args.parentId = feedId;
+        args.parentIdType = FuotenEnums::Feed;
+    }
+
+    const IdList ids = query(args);
+    QCOMPARE(ids, expected(m_items, args));
+    QCOMPARE(ids.size(), (feedId > -1) ? (itemCount / 3) : itemCount);
+}
+
+
+void MemoryStorageTest::filters()
+{
+    QueryArgs args;
+    args.sortingRole = FuotenEnums::Time;
+
+    args.parentId = 2;
+    args.parentIdType = FuotenEnums::Folder;
+    QCOMPARE(query(args), expected(m_items, args));
+
+    args.unreadOnly = true;
+    QCOMPARE(query(args), expected(m_items, args));
+
+    args = QueryArgs();
+    args.starredOnly = true;
+    const IdList starred = query(args);
+    QCOMPARE(starred, expected(m_items, args));
+    QCOMPARE(starred.size(), itemCount / 5);
+
+    // the ID list restricts the result, unknown IDs are ignored
+    args = QueryArgs();
+    args.inIds = IdList({3, 9, 27, 1000});
+    args.inIdsType = FuotenEnums::Item;
+    args.sortOrder = Qt::DescendingOrder;
+    QCOMPARE(query(args), IdList({27, 9, 3}));
+}
+
+
+void MemoryStorageTest::limit_data()
+{
+    QTest::addColumn<int>("role");
+    QTest::addColumn<qint64>("feedId");
+    QTest::addColumn<int>("limit");
+
+    QTest::newRow("index-time-5") << static_cast<int>(FuotenEnums::Time) << static_cast<qint64>(-1) << 5;
+    QTest::newRow("index-name-1") << static_cast<int>(FuotenEnums::Name) << static_cast<qint64>(-1) << 1;
+    QTest::newRow("index-more-than-items") << static_cast<int>(FuotenEnums::ID) << static_cast<qint64>(-1) << (itemCount + 10);
+    QTest::newRow("feed-time-3") << static_cast<int>(FuotenEnums::Time) << static_cast<qint64>(1) << 3;
+    QTest::newRow("feed-more-than-items") << static_cast<int>(FuotenEnums::Time) << static_cast<qint64>(1) << itemCount;
+}
+
+
+void MemoryStorageTest::limit()
+{
+    QFETCH(int, role);
+    QFETCH(qint64, feedId);
+    QFETCH(int, limit);
+
+    for (Qt::SortOrder order : {Qt::AscendingOrder, Qt::DescendingOrder}) {
+        QueryArgs args;
+        args.sortingRole = static_cast<FuotenEnums::SortingRole>(role);
+        args.sortOrder = order;
+        args.limit = limit;
+        if (feedId > -1) {
+            args.parentId = feedId;
+            args.parentIdType = FuotenEnums::Feed;
+        }
+
+        // the limited result is the start of the complete result
+        const IdList ids = query(args);
+        QCOMPARE(ids, expected(m_items, args));
+
+        args.limit = 0;
+        QCOMPARE(ids, query(args).mid(0, limit));
+    }
+}
+
+
+void MemoryStorageTest::indexUpdates()
+{
+    QueryArgs byTime;
+    byTime.sortingRole = FuotenEnums::Time;
+    QueryArgs byName;
+    byName.sortingRole = FuotenEnums::Name;
+
+    // builds the sorted indexes
+    QCOMPARE(query(byTime), expected(m_items, byTime));
+
+    // new items and items whose sort keys changed are merged into the indexes
+    ItemRecords changed;
+    for (int n = itemCount + 1; n <= itemCount + 5; ++n) {
+        changed.append(item(n));
+    }
+    for (int n : {4, 17}) {
+        ItemRecord i = item(n);
+        i.title = QStringLiteral("Changed %1").arg(n);
+        i.pubDate = 1400000000 + n;
+        i.lastModified = 1500000001;
+        changed.append(i);
+    }
+    store(changed);
+
+    for (const ItemRecord &c : qAsConst(changed)) {
+        bool replaced = false;
+        for (ItemRecord &i : m_items) {
+            if (i.id == c.id) {
+                i = c;
+                replaced = true;
+            }
+        }
+        if (!replaced) {
+            m_items.append(c);
+        }
+    }
+
+    QCOMPARE(query(byTime), expected(m_items, byTime));
+    QCOMPARE(query(byName), expected(m_items, byName));
+
+    // the items of a deleted feed are removed from the indexes
+    m_storage->feedDeleted(2);
+
+    ItemRecords remaining;
+    for (const ItemRecord &i : qAsConst(m_items)) {
+        if (i.feedId != 2) {
+            remaining.append(i);
+        }
+    }
+
+    QCOMPARE(query(byTime), expected(remaining, byTime));
+    QCOMPARE(query(byName), expected(remaining, byName));
+    byName.sortOrder = Qt::DescendingOrder;
+    byName.limit = 4;
+    QCOMPARE(query(byName), expected(remaining, byName));
+}
+
+
+QTEST_GUILESS_MAIN(MemoryStorageTest)
+
+#include "tst_memorystorage.moc"
@@ -0,0 +1,745 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <Fuoten/Storage/SQLiteStorage>
+#include <Fuoten/Storage/MemoryStorage>
+#include <Fuoten/Storage/MappedStorage>
+#include <Fuoten/Helpers/FastJsonDecoder>
+#include <Fuoten/Article>
+
+using namespace Fuoten;
+
+// storing a big data set can take a long time, especially on slow flash storage
+static const int waitTimeout = 60 * 60 * 1000;
+
+
+/*
+ * Returns the peak resident set size of the process in KiB, or -1 if it is
+ * not available on this platform.
+ */
+static qint64 peakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile f(QStringLiteral("/proc/self/status"));
+    if (f.open(QIODevice::ReadOnly|QIODevice::Text)) {
+        const QList<QByteArray> lines = f.readAll().split('\n');
+        for (const QByteArray &line : lines) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+#endif
+    return -1;
+}
+
+
+/*
+ * Resets the peak resident set size, so that every benchmark gets its own
+ * value. Requires Linux 4.0 or newer.
+ */
+static void resetPeakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile f(QStringLiteral("/proc/self/clear_refs"));
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write("5");
+    }
+#endif
+}
+
+
+static QByteArray readFile(const QString &path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return f.readAll();
+}
+
+
+static void reportThroughput(const char *unit, qint64 count, qint64 nsecs)
+{
+    if (nsecs > 0) {
+        qInfo("Throughput: %lli %s in %.1f ms, %.0f %s/s", count, unit, nsecs / 1000000.0, count * 1000000000.0 / nsecs, unit);
+    }
+}
+
+
+/*
+ * Benchmarks the storage functions used by a synchronization with a data set
+ * written by scripts/gendataset.py. The directory of the data set is read from
+ * the FUOTEN_DATASET environment variable, the storage implementation from
+ * FUOTEN_BENCH_STORAGE, that can be sqlite (default), memory or mapped.
+ *
+ * The benchmarks build on each other in the order they are declared, if a
+ * single benchmark is run, the data it needs is stored first without being
+ * measured.
+ */
+class StorageBench : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    void foldersRequested();
+    void feedsRequested();
+    void itemsRequestedInitial();
+    void itemsRequestedIncremental();
+    void coldStart_data();
+    void coldStart();
+    void getArticles_data();
+    void getArticles();
+    void enqueueItem();
+    void enqueueMarkFeedRead();
+    void enqueueMarkFolderRead();
+    void enqueueMarkAllItemsRead();
+    void clearQueue();
+
+private:
+    enum Stage : quint8 {
+        Empty,
+        Folders,
+        Feeds,
+        Items,
+        UpdatedItems
+    };
+
+    enum ArticleQuery : quint8 {
+        AllArticles,
+        FullBodies,
+        StrippedBodies,
+        UnreadOnly,
+        StarredOnly,
+        ByFeed,
+        ByFolder,
+        InFeeds,
+        InItems,
+        QueuedOnly,
+        NewestFirst
+    };
+
+    AbstractStorage *createStorage();
+    bool initStorage(AbstractStorage *storage);
+    void prepare(Stage stage);
+    bool storeFolders();
+    bool storeFeeds();
+    bool storeItems(const QVector<ItemRecords> &pages);
+    bool waitForIdle();
+    QueryArgs queryArgs(int query) const;
+    int countArticles(const QueryArgs &args);
+
+    QTemporaryDir m_tmpDir;
+    QString m_storageType;
+    FolderRecords m_folders;
+    FeedRecords m_feeds;
+    QVector<ItemRecords> m_itemPages;
+    ItemRecords m_updatedItems;
+    qint64 m_itemCount = 0;
+    qint64 m_feedId = 0;
+    qint64 m_folderId = 0;
+    AbstractStorage *m_storage = nullptr;
+    Stage m_stage = Empty;
+};
+
+
+void StorageBench::initTestCase()
+{
+    const QString dataset = QString::fromLocal8Bit(qgetenv("FUOTEN_DATASET"));
+    if (dataset.isEmpty()) {
+        QSKIP("Set FUOTEN_DATASET to a directory written by scripts/gendataset.py.");
+    }
+
+    m_storageType = QString::fromLocal8Bit(qgetenv("FUOTEN_BENCH_STORAGE"));
+    if (m_storageType.isEmpty()) {
+        m_storageType = QStringLiteral("sqlite");
+    }
+
+    QVERIFY(m_tmpDir.isValid());
+
+    // the data set is decoded like the API classes do it, so that only the storage is measured
+    const QDir dir(dataset);
+    FastJsonDecoder decoder;
+    QString error;
+
+    QVERIFY2(decoder.decodeFolders(readFile(dir.filePath(QStringLiteral("folders.json"))), &m_folders, &error), qUtf8Printable(error));
+    QVERIFY2(decoder.decodeFeeds(readFile(dir.filePath(QStringLiteral("feeds.json"))), &m_feeds, &error), qUtf8Printable(error));
+
+    // big data sets are split into the pages of a paged synchronization
+    QStringList itemFiles = dir.entryList({QStringLiteral("items-[0-9]*.json")}, QDir::Files, QDir::Name);
+    if (itemFiles.isEmpty()) {
+        itemFiles.append(QStringLiteral("items.json"));
+    }
+
+    for (const QString &file : qAsConst(itemFiles)) {
+        ItemRecords page;
+        QVERIFY2(decoder.decodeItems(readFile(dir.filePath(file)), &page, &error), qUtf8Printable(error));
+        m_itemCount += page.size();
+        m_itemPages.append(page);
+    }
+
+    QVERIFY2(decoder.decodeItems(readFile(dir.filePath(QStringLiteral("items-update.json"))), &m_updatedItems, &error), qUtf8Printable(error));
+
+    QVERIFY(!m_folders.isEmpty());
+    QVERIFY(!m_feeds.isEmpty());
+    QVERIFY(m_itemCount > 0);
+
+    // the feed and folder queries use the feed of the newest item, so that they are not empty
+    m_feedId = m_itemPages.first().first().feedId;
+    for (const FeedRecord &feed : qAsConst(m_feeds)) {
+        if (feed.id == m_feedId) {
+            m_folderId = feed.folderId;
+            break;
+        }
+    }
+
+    qInfo("Data set: %i folders, %i feeds, %lli items in %i pages, %i updated items", m_folders.size(), m_feeds.size(), m_itemCount, m_itemPages.size(), m_updatedItems.size());
+
+    m_storage = createStorage();
+    QVERIFY(initStorage(m_storage));
+
+    qInfo("Storage: %s", m_storage->metaObject()->className());
+}
+
+
+void StorageBench::cleanupTestCase()
+{
+    delete m_storage;
+    m_storage = nullptr;
+}
+
+
+void StorageBench::init()
+{
+    resetPeakMemory();
+}
+
+
+void StorageBench::cleanup()
+{
+    qInfo("Peak RSS: %lli KiB", peakMemory());
+}
+
+
+AbstractStorage *StorageBench::createStorage()
+{
+    if (m_storageType == QLatin1String("memory")) {
+        return new MemoryStorage(this);
+    } else if (m_storageType == QLatin1String("mapped")) {
+        return new MappedStorage(m_tmpDir.filePath(QStringLiteral("mapped")), this);
+    } else {
+        return new SQLiteStorage(m_tmpDir.filePath(QStringLiteral("fuoten.sqlite")), this);
+    }
+}
+
+
+bool StorageBench::initStorage(AbstractStorage *storage)
+{
+    QSignalSpy spy(storage, &AbstractStorage::readyChanged);
+    storage->init();
+    return storage->ready() || spy.wait(waitTimeout);
+}
+
+
+/*
+ * Stores the data needed by a benchmark that has not been stored by the
+ * previous benchmarks yet.
+ */
+void StorageBench::prepare(Stage stage)
+{
+    if ((stage >= Folders) && (m_stage < Folders)) {
+        QVERIFY(storeFolders());
+        m_stage = Folders;
+    }
+
+    if ((stage >= Feeds) && (m_stage < Feeds)) {
+        QVERIFY(storeFeeds());
+        m_stage = Feeds;
+    }
+
+    if ((stage >= Items) && (m_stage < Items)) {
+        QVERIFY(storeItems(m_itemPages));
+        m_stage = Items;
+    }
+
+    if ((stage >= UpdatedItems) && (m_stage < UpdatedItems)) {
+        QVERIFY(storeItems({m_updatedItems}));
+        m_stage = UpdatedItems;
+    }
+}
+
+
+bool StorageBench::storeFolders()
+{
+    QSignalSpy spy(m_storage, &AbstractStorage::requestedFolders);
+    m_storage->foldersRequested(m_folders);
+    return !spy.isEmpty() || spy.wait(waitTimeout);
+}
+
+
+bool StorageBench::storeFeeds()
+{
+    QSignalSpy spy(m_storage, &AbstractStorage::requestedFeeds);
+    m_storage->feedsRequested(m_feeds);
+    return !spy.isEmpty() || spy.wait(waitTimeout);
+}
+
+
+/*
+ * Stores the pages like the Synchronizer does it and waits until the deferred
+ * item maintenance after the last page has been finished.
+ */
+bool StorageBench::storeItems(const QVector<ItemRecords> &pages)
+{
+    QSignalSpy spy(m_storage, &AbstractStorage::itemsBatchStored);
+
+    m_storage->deferItemsMaintenance(true);
+    for (const ItemRecords &page : pages) {
+        m_storage->itemsRequested(page, m_storage->createBatchToken());
+    }
+    const quint64 finished = m_storage->createBatchToken();
+    m_storage->deferItemsMaintenance(false, finished);
+
+    while (spy.isEmpty() || (spy.last().first().toULongLong() != finished)) {
+        if (!spy.wait(waitTimeout)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool StorageBench::waitForIdle()
+{
+    while (m_storage->inOperation()) {
+        QSignalSpy spy(m_storage, &AbstractStorage::inOperationChanged);
+        if (!spy.wait(waitTimeout)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+QueryArgs StorageBench::queryArgs(int query) const
+{
+    QueryArgs args;
+
+    switch (query) {
+    case FullBodies:
+        args.bodyLimit = 0;
+        args.limit = 100;
+        break;
+    case StrippedBodies:
+        args.bodyLimit = 250;
+        args.limit = 100;
+        break;
+    case UnreadOnly:
+        args.unreadOnly = true;
+        break;
+    case StarredOnly:
+        args.starredOnly = true;
+        break;
+    case ByFeed:
+        args.parentId = m_feedId;
+        args.parentIdType = FuotenEnums::Feed;
+        break;
+    case ByFolder:
+        args.parentId = m_folderId;
+        args.parentIdType = FuotenEnums::Folder;
+        break;
+    case InFeeds:
+        for (int i = 0; (i < m_feeds.size()) && (i < 10); ++i) {
+            args.inIds.append(m_feeds.at(i).id);
+        }
+        args.inIdsType = FuotenEnums::Feed;
+        break;
+    case InItems:
+    {
+        const ItemRecords &page = m_itemPages.first();
+        for (int i = 0; (i < page.size()) && (i < 100); ++i) {
+            args.inIds.append(page.at(i).id);
+        }
+        args.inIdsType = FuotenEnums::Item;
+        args.bodyLimit = 0;
+        break;
+    }
+    case QueuedOnly:
+        args.queuedOnly = true;
+        break;
+    case NewestFirst:
+        args.sortingRole = FuotenEnums::Time;
+        args.sortOrder = Qt::DescendingOrder;
+        args.limit = 50;
+        break;
+    default:
+        break;
+    }
+
+    return args;
+}
+
+
+int StorageBench::countArticles(const QueryArgs &args)
+{
+    const QList<Article*> articles = m_storage->getArticles(args);
+    const int count = articles.size();
+    qDeleteAll(articles);
+    return count;
+}
+
+
+void StorageBench::foldersRequested()
+{
+    QElapsedTimer timer;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        QVERIFY(storeFolders());
+    }
+
+    reportThroughput("folders", m_folders.size(), timer.nsecsElapsed());
+
+    if (m_stage < Folders) {
+        m_stage = Folders;
+    }
+}
+
+
+void StorageBench::feedsRequested()
+{
+    prepare(Folders);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        QVERIFY(storeFeeds());
+    }
+
+    reportThroughput("feeds", m_feeds.size(), timer.nsecsElapsed());
+
+    if (m_stage < Feeds) {
+        m_stage = Feeds;
+    }
+}
+
+
+void StorageBench::itemsRequestedInitial()
+{
+    prepare(Feeds);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        QVERIFY(storeItems(m_itemPages));
+    }
+
+    reportThroughput("items", m_itemCount, timer.nsecsElapsed());
+
+    if (m_stage < Items) {
+        m_stage = Items;
+    }
+}
+
+
+void StorageBench::itemsRequestedIncremental()
+{
+    prepare(Items);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        QVERIFY(storeItems({m_updatedItems}));
+    }
+
+    reportThroughput("items", m_updatedItems.size(), timer.nsecsElapsed());
+
+    m_stage = UpdatedItems;
+}
+
+
+/*
+ * Measures the initialization of a storage that already contains the data
+ * set. With dirty counters the SQLite storage has to count the items again,
+ * like after the application stopped while storing items.
+ */
+void StorageBench::coldStart_data()
+{
+    QTest::addColumn<bool>("dirtyCounters");
+
+    QTest::newRow("clean counters") << false;
+    QTest::newRow("dirty counters") << true;
+}
+
+
+void StorageBench::coldStart()
+{
+    QFETCH(bool, dirtyCounters);
+
+    if (m_storageType == QLatin1String("memory")) {
+        QSKIP("The memory storage does not persist any data.");
+    }
+
+    if (dirtyCounters && (m_storageType != QLatin1String("sqlite"))) {
+        QSKIP("Only the SQLite storage persists the counters.");
+    }
+
+    prepare(UpdatedItems);
+    QVERIFY(waitForIdle());
+
+    delete m_storage;
+    m_storage = nullptr;
+
+    if (dirtyCounters) {
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("storagebench"));
+            db.setDatabaseName(m_tmpDir.filePath(QStringLiteral("fuoten.sqlite")));
+            QVERIFY(db.open());
+            QSqlQuery q(db);
+            QVERIFY(q.exec(QStringLiteral("UPDATE system SET value = '1' WHERE key = 'counters_dirty'")));
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(QStringLiteral("storagebench"));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK_ONCE {
+        m_storage = createStorage();
+        QVERIFY(initStorage(m_storage));
+    }
+
+    reportThroughput("items", m_itemCount, timer.nsecsElapsed());
+}
+
+
+void StorageBench::getArticles_data()
+{
+    QTest::addColumn<int>("query");
+
+    QTest::newRow("all") << static_cast<int>(AllArticles);
+    QTest::newRow("full bodies") << static_cast<int>(FullBodies);
+    QTest::newRow("stripped bodies") << static_cast<int>(StrippedBodies);
+    QTest::newRow("unread only") << static_cast<int>(UnreadOnly);
+    QTest::newRow("starred only") << static_cast<int>(StarredOnly);
+    QTest::newRow("by feed") << static_cast<int>(ByFeed);
+    QTest::newRow("by folder") << static_cast<int>(ByFolder);
+    QTest::newRow("in feeds") << static_cast<int>(InFeeds);
+    QTest::newRow("in items") << static_cast<int>(InItems);
+    QTest::newRow("queued only") << static_cast<int>(QueuedOnly);
+    QTest::newRow("newest first") << static_cast<int>(NewestFirst);
+}
+
+
+void StorageBench::getArticles()
+{
+    QFETCH(int, query);
+
+    prepare(UpdatedItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    const QueryArgs args = queryArgs(query);
+    QElapsedTimer timer;
+    qint64 nsecs = 0;
+    qint64 articles = 0;
+
+    QBENCHMARK {
+        timer.start();
+        const QList<Article*> result = m_storage->getArticles(args);
+        nsecs += timer.nsecsElapsed();
+        articles += result.size();
+        qDeleteAll(result);
+    }
+
+    reportThroughput("articles", articles, nsecs);
+}
+
+
+void StorageBench::enqueueItem()
+{
+    prepare(UpdatedItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QueryArgs args;
+    args.unreadOnly = true;
+    args.limit = 1000;
+    const QList<Article*> articles = m_storage->getArticles(args);
+    QVERIFY(!articles.isEmpty());
+
+    QElapsedTimer timer;
+    bool enqueued = true;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        for (Article *a : articles) {
+            enqueued &= m_storage->enqueueItem(FuotenEnums::MarkAsRead, a);
+        }
+    }
+
+    const qint64 nsecs = timer.nsecsElapsed();
+    qDeleteAll(articles);
+
+    QVERIFY(enqueued);
+    reportThroughput("items", articles.size(), nsecs);
+}
+
+
+void StorageBench::enqueueMarkFeedRead()
+{
+    prepare(UpdatedItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    const QueryArgs args = queryArgs(ByFeed);
+    const qint64 newestItemId = m_storage->getNewestItemId(FuotenEnums::Feed, args.parentId);
+    QVERIFY(newestItemId > 0);
+
+    QueryArgs unreadArgs = args;
+    unreadArgs.unreadOnly = true;
+    const int unread = countArticles(unreadArgs);
+
+    QElapsedTimer timer;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        QSignalSpy spy(m_storage, &AbstractStorage::markedReadFeedInQueue);
+        QVERIFY(m_storage->enqueueMarkFeedRead(args.parentId, newestItemId));
+        QVERIFY(!spy.isEmpty() || spy.wait(waitTimeout));
+    }
+
+    reportThroughput("items", unread, timer.nsecsElapsed());
+
+    QVERIFY(waitForIdle());
+}
+
+
+void StorageBench::enqueueMarkFolderRead()
+{
+    prepare(UpdatedItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    const QueryArgs args = queryArgs(ByFolder);
+    const qint64 newestItemId = m_storage->getNewestItemId(FuotenEnums::Folder, args.parentId);
+    QVERIFY(newestItemId > 0);
+
+    QueryArgs unreadArgs = args;
+    unreadArgs.unreadOnly = true;
+    const int unread = countArticles(unreadArgs);
+
+    QElapsedTimer timer;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        QSignalSpy spy(m_storage, &AbstractStorage::markedReadFolderInQueue);
+        QVERIFY(m_storage->enqueueMarkFolderRead(args.parentId, newestItemId));
+        QVERIFY(!spy.isEmpty() || spy.wait(waitTimeout));
+    }
+
+    reportThroughput("items", unread, timer.nsecsElapsed());
+
+    QVERIFY(waitForIdle());
+}
+
+
+void StorageBench::enqueueMarkAllItemsRead()
+{
+    prepare(UpdatedItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    const quint16 unread = m_storage->totalUnread();
+
+    QElapsedTimer timer;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        QSignalSpy spy(m_storage, &AbstractStorage::markedAllItemsReadInQueue);
+        QVERIFY(m_storage->enqueueMarkAllItemsRead());
+        QVERIFY(!spy.isEmpty() || spy.wait(waitTimeout));
+    }
+
+    reportThroughput("items", unread, timer.nsecsElapsed());
+
+    QVERIFY(waitForIdle());
+}
+
+
+void StorageBench::clearQueue()
+{
+    prepare(UpdatedItems);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QueryArgs args;
+    args.queuedOnly = true;
+    const int queued = countArticles(args);
+
+    QElapsedTimer timer;
+
+    QBENCHMARK_ONCE {
+        timer.start();
+        QSignalSpy spy(m_storage, &AbstractStorage::queueCleared);
+        m_storage->clearQueue();
+        QVERIFY(!spy.isEmpty() || spy.wait(waitTimeout));
+    }
+
+    reportThroughput("items", queued, timer.nsecsElapsed());
+
+    QVERIFY(waitForIdle());
+}
+
+
+QTEST_GUILESS_MAIN(StorageBench)
+
+#include "tst_storagebench.moc"
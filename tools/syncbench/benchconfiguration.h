@@ -0,0 +1,58 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENBENCHCONFIGURATION_H
+#define FUOTENBENCHCONFIGURATION_H
+
+#include <Fuoten/Helpers/AbstractConfiguration>
+#include <QVersionNumber>
+#include <QDateTime>
+
+/*
+ * Configuration that points to the FakeNewsServer and keeps the time of the
+ * last synchronization in memory, so that the second run performs an
+ * incremental synchronization.
+ */
+class BenchConfiguration : public Fuoten::AbstractConfiguration
+{
+    Q_OBJECT
+public:
+    explicit BenchConfiguration(quint16 port, QObject *parent = nullptr) :
+        Fuoten::AbstractConfiguration(parent), m_port(port)
+    {}
+
+    QString getUsername() const override { return QStringLiteral("bench"); }
+    QString getPassword() const override { return QStringLiteral("bench"); }
+    bool getUseSSL() const override { return false; }
+    QString getHost() const override { return QStringLiteral("127.0.0.1"); }
+    QString getInstallPath() const override { return QString(); }
+    int getServerPort() const override { return m_port; }
+    bool isAccountValid() const override { return true; }
+    QVersionNumber getServerVersion() const override { return QVersionNumber(18, 0, 0); }
+    void setServerVersion(const QString &nServerVersion) override { Q_UNUSED(nServerVersion); }
+    void setIsAccountValid(bool nIsAccountValid) override { Q_UNUSED(nIsAccountValid); }
+    QDateTime getLastSync() const override { return m_lastSync; }
+    void setLastSync(const QDateTime &syncTime) override { m_lastSync = syncTime; }
+
+private:
+    QDateTime m_lastSync;
+    quint16 m_port;
+};
+
+#endif // FUOTENBENCHCONFIGURATION_H
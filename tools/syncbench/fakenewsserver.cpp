@@ -0,0 +1,732 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "fakenewsserver.h"
+#include <QTcpSocket>
+#include <QTimer>
+#include <QPointer>
+#include <QUrlQuery>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QVariant>
+#include <algorithm>
+
+static const char *words[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do", "eiusmod", "tempor",
+    "incididunt", "ut", "labore", "et", "dolore", "magna", "aliqua", "enim", "ad", "minim", "veniam", "quis", "nostrud",
+    "exercitation", "ullamco", "laboris", "nisi", "aliquip", "ex", "ea", "commodo", "consequat", "duis", "aute", "irure",
+    "in", "reprehenderit", "voluptate", "velit", "esse", "cillum", "fugiat", "nulla", "pariatur", "excepteur", "sint",
+    "occaecat", "cupidatat", "non", "proident", "sunt", "culpa", "qui", "officia", "deserunt", "mollit", "anim", "id", "est"
+};
+static const int wordCount = sizeof(words) / sizeof(words[0]);
+
+static const QByteArray apiPrefix("/index.php/apps/news/api/v1-2");
+
+// the size of the buffered reply data, further item data is generated when the buffer has been sent
+static const int streamBufferSize = 256 * 1024;
+
+
+struct FakeNewsServer::Connection {
+    QByteArray received;
+    QByteArray out;
+    QVector<int> items;
+    int nextItem = 0;
+    bool streaming = false;
+    bool busy = false;
+    qint64 allowance = 0;
+    QElapsedTimer lastRefill;
+    QTimer *throttle = nullptr;
+};
+
+
+static void appendWords(QByteArray &ba, std::mt19937 &rnd, int count)
+{
+    std::uniform_int_distribution<int> w(0, wordCount - 1);
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            ba.append(' ');
+        }
+        ba.append(words[w(rnd)]);
+    }
+}
+
+
+static QByteArray md5(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+}
+
+
+FakeNewsServer::FakeNewsServer(const Options &options, QObject *parent) :
+    QObject(parent), m_options(options), m_random(options.seed)
+{
+    if (m_options.feeds <= 0) {
+        m_options.feeds = qMax(10, m_options.items / 500);
+    }
+    if (m_options.folders <= 0) {
+        m_options.folders = qMax(3, m_options.feeds / 20);
+    }
+    generate();
+}
+
+
+FakeNewsServer::~FakeNewsServer()
+{
+    qDeleteAll(m_connections);
+}
+
+
+quint16 FakeNewsServer::port() const
+{
+    return m_server ? m_server->serverPort() : 0;
+}
+
+
+int FakeNewsServer::requestCount() const
+{
+    return m_requests.load();
+}
+
+
+void FakeNewsServer::resetRequestCount()
+{
+    m_requests.store(0);
+}
+
+
+int FakeNewsServer::itemCount() const
+{
+    return m_items.size();
+}
+
+
+int FakeNewsServer::feedCount() const
+{
+    return m_feeds.size();
+}
+
+
+int FakeNewsServer::folderCount() const
+{
+    return m_folders.size();
+}
+
+
+bool FakeNewsServer::listen()
+{
+    if (!m_server) {
+        m_server = new QTcpServer(this);
+        connect(m_server, &QTcpServer::newConnection, this, &FakeNewsServer::onNewConnection);
+    }
+    return m_server->listen(QHostAddress::LocalHost, 0);
+}
+
+
+void FakeNewsServer::generate()
+{
+    m_clock = QDateTime::currentDateTimeUtc().toTime_t();
+
+    std::uniform_int_distribution<int> nameLength(1, 3);
+    for (int i = 1; i <= m_options.folders; ++i) {
+        QByteArray name;
+        appendWords(name, m_random, nameLength(m_random));
+        m_folders.append(qMakePair(QString::fromLatin1(name), static_cast<qint64>(i)));
+    }
+
+    std::uniform_int_distribution<int> folder(0, m_options.folders);
+    for (int i = 1; i <= m_options.feeds; ++i) {
+        QByteArray title;
+        appendWords(title, m_random, nameLength(m_random) + 1);
+        m_feeds.append(qMakePair(QString::fromLatin1(title), static_cast<qint64>(folder(m_random))));
+    }
+
+    m_items.reserve(m_options.items);
+    m_itemIndex.reserve(m_options.items);
+    for (qint64 id = 1; id <= m_options.items; ++id) {
+        m_itemIndex.insert(id, m_items.size());
+        m_items.append(generateItem(id, m_clock - 3600));
+    }
+}
+
+
+FakeNewsServer::Item FakeNewsServer::generateItem(qint64 id, uint lastModified)
+{
+    // every item has its own generator, so the item data does not depend on the order of generation
+    std::mt19937 rnd(m_options.seed * 1000003u + static_cast<quint32>(id));
+    std::uniform_int_distribution<qint64> feed(1, m_options.feeds);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    Item i;
+    i.id = id;
+    i.feedId = feed(rnd);
+    i.unread = chance(rnd) < 0.3;
+    i.starred = chance(rnd) < 0.02;
+    i.lastModified = lastModified;
+    return i;
+}
+
+
+QByteArray FakeNewsServer::itemJson(const Item &item) const
+{
+    // the text gets its own generator, so it stays the same when the state of the item changes
+    std::mt19937 rnd((m_options.seed * 1000003u + static_cast<quint32>(item.id)) ^ 0x5bd1e995u);
+    std::uniform_int_distribution<int> titleLength(3, 12);
+    std::uniform_int_distribution<int> paragraphLength(20, 80);
+    // body sizes of real feeds follow roughly a log-normal distribution with a median of about 2 KiB
+    std::lognormal_distribution<double> bodySize(7.6, 0.9);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    const QByteArray feedHost = QByteArrayLiteral("https://feed") + QByteArray::number(item.feedId) + QByteArrayLiteral(".example.com/");
+    const QByteArray guid = feedHost + QByteArrayLiteral("?p=") + QByteArray::number(item.id);
+    const uint pubDate = m_clock - 30 * 86400 + static_cast<uint>(item.id % (30 * 86400));
+
+    QByteArray ba;
+    ba.reserve(4096);
+    ba.append("{\"id\":").append(QByteArray::number(item.id));
+    ba.append(",\"guid\":\"").append(guid);
+    ba.append("\",\"guidHash\":\"").append(md5(guid));
+    ba.append("\",\"url\":\"").append(guid);
+    ba.append("\",\"title\":\"");
+    appendWords(ba, rnd, titleLength(rnd));
+    ba.append("\",\"author\":\"");
+    appendWords(ba, rnd, 2);
+    ba.append("\",\"pubDate\":").append(QByteArray::number(pubDate));
+    ba.append(",\"body\":\"");
+    const int size = qMin(static_cast<int>(bodySize(rnd)), 256 * 1024);
+    const int bodyStart = ba.size();
+    while ((ba.size() - bodyStart) < size) {
+        ba.append("<p>");
+        appendWords(ba, rnd, paragraphLength(rnd));
+        ba.append("<\\/p>");
+    }
+    if (chance(rnd) < 0.05) {
+        ba.append("\",\"enclosureMime\":\"audio/mpeg\",\"enclosureLink\":\"").append(feedHost).append(QByteArray::number(item.id)).append(".mp3\"");
+    } else {
+        ba.append("\",\"enclosureMime\":null,\"enclosureLink\":null");
+    }
+    ba.append(",\"feedId\":").append(QByteArray::number(item.feedId));
+    ba.append(",\"unread\":").append(item.unread ? "true" : "false");
+    ba.append(",\"starred\":").append(item.starred ? "true" : "false");
+    ba.append(",\"lastModified\":").append(QByteArray::number(item.lastModified));
+    ba.append(",\"fingerprint\":\"").append(md5(QByteArray::number(item.id) + '-' + QByteArray::number(item.lastModified)));
+    ba.append("\"}");
+    return ba;
+}
+
+
+QByteArray FakeNewsServer::folderJson() const
+{
+    QJsonArray folders;
+    for (const QPair<QString, qint64> &f : m_folders) {
+        QJsonObject o;
+        o.insert(QStringLiteral("id"), f.second);
+        o.insert(QStringLiteral("name"), f.first);
+        folders.append(o);
+    }
+    QJsonObject root;
+    root.insert(QStringLiteral("folders"), folders);
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+
+QByteArray FakeNewsServer::feedJson() const
+{
+    QJsonArray feeds;
+    for (int i = 0; i < m_feeds.size(); ++i) {
+        const qint64 id = i + 1;
+        const QString host = QStringLiteral("https://feed%1.example.com/").arg(id);
+        QJsonObject o;
+        o.insert(QStringLiteral("id"), id);
+        o.insert(QStringLiteral("url"), host + QLatin1String("rss.xml"));
+        o.insert(QStringLiteral("title"), m_feeds.at(i).first);
+        o.insert(QStringLiteral("faviconLink"), host + QLatin1String("favicon.ico"));
+        o.insert(QStringLiteral("added"), static_cast<qint64>(m_clock - 90 * 86400 + id * 60));
+        o.insert(QStringLiteral("folderId"), m_feeds.at(i).second);
+        o.insert(QStringLiteral("unreadCount"), 0);
+        o.insert(QStringLiteral("ordering"), 0);
+        o.insert(QStringLiteral("link"), host);
+        o.insert(QStringLiteral("pinned"), false);
+        o.insert(QStringLiteral("updateErrorCount"), 0);
+        o.insert(QStringLiteral("lastUpdateError"), QJsonValue());
+        feeds.append(o);
+    }
+    int starred = 0;
+    for (const Item &i : m_items) {
+        if (i.starred) {
+            starred++;
+        }
+    }
+    QJsonObject root;
+    root.insert(QStringLiteral("feeds"), feeds);
+    root.insert(QStringLiteral("starredCount"), starred);
+    root.insert(QStringLiteral("newestItemId"), m_items.isEmpty() ? 0 : m_items.last().id);
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+
+int FakeNewsServer::applyUpdate(double ratio)
+{
+    m_clock = qMax(QDateTime::currentDateTimeUtc().toTime_t(), m_clock + 1);
+
+    const int updateCount = qMax(1, static_cast<int>(m_items.size() * ratio));
+    const int changedCount = qMin(updateCount / 2, m_items.size());
+
+    // changed items toggle their unread state like it happens when reading on another device
+    QVector<int> indexes(m_items.size());
+    for (int i = 0; i < indexes.size(); ++i) {
+        indexes[i] = i;
+    }
+    for (int i = 0; i < changedCount; ++i) {
+        std::uniform_int_distribution<int> pick(i, indexes.size() - 1);
+        std::swap(indexes[i], indexes[pick(m_random)]);
+        Item &item = m_items[indexes.at(i)];
+        item.unread = !item.unread;
+        item.lastModified = m_clock;
+    }
+
+    qint64 nextId = m_items.isEmpty() ? 1 : m_items.last().id + 1;
+    for (int i = changedCount; i < updateCount; ++i) {
+        m_itemIndex.insert(nextId, m_items.size());
+        m_items.append(generateItem(nextId, m_clock));
+        nextId++;
+    }
+    m_guidHashIndex.clear();
+
+    return updateCount;
+}
+
+
+void FakeNewsServer::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        Connection *c = new Connection;
+        c->allowance = m_options.bandwidth / 10;
+        c->lastRefill.start();
+        m_connections.insert(socket, c);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket] () {onReadyRead(socket);});
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, socket] () {pump(socket);});
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket] () {
+            delete m_connections.take(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+
+void FakeNewsServer::onReadyRead(QTcpSocket *socket)
+{
+    Connection *c = m_connections.value(socket);
+    if (!c) {
+        return;
+    }
+
+    c->received.append(socket->readAll());
+
+    // requests are answered one after another, the client does not use pipelining
+    if (c->busy) {
+        return;
+    }
+
+    const int headerEnd = c->received.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+
+    const QList<QByteArray> lines = c->received.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() < 2) {
+        socket->disconnectFromHost();
+        return;
+    }
+
+    int contentLength = 0;
+    for (int i = 1; i < lines.size(); ++i) {
+        const QByteArray line = lines.at(i).trimmed();
+        if (line.toLower().startsWith("content-length:")) {
+            contentLength = line.mid(15).trimmed().toInt();
+        }
+    }
+
+    if (c->received.size() < (headerEnd + 4 + contentLength)) {
+        return;
+    }
+
+    Request r;
+    r.method = requestLine.at(0);
+    const QByteArray target = requestLine.at(1);
+    const int queryStart = target.indexOf('?');
+    r.path = (queryStart < 0) ? target : target.left(queryStart);
+    r.query = (queryStart < 0) ? QByteArray() : target.mid(queryStart + 1);
+    r.body = c->received.mid(headerEnd + 4, contentLength);
+    c->received.remove(0, headerEnd + 4 + contentLength);
+    c->busy = true;
+
+    m_requests.ref();
+
+    if (m_options.latency > 0) {
+        QPointer<QTcpSocket> s(socket);
+        QTimer::singleShot(m_options.latency, this, [this, s, r] () {
+            if (s) {
+                handle(s, r);
+            }
+        });
+    } else {
+        handle(socket, r);
+    }
+}
+
+
+void FakeNewsServer::handle(QTcpSocket *socket, const Request &request)
+{
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    if ((m_options.failureRate > 0.0) && (chance(m_random) < m_options.failureRate)) {
+        sendReply(socket, 503, QByteArray());
+        return;
+    }
+
+    route(socket, request);
+}
+
+
+void FakeNewsServer::route(QTcpSocket *socket, const Request &request)
+{
+    if (!request.path.startsWith(apiPrefix)) {
+        sendReply(socket, 404, QByteArray());
+        return;
+    }
+
+    const QList<QByteArray> parts = request.path.mid(apiPrefix.size() + 1).split('/');
+    const QUrlQuery query(QString::fromLatin1(request.query));
+    const bool get = (request.method == "GET");
+    const bool put = (request.method == "PUT");
+    const QByteArray first = parts.value(0);
+
+    if (get && (parts.size() == 1)) {
+        if (first == "version") {
+            sendReply(socket, 200, QByteArrayLiteral("{\"version\":\"18.0.0\"}"));
+        } else if (first == "status") {
+            sendReply(socket, 200, QByteArrayLiteral("{\"version\":\"18.0.0\",\"warnings\":{\"improperlyConfiguredCron\":false,\"incorrectDbCharset\":false}}"));
+        } else if (first == "user") {
+            sendReply(socket, 200, QByteArrayLiteral("{\"userId\":\"bench\",\"displayName\":\"Benchmark\",\"lastLoginTimestamp\":0,\"avatar\":null}"));
+        } else if (first == "folders") {
+            sendReply(socket, 200, folderJson());
+        } else if (first == "feeds") {
+            sendReply(socket, 200, feedJson());
+        } else if (first == "items") {
+            sendItems(socket, selectItems(query, false));
+        } else {
+            sendReply(socket, 404, QByteArray());
+        }
+        return;
+    }
+
+    if (get && (parts.size() == 2) && (first == "items") && (parts.at(1) == "updated")) {
+        sendItems(socket, selectItems(query, true));
+        return;
+    }
+
+    if (put && (first == "items")) {
+        if ((parts.size() == 3) && (parts.at(2) == "multiple")) {
+            const QByteArray action = parts.at(1);
+            if (action == "read" || action == "unread") {
+                applyToItems(request.body, false, action == "unread", false);
+            } else {
+                applyToItems(request.body, true, false, action == "star");
+            }
+            sendReply(socket, 200, QByteArray());
+            return;
+        }
+        if ((parts.size() == 3) && (parts.at(2) == "read" || parts.at(2) == "unread")) {
+            const int idx = m_itemIndex.value(parts.at(1).toLongLong(), -1);
+            if (idx > -1) {
+                m_items[idx].unread = (parts.at(2) == "unread");
+                m_items[idx].lastModified = m_clock;
+            }
+            sendReply(socket, 200, QByteArray());
+            return;
+        }
+        if ((parts.size() == 4) && (parts.at(3) == "star" || parts.at(3) == "unstar")) {
+            QJsonObject o;
+            o.insert(QStringLiteral("feedId"), parts.at(1).toLongLong());
+            o.insert(QStringLiteral("guidHash"), QString::fromLatin1(parts.at(2)));
+            QJsonObject root;
+            root.insert(QStringLiteral("items"), QJsonArray({o}));
+            applyToItems(QJsonDocument(root).toJson(QJsonDocument::Compact), true, false, parts.at(3) == "star");
+            sendReply(socket, 200, QByteArray());
+            return;
+        }
+        if ((parts.size() == 2) && (parts.at(1) == "read")) {
+            markRead(0, false, QJsonDocument::fromJson(request.body).object().value(QStringLiteral("newestItemId")).toVariant().toLongLong());
+            sendReply(socket, 200, QByteArray());
+            return;
+        }
+    }
+
+    if (put && (parts.size() == 3) && (parts.at(2) == "read") && (first == "feeds" || first == "folders")) {
+        markRead(parts.at(1).toLongLong(), first == "folders", QJsonDocument::fromJson(request.body).object().value(QStringLiteral("newestItemId")).toVariant().toLongLong());
+        sendReply(socket, 200, QByteArray());
+        return;
+    }
+
+    sendReply(socket, 404, QByteArray());
+}
+
+
+/*
+ * Returns the indexes of the items that match the query of the items or the
+ * items/updated route, in the order they are sent.
+ */
+QVector<int> FakeNewsServer::selectItems(const QUrlQuery &query, bool updated) const
+{
+    const int type = query.hasQueryItem(QStringLiteral("type")) ? query.queryItemValue(QStringLiteral("type")).toInt() : 3;
+    const qint64 id = query.queryItemValue(QStringLiteral("id")).toLongLong();
+    const uint lastModified = query.queryItemValue(QStringLiteral("lastModified")).toUInt();
+    const bool getRead = (query.queryItemValue(QStringLiteral("getRead")) != QLatin1String("false"));
+    const bool oldestFirst = (query.queryItemValue(QStringLiteral("oldestFirst")) == QLatin1String("true"));
+    const int batchSize = query.hasQueryItem(QStringLiteral("batchSize")) ? query.queryItemValue(QStringLiteral("batchSize")).toInt() : -1;
+    const qint64 offset = query.queryItemValue(QStringLiteral("offset")).toLongLong();
+
+    QVector<int> result;
+
+    // the items are sorted by ID, because new items are appended
+    const int count = m_items.size();
+    for (int n = 0; n < count; ++n) {
+        const int idx = (updated || oldestFirst) ? n : (count - 1 - n);
+        const Item &i = m_items.at(idx);
+
+        if (updated) {
+            if (i.lastModified < lastModified) {
+                continue;
+            }
+        } else {
+            if (!getRead && !i.unread) {
+                continue;
+            }
+            if ((offset > 0) && (oldestFirst ? (i.id <= offset) : (i.id >= offset))) {
+                continue;
+            }
+        }
+
+        switch (type) {
+        case 0:
+            if (i.feedId != id) {
+                continue;
+            }
+            break;
+        case 1:
+            if (m_feeds.at(static_cast<int>(i.feedId) - 1).second != id) {
+                continue;
+            }
+            break;
+        case 2:
+            if (!i.starred) {
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+
+        result.append(idx);
+        if (!updated && (batchSize > 0) && (result.size() >= batchSize)) {
+            break;
+        }
+    }
+
+    return result;
+}
+
+
+void FakeNewsServer::applyToItems(const QByteArray &body, bool guidHashes, bool unread, bool star)
+{
+    if (guidHashes && m_guidHashIndex.isEmpty()) {
+        m_guidHashIndex.reserve(m_items.size());
+        for (int idx = 0; idx < m_items.size(); ++idx) {
+            const Item &i = m_items.at(idx);
+            const QByteArray guid = QByteArrayLiteral("https://feed") + QByteArray::number(i.feedId) + QByteArrayLiteral(".example.com/?p=") + QByteArray::number(i.id);
+            m_guidHashIndex.insert(qMakePair(i.feedId, md5(guid)), idx);
+        }
+    }
+
+    const QJsonArray items = QJsonDocument::fromJson(body).object().value(QStringLiteral("items")).toArray();
+    for (const QJsonValue &v : items) {
+        int idx = -1;
+        if (guidHashes) {
+            const QJsonObject o = v.toObject();
+            idx = m_guidHashIndex.value(qMakePair(o.value(QStringLiteral("feedId")).toVariant().toLongLong(), o.value(QStringLiteral("guidHash")).toString().toLatin1()), -1);
+        } else {
+            idx = m_itemIndex.value(v.toVariant().toLongLong(), -1);
+        }
+        if (idx < 0) {
+            continue;
+        }
+        Item &i = m_items[idx];
+        if (guidHashes) {
+            i.starred = star;
+        } else {
+            i.unread = unread;
+        }
+        i.lastModified = m_clock;
+    }
+}
+
+
+void FakeNewsServer::markRead(qint64 id, bool folder, qint64 newestItemId)
+{
+    for (Item &i : m_items) {
+        if (!i.unread || (i.id > newestItemId)) {
+            continue;
+        }
+        if ((id > 0) && ((folder ? m_feeds.at(static_cast<int>(i.feedId) - 1).second : i.feedId) != id)) {
+            continue;
+        }
+        i.unread = false;
+        i.lastModified = m_clock;
+    }
+}
+
+
+void FakeNewsServer::sendReply(QTcpSocket *socket, int status, const QByteArray &body)
+{
+    Connection *c = m_connections.value(socket);
+    if (!c) {
+        return;
+    }
+
+    QByteArray statusText;
+    switch (status) {
+    case 200:
+        statusText = QByteArrayLiteral("OK");
+        break;
+    case 404:
+        statusText = QByteArrayLiteral("Not Found");
+        break;
+    default:
+        statusText = QByteArrayLiteral("Service Unavailable");
+        break;
+    }
+
+    c->out.append("HTTP/1.1 ").append(QByteArray::number(status)).append(' ').append(statusText).append("\r\n");
+    c->out.append("Content-Type: application/json; charset=utf-8\r\n");
+    c->out.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n\r\n");
+    c->out.append(body);
+
+    pump(socket);
+}
+
+
+void FakeNewsServer::sendItems(QTcpSocket *socket, const QVector<int> &indexes)
+{
+    Connection *c = m_connections.value(socket);
+    if (!c) {
+        return;
+    }
+
+    c->out.append("HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nTransfer-Encoding: chunked\r\n\r\n");
+    c->items = indexes;
+    c->nextItem = -1;
+    c->streaming = true;
+
+    pump(socket);
+}
+
+
+/*
+ * Generates further item data if the buffer is running empty and writes as much
+ * data as the bandwidth cap allows. Called again when data has been written
+ * or the throttle timer fires.
+ */
+void FakeNewsServer::pump(QTcpSocket *socket)
+{
+    Connection *c = m_connections.value(socket);
+    if (!c) {
+        return;
+    }
+
+    while (c->streaming && (c->out.size() < streamBufferSize)) {
+        QByteArray chunk;
+        if (c->nextItem < 0) {
+            chunk = QByteArrayLiteral("{\"items\":[");
+            c->nextItem = 0;
+        }
+        while ((c->nextItem < c->items.size()) && (chunk.size() < streamBufferSize)) {
+            if (c->nextItem > 0) {
+                chunk.append(',');
+            }
+            chunk.append(itemJson(m_items.at(c->items.at(c->nextItem))));
+            c->nextItem++;
+        }
+        if (c->nextItem >= c->items.size()) {
+            chunk.append("]}");
+            c->streaming = false;
+            c->items.clear();
+        }
+        c->out.append(QByteArray::number(chunk.size(), 16)).append("\r\n").append(chunk).append("\r\n");
+        if (!c->streaming) {
+            c->out.append("0\r\n\r\n");
+        }
+    }
+
+    qint64 budget = c->out.size();
+
+    if (m_options.bandwidth > 0) {
+        // token bucket that allows bursts of up to 100 milliseconds
+        c->allowance = qMin(c->allowance + (c->lastRefill.restart() * m_options.bandwidth) / 1000, qMax<qint64>(m_options.bandwidth / 10, 1));
+        budget = qMin(budget, c->allowance);
+    }
+
+    // wait for the socket to drain its buffer before writing more
+    if (socket->bytesToWrite() > streamBufferSize) {
+        budget = 0;
+    }
+
+    if (budget > 0) {
+        const qint64 written = socket->write(c->out.constData(), budget);
+        if (written > 0) {
+            c->out.remove(0, static_cast<int>(written));
+            c->allowance -= written;
+        }
+    }
+
+    if (!c->out.isEmpty() || c->streaming) {
+        if ((m_options.bandwidth > 0) && (socket->bytesToWrite() == 0)) {
+            if (!c->throttle) {
+                c->throttle = new QTimer(socket);
+                c->throttle->setSingleShot(true);
+                c->throttle->setInterval(20);
+                connect(c->throttle, &QTimer::timeout, this, [this, socket] () {pump(socket);});
+            }
+            if (!c->throttle->isActive()) {
+                c->throttle->start();
+            }
+        }
+        return;
+    }
+
+    // the reply has been handed to the socket, the next request can be processed
+    if (c->busy) {
+        c->busy = false;
+        QTimer::singleShot(0, socket, [this, socket] () {onReadyRead(socket);});
+    }
+}
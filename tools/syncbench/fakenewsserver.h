@@ -0,0 +1,131 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUOTENFAKENEWSSERVER_H
+#define FUOTENFAKENEWSSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QAtomicInt>
+#include <random>
+
+class QTcpSocket;
+class QUrlQuery;
+
+/*
+ * Minimal stand-in for the News App API v1.2 of a Nextcloud server that is used
+ * to benchmark the Synchronizer without a real server.
+ *
+ * The server generates a deterministic synthetic data set and implements the
+ * routes the API classes use. Only the metadata of the items is kept in memory,
+ * the JSON representation of an item is built from its ID when it is sent, so
+ * that the memory usage of the server does not distort the measurement of the
+ * client. Big replies are streamed with chunked transfer encoding.
+ *
+ * Latency, a bandwidth cap and a failure rate can be injected. Failed requests
+ * are answered with 503 Service Unavailable, that is retried by the library.
+ */
+class FakeNewsServer : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options {
+        int items = 1000;
+        int feeds = 0;
+        int folders = 0;
+        quint32 seed = 1;
+        int latency = 0;            // milliseconds added to every reply
+        qint64 bandwidth = 0;       // bytes per second and connection, 0 means unlimited
+        double failureRate = 0.0;   // probability of answering with 503
+    };
+
+    explicit FakeNewsServer(const Options &options, QObject *parent = nullptr);
+    ~FakeNewsServer() override;
+
+    quint16 port() const;
+    int requestCount() const;
+    void resetRequestCount();
+
+    int itemCount() const;
+    int feedCount() const;
+    int folderCount() const;
+
+public Q_SLOTS:
+    bool listen();
+
+    /*
+     * Changes the read state of ratio/2 existing items and adds new items, like
+     * it happens between two synchronizations. Returns the number of changed
+     * and added items.
+     */
+    int applyUpdate(double ratio);
+
+private:
+    struct Item {
+        qint64 id;
+        qint64 feedId;
+        uint lastModified;
+        bool unread;
+        bool starred;
+    };
+
+    struct Request {
+        QByteArray method;
+        QByteArray path;
+        QByteArray query;
+        QByteArray body;
+    };
+
+    struct Connection;
+
+    void generate();
+    Item generateItem(qint64 id, uint lastModified);
+    QByteArray itemJson(const Item &item) const;
+    QByteArray folderJson() const;
+    QByteArray feedJson() const;
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket *socket);
+    void handle(QTcpSocket *socket, const Request &request);
+    void route(QTcpSocket *socket, const Request &request);
+    QVector<int> selectItems(const QUrlQuery &query, bool updated) const;
+    void applyToItems(const QByteArray &body, bool guidHashes, bool unread, bool star);
+    void markRead(qint64 id, bool folder, qint64 newestItemId);
+
+    void sendReply(QTcpSocket *socket, int status, const QByteArray &body);
+    void sendItems(QTcpSocket *socket, const QVector<int> &indexes);
+    void pump(QTcpSocket *socket);
+
+    Options m_options;
+    QTcpServer *m_server = nullptr;
+    QVector<QPair<QString, qint64> > m_folders; // name, id
+    QVector<QPair<QString, qint64> > m_feeds;   // title, folder ID
+    QVector<Item> m_items;
+    QHash<qint64, int> m_itemIndex;
+    QHash<QPair<qint64, QByteArray>, int> m_guidHashIndex;
+    QHash<QTcpSocket*, Connection*> m_connections;
+    std::mt19937 m_random;
+    QAtomicInt m_requests;
+    uint m_clock = 0;
+};
+
+#endif // FUOTENFAKENEWSSERVER_H
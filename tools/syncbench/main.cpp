@@ -0,0 +1,262 @@
+/* libfuoten - Qt based library to access the ownCloud/Nextcloud News App API
+ * Copyright (C) 2016-2017 Matthias Fehring
+ * https://github.com/Huessenbergnetz/libfuoten
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThread>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <Fuoten/API/Component>
+#include <Fuoten/Helpers/Synchronizer>
+#include <Fuoten/Helpers/MetricsAggregator>
+#include <Fuoten/Helpers/Tracer>
+#include <Fuoten/Helpers/TrafficRecorder>
+#include <Fuoten/Helpers/ReplayNamFactory>
+#include <Fuoten/Storage/SQLiteStorage>
+#include <Fuoten/Storage/MemoryStorage>
+#include <Fuoten/Error>
+#include "fakenewsserver.h"
+#include "benchconfiguration.h"
+
+/*
+ * Returns the peak resident set size of the process in KiB, or -1 if it is
+ * not available on this platform.
+ */
+static qint64 peakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile f(QStringLiteral("/proc/self/status"));
+    if (f.open(QIODevice::ReadOnly|QIODevice::Text)) {
+        const QList<QByteArray> lines = f.readAll().split('\n');
+        for (const QByteArray &line : lines) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+#endif
+    return -1;
+}
+
+
+/*
+ * Resets the peak resident set size, so that every synchronization gets its
+ * own value. Requires Linux 4.0 or newer.
+ */
+static void resetPeakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile f(QStringLiteral("/proc/self/clear_refs"));
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write("5");
+    }
+#endif
+}
+
+
+struct RunResult {
+    qint64 wallTime = 0;
+    int requests = 0;
+    qint64 peakMemory = -1;
+    bool succeeded = false;
+};
+
+
+static RunResult runSync(Fuoten::Synchronizer *sync, FakeNewsServer *server, bool replaying)
+{
+    RunResult r;
+
+    server->resetRequestCount();
+    resetPeakMemory();
+
+    QEventLoop loop;
+    QObject::connect(sync, &Fuoten::Synchronizer::succeeded, &loop, [&loop, &r] () {
+        r.succeeded = true;
+        loop.quit();
+    });
+    QObject::connect(sync, &Fuoten::Synchronizer::failed, &loop, [&loop] (Fuoten::Error *e) {
+        QTextStream(stderr) << "Synchronization failed: " << (e ? e->text() : QString()) << endl;
+        loop.quit();
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    sync->start();
+    loop.exec();
+
+    r.wallTime = timer.elapsed();
+    r.requests = replaying ? -1 : server->requestCount();
+    r.peakMemory = peakMemory();
+
+    return r;
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName(QStringLiteral("Huessenbergnetz"));
+    app.setApplicationName(QStringLiteral("fuoten-syncbench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Measures the first and an incremental synchronization against a local stand-in for the News App API."));
+    parser.addHelpOption();
+    parser.addOptions({
+        {QStringLiteral("items"), QStringLiteral("Number of items on the server (default: 10000)."), QStringLiteral("count"), QStringLiteral("10000")},
+        {QStringLiteral("feeds"), QStringLiteral("Number of feeds, defaults to items / 500."), QStringLiteral("count"), QStringLiteral("0")},
+        {QStringLiteral("folders"), QStringLiteral("Number of folders, defaults to feeds / 20."), QStringLiteral("count"), QStringLiteral("0")},
+        {QStringLiteral("seed"), QStringLiteral("Seed of the data generator (default: 1)."), QStringLiteral("seed"), QStringLiteral("1")},
+        {QStringLiteral("update-ratio"), QStringLiteral("Ratio of items that are changed or added before the incremental synchronization (default: 0.05)."), QStringLiteral("ratio"), QStringLiteral("0.05")},
+        {QStringLiteral("latency"), QStringLiteral("Latency added to every reply in milliseconds (default: 0)."), QStringLiteral("msecs"), QStringLiteral("0")},
+        {QStringLiteral("bandwidth"), QStringLiteral("Bandwidth per connection in KiB/s, 0 means unlimited (default: 0)."), QStringLiteral("kibps"), QStringLiteral("0")},
+        {QStringLiteral("failure-rate"), QStringLiteral("Ratio of requests that fail with 503 (default: 0)."), QStringLiteral("ratio"), QStringLiteral("0")},
+        {QStringLiteral("storage"), QStringLiteral("Storage backend, sqlite or memory (default: sqlite)."), QStringLiteral("type"), QStringLiteral("sqlite")},
+        {QStringLiteral("page-size"), QStringLiteral("Page size of the initial synchronization, 0 requests all items at once (default: 0)."), QStringLiteral("count"), QStringLiteral("0")},
+        {QStringLiteral("metrics"), QStringLiteral("Print request metrics per API route.")},
+        {QStringLiteral("trace"), QStringLiteral("Write a Chrome trace of both synchronizations to <file>."), QStringLiteral("file")},
+        {QStringLiteral("record"), QStringLiteral("Record the traffic of both synchronizations to <file>."), QStringLiteral("file")},
+        {QStringLiteral("replay"), QStringLiteral("Replay the traffic recorded in <file> instead of using the stand-in server."), QStringLiteral("file")}
+    });
+    parser.process(app);
+
+    FakeNewsServer::Options options;
+    options.items = parser.value(QStringLiteral("items")).toInt();
+    options.feeds = parser.value(QStringLiteral("feeds")).toInt();
+    options.folders = parser.value(QStringLiteral("folders")).toInt();
+    options.seed = parser.value(QStringLiteral("seed")).toUInt();
+    options.latency = parser.value(QStringLiteral("latency")).toInt();
+    options.bandwidth = parser.value(QStringLiteral("bandwidth")).toLongLong() * 1024;
+    options.failureRate = parser.value(QStringLiteral("failure-rate")).toDouble();
+
+    QTextStream out(stdout);
+
+    // the server runs in its own thread, so that it does not compete with the client for the event loop
+    FakeNewsServer *server = new FakeNewsServer(options);
+    QThread serverThread;
+    server->moveToThread(&serverThread);
+    QObject::connect(&serverThread, &QThread::finished, server, &QObject::deleteLater);
+    serverThread.start();
+
+    bool listening = false;
+    QMetaObject::invokeMethod(server, "listen", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, listening));
+    if (!listening) {
+        QTextStream(stderr) << "Failed to start the server." << endl;
+        serverThread.quit();
+        serverThread.wait();
+        return 1;
+    }
+
+    out << "Data set: " << server->itemCount() << " items, " << server->feedCount() << " feeds, " << server->folderCount() << " folders" << endl;
+
+    BenchConfiguration config(server->port());
+
+    QTemporaryDir tmpDir;
+    Fuoten::AbstractStorage *storage = nullptr;
+    if (parser.value(QStringLiteral("storage")) == QLatin1String("memory")) {
+        storage = new Fuoten::MemoryStorage(&app);
+    } else {
+        storage = new Fuoten::SQLiteStorage(tmpDir.filePath(QStringLiteral("fuoten.sqlite")), &app);
+    }
+    storage->setConfiguration(&config);
+
+    QEventLoop initLoop;
+    QObject::connect(storage, &Fuoten::AbstractStorage::readyChanged, &initLoop, &QEventLoop::quit);
+    storage->init();
+    if (!storage->ready()) {
+        initLoop.exec();
+    }
+
+    out << "Storage: " << storage->metaObject()->className() << endl;
+
+    Fuoten::MetricsAggregator metrics;
+    if (parser.isSet(QStringLiteral("metrics"))) {
+        Fuoten::Component::setDefaultMetricsSink(&metrics);
+    }
+
+    if (parser.isSet(QStringLiteral("trace"))) {
+        Fuoten::Tracer::setEnabled(true);
+    }
+
+    Fuoten::TrafficRecorder recorder;
+    if (parser.isSet(QStringLiteral("record"))) {
+        if (!recorder.open(parser.value(QStringLiteral("record")))) {
+            return 1;
+        }
+        Fuoten::Component::setDefaultTrafficRecorder(&recorder);
+    }
+
+    // the replayed replies are answered without network access, the request count is not available then
+    Fuoten::ReplayNamFactory replay;
+    const bool replaying = parser.isSet(QStringLiteral("replay"));
+    if (replaying) {
+        if (!replay.load(parser.value(QStringLiteral("replay")))) {
+            return 1;
+        }
+        Fuoten::Component::setNetworkAccessManagerFactory(&replay);
+        out << "Replaying " << replay.count() << " recorded replies" << endl;
+    }
+
+    Fuoten::Synchronizer sync;
+    sync.setConfiguration(&config);
+    sync.setStorage(storage);
+    sync.setPageSize(parser.value(QStringLiteral("page-size")).toInt());
+
+    const RunResult first = runSync(&sync, server, replaying);
+
+    int updated = 0;
+    QMetaObject::invokeMethod(server, "applyUpdate", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, updated), Q_ARG(double, parser.value(QStringLiteral("update-ratio")).toDouble()));
+
+    const RunResult incremental = first.succeeded ? runSync(&sync, server, replaying) : RunResult();
+
+    out << endl;
+    out << qSetFieldWidth(14) << left << "sync" << right << "wall time [ms]" << "requests" << "peak RSS [KiB]" << qSetFieldWidth(0) << endl;
+    out << qSetFieldWidth(14) << left << "first" << right << first.wallTime << first.requests << first.peakMemory << qSetFieldWidth(0) << endl;
+    if (first.succeeded) {
+        out << qSetFieldWidth(14) << left << "incremental" << right << incremental.wallTime << incremental.requests << incremental.peakMemory << qSetFieldWidth(0) << endl;
+        out << "(" << updated << " items changed or added before the incremental synchronization)" << endl;
+    }
+
+    if (parser.isSet(QStringLiteral("metrics"))) {
+        Fuoten::Component::setDefaultMetricsSink(nullptr);
+        out << endl << QJsonDocument(metrics.toJson()).toJson(QJsonDocument::Indented);
+    }
+
+    if (parser.isSet(QStringLiteral("record"))) {
+        Fuoten::Component::setDefaultTrafficRecorder(nullptr);
+        recorder.close();
+    }
+
+    if (replaying && (replay.unmatched() > 0)) {
+        out << replay.unmatched() << " requests had no recorded reply" << endl;
+    }
+
+    if (parser.isSet(QStringLiteral("trace"))) {
+        Fuoten::Tracer::setEnabled(false);
+        Fuoten::Tracer::save(parser.value(QStringLiteral("trace")));
+    }
+
+    serverThread.quit();
+    serverThread.wait();
+
+    return (first.succeeded && incremental.succeeded) ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+TARGET = fuoten-syncbench
+TEMPLATE = app
+
+QT += network sql
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += c++11
+CONFIG += no_keywords
+
+# the directory containing libfuoten, defaults to the Qt library directory
+isEmpty(FUOTEN_LIB_DIR): FUOTEN_LIB_DIR = $$[QT_INSTALL_LIBS]
+
+INCLUDEPATH += $$PWD/../..
+LIBS += -L$${FUOTEN_LIB_DIR} -lfuoten
+QMAKE_RPATHDIR += $${FUOTEN_LIB_DIR}
+
+HEADERS += \
+    fakenewsserver.h \
+    benchconfiguration.h
+
+SOURCES += \
+    main.cpp \
+    fakenewsserver.cpp